@@ -0,0 +1,131 @@
+// Compares BoxCulling's SIMD paths against the scalar reference: Frustum::intersects
+// over an array of boxes, and a glm::min/max loop over Vertex positions and UVs.
+//
+// Usage: cullingBenchmark [boxes] [vertices]
+//   Boxes are scattered around a camera looking down -Z, so about a tenth pass;
+//   defaults are 100000 boxes and 4M vertices. Every path's output is checked
+//   against the reference and a mismatch fails the run.
+
+#include "src/scene/BoxCulling.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr int ITERATIONS = 20;
+
+    struct Box {
+        glm::vec3 boundsMin;
+        glm::vec3 boundsMax;
+    };
+
+    template<typename Run>
+    double bestSeconds(Run&& run) {
+        double best = 1e30;
+        for (int i = 0; i < ITERATIONS; i++) {
+            auto start = std::chrono::steady_clock::now();
+            run();
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+
+    bool sameBounds(const VertexBounds& a, const VertexBounds& b) {
+        return a.posMin == b.posMin && a.posMax == b.posMax && a.uvMin == b.uvMin && a.uvMax == b.uvMax;
+    }
+
+    constexpr BoxCulling::Path PATHS[] = {
+        BoxCulling::Path::Scalar, BoxCulling::Path::SSE, BoxCulling::Path::AVX2, BoxCulling::Path::NEON
+    };
+}
+
+int main(int argc, char* argv[]) {
+    const uint32_t boxCount = argc > 1 ? static_cast<uint32_t>(std::stoul(argv[1])) : 100000;
+    const size_t vertexCount = argc > 2 ? std::stoull(argv[2]) : 4u << 20;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> position(-100.0f, 100.0f);
+    std::uniform_real_distribution<float> size(0.1f, 4.0f);
+
+    std::vector<Box> boxes(boxCount);
+    BoxList list;
+    list.reserve(boxCount);
+    for (Box& box : boxes) {
+        const glm::vec3 center(position(rng), position(rng), position(rng));
+        const glm::vec3 extent(size(rng), size(rng), size(rng));
+        box = { center - extent, center + extent };
+        list.add(box.boundsMin, box.boundsMax);
+    }
+
+    std::vector<Vertex> vertices(vertexCount);
+    for (Vertex& vertex : vertices) {
+        vertex.pos = glm::vec3(position(rng), position(rng), position(rng));
+        vertex.color = glm::vec3(1.0f);
+        vertex.texCoord = glm::vec2(position(rng), position(rng));
+    }
+
+    const glm::mat4 proj = glm::perspective(glm::radians(60.0f), 16.0f / 9.0f, 0.1f, 150.0f);
+    const glm::mat4 view = glm::lookAt(glm::vec3(0.0f), glm::vec3(0.0f, 0.0f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    const Frustum frustum = Frustum::fromMatrix(proj * view);
+
+    std::printf("best path: %s\n", BoxCulling::getPathName(BoxCulling::getBestPath()));
+
+    // Reference: the per-box test the renderer used before BoxCulling
+    std::vector<uint32_t> expected;
+    const double reference = bestSeconds([&] {
+        expected.clear();
+        for (uint32_t i = 0; i < boxCount; i++) {
+            if (frustum.intersects(boxes[i].boundsMin, boxes[i].boundsMax)) {
+                expected.push_back(i);
+            }
+        }
+    });
+    std::printf("%u boxes, %zu visible\n", boxCount, expected.size());
+    std::printf("  Frustum::intersects: %8.3f ms  %6.2f ns/box\n", reference * 1000.0, reference * 1e9 / boxCount);
+
+    bool matches = true;
+    std::vector<uint32_t> visible;
+    for (BoxCulling::Path path : PATHS) {
+        if (!BoxCulling::isSupported(path)) {
+            continue;
+        }
+        const double seconds = bestSeconds([&] { BoxCulling::cull(frustum, list, visible, path); });
+        const bool same = visible == expected;
+        matches = matches && same;
+        std::printf("  %-19s %8.3f ms  %6.2f ns/box  %.2fx%s\n", (std::string(BoxCulling::getPathName(path)) + ":").c_str(),
+                    seconds * 1000.0, seconds * 1e9 / boxCount, reference / seconds, same ? "" : "  MISMATCH");
+    }
+
+    VertexBounds expectedBounds;
+    const double boundsReference = bestSeconds([&] {
+        expectedBounds = VertexBounds{};
+        for (const Vertex& vertex : vertices) {
+            expectedBounds.posMin = glm::min(expectedBounds.posMin, vertex.pos);
+            expectedBounds.posMax = glm::max(expectedBounds.posMax, vertex.pos);
+            expectedBounds.uvMin = glm::min(expectedBounds.uvMin, vertex.texCoord);
+            expectedBounds.uvMax = glm::max(expectedBounds.uvMax, vertex.texCoord);
+        }
+    });
+    std::printf("%zu vertices\n", vertexCount);
+    std::printf("  glm::min/max loop:   %8.3f ms  %6.2f GB/s\n", boundsReference * 1000.0,
+                static_cast<double>(vertexCount * sizeof(Vertex)) / boundsReference * 1e-9);
+    for (BoxCulling::Path path : PATHS) {
+        if (!BoxCulling::isSupported(path)) {
+            continue;
+        }
+        VertexBounds bounds;
+        const double seconds = bestSeconds([&] { bounds = BoxCulling::computeBounds(vertices, path); });
+        const bool same = sameBounds(bounds, expectedBounds);
+        matches = matches && same;
+        std::printf("  %-19s %8.3f ms  %6.2f GB/s  %.2fx%s\n", (std::string(BoxCulling::getPathName(path)) + ":").c_str(),
+                    seconds * 1000.0, static_cast<double>(vertexCount * sizeof(Vertex)) / seconds * 1e-9,
+                    boundsReference / seconds, same ? "" : "  MISMATCH");
+    }
+
+    return matches ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,259 @@
+// Renders scripted camera paths offscreen, without a window or surface, and
+// writes CPU and GPU frame times as JSON for regression tracking.
+//
+// Usage: headlessBenchmark [--model a.obj|b.fdf]... [--model-instances N]
+//                          [--scene a.obj ...] [--instances N] [--texture PATH]
+//                          [--camera spin|orbit|flyover|path.txt] [--frames N]
+//                          [--warmup N] [--size WxH] [--frames-in-flight N] [--msaa N]
+//                          [--live-rows N] [--device NAME|UUID] [--report report.json]
+//                          [--validation]
+//   Every --model is a case, rendered for N frames along the camera path after
+//   its uploads finished and `warmup` more frames; --model-instances draws .obj
+//   models as N instanced copies and --live-rows edits N rows of .fdf maps every
+//   timed frame, through partial uploads. --device pins the GPU by name substring
+//   or UUID, so runs on multi-GPU machines compare the same device. The report
+//   defaults to benchmark_report.json, since the renderer logs to stdout.
+
+#include "src/rendering/Renderer.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr const char* DEFAULT_MODEL = "models/viking_room.obj";
+    constexpr const char* DEFAULT_TEXTURE = "textures/viking_room.png";
+    constexpr double LOAD_TIMEOUT_SECONDS = 60.0;
+
+    const std::vector<const char*> VALIDATION_LAYERS = { "VK_LAYER_KHRONOS_validation" };
+
+    struct Options {
+        std::vector<std::string> models;
+        uint32_t modelInstances = 0;
+        std::vector<std::string> scenePaths;
+        uint32_t sceneInstances = 1;
+        std::string texturePath = DEFAULT_TEXTURE;
+        std::string camera = "orbit";
+        uint32_t frames = 600;
+        uint32_t warmup = 60;
+        vk::Extent2D extent{ 1920, 1080 };
+        uint32_t framesInFlight = 0;  // 0: the profile's
+        uint32_t msaaSamples = 1;
+        uint32_t liveRows = 0;
+        std::string deviceSelector;  // Empty: the best-scoring GPU
+        std::string reportPath = "benchmark_report.json";
+        bool validation = false;
+    };
+
+    Options parseOptions(int argc, char* argv[]) {
+        Options options;
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            const bool hasValue = i + 1 < argc;
+            if (arg == "--model" && hasValue) {
+                options.models.emplace_back(argv[++i]);
+            } else if (arg == "--model-instances" && hasValue) {
+                options.modelInstances = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--scene") {
+                while (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) {
+                    options.scenePaths.emplace_back(argv[++i]);
+                }
+            } else if (arg == "--instances" && hasValue) {
+                options.sceneInstances = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--texture" && hasValue) {
+                options.texturePath = argv[++i];
+            } else if (arg == "--camera" && hasValue) {
+                options.camera = argv[++i];
+            } else if (arg == "--frames" && hasValue) {
+                options.frames = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--warmup" && hasValue) {
+                options.warmup = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--size" && hasValue) {
+                std::string size = argv[++i];
+                size_t separator = size.find('x');
+                if (separator == std::string::npos) {
+                    throw std::invalid_argument("--size expects WxH, got " + size);
+                }
+                options.extent = vk::Extent2D{
+                    static_cast<uint32_t>(std::stoul(size.substr(0, separator))),
+                    static_cast<uint32_t>(std::stoul(size.substr(separator + 1)))
+                };
+            } else if (arg == "--frames-in-flight" && hasValue) {
+                options.framesInFlight = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--msaa" && hasValue) {
+                options.msaaSamples = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--live-rows" && hasValue) {
+                options.liveRows = static_cast<uint32_t>(std::stoul(argv[++i]));
+            } else if (arg == "--device" && hasValue) {
+                options.deviceSelector = argv[++i];
+            } else if (arg == "--report" && hasValue) {
+                options.reportPath = argv[++i];
+            } else if (arg == "--validation") {
+                options.validation = true;
+            } else {
+                throw std::invalid_argument("unknown argument: " + arg);
+            }
+        }
+        if (options.models.empty()) {
+            options.models.emplace_back(DEFAULT_MODEL);
+        }
+        if (options.frames == 0 || options.extent.width == 0 || options.extent.height == 0) {
+            throw std::invalid_argument("frames and size must be non-zero");
+        }
+        return options;
+    }
+
+    std::string jsonString(const std::string& text) {
+        std::string quoted = "\"";
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                quoted += '\\';
+            }
+            quoted += c;
+        }
+        return quoted + "\"";
+    }
+
+    void writeHistogram(std::ostream& out, const LatencyHistogram& histogram) {
+        out << "{\"samples\":" << histogram.getCount()
+            << ",\"p50\":" << histogram.percentileMs(0.50)
+            << ",\"p95\":" << histogram.percentileMs(0.95)
+            << ",\"p99\":" << histogram.percentileMs(0.99)
+            << ",\"mean\":" << histogram.getMeanMs()
+            << ",\"max\":" << histogram.getMaxMs() << "}";
+    }
+
+    // One case: load, wait for the uploads, warm up, then time the path
+    void runCase(Renderer& renderer, const Options& options, const CameraPath& path,
+                 const std::string& model, std::ostream& out) {
+        renderer.loadModel(model, options.liveRows > 0);
+        if (!options.scenePaths.empty()) {
+            renderer.loadScene(options.scenePaths, options.sceneInstances);
+        }
+        if (!model.ends_with(".fdf")) {
+            renderer.loadTexture(options.texturePath);
+        }
+
+        auto drawAt = [&](float t) {
+            renderer.waitForNextFrame();
+            renderer.setCamera(path.sample(t));
+            renderer.drawFrame();
+        };
+
+        const auto loadStart = std::chrono::steady_clock::now();
+        while (!renderer.isSceneReady()) {
+            if (std::chrono::duration<double>(std::chrono::steady_clock::now() - loadStart).count() > LOAD_TIMEOUT_SECONDS) {
+                throw std::runtime_error("timed out waiting for uploads of " + model);
+            }
+            drawAt(0.0f);
+        }
+        for (uint32_t i = 0; i < options.warmup; i++) {
+            drawAt(0.0f);
+        }
+
+        renderer.getCpuProfiler().reset();
+        if (GpuProfiler* gpu = renderer.getGpuProfiler()) {
+            gpu->resetStatistics();
+        }
+        // A band of rows steps down the map each frame, raised on one pass and lowered on the next
+        Heightmap* heightmap = renderer.getHeightmap();
+        auto editRows = [&](uint32_t frame) {
+            const uint32_t rows = std::min(options.liveRows, heightmap->getHeight());
+            const uint32_t bands = heightmap->getHeight() / rows;
+            const uint32_t firstRow = (frame % bands) * rows;
+            const float offset = (frame / bands) % 2 == 0 ? 1.0f : -1.0f;
+            const size_t begin = static_cast<size_t>(firstRow) * heightmap->getWidth();
+            std::vector<float> band(heightmap->getHeights().begin() + begin,
+                                    heightmap->getHeights().begin() + begin + static_cast<size_t>(rows) * heightmap->getWidth());
+            for (float& value : band) {
+                value += offset;
+            }
+            heightmap->updateRegion(0, firstRow, heightmap->getWidth(), rows, band);
+        };
+
+        const auto runStart = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < options.frames; i++) {
+            if (heightmap && options.liveRows > 0) {
+                editRows(i);
+            }
+            drawAt(options.frames > 1 ? static_cast<float>(i) / static_cast<float>(options.frames - 1) : 0.0f);
+        }
+        renderer.waitIdle();
+        const double runSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - runStart).count();
+
+        const CpuProfiler& cpu = renderer.getCpuProfiler();
+        out << "{\"model\":" << jsonString(model)
+            << ",\"modelInstances\":" << options.modelInstances
+            << ",\"liveRows\":" << (heightmap ? options.liveRows : 0)
+            << ",\"frames\":" << options.frames
+            << ",\"seconds\":" << runSeconds
+            << ",\"fps\":" << static_cast<double>(options.frames) / runSeconds
+            << ",\"cpu\":{\"frame\":";
+        writeHistogram(out, cpu.getFrameHistogram());
+        for (uint32_t phase = 0; phase < static_cast<uint32_t>(FramePhase::Count); phase++) {
+            out << "," << jsonString(getFramePhaseName(static_cast<FramePhase>(phase))) << ":";
+            writeHistogram(out, cpu.getPhaseHistogram(static_cast<FramePhase>(phase)));
+        }
+        out << ",\"droppedSamples\":" << cpu.getDroppedSamples() << "}";
+
+        // Scopes keep the last HISTORY_SIZE samples; the final frames in flight are not collected
+        out << ",\"gpu\":{";
+        if (const GpuProfiler* gpu = renderer.getGpuProfiler()) {
+            bool first = true;
+            for (const GpuScopeStats& stats : gpu->getScopeStats()) {
+                out << (first ? "" : ",") << jsonString(stats.name)
+                    << ":{\"samples\":" << stats.samples << ",\"p50\":" << stats.p50Ms
+                    << ",\"p95\":" << stats.p95Ms << ",\"p99\":" << stats.p99Ms
+                    << ",\"mean\":" << stats.averageMs << "}";
+                first = false;
+            }
+        }
+        out << "}}";
+    }
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        const Options options = parseOptions(argc, argv);
+        const CameraPath path = CameraPath::fromName(options.camera);
+
+        Renderer renderer(options.extent, VALIDATION_LAYERS, options.validation, PresentProfile::Balanced,
+                          options.msaaSamples, options.deviceSelector);
+        if (options.framesInFlight != 0) {
+            renderer.setFramesInFlight(options.framesInFlight);
+        }
+        renderer.setModelInstances(options.modelInstances);
+
+        std::ostringstream report;
+        report << std::fixed << std::setprecision(3);
+        report << "{\"device\":" << jsonString(renderer.getDeviceName())
+               << ",\"width\":" << options.extent.width << ",\"height\":" << options.extent.height
+               << ",\"framesInFlight\":" << renderer.getFramesInFlight()
+               << ",\"msaaSamples\":" << renderer.getMsaaSamples()
+               << ",\"camera\":" << jsonString(path.getName())
+               << ",\"unit\":\"ms\",\"cases\":[";
+        for (size_t i = 0; i < options.models.size(); i++) {
+            report << (i == 0 ? "\n" : ",\n");
+            runCase(renderer, options, path, options.models[i], report);
+        }
+        report << "\n]}\n";
+
+        std::ofstream file(options.reportPath, std::ios::trunc);
+        if (!(file << report.str())) {
+            throw std::runtime_error("failed to write report: " + options.reportPath);
+        }
+        std::cout << "Report written to " << options.reportPath << std::endl;
+    }
+    catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,313 @@
+// Microbenchmarks of the load and upload paths:
+//   - OBJLoader::load parse + dedupe rate (vertices/s) on a generated grid and given models
+//   - FDFLoader::loadHeightmap parse rate (MB/s) on a generated map and given maps
+//   - TextureLoader::loadImage decode rate (megapixels/s)
+//   - Mesh upload and UploadManager staging-to-device rate (GB/s), one batched
+//     submit versus one submit per resource, on a headless device
+//   - swapchain acquire/present latency (opt-in, needs a display)
+//
+// Usage: loaderBenchmark [--obj a.obj]... [--fdf a.fdf]... [--texture a.png]...
+//                        [--swapchain] [--present-profile NAME] [--report report.json]
+//   Generated inputs are fixed, so runs are comparable across commits. Every rate
+//   is the best of ITERATIONS runs. --report also writes the results as JSON.
+
+#include "src/loaders/OBJLoader.hpp"
+#include "src/loaders/FDFLoader.hpp"
+#include "src/loaders/TextureLoader.hpp"
+#include "src/rendering/Renderer.hpp"
+#include "src/rendering/UploadManager.hpp"
+#include "src/resources/StagingRing.hpp"
+#include "src/scene/Mesh.hpp"
+
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    constexpr int ITERATIONS = 5;
+
+    // Generated inputs: ~1M vertex OBJ grid, ~4M point FdF map with colors on every fourth point
+    constexpr uint32_t OBJ_GRID_SIZE = 1024;
+    constexpr uint32_t FDF_GRID_SIZE = 2048;
+
+    // Upload cases: many small resources and a few large ones
+    struct UploadCase {
+        const char* name;
+        uint32_t resources;
+        vk::DeviceSize bytes;
+    };
+    constexpr UploadCase UPLOAD_CASES[] = {
+        { "256 x 64 KB", 256, 64 * 1024 },
+        { "8 x 2 MB", 8, 2 * 1024 * 1024 }
+    };
+
+    constexpr uint32_t SWAPCHAIN_FRAMES = 300;
+
+    struct Result {
+        std::string benchmark;
+        std::string input;
+        double value;
+        std::string unit;
+    };
+
+    std::vector<Result> results;
+
+    void report(const std::string& benchmark, const std::string& input, double value, const std::string& unit) {
+        std::printf("%-28s %-36s %12.2f %s\n", benchmark.c_str(), input.c_str(), value, unit.c_str());
+        results.push_back({ benchmark, input, value, unit });
+    }
+
+    template<typename Run>
+    double bestSeconds(Run&& run) {
+        double best = 1e30;
+        for (int i = 0; i < ITERATIONS; i++) {
+            auto start = std::chrono::steady_clock::now();
+            run();
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+
+    // Grid of quads with per-point UVs; positions vary so nothing dedupes by accident
+    std::string writeObjGrid(const std::filesystem::path& directory) {
+        std::string path = (directory / "loader_benchmark_grid.obj").string();
+        std::ofstream out(path, std::ios::trunc);
+        for (uint32_t y = 0; y < OBJ_GRID_SIZE; y++) {
+            for (uint32_t x = 0; x < OBJ_GRID_SIZE; x++) {
+                out << "v " << x << ' ' << y << ' ' << (x * 7 + y * 13) % 5 << '\n';
+            }
+        }
+        for (uint32_t y = 0; y < OBJ_GRID_SIZE; y++) {
+            for (uint32_t x = 0; x < OBJ_GRID_SIZE; x++) {
+                out << "vt " << static_cast<float>(x) / (OBJ_GRID_SIZE - 1) << ' '
+                    << static_cast<float>(y) / (OBJ_GRID_SIZE - 1) << '\n';
+            }
+        }
+        for (uint32_t y = 0; y + 1 < OBJ_GRID_SIZE; y++) {
+            for (uint32_t x = 0; x + 1 < OBJ_GRID_SIZE; x++) {
+                const uint32_t a = y * OBJ_GRID_SIZE + x + 1;  // OBJ indices are 1-based
+                const uint32_t b = a + 1;
+                const uint32_t c = a + OBJ_GRID_SIZE;
+                const uint32_t d = c + 1;
+                out << "f " << a << '/' << a << ' ' << b << '/' << b << ' ' << c << '/' << c << '\n'
+                    << "f " << b << '/' << b << ' ' << d << '/' << d << ' ' << c << '/' << c << '\n';
+            }
+        }
+        if (!out) {
+            throw std::runtime_error("failed to write " + path);
+        }
+        return path;
+    }
+
+    std::string writeFdfGrid(const std::filesystem::path& directory) {
+        std::string path = (directory / "loader_benchmark_grid.fdf").string();
+        std::ofstream out(path, std::ios::trunc);
+        char color[16];
+        for (uint32_t y = 0; y < FDF_GRID_SIZE; y++) {
+            for (uint32_t x = 0; x < FDF_GRID_SIZE; x++) {
+                out << (x == 0 ? "" : " ") << static_cast<int>((x * 31 + y * 17) % 64) - 32;
+                if ((x + y) % 4 == 0) {
+                    std::snprintf(color, sizeof(color), ",0x%06X", (x * 2654435761u + y) & 0xFFFFFF);
+                    out << color;
+                }
+            }
+            out << '\n';
+        }
+        if (!out) {
+            throw std::runtime_error("failed to write " + path);
+        }
+        return path;
+    }
+
+    void benchmarkObj(const std::string& path, const std::string& label) {
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        double seconds = bestSeconds([&] { OBJLoader::load(path, vertices, indices); });
+        report("obj parse+dedupe", label, static_cast<double>(vertices.size()) / seconds / 1e6, "Mvertices/s");
+        report("obj parse+dedupe", label, static_cast<double>(indices.size() / 3) / seconds / 1e6, "Mtriangles/s");
+    }
+
+    void benchmarkFdf(const std::string& path, const std::string& label) {
+        HeightmapData heightmap;
+        FDFLoadStats stats;
+        double seconds = bestSeconds([&] { stats = FDFLoader::loadHeightmap(path, heightmap); });
+        report("fdf parse", label, static_cast<double>(stats.fileBytes) / (1024.0 * 1024.0) / seconds, "MB/s");
+    }
+
+    void benchmarkTexture(const std::string& path) {
+        TextureData data;
+        double seconds = bestSeconds([&] { data = TextureLoader::loadImage(path); });
+        report("texture decode", path, static_cast<double>(data.width) * data.height / seconds / 1e6, "Mpixels/s");
+    }
+
+    void benchmarkUploads(const std::string& objGrid) {
+        VulkanDevice device({}, false, true);
+        device.createLogicalDevice();
+        StagingRing stagingRing(device);
+        UploadManager uploadManager(device, stagingRing);
+
+        for (const UploadCase& uploadCase : UPLOAD_CASES) {
+            std::vector<std::unique_ptr<VulkanBuffer>> buffers;
+            for (uint32_t i = 0; i < uploadCase.resources; i++) {
+                buffers.push_back(std::make_unique<VulkanBuffer>(device, uploadCase.bytes,
+                    vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer,
+                    vk::MemoryPropertyFlagBits::eDeviceLocal));
+            }
+            std::vector<unsigned char> data(uploadCase.bytes, 0xA5);
+            const double totalBytes = static_cast<double>(uploadCase.bytes) * uploadCase.resources;
+
+            double batched = bestSeconds([&] {
+                for (auto& buffer : buffers) {
+                    uploadManager.uploadBuffer(*buffer, data.data(), uploadCase.bytes);
+                }
+                uploadManager.wait(uploadManager.flush());
+                uploadManager.collect();
+            });
+            double perResource = bestSeconds([&] {
+                UploadTicket ticket = 0;
+                for (auto& buffer : buffers) {
+                    uploadManager.uploadBuffer(*buffer, data.data(), uploadCase.bytes);
+                    ticket = uploadManager.flush();
+                }
+                uploadManager.wait(ticket);
+                uploadManager.collect();
+            });
+            report("upload batched", uploadCase.name, totalBytes / batched / 1e9, "GB/s");
+            report("upload per-resource submit", uploadCase.name, totalBytes / perResource / 1e9, "GB/s");
+        }
+
+        // Mesh::createBuffers: optimization, encoding and upload of the generated grid
+        std::vector<Vertex> vertices;
+        std::vector<uint32_t> indices;
+        OBJLoader::load(objGrid, vertices, indices);
+        const double meshBytes = static_cast<double>(vertices.size() * sizeof(Vertex) + indices.size() * sizeof(uint32_t));
+        double meshSeconds = bestSeconds([&] {
+            Mesh mesh(device, uploadManager, vertices, indices);
+            uploadManager.wait(uploadManager.flush());
+            uploadManager.collect();
+        });
+        report("mesh createBuffers", "generated grid", meshBytes / meshSeconds / 1e9, "GB/s");
+    }
+
+    void benchmarkSwapchain(PresentProfile profile) {
+        if (!glfwInit()) {
+            std::printf("swapchain: skipped, no display\n");
+            return;
+        }
+        glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
+        GLFWwindow* window = glfwCreateWindow(800, 600, "loaderBenchmark", nullptr, nullptr);
+        if (!window) {
+            glfwTerminate();
+            std::printf("swapchain: skipped, no window\n");
+            return;
+        }
+
+        {
+            Renderer renderer(window, {}, false, profile);
+            for (uint32_t i = 0; i < SWAPCHAIN_FRAMES; i++) {
+                renderer.waitForNextFrame();
+                glfwPollEvents();
+                renderer.drawFrame();
+            }
+            renderer.waitIdle();
+
+            const std::string input = getPresentProfileName(profile);
+            const CpuProfiler& cpu = renderer.getCpuProfiler();
+            for (FramePhase phase : { FramePhase::Acquire, FramePhase::Present }) {
+                const LatencyHistogram& histogram = cpu.getPhaseHistogram(phase);
+                const std::string name = std::string("swapchain ") + getFramePhaseName(phase);
+                report(name + " p50", input, histogram.percentileMs(0.50), "ms");
+                report(name + " p99", input, histogram.percentileMs(0.99), "ms");
+            }
+        }
+        glfwDestroyWindow(window);
+        glfwTerminate();
+    }
+
+    void writeReport(const std::string& path) {
+        std::ofstream out(path, std::ios::trunc);
+        out << "[";
+        for (size_t i = 0; i < results.size(); i++) {
+            const Result& result = results[i];
+            out << (i == 0 ? "\n" : ",\n")
+                << "{\"benchmark\":\"" << result.benchmark << "\",\"input\":\"" << result.input
+                << "\",\"value\":" << result.value << ",\"unit\":\"" << result.unit << "\"}";
+        }
+        out << "\n]\n";
+        if (!out) {
+            throw std::runtime_error("failed to write report: " + path);
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    try {
+        std::vector<std::string> objPaths, fdfPaths, texturePaths;
+        bool swapchain = false;
+        PresentProfile profile = PresentProfile::MaxThroughput;
+        std::string reportPath;
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--obj" && i + 1 < argc) {
+                objPaths.emplace_back(argv[++i]);
+            } else if (arg == "--fdf" && i + 1 < argc) {
+                fdfPaths.emplace_back(argv[++i]);
+            } else if (arg == "--texture" && i + 1 < argc) {
+                texturePaths.emplace_back(argv[++i]);
+            } else if (arg == "--swapchain") {
+                swapchain = true;
+            } else if (arg == "--present-profile" && i + 1 < argc) {
+                std::optional<PresentProfile> parsed = parsePresentProfile(argv[++i]);
+                if (!parsed) {
+                    throw std::invalid_argument("unknown present profile: " + std::string(argv[i]));
+                }
+                profile = *parsed;
+            } else if (arg == "--report" && i + 1 < argc) {
+                reportPath = argv[++i];
+            } else {
+                throw std::invalid_argument("unknown argument: " + arg);
+            }
+        }
+
+        const std::filesystem::path directory = std::filesystem::temp_directory_path();
+        const std::string objGrid = writeObjGrid(directory);
+        const std::string fdfGrid = writeFdfGrid(directory);
+
+        benchmarkObj(objGrid, "generated grid");
+        for (const std::string& path : objPaths) {
+            benchmarkObj(path, path);
+        }
+        benchmarkFdf(fdfGrid, "generated grid");
+        for (const std::string& path : fdfPaths) {
+            benchmarkFdf(path, path);
+        }
+        for (const std::string& path : texturePaths) {
+            benchmarkTexture(path);
+        }
+        benchmarkUploads(objGrid);
+        if (swapchain) {
+            benchmarkSwapchain(profile);
+        }
+
+        std::filesystem::remove(objGrid);
+        std::filesystem::remove(fdfGrid);
+        if (!reportPath.empty()) {
+            writeReport(reportPath);
+        }
+    }
+    catch (const std::exception& e) {
+        std::fprintf(stderr, "%s\n", e.what());
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+// Compares OBJLoader's index-triple dedupe against the previous whole-vertex
+// std::unordered_map dedupe on the same parsed data.
+//
+// Usage: objDedupeBenchmark [model.obj]
+//   Without a model, a synthetic grid of ~4.5M triangles is generated in memory.
+
+#include "src/loaders/OBJLoader.hpp"
+#include <tiny_obj_loader.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+    constexpr int ITERATIONS = 3;
+
+    // Dedupe as OBJLoader::load did before the index-triple table
+    void legacyBuildVertices(const tinyobj::attrib_t& attrib,
+                             const std::vector<tinyobj::shape_t>& shapes,
+                             std::vector<Vertex>& vertices,
+                             std::vector<uint32_t>& indices) {
+        vertices.clear();
+        indices.clear();
+        std::unordered_map<Vertex, uint32_t> uniqueVertices;
+
+        for (const auto& shape : shapes) {
+            for (const auto& index : shape.mesh.indices) {
+                Vertex vertex{};
+                vertex.pos = {
+                    attrib.vertices[3 * index.vertex_index + 0],
+                    attrib.vertices[3 * index.vertex_index + 1],
+                    attrib.vertices[3 * index.vertex_index + 2]
+                };
+                if (index.texcoord_index >= 0) {
+                    vertex.texCoord = {
+                        attrib.texcoords[2 * index.texcoord_index + 0],
+                        1.0f - attrib.texcoords[2 * index.texcoord_index + 1]
+                    };
+                }
+                vertex.color = {1.0f, 1.0f, 1.0f};
+
+                if (!uniqueVertices.contains(vertex)) {
+                    uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
+                    vertices.push_back(vertex);
+                }
+                indices.push_back(uniqueVertices[vertex]);
+            }
+        }
+    }
+
+    // Regular grid with shared positions and UVs: the worst case for the XOR vertex hash
+    void makeGrid(uint32_t size, tinyobj::attrib_t& attrib, std::vector<tinyobj::shape_t>& shapes) {
+        attrib.vertices.reserve(size_t{ size } * size * 3);
+        attrib.texcoords.reserve(size_t{ size } * size * 2);
+        for (uint32_t y = 0; y < size; y++) {
+            for (uint32_t x = 0; x < size; x++) {
+                attrib.vertices.insert(attrib.vertices.end(), { float(x), float(y), float((x * 7 + y * 13) % 5) });
+                attrib.texcoords.insert(attrib.texcoords.end(), { float(x) / float(size - 1), float(y) / float(size - 1) });
+            }
+        }
+
+        tinyobj::shape_t shape;
+        shape.mesh.indices.reserve(size_t{ size - 1 } * (size - 1) * 6);
+        auto corner = [&](uint32_t x, uint32_t y) {
+            tinyobj::index_t index;
+            index.vertex_index = static_cast<int>(y * size + x);
+            index.normal_index = -1;
+            index.texcoord_index = index.vertex_index;
+            shape.mesh.indices.push_back(index);
+        };
+        for (uint32_t y = 0; y + 1 < size; y++) {
+            for (uint32_t x = 0; x + 1 < size; x++) {
+                corner(x, y); corner(x + 1, y); corner(x, y + 1);
+                corner(x + 1, y); corner(x + 1, y + 1); corner(x, y + 1);
+            }
+        }
+        shapes.push_back(std::move(shape));
+    }
+
+    template<typename Build>
+    double bestSeconds(Build&& build) {
+        double best = 1e30;
+        for (int i = 0; i < ITERATIONS; i++) {
+            auto start = std::chrono::steady_clock::now();
+            build();
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+}
+
+int main(int argc, char* argv[]) {
+    tinyobj::attrib_t attrib;
+    std::vector<tinyobj::shape_t> shapes;
+
+    if (argc > 1) {
+        std::vector<tinyobj::material_t> materials;
+        std::string warn, err;
+        if (!tinyobj::LoadObj(&attrib, &shapes, &materials, &warn, &err, argv[1])) {
+            std::fprintf(stderr, "Failed to load %s: %s%s\n", argv[1], warn.c_str(), err.c_str());
+            return EXIT_FAILURE;
+        }
+    } else {
+        makeGrid(1500, attrib, shapes);
+    }
+
+    size_t corners = 0;
+    for (const auto& shape : shapes) {
+        corners += shape.mesh.indices.size();
+    }
+    std::printf("%zu triangles, %zu corners\n", corners / 3, corners);
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+
+    double legacy = bestSeconds([&] { legacyBuildVertices(attrib, shapes, vertices, indices); });
+    size_t legacyVertices = vertices.size();
+    double triple = bestSeconds([&] { OBJLoader::buildVertices(attrib, shapes, vertices, indices); });
+
+    std::printf("unordered_map<Vertex>: %8.1f ms  %zu vertices\n", legacy * 1000.0, legacyVertices);
+    std::printf("index-triple table:    %8.1f ms  %zu vertices\n", triple * 1000.0, vertices.size());
+    std::printf("speedup: %.2fx\n", legacy / triple);
+    return EXIT_SUCCESS;
+}
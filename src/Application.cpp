@@ -1,9 +1,46 @@
 #include "Application.hpp"
 
+#include <iomanip>
 #include <iostream>
+#include <optional>
 #include <stdexcept>
 
-Application::Application() {
+Application::Application(int argc, char* argv[]) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--scene") {
+            // Every following non-option argument is a scene model
+            while (i + 1 < argc && std::string(argv[i + 1]).rfind("--", 0) != 0) {
+                scenePaths.emplace_back(argv[++i]);
+            }
+        } else if (arg == "--instances" && i + 1 < argc) {
+            sceneInstances = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--model-instances" && i + 1 < argc) {
+            modelInstances = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--present-profile" && i + 1 < argc) {
+            std::optional<PresentProfile> profile = parsePresentProfile(argv[++i]);
+            if (!profile) {
+                throw std::invalid_argument("unknown present profile: " + std::string(argv[i]));
+            }
+            presentProfile = *profile;
+        } else if (arg == "--frames-in-flight" && i + 1 < argc) {
+            framesInFlight = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--msaa" && i + 1 < argc) {
+            msaaSamples = static_cast<uint32_t>(std::stoul(argv[++i]));
+        } else if (arg == "--device" && i + 1 < argc) {
+            deviceSelector = argv[++i];
+        } else if (arg == "--low-latency") {
+            lowLatency = true;
+        } else if (arg == "--gpu-trace" && i + 1 < argc) {
+            gpuTracePath = argv[++i];
+        } else if (arg == "--cpu-profile" && i + 1 < argc) {
+            cpuProfilePath = argv[++i];
+        } else if (i == 1) {
+            modelPath = arg;
+        } else {
+            throw std::invalid_argument("unknown argument: " + arg);
+        }
+    }
     initWindow();
     initVulkan();
 }
@@ -25,20 +62,81 @@ void Application::initWindow() {
     window = glfwCreateWindow(WINDOW_WIDTH, WINDOW_HEIGHT, WINDOW_TITLE, nullptr, nullptr);
     glfwSetWindowUserPointer(window, this);
     glfwSetFramebufferSizeCallback(window, framebufferResizeCallback);
+    glfwSetKeyCallback(window, keyCallback);
 }
 
 void Application::initVulkan() {
-    renderer = std::make_unique<Renderer>(window, validationLayers, enableValidationLayers);
-    renderer->loadModel(MODEL_PATH);
-    renderer->loadTexture(TEXTURE_PATH);
+    renderer = std::make_unique<Renderer>(window, validationLayers, enableValidationLayers, presentProfile, msaaSamples,
+                                          deviceSelector);
+    if (framesInFlight != 0) {
+        renderer->setFramesInFlight(framesInFlight);
+    }
+    renderer->setLowLatency(lowLatency);
+    if (!cpuProfilePath.empty()) {
+        renderer->getCpuProfiler().streamTo(cpuProfilePath);
+    }
+    // Loads return at once; the window shows frames while models parse and upload
+    renderer->loadModel(modelPath);
+    renderer->setModelInstances(modelInstances);
+    if (!scenePaths.empty()) {
+        renderer->loadScene(scenePaths, sceneInstances);
+    }
+
+    // FdF maps are colored per vertex; only textured models need the texture
+    if (!modelPath.ends_with(".fdf")) {
+        renderer->loadTexture(TEXTURE_PATH);
+    }
 }
 
 void Application::mainLoop() {
+    double lastTitleUpdate = glfwGetTime();
     while (!glfwWindowShouldClose(window)) {
+        // Pace before sampling input, so the frame reflects the newest input
+        renderer->waitForNextFrame();
         glfwPollEvents();
         renderer->drawFrame();
+
+        // Terrain counters in the title, refreshed once per second
+        double now = glfwGetTime();
+        if (modelPath.ends_with(".fdf") && now - lastTitleUpdate >= 1.0) {
+            lastTitleUpdate = now;
+            TerrainStats stats = renderer->getTerrainStats();
+            std::string title = std::string(WINDOW_TITLE) +
+                " - tiles drawn " + std::to_string(stats.tilesDrawn) +
+                ", culled " + std::to_string(stats.tilesCulled) +
+                ", triangles " + std::to_string(stats.trianglesDrawn);
+            glfwSetWindowTitle(window, title.c_str());
+        }
     }
     renderer->waitIdle();
+    renderer->getCpuProfiler().writeReport(std::cout);
+    reportGpuProfile();
+}
+
+void Application::reportGpuProfile() const {
+    const GpuProfiler* profiler = renderer->getGpuProfiler();
+    if (!profiler) {
+        return;
+    }
+
+    std::cout << "GPU scopes (ms, last " << GpuProfiler::HISTORY_SIZE << " frames):" << std::endl;
+    for (const GpuScopeStats& stats : profiler->getScopeStats()) {
+        std::cout << "  " << std::left << std::setw(14) << stats.name << std::right << std::fixed << std::setprecision(3)
+                  << " avg " << stats.averageMs << "  p50 " << stats.p50Ms
+                  << "  p95 " << stats.p95Ms << "  p99 " << stats.p99Ms << std::endl;
+    }
+    if (profiler->hasStatistics()) {
+        const GpuPipelineStatistics& pipeline = profiler->getPipelineStatistics();
+        std::cout << "GPU last frame: " << pipeline.inputPrimitives << " primitives in, "
+                  << pipeline.clippingPrimitives << " after clipping, "
+                  << pipeline.vertexInvocations << " vertex / " << pipeline.fragmentInvocations << " fragment / "
+                  << pipeline.computeInvocations << " compute invocations" << std::endl;
+    }
+
+    if (!gpuTracePath.empty()) {
+        profiler->writeChromeTrace(gpuTracePath);
+        std::cout << "GPU trace written to " << gpuTracePath << std::endl;
+    }
 }
 
 void Application::cleanup() {
@@ -58,3 +156,32 @@ void Application::framebufferResizeCallback(GLFWwindow* window, int width, int h
     auto app = reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
     app->renderer->handleFramebufferResize();
 }
+
+void Application::keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods) {
+    auto app = reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
+    if (key == GLFW_KEY_M && action == GLFW_PRESS) {
+        // Cycle fill -> wireframe -> lines
+        RenderMode next = RenderMode::Fill;
+        switch (app->renderer->getRenderMode()) {
+            case RenderMode::Fill: next = RenderMode::Wireframe; break;
+            case RenderMode::Wireframe: next = RenderMode::Lines; break;
+            case RenderMode::Lines: next = RenderMode::Fill; break;
+        }
+        app->renderer->setRenderMode(next);
+    }
+    if (key == GLFW_KEY_P && action == GLFW_PRESS) {
+        // Cycle balanced -> max-throughput -> low-latency -> power-saver
+        PresentProfile next = PresentProfile::Balanced;
+        switch (app->renderer->getPresentProfile()) {
+            case PresentProfile::Balanced: next = PresentProfile::MaxThroughput; break;
+            case PresentProfile::MaxThroughput: next = PresentProfile::LowLatency; break;
+            case PresentProfile::LowLatency: next = PresentProfile::PowerSaver; break;
+            case PresentProfile::PowerSaver: next = PresentProfile::Balanced; break;
+        }
+        app->renderer->requestPresentProfile(next);
+    }
+    if (key == GLFW_KEY_L && action == GLFW_PRESS) {
+        app->renderer->setLowLatency(!app->renderer->isLowLatency());
+        std::cout << "Low-latency mode " << (app->renderer->isLowLatency() ? "on" : "off") << std::endl;
+    }
+}
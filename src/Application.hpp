@@ -20,8 +20,22 @@ class Application {
 public:
     /**
      * @brief Construct application with default window size and validation settings
+     * @param argc Argument count from main
+     * @param argv Arguments from main: `[model] [--model-instances N] [--scene a.obj b.obj ...]
+     *             [--instances N] [--present-profile NAME] [--frames-in-flight N] [--low-latency]
+     *             [--msaa N] [--device NAME|UUID] [--gpu-trace trace.json] [--cpu-profile frames.csv]`;
+     *             the model is an .obj
+     *             or .fdf map, --model-instances draws an .obj N times in one instanced call,
+     *             scene models are drawn N times each with indirect multi-draw,
+     *             NAME is balanced, max-throughput, low-latency or power-saver,
+     *             --frames-in-flight overrides the profile's, --msaa renders with N samples
+     *             per pixel (clamped to the device), --device picks the GPU whose name
+     *             contains NAME or whose UUID is given, --gpu-trace writes GPU scopes
+     *             as a Chrome trace on exit and --cpu-profile streams per-frame CPU phase
+     *             times as CSV (their percentiles are printed on exit either way)
+     * @throws std::invalid_argument on an unknown argument
      */
-    Application();
+    Application(int argc, char* argv[]);
 
     /**
      * @brief Destructor - ensures proper cleanup order
@@ -61,6 +75,17 @@ private:
 #endif
 
     // Members
+    std::string modelPath = MODEL_PATH;
+    uint32_t modelInstances = 0;  // 0: the model is drawn once, uninstanced
+    std::vector<std::string> scenePaths;
+    uint32_t sceneInstances = 1;
+    PresentProfile presentProfile = PresentProfile::Balanced;
+    uint32_t framesInFlight = 0;  // 0: the profile's
+    uint32_t msaaSamples = 1;
+    std::string deviceSelector;  // Empty: the best-scoring GPU
+    bool lowLatency = false;
+    std::string gpuTracePath;
+    std::string cpuProfilePath;
     GLFWwindow* window = nullptr;
     std::unique_ptr<Renderer> renderer;
 
@@ -70,10 +95,12 @@ private:
 
     // Main loop
     void mainLoop();
+    void reportGpuProfile() const;
 
     // Cleanup
     void cleanup();
 
     // Callbacks
     static void framebufferResizeCallback(GLFWwindow* window, int width, int height);
+    static void keyCallback(GLFWwindow* window, int key, int scancode, int action, int mods);
 };
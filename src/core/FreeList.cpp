@@ -0,0 +1,62 @@
+#include "FreeList.hpp"
+#include <algorithm>
+#include <iterator>
+
+namespace {
+	uint64_t alignUp(uint64_t value, uint64_t alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+FreeList::FreeList(uint64_t size) {
+	if (size > 0) {
+		ranges.emplace(0, size);
+	}
+}
+
+bool FreeList::allocate(uint64_t size, uint64_t alignment, uint64_t& outOffset) {
+	for (auto it = ranges.begin(); it != ranges.end(); ++it) {
+		auto [rangeOffset, rangeSize] = *it;
+		uint64_t alignedOffset = alignUp(rangeOffset, alignment);
+		uint64_t rangeEnd = rangeOffset + rangeSize;
+		if (alignedOffset + size > rangeEnd) {
+			continue;
+		}
+
+		ranges.erase(it);
+		if (alignedOffset > rangeOffset) {
+			ranges.emplace(rangeOffset, alignedOffset - rangeOffset);
+		}
+		if (alignedOffset + size < rangeEnd) {
+			ranges.emplace(alignedOffset + size, rangeEnd - (alignedOffset + size));
+		}
+		outOffset = alignedOffset;
+		return true;
+	}
+	return false;
+}
+
+void FreeList::free(uint64_t offset, uint64_t size) {
+	auto next = ranges.lower_bound(offset);
+	if (next != ranges.end() && offset + size == next->first) {
+		size += next->second;
+		next = ranges.erase(next);
+	}
+	if (next != ranges.begin()) {
+		auto prev = std::prev(next);
+		if (prev->first + prev->second == offset) {
+			offset = prev->first;
+			size += prev->second;
+			ranges.erase(prev);
+		}
+	}
+	ranges.emplace(offset, size);
+}
+
+uint64_t FreeList::getLargestRange() const {
+	uint64_t largest = 0;
+	for (const auto& [offset, size] : ranges) {
+		largest = std::max(largest, size);
+	}
+	return largest;
+}
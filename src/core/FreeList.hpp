@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+
+// First-fit free list over the byte range [0, size) of one memory block, kept coalesced
+//
+// Alignment padding in front of an allocation stays in the list, so it is reclaimed
+// once the allocation next to it is freed.
+class FreeList {
+public:
+	FreeList() = default;  // Nothing free, e.g. a block holding a single dedicated allocation
+	explicit FreeList(uint64_t size);
+
+	// Take size bytes at an offset that is a multiple of alignment; false if no free range fits
+	bool allocate(uint64_t size, uint64_t alignment, uint64_t& outOffset);
+
+	// Return a range taken by allocate(), merging it with the free ranges it touches
+	void free(uint64_t offset, uint64_t size);
+
+	uint32_t getRangeCount() const { return static_cast<uint32_t>(ranges.size()); }
+	uint64_t getLargestRange() const;
+	const std::map<uint64_t, uint64_t>& getRanges() const { return ranges; }  // offset -> size
+
+private:
+	std::map<uint64_t, uint64_t> ranges;
+};
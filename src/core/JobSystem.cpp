@@ -0,0 +1,162 @@
+#include "JobSystem.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iostream>
+
+namespace {
+	// The pool and worker index of the calling thread, if it is a worker
+	thread_local const JobSystem* currentSystem = nullptr;
+	thread_local uint32_t currentWorker = 0;
+}
+
+JobSystem::JobSystem(uint32_t threadCount) {
+	if (threadCount == 0) {
+		uint32_t cores = std::thread::hardware_concurrency();
+		threadCount = cores > 1 ? cores - 1 : 1;
+	}
+
+	queues.reserve(threadCount);
+	for (uint32_t i = 0; i < threadCount; i++) {
+		queues.push_back(std::make_unique<WorkerQueue>());
+	}
+	workers.reserve(threadCount);
+	for (uint32_t i = 0; i < threadCount; i++) {
+		workers.emplace_back([this, i] { workerLoop(i); });
+	}
+}
+
+JobSystem::~JobSystem() {
+	// Help drain the queues, so waiting on the workers can't hang behind a full pool
+	while (queued.load(std::memory_order_acquire) > 0) {
+		if (!tryRun(0)) {
+			std::this_thread::yield();
+		}
+	}
+	{
+		std::lock_guard lock(sleepMutex);
+		stopping = true;
+	}
+	wake.notify_all();
+	for (std::thread& worker : workers) {
+		worker.join();
+	}
+}
+
+void JobSystem::submit(Job job, JobGroup* group) {
+	if (group) {
+		group->pending.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	// Workers keep their own follow-up jobs; everyone else spreads round-robin
+	const uint32_t queue = currentSystem == this
+		? currentWorker
+		: nextQueue.fetch_add(1, std::memory_order_relaxed) % static_cast<uint32_t>(queues.size());
+	{
+		std::lock_guard lock(queues[queue]->mutex);
+		queues[queue]->tasks.push_back({ std::move(job), group });
+	}
+	queued.fetch_add(1, std::memory_order_release);
+
+	// Taking the lock orders the count against a worker checking it before sleeping
+	{
+		std::lock_guard lock(sleepMutex);
+	}
+	wake.notify_one();
+}
+
+void JobSystem::wait(JobGroup& group) {
+	const uint32_t preferred = currentSystem == this ? currentWorker : 0;
+	while (!group.isDone()) {
+		if (tryRun(preferred)) {
+			continue;
+		}
+		// The timeout covers jobs queued after the check, which only notify workers
+		std::unique_lock lock(sleepMutex);
+		groupDone.wait_for(lock, std::chrono::milliseconds(1), [&] {
+			return group.isDone() || queued.load(std::memory_order_acquire) > 0;
+		});
+	}
+}
+
+void JobSystem::publish(Job job) {
+	std::lock_guard lock(publishedMutex);
+	published.push_back(std::move(job));
+}
+
+uint32_t JobSystem::runPublished() {
+	std::vector<Job> ready;
+	{
+		std::lock_guard lock(publishedMutex);
+		ready.swap(published);
+	}
+	// Jobs published meanwhile run on the next call
+	for (Job& job : ready) {
+		job();
+	}
+	return static_cast<uint32_t>(ready.size());
+}
+
+void JobSystem::workerLoop(uint32_t index) {
+	currentSystem = this;
+	currentWorker = index;
+	while (true) {
+		if (tryRun(index)) {
+			continue;
+		}
+		std::unique_lock lock(sleepMutex);
+		wake.wait(lock, [this] { return stopping || queued.load(std::memory_order_acquire) > 0; });
+		if (stopping && queued.load(std::memory_order_acquire) == 0) {
+			return;
+		}
+	}
+}
+
+bool JobSystem::tryRun(uint32_t preferredQueue) {
+	Task task;
+	if (!takeTask(preferredQueue, task)) {
+		return false;
+	}
+	run(task);
+	return true;
+}
+
+bool JobSystem::takeTask(uint32_t preferredQueue, Task& task) {
+	// Own queue from the back (newest first), then steal the oldest from the others
+	const uint32_t count = static_cast<uint32_t>(queues.size());
+	for (uint32_t i = 0; i < count; i++) {
+		WorkerQueue& queue = *queues[(preferredQueue + i) % count];
+		std::lock_guard lock(queue.mutex);
+		if (queue.tasks.empty()) {
+			continue;
+		}
+		if (i == 0) {
+			task = std::move(queue.tasks.back());
+			queue.tasks.pop_back();
+		} else {
+			task = std::move(queue.tasks.front());
+			queue.tasks.pop_front();
+		}
+		queued.fetch_sub(1, std::memory_order_acq_rel);
+		return true;
+	}
+	return false;
+}
+
+void JobSystem::run(Task& task) {
+	// A throwing job would take its worker down with it; jobs report their own errors
+	try {
+		task.job();
+	} catch (const std::exception& e) {
+		std::cerr << "Job failed: " << e.what() << std::endl;
+	} catch (...) {
+		std::cerr << "Job failed: exception not derived from std::exception" << std::endl;
+	}
+
+	// Nothing touches the group after its count reaches zero; the waiter may free it
+	if (task.group && task.group->pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		std::lock_guard lock(sleepMutex);
+		groupDone.notify_all();
+	}
+}
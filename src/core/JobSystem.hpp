@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Jobs counted together so their submitter can wait for all of them
+class JobGroup {
+public:
+	JobGroup() = default;
+
+	JobGroup(const JobGroup&) = delete;
+	JobGroup& operator=(const JobGroup&) = delete;
+
+	bool isDone() const { return pending.load(std::memory_order_acquire) == 0; }
+
+private:
+	friend class JobSystem;
+	std::atomic<uint32_t> pending{ 0 };
+};
+
+// Worker pool with one deque per worker and work stealing
+//
+// A worker pushes the jobs it submits onto its own deque and pops them back LIFO,
+// so follow-up work stays on a warm cache; idle workers steal from the front of
+// other deques. Jobs submitted from other threads are spread round-robin.
+// Results that must be applied on the main thread (GPU uploads, publishing into
+// the renderer) are handed back with publish() and run by runPublished().
+class JobSystem {
+public:
+	using Job = std::function<void()>;
+
+	// threadCount 0 picks one per core, leaving one for the main thread
+	explicit JobSystem(uint32_t threadCount = 0);
+
+	// Runs the jobs still queued, then joins the workers; cancel long jobs beforehand
+	~JobSystem();
+
+	JobSystem(const JobSystem&) = delete;
+	JobSystem& operator=(const JobSystem&) = delete;
+	JobSystem(JobSystem&&) = delete;
+	JobSystem& operator=(JobSystem&&) = delete;
+
+	// Queue a job from any thread; the group, if any, must outlive it
+	void submit(Job job, JobGroup* group = nullptr);
+
+	// Block until every job of the group finished, running queued jobs meanwhile
+	void wait(JobGroup& group);
+
+	// Queue work for the main thread; safe from any thread
+	void publish(Job job);
+
+	// Run every published job (main thread only); returns how many ran
+	uint32_t runPublished();
+
+	uint32_t getThreadCount() const { return static_cast<uint32_t>(workers.size()); }
+
+private:
+	struct Task {
+		Job job;
+		JobGroup* group = nullptr;
+	};
+
+	struct WorkerQueue {
+		std::mutex mutex;
+		std::deque<Task> tasks;
+	};
+
+	std::vector<std::unique_ptr<WorkerQueue>> queues;
+	std::vector<std::thread> workers;
+	std::atomic<uint32_t> nextQueue{ 0 };
+
+	// Sleeping workers and waiters; queued counts tasks not yet taken
+	std::mutex sleepMutex;
+	std::condition_variable wake;
+	std::condition_variable groupDone;
+	std::atomic<size_t> queued{ 0 };
+	bool stopping = false;
+
+	std::mutex publishedMutex;
+	std::vector<Job> published;
+
+	void workerLoop(uint32_t index);
+	bool tryRun(uint32_t preferredQueue);
+	bool takeTask(uint32_t preferredQueue, Task& task);
+	void run(Task& task);
+};
@@ -0,0 +1,180 @@
+#include "MemoryAllocator.hpp"
+#include "VulkanDevice.hpp"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+namespace {
+	vk::DeviceSize alignUp(vk::DeviceSize value, vk::DeviceSize alignment) {
+		return (value + alignment - 1) / alignment * alignment;
+	}
+}
+
+MemoryAllocation::MemoryAllocation(MemoryAllocation&& other) noexcept
+	: allocator(std::exchange(other.allocator, nullptr))
+	, block(std::exchange(other.block, nullptr))
+	, poolIndex(other.poolIndex)
+	, offset(other.offset)
+	, size(other.size)
+{
+}
+
+MemoryAllocation& MemoryAllocation::operator=(MemoryAllocation&& other) noexcept {
+	if (this != &other) {
+		release();
+		allocator = std::exchange(other.allocator, nullptr);
+		block = std::exchange(other.block, nullptr);
+		poolIndex = other.poolIndex;
+		offset = other.offset;
+		size = other.size;
+	}
+	return *this;
+}
+
+vk::DeviceMemory MemoryAllocation::getMemory() const {
+	return block ? *block->memory : vk::DeviceMemory{};
+}
+
+void* MemoryAllocation::getMappedData() const {
+	if (!block || !block->mapped) {
+		return nullptr;
+	}
+	return static_cast<char*>(block->mapped) + offset;
+}
+
+void MemoryAllocation::release() {
+	if (allocator) {
+		allocator->free(*this);
+		allocator = nullptr;
+		block = nullptr;
+	}
+}
+
+MemoryAllocator::MemoryAllocator(VulkanDevice& device, vk::DeviceSize blockSize)
+	: device(device), blockSize(blockSize)
+{
+	vk::PhysicalDeviceMemoryProperties memProperties = device.getPhysicalDevice().getMemoryProperties();
+	const vk::PhysicalDeviceLimits limits = device.getPhysicalDevice().getProperties().limits;
+	maxAllocationCount = limits.maxMemoryAllocationCount;
+
+	pools.resize(memProperties.memoryTypeCount * 2);
+	for (uint32_t i = 0; i < memProperties.memoryTypeCount; i++) {
+		const vk::MemoryPropertyFlags flags = memProperties.memoryTypes[i].propertyFlags;
+		bool hostVisible = !!(flags & vk::MemoryPropertyFlagBits::eHostVisible);
+		// Flushed and invalidated ranges must cover whole atoms, so allocations start and end on them
+		vk::DeviceSize atomSize = hostVisible && !(flags & vk::MemoryPropertyFlagBits::eHostCoherent)
+			? std::max<vk::DeviceSize>(limits.nonCoherentAtomSize, 1) : 1;
+		pools[i * 2 + 0] = Pool{ .memoryTypeIndex = i, .hostVisible = hostVisible, .atomSize = atomSize };
+		pools[i * 2 + 1] = Pool{ .memoryTypeIndex = i, .hostVisible = hostVisible, .atomSize = atomSize };
+	}
+}
+
+MemoryAllocation MemoryAllocator::allocate(const vk::MemoryRequirements& requirements,
+										   vk::MemoryPropertyFlags properties,
+										   bool linear) {
+	uint32_t memoryTypeIndex = device.findMemoryType(requirements.memoryTypeBits, properties);
+	uint32_t poolIndex = memoryTypeIndex * 2 + (linear ? 0 : 1);
+
+	std::lock_guard lock(mutex);
+	Pool& pool = pools[poolIndex];
+
+	const vk::DeviceSize size = alignUp(requirements.size, pool.atomSize);
+	const vk::DeviceSize alignment = std::max(requirements.alignment, pool.atomSize);
+
+	MemoryAllocation allocation;
+	allocation.allocator = this;
+	allocation.poolIndex = poolIndex;
+	allocation.size = size;
+
+	// Large resources get their own block so they don't strand most of a pooled one
+	if (size > blockSize / 2) {
+		allocation.block = &createBlock(pool, size, true);
+		allocation.offset = 0;
+	} else {
+		for (auto& block : pool.blocks) {
+			if (!block->dedicated && block->freeList.allocate(size, alignment, allocation.offset)) {
+				allocation.block = block.get();
+				break;
+			}
+		}
+		if (!allocation.block) {
+			MemoryAllocation::Block& block = createBlock(pool, blockSize, false);
+			block.freeList.allocate(size, alignment, allocation.offset);
+			allocation.block = &block;
+		}
+	}
+
+	allocation.block->allocationCount++;
+	allocation.block->bytesInUse += size;
+	return allocation;
+}
+
+MemoryAllocation::Block& MemoryAllocator::createBlock(Pool& pool, vk::DeviceSize size, bool dedicated) {
+	if (liveBlockCount >= maxAllocationCount) {
+		throw std::runtime_error("device memory allocation limit reached (" + std::to_string(maxAllocationCount) + " blocks)");
+	}
+
+	vk::MemoryAllocateInfo allocInfo{
+		.allocationSize = size,
+		.memoryTypeIndex = pool.memoryTypeIndex
+	};
+
+	auto block = std::make_unique<MemoryAllocation::Block>();
+	block->memory = vk::raii::DeviceMemory(device.getDevice(), allocInfo);
+	block->size = size;
+	block->dedicated = dedicated;
+	if (!dedicated) {
+		block->freeList = FreeList(size);
+	}
+	// Map host-visible blocks once for their whole lifetime; sub-allocations can't map individually
+	if (pool.hostVisible) {
+		block->mapped = block->memory.mapMemory(0, size);
+	}
+
+	liveBlockCount++;
+	pool.blocks.push_back(std::move(block));
+	return *pool.blocks.back();
+}
+
+void MemoryAllocator::free(MemoryAllocation& allocation) {
+	std::lock_guard lock(mutex);
+	Pool& pool = pools[allocation.poolIndex];
+	MemoryAllocation::Block& block = *allocation.block;
+
+	block.allocationCount--;
+	block.bytesInUse -= allocation.size;
+
+	if (!block.dedicated) {
+		block.freeList.free(allocation.offset, allocation.size);
+	}
+
+	if (block.allocationCount > 0) {
+		return;
+	}
+
+	// Keep a single empty pooled block around to absorb load/unload churn
+	bool keepBlock = !block.dedicated && std::ranges::count_if(pool.blocks, [](const auto& b) {
+		return !b->dedicated && b->allocationCount == 0;
+	}) == 1;
+	if (!keepBlock) {
+		std::erase_if(pool.blocks, [&block](const auto& b) { return b.get() == &block; });
+		liveBlockCount--;
+	}
+}
+
+MemoryStats MemoryAllocator::getStats() const {
+	std::lock_guard lock(mutex);
+	MemoryStats stats;
+	for (const auto& pool : pools) {
+		for (const auto& block : pool.blocks) {
+			stats.blockCount++;
+			stats.allocationCount += block->allocationCount;
+			stats.bytesReserved += block->size;
+			stats.bytesInUse += block->bytesInUse;
+			stats.freeRangeCount += block->freeList.getRangeCount();
+			stats.largestFreeRange = std::max(stats.largestFreeRange, block->freeList.getLargestRange());
+		}
+	}
+	return stats;
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "../utils/VulkanCommon.hpp"
+#include "FreeList.hpp"
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class VulkanDevice;
+class MemoryAllocator;
+
+// Snapshot of allocator usage, summed over every memory type
+struct MemoryStats {
+	uint32_t blockCount = 0;             // vkAllocateMemory calls currently alive
+	uint32_t allocationCount = 0;        // live sub-allocations
+	vk::DeviceSize bytesReserved = 0;    // total size of all device memory blocks
+	vk::DeviceSize bytesInUse = 0;       // bytes handed out to live sub-allocations
+	vk::DeviceSize largestFreeRange = 0; // largest contiguous free range in any block
+	uint32_t freeRangeCount = 0;
+
+	// 0 when all free space is one contiguous range, approaching 1 as it gets scattered
+	float fragmentation() const {
+		vk::DeviceSize freeBytes = bytesReserved - bytesInUse;
+		if (freeBytes == 0) {
+			return 0.0f;
+		}
+		return 1.0f - static_cast<float>(largestFreeRange) / static_cast<float>(freeBytes);
+	}
+};
+
+// RAII handle to a range of a pooled vk::DeviceMemory block, returned to the pool on destruction
+class MemoryAllocation {
+public:
+	MemoryAllocation() = default;
+	~MemoryAllocation() { release(); }
+
+	MemoryAllocation(const MemoryAllocation&) = delete;
+	MemoryAllocation& operator=(const MemoryAllocation&) = delete;
+	MemoryAllocation(MemoryAllocation&& other) noexcept;
+	MemoryAllocation& operator=(MemoryAllocation&& other) noexcept;
+
+	vk::DeviceMemory getMemory() const;
+	vk::DeviceSize getOffset() const { return offset; }
+	vk::DeviceSize getSize() const { return size; }  // Whole nonCoherentAtomSize atoms on non-coherent types
+	// Blocks in host-visible memory are persistently mapped; nullptr otherwise
+	void* getMappedData() const;
+
+	explicit operator bool() const { return allocator != nullptr; }
+
+private:
+	friend class MemoryAllocator;
+	struct Block;
+
+	MemoryAllocator* allocator = nullptr;
+	Block* block = nullptr;
+	uint32_t poolIndex = 0;
+	vk::DeviceSize offset = 0;
+	vk::DeviceSize size = 0;
+
+	void release();
+};
+
+struct MemoryAllocation::Block {
+	vk::raii::DeviceMemory memory = nullptr;
+	vk::DeviceSize size = 0;
+	void* mapped = nullptr;
+	bool dedicated = false;
+	uint32_t allocationCount = 0;
+	vk::DeviceSize bytesInUse = 0;
+	FreeList freeList;  // Empty for dedicated blocks
+};
+
+// Block-based sub-allocator: one pool of large vk::DeviceMemory blocks per memory type,
+// so buffers and images share a handful of driver allocations instead of one each.
+class MemoryAllocator {
+public:
+	static constexpr vk::DeviceSize DEFAULT_BLOCK_SIZE = 64ull * 1024 * 1024;
+
+	explicit MemoryAllocator(VulkanDevice& device, vk::DeviceSize blockSize = DEFAULT_BLOCK_SIZE);
+	~MemoryAllocator() = default;
+
+	MemoryAllocator(const MemoryAllocator&) = delete;
+	MemoryAllocator& operator=(const MemoryAllocator&) = delete;
+
+	// linear: buffers and linear-tiled images; kept in separate blocks from optimal-tiled
+	// images so bufferImageGranularity never has to be honoured between neighbours
+	MemoryAllocation allocate(const vk::MemoryRequirements& requirements,
+							  vk::MemoryPropertyFlags properties,
+							  bool linear = true);
+
+	MemoryStats getStats() const;
+
+private:
+	struct Pool {
+		uint32_t memoryTypeIndex = 0;
+		bool hostVisible = false;
+		vk::DeviceSize atomSize = 1;  // nonCoherentAtomSize for host-visible, non-coherent types
+		std::vector<std::unique_ptr<MemoryAllocation::Block>> blocks;
+	};
+
+	VulkanDevice& device;
+	vk::DeviceSize blockSize;
+	uint32_t maxAllocationCount;
+	uint32_t liveBlockCount = 0;
+	std::vector<Pool> pools;  // indexed by memoryTypeIndex * 2 + (linear ? 0 : 1)
+	mutable std::mutex mutex;
+
+	friend class MemoryAllocation;
+	void free(MemoryAllocation& allocation);
+
+	MemoryAllocation::Block& createBlock(Pool& pool, vk::DeviceSize size, bool dedicated);
+};
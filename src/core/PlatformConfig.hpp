@@ -6,17 +6,16 @@
 namespace Platform {
 
 // Platform-specific constants
+// Linux picks dynamic rendering at runtime (DeviceCapabilities::dynamicRendering), falling
+// back to a render pass on drivers without it; the other platforms require it
 #ifdef __linux__
-	constexpr bool USE_DYNAMIC_RENDERING = false;
 	constexpr bool USE_VULKAN_1_3_FEATURES = false;
 	constexpr uint32_t REQUIRED_VULKAN_VERSION = VK_API_VERSION_1_1;
 #elif defined(__APPLE__)
-	constexpr bool USE_DYNAMIC_RENDERING = true;
 	constexpr bool USE_VULKAN_1_3_FEATURES = true;
 	constexpr uint32_t REQUIRED_VULKAN_VERSION = VK_API_VERSION_1_3;
 #else
 	// Windows: Full Vulkan 1.3 support
-	constexpr bool USE_DYNAMIC_RENDERING = true;
 	constexpr bool USE_VULKAN_1_3_FEATURES = true;
 	constexpr uint32_t REQUIRED_VULKAN_VERSION = VK_API_VERSION_1_3;
 #endif
@@ -48,6 +47,35 @@ inline std::vector<const char*> getRequiredDeviceExtensions() {
 #endif
 }
 
+// Extensions dynamic rendering and synchronization2 need below Vulkan 1.3, where both are core.
+// Dynamic rendering builds on depth/stencil resolve, itself core from Vulkan 1.2
+inline std::vector<const char*> getDynamicRenderingExtensions(uint32_t deviceApiVersion) {
+	if (deviceApiVersion >= VK_API_VERSION_1_3) {
+		return {};
+	}
+	std::vector<const char*> extensions = {
+		vk::KHRDynamicRenderingExtensionName,
+		vk::KHRSynchronization2ExtensionName
+	};
+	if (deviceApiVersion < VK_API_VERSION_1_2) {
+		extensions.push_back(vk::KHRDepthStencilResolveExtensionName);
+		extensions.push_back(vk::KHRCreateRenderpass2ExtensionName);
+	}
+	return extensions;
+}
+
+// Bindless textures: a partially bound runtime array written while frames are in flight.
+// Takes vk::PhysicalDeviceDescriptorIndexingFeatures or vk::PhysicalDeviceVulkan12Features;
+// the array also needs shaderSampledImageArrayDynamicIndexing. Without them every texture
+// gets a descriptor set of its own
+template<typename Features>
+inline bool hasBindlessFeatures(const Features& features) {
+	return features.runtimeDescriptorArray &&
+		   features.descriptorBindingPartiallyBound &&
+		   features.descriptorBindingSampledImageUpdateAfterBind &&
+		   features.descriptorBindingUpdateUnusedWhilePending;
+}
+
 // Check if device supports required features
 inline bool checkDeviceFeatureSupport(const vk::raii::PhysicalDevice& device) {
 #ifdef __linux__
@@ -1,18 +1,120 @@
 #include "VulkanDevice.hpp"
 #include "PlatformConfig.hpp"
 #include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <cctype>
 #include <cstring>
 #include <algorithm>
+#include <optional>
 #include <ranges>
 
 #define GLFW_INCLUDE_VULKAN
 #include <GLFW/glfw3.h>
 
-VulkanDevice::VulkanDevice(const std::vector<const char*>& validationLayers, bool enableValidation)
+namespace {
+	bool hasExtension(const std::vector<vk::ExtensionProperties>& extensions, const char* name) {
+		return std::ranges::any_of(extensions, [name](const vk::ExtensionProperties& extension) {
+			return strcmp(extension.extensionName, name) == 0;
+		});
+	}
+
+	std::string toLower(std::string text) {
+		std::ranges::transform(text, text.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		return text;
+	}
+
+	std::string uuidHex(const vk::raii::PhysicalDevice& device) {
+		auto properties = device.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceIDProperties>();
+		std::ostringstream hex;
+		for (uint8_t byte : properties.get<vk::PhysicalDeviceIDProperties>().deviceUUID) {
+			hex << std::hex << std::setw(2) << std::setfill('0') << static_cast<uint32_t>(byte);
+		}
+		return hex.str();
+	}
+
+	vk::DeviceSize deviceLocalBytes(const vk::raii::PhysicalDevice& device) {
+		vk::PhysicalDeviceMemoryProperties memoryProperties = device.getMemoryProperties();
+		vk::DeviceSize bytes = 0;
+		for (uint32_t i = 0; i < memoryProperties.memoryHeapCount; i++) {
+			if (memoryProperties.memoryHeaps[i].flags & vk::MemoryHeapFlagBits::eDeviceLocal) {
+				bytes += memoryProperties.memoryHeaps[i].size;
+			}
+		}
+		return bytes;
+	}
+
+	// A name substring, or the UUID with or without its dashes
+	bool matchesSelector(const vk::raii::PhysicalDevice& device, const std::string& selector) {
+		std::string wanted = toLower(selector);
+		if (toLower(device.getProperties().deviceName.data()).find(wanted) != std::string::npos) {
+			return true;
+		}
+		std::erase(wanted, '-');
+		return wanted == uuidHex(device);
+	}
+
+	// Compared in order: device type, whole GiB of device-local memory, then optional
+	// features, so a discrete GPU always beats an integrated one with more shared memory
+	struct DeviceScore {
+		uint32_t typeRank = 0;
+		vk::DeviceSize vramGiB = 0;
+		uint32_t optionalFeatures = 0;
+
+		auto operator<=>(const DeviceScore&) const = default;
+	};
+
+	DeviceScore scoreDevice(const vk::raii::PhysicalDevice& device) {
+		vk::PhysicalDeviceProperties properties = device.getProperties();
+		DeviceScore score;
+		switch (properties.deviceType) {
+			case vk::PhysicalDeviceType::eDiscreteGpu:   score.typeRank = 4; break;
+			case vk::PhysicalDeviceType::eIntegratedGpu: score.typeRank = 3; break;
+			case vk::PhysicalDeviceType::eVirtualGpu:    score.typeRank = 2; break;
+			case vk::PhysicalDeviceType::eCpu:           score.typeRank = 1; break;  // llvmpipe and the like
+			default:                                     score.typeRank = 0; break;
+		}
+		score.vramGiB = deviceLocalBytes(device) >> 30;
+
+		// The optional features createLogicalDevice enables; promoted extensions count at their core version
+		vk::PhysicalDeviceFeatures features = device.getFeatures();
+		auto extensions = device.enumerateDeviceExtensionProperties();
+		const bool vulkan1_2 = properties.apiVersion >= VK_API_VERSION_1_2;
+		const bool vulkan1_3 = properties.apiVersion >= VK_API_VERSION_1_3;
+		for (bool supported : {
+				 features.multiDrawIndirect && features.drawIndirectFirstInstance,
+				 !!features.fillModeNonSolid,
+				 !!features.samplerAnisotropy,
+				 !!features.pipelineStatisticsQuery,
+				 vulkan1_2 || hasExtension(extensions, vk::KHRTimelineSemaphoreExtensionName),
+				 vulkan1_2 || hasExtension(extensions, vk::KHRDrawIndirectCountExtensionName),
+				 vulkan1_3 || hasExtension(extensions, vk::KHRDynamicRenderingExtensionName) }) {
+			score.optionalFeatures += supported ? 1 : 0;
+		}
+		return score;
+	}
+
+	std::string describeDevice(const vk::raii::PhysicalDevice& device) {
+		vk::PhysicalDeviceProperties properties = device.getProperties();
+		return std::string(properties.deviceName.data()) + " [" + vk::to_string(properties.deviceType) + ", " +
+			std::to_string(deviceLocalBytes(device) >> 20) + " MB device-local, UUID " + uuidHex(device) + "]";
+	}
+}
+
+VulkanDevice::VulkanDevice(const std::vector<const char*>& validationLayers, bool enableValidation, bool headless,
+						   const std::string& deviceSelector)
 	: enableValidationLayers(enableValidation)
+	, headless(headless)
 	, validationLayers(validationLayers)
 	, requiredDeviceExtensions(Platform::getRequiredDeviceExtensions())
+	, deviceSelector(deviceSelector)
 {
+	if (headless) {
+		// Swapchains need the surface instance extensions, which headless instances don't enable
+		std::erase_if(requiredDeviceExtensions, [](const char* extension) {
+			return strcmp(extension, vk::KHRSwapchainExtensionName) == 0;
+		});
+	}
 	createInstance();
 	setupDebugMessenger();
 	pickPhysicalDevice();
@@ -97,56 +199,121 @@ void VulkanDevice::setupDebugMessenger() {
 	debugMessenger = instance.createDebugUtilsMessengerEXT(debugUtilsMessengerCreateInfoEXT);
 }
 
-void VulkanDevice::pickPhysicalDevice() {
-	std::vector<vk::raii::PhysicalDevice> devices = instance.enumeratePhysicalDevices();
-	const auto devIter = std::ranges::find_if(
-		devices,
-		[&](auto const & device) {
-			// Check if the device supports the Vulkan 1.1 API version (relaxed requirement)
-			bool supportsVulkan1_1 = device.getProperties().apiVersion >= VK_API_VERSION_1_1;
-
-			// Check if any of the queue families support graphics operations
-			auto queueFamilies = device.getQueueFamilyProperties();
-			bool supportsGraphics = std::ranges::any_of(
-				queueFamilies,
-				[](auto const & qfp) { return !!(qfp.queueFlags & vk::QueueFlagBits::eGraphics); }
-			);
-
-			// Check if all required device extensions are available
-			auto availableDeviceExtensions = device.enumerateDeviceExtensionProperties();
-			bool supportsAllRequiredExtensions = std::ranges::all_of(
-				requiredDeviceExtensions,
-				[&availableDeviceExtensions](auto const & requiredDeviceExtension) {
-					return std::ranges::any_of(
-						availableDeviceExtensions,
-						[requiredDeviceExtension](auto const & availableDeviceExtension) {
-							return strcmp(availableDeviceExtension.extensionName, requiredDeviceExtension) == 0;
-						}
-					);
-				}
-			);
-
-			// Check required features
-			bool supportsRequiredFeatures = Platform::checkDeviceFeatureSupport(device);
-
-			return supportsVulkan1_1 && supportsGraphics && supportsAllRequiredExtensions && supportsRequiredFeatures;
+bool VulkanDevice::isDeviceSuitable(const vk::raii::PhysicalDevice& candidate) const {
+	// Check if the device supports the Vulkan 1.1 API version (relaxed requirement)
+	bool supportsVulkan1_1 = candidate.getProperties().apiVersion >= VK_API_VERSION_1_1;
+
+	// Check if any of the queue families support graphics operations
+	auto queueFamilies = candidate.getQueueFamilyProperties();
+	bool supportsGraphics = std::ranges::any_of(
+		queueFamilies,
+		[](auto const & qfp) { return !!(qfp.queueFlags & vk::QueueFlagBits::eGraphics); }
+	);
+
+	// Check if all required device extensions are available
+	auto availableDeviceExtensions = candidate.enumerateDeviceExtensionProperties();
+	bool supportsAllRequiredExtensions = std::ranges::all_of(
+		requiredDeviceExtensions,
+		[&availableDeviceExtensions](auto const & requiredDeviceExtension) {
+			return hasExtension(availableDeviceExtensions, requiredDeviceExtension);
 		}
 	);
 
-	if (devIter != devices.end()) {
-		physicalDevice = *devIter;
-	} else {
+	// Check required features
+	bool supportsRequiredFeatures = Platform::checkDeviceFeatureSupport(candidate);
+
+	return supportsVulkan1_1 && supportsGraphics && supportsAllRequiredExtensions && supportsRequiredFeatures;
+}
+
+void VulkanDevice::pickPhysicalDevice() {
+	std::vector<vk::raii::PhysicalDevice> devices = instance.enumeratePhysicalDevices();
+	std::erase_if(devices, [this](const vk::raii::PhysicalDevice& candidate) { return !isDeviceSuitable(candidate); });
+	if (devices.empty()) {
 		throw std::runtime_error("failed to find a suitable GPU!");
 	}
+
+	auto chosen = devices.end();
+	if (!deviceSelector.empty()) {
+		chosen = std::ranges::find_if(devices, [this](const vk::raii::PhysicalDevice& candidate) {
+			return matchesSelector(candidate, deviceSelector);
+		});
+		if (chosen == devices.end()) {
+			std::string names;
+			for (const vk::raii::PhysicalDevice& candidate : devices) {
+				names += (names.empty() ? "" : ", ") + describeDevice(candidate);
+			}
+			throw std::runtime_error("no suitable GPU matches \"" + deviceSelector + "\" (found " + names + ")");
+		}
+	} else {
+		// Ties keep enumeration order, which is what the loader considers the default
+		chosen = std::ranges::max_element(devices, {}, [](const vk::raii::PhysicalDevice& candidate) {
+			return scoreDevice(candidate);
+		});
+	}
+	physicalDevice = *chosen;
+
+	std::cout << "GPU: " << describeDevice(physicalDevice)
+			  << (!deviceSelector.empty() ? ", selected by \"" + deviceSelector + "\""
+				  : devices.size() > 1 ? ", best of " + std::to_string(devices.size()) + " suitable" : "") << std::endl;
+
+	pickTransferQueueFamily();
+	pickComputeQueueFamily();
+}
+
+void VulkanDevice::pickTransferQueueFamily() {
+	std::vector<vk::QueueFamilyProperties> queueFamilyProperties = physicalDevice.getQueueFamilyProperties();
+
+	// Prefer a DMA-only family (transfer without graphics/compute), then any non-graphics
+	// transfer family; otherwise uploads share the graphics queue
+	auto isTransferOnly = [](const vk::QueueFamilyProperties& qfp) {
+		return (qfp.queueFlags & vk::QueueFlagBits::eTransfer) &&
+			!(qfp.queueFlags & (vk::QueueFlagBits::eGraphics | vk::QueueFlagBits::eCompute));
+	};
+	auto isNonGraphicsTransfer = [](const vk::QueueFamilyProperties& qfp) {
+		return (qfp.queueFlags & (vk::QueueFlagBits::eTransfer | vk::QueueFlagBits::eCompute)) &&
+			!(qfp.queueFlags & vk::QueueFlagBits::eGraphics);
+	};
+
+	for (auto predicate : { +isTransferOnly, +isNonGraphicsTransfer }) {
+		for (uint32_t qfpIndex = 0; qfpIndex < queueFamilyProperties.size(); qfpIndex++) {
+			if (queueFamilyProperties[qfpIndex].queueCount > 0 && predicate(queueFamilyProperties[qfpIndex])) {
+				transferQueueFamily = qfpIndex;
+				return;
+			}
+		}
+	}
+}
+
+void VulkanDevice::pickComputeQueueFamily() {
+	std::vector<vk::QueueFamilyProperties> queueFamilyProperties = physicalDevice.getQueueFamilyProperties();
+
+	// An async compute family runs beside graphics; prefer one uploads don't also use
+	std::optional<uint32_t> shared;
+	for (uint32_t qfpIndex = 0; qfpIndex < queueFamilyProperties.size(); qfpIndex++) {
+		const vk::QueueFamilyProperties& qfp = queueFamilyProperties[qfpIndex];
+		if (qfp.queueCount == 0 || !(qfp.queueFlags & vk::QueueFlagBits::eCompute) ||
+			(qfp.queueFlags & vk::QueueFlagBits::eGraphics)) {
+			continue;
+		}
+		if (qfpIndex != transferQueueFamily) {
+			computeQueueFamily = qfpIndex;
+			return;
+		}
+		shared = qfpIndex;
+	}
+	if (shared) {
+		computeQueueFamily = *shared;
+	}
 }
 
 void VulkanDevice::createLogicalDevice() {
 	std::vector<vk::QueueFamilyProperties> queueFamilyProperties = physicalDevice.getQueueFamilyProperties();
 
 	// Get the first index into queueFamilyProperties which supports both graphics and present
+	// (headless: graphics only)
 	for (uint32_t qfpIndex = 0; qfpIndex < queueFamilyProperties.size(); qfpIndex++) {
 		if ((queueFamilyProperties[qfpIndex].queueFlags & vk::QueueFlagBits::eGraphics) &&
-			physicalDevice.getSurfaceSupportKHR(qfpIndex, *surface)) {
+			(headless || physicalDevice.getSurfaceSupportKHR(qfpIndex, *surface))) {
 			// Found a queue family that supports both graphics and present
 			graphicsQueueFamily = qfpIndex;
 			break;
@@ -157,7 +324,15 @@ void VulkanDevice::createLogicalDevice() {
 	}
 
 	float queuePriority = 0.0f;
-	vk::DeviceQueueCreateInfo deviceQueueCreateInfo = Platform::createDeviceQueueCreateInfo(graphicsQueueFamily, &queuePriority);
+	std::vector<vk::DeviceQueueCreateInfo> queueCreateInfos = {
+		Platform::createDeviceQueueCreateInfo(graphicsQueueFamily, &queuePriority)
+	};
+	if (hasDedicatedTransferQueue()) {
+		queueCreateInfos.push_back(Platform::createDeviceQueueCreateInfo(transferQueueFamily, &queuePriority));
+	}
+	if (hasAsyncComputeQueue() && computeQueueFamily != transferQueueFamily) {
+		queueCreateInfos.push_back(Platform::createDeviceQueueCreateInfo(computeQueueFamily, &queuePriority));
+	}
 
 	// Build feature chain based on platform requirements
 	if constexpr (!Platform::USE_VULKAN_1_3_FEATURES) {
@@ -167,34 +342,137 @@ void VulkanDevice::createLogicalDevice() {
 		vk::PhysicalDeviceFeatures2 featureChain = {
 			.features = availableFeatures  // Enable all available features
 		};
+		capabilities.multiDrawIndirect = availableFeatures.multiDrawIndirect && availableFeatures.drawIndirectFirstInstance;
+		capabilities.fillModeNonSolid = availableFeatures.fillModeNonSolid;
+		capabilities.samplerAnisotropy = availableFeatures.samplerAnisotropy;
+		capabilities.pipelineStatisticsQuery = availableFeatures.pipelineStatisticsQuery;
+		capabilities.inheritedQueries = availableFeatures.inheritedQueries;
+
+		// Timeline semaphores come from VK_KHR_timeline_semaphore below Vulkan 1.2; optional
+		std::vector<const char*> deviceExtensions = requiredDeviceExtensions;
+		vk::PhysicalDeviceTimelineSemaphoreFeatures timelineSemaphoreFeatures{ .timelineSemaphore = true };
+		if (hasDeviceExtension(vk::KHRTimelineSemaphoreExtensionName) &&
+			physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceTimelineSemaphoreFeatures>()
+				.get<vk::PhysicalDeviceTimelineSemaphoreFeatures>().timelineSemaphore) {
+			deviceExtensions.push_back(vk::KHRTimelineSemaphoreExtensionName);
+			timelineSemaphoreFeatures.pNext = featureChain.pNext;
+			featureChain.pNext = &timelineSemaphoreFeatures;
+			capabilities.timelineSemaphores = true;
+		}
+
+		// Bindless texture array from VK_EXT_descriptor_indexing (core from Vulkan 1.2); without
+		// it BindlessDescriptors gives every texture a descriptor set of its own
+		vk::PhysicalDeviceDescriptorIndexingFeatures descriptorIndexingFeatures{
+			.descriptorBindingSampledImageUpdateAfterBind = true,
+			.descriptorBindingUpdateUnusedWhilePending = true,
+			.descriptorBindingPartiallyBound = true,
+			.runtimeDescriptorArray = true
+		};
+		if (hasDeviceExtension(vk::EXTDescriptorIndexingExtensionName) &&
+			availableFeatures.shaderSampledImageArrayDynamicIndexing &&
+			Platform::hasBindlessFeatures(
+				physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceDescriptorIndexingFeatures>()
+					.get<vk::PhysicalDeviceDescriptorIndexingFeatures>())) {
+			deviceExtensions.push_back(vk::EXTDescriptorIndexingExtensionName);
+			descriptorIndexingFeatures.pNext = featureChain.pNext;
+			featureChain.pNext = &descriptorIndexingFeatures;
+			capabilities.descriptorIndexing = true;
+		}
+
+		// The extension has no feature struct: enabling it makes the count draws usable. Vulkan 1.2's
+		// drawIndirectCount bit would need Vulkan12Features, which can't share the chain with the structs above
+		if (hasDeviceExtension(vk::KHRDrawIndirectCountExtensionName)) {
+			deviceExtensions.push_back(vk::KHRDrawIndirectCountExtensionName);
+			capabilities.drawIndirectCount = true;
+		}
+
+		// Dynamic rendering with synchronization2 when the driver has them (core from Vulkan 1.3);
+		// llvmpipe and older drivers keep the render pass path
+		std::vector<const char*> dynamicRenderingExtensions =
+			Platform::getDynamicRenderingExtensions(physicalDevice.getProperties().apiVersion);
+		vk::PhysicalDeviceSynchronization2Features synchronization2Features{ .synchronization2 = true };
+		vk::PhysicalDeviceDynamicRenderingFeatures dynamicRenderingFeatures{
+			.pNext = &synchronization2Features,
+			.dynamicRendering = true
+		};
+		if (std::ranges::all_of(dynamicRenderingExtensions, [this](const char* name) { return hasDeviceExtension(name); })) {
+			auto supported = physicalDevice.getFeatures2<
+				vk::PhysicalDeviceFeatures2,
+				vk::PhysicalDeviceDynamicRenderingFeatures,
+				vk::PhysicalDeviceSynchronization2Features
+			>();
+			if (supported.get<vk::PhysicalDeviceDynamicRenderingFeatures>().dynamicRendering &&
+				supported.get<vk::PhysicalDeviceSynchronization2Features>().synchronization2) {
+				deviceExtensions.insert(deviceExtensions.end(),
+					dynamicRenderingExtensions.begin(), dynamicRenderingExtensions.end());
+				synchronization2Features.pNext = featureChain.pNext;
+				featureChain.pNext = &dynamicRenderingFeatures;
+				capabilities.dynamicRendering = true;
+			}
+		}
 
 		vk::DeviceCreateInfo deviceCreateInfo{
 			.pNext = &featureChain,
-			.queueCreateInfoCount = 1,
-			.pQueueCreateInfos = &deviceQueueCreateInfo,
-			.enabledExtensionCount = static_cast<uint32_t>(requiredDeviceExtensions.size()),
-			.ppEnabledExtensionNames = requiredDeviceExtensions.data()
+			.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size()),
+			.pQueueCreateInfos = queueCreateInfos.data(),
+			.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size()),
+			.ppEnabledExtensionNames = deviceExtensions.data()
 		};
 
 		device = vk::raii::Device(physicalDevice, deviceCreateInfo);
 	} else {
 		// macOS/Windows: Enable full Vulkan 1.3 features
+		// Block-compressed texture families, wireframe, indirect multi-draw and count draws, pipeline statistics
+		// and timeline semaphores are optional; enable whichever the device has
+		auto availableFeatures = physicalDevice.getFeatures();
+		auto available12 = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>()
+			.get<vk::PhysicalDeviceVulkan12Features>();
+		capabilities = DeviceCapabilities{
+			.timelineSemaphores = !!available12.timelineSemaphore,
+			.dynamicRendering = true,    // Required, checked in pickPhysicalDevice
+			.descriptorIndexing = availableFeatures.shaderSampledImageArrayDynamicIndexing &&
+				Platform::hasBindlessFeatures(available12),
+			.drawIndirectCount = !!available12.drawIndirectCount,
+			.multiDrawIndirect = availableFeatures.multiDrawIndirect && availableFeatures.drawIndirectFirstInstance,
+			.fillModeNonSolid = !!availableFeatures.fillModeNonSolid,
+			.samplerAnisotropy = true,   // Enabled unconditionally below
+			.pipelineStatisticsQuery = !!availableFeatures.pipelineStatisticsQuery,
+			.inheritedQueries = !!availableFeatures.inheritedQueries
+		};
+
 		vk::StructureChain<
 			vk::PhysicalDeviceFeatures2,
 			vk::PhysicalDeviceVulkan11Features,
+			vk::PhysicalDeviceVulkan12Features,
 			vk::PhysicalDeviceVulkan13Features,
 			vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT
 		> featureChain = {
-			{.features = {.samplerAnisotropy = true }},             // vk::PhysicalDeviceFeatures2
+			{.features = {
+				.multiDrawIndirect = availableFeatures.multiDrawIndirect,
+				.drawIndirectFirstInstance = availableFeatures.drawIndirectFirstInstance,
+				.fillModeNonSolid = availableFeatures.fillModeNonSolid,
+				.samplerAnisotropy = true,
+				.textureCompressionETC2 = availableFeatures.textureCompressionETC2,
+				.textureCompressionASTC_LDR = availableFeatures.textureCompressionASTC_LDR,
+				.textureCompressionBC = availableFeatures.textureCompressionBC,
+				.pipelineStatisticsQuery = availableFeatures.pipelineStatisticsQuery,
+				.shaderSampledImageArrayDynamicIndexing = capabilities.descriptorIndexing,
+				.inheritedQueries = availableFeatures.inheritedQueries }},  // vk::PhysicalDeviceFeatures2
 			{.shaderDrawParameters = true },                        // vk::PhysicalDeviceVulkan11Features
+			{.drawIndirectCount = capabilities.drawIndirectCount,
+			 .descriptorBindingSampledImageUpdateAfterBind = capabilities.descriptorIndexing,
+			 .descriptorBindingUpdateUnusedWhilePending = capabilities.descriptorIndexing,
+			 .descriptorBindingPartiallyBound = capabilities.descriptorIndexing,
+			 .runtimeDescriptorArray = capabilities.descriptorIndexing,
+			 .timelineSemaphore = capabilities.timelineSemaphores },  // vk::PhysicalDeviceVulkan12Features
 			{.synchronization2 = true, .dynamicRendering = true },  // vk::PhysicalDeviceVulkan13Features
 			{.extendedDynamicState = true }                         // vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT
 		};
 
 		vk::DeviceCreateInfo deviceCreateInfo{
 			.pNext = &featureChain.get<vk::PhysicalDeviceFeatures2>(),
-			.queueCreateInfoCount = 1,
-			.pQueueCreateInfos = &deviceQueueCreateInfo,
+			.queueCreateInfoCount = static_cast<uint32_t>(queueCreateInfos.size()),
+			.pQueueCreateInfos = queueCreateInfos.data(),
 			.enabledExtensionCount = static_cast<uint32_t>(requiredDeviceExtensions.size()),
 			.ppEnabledExtensionNames = requiredDeviceExtensions.data()
 		};
@@ -202,13 +480,24 @@ void VulkanDevice::createLogicalDevice() {
 		device = vk::raii::Device(physicalDevice, deviceCreateInfo);
 	}
 	graphicsQueue = vk::raii::Queue(device, graphicsQueueFamily, 0);
+	if (hasDedicatedTransferQueue()) {
+		transferQueue = vk::raii::Queue(device, transferQueueFamily, 0);
+	}
+	if (hasAsyncComputeQueue()) {
+		// Queue 0 of a family shared with transfer is the same VkQueue; both are only submitted to from the main thread
+		computeQueue = vk::raii::Queue(device, computeQueueFamily, 0);
+	}
+
+	allocator = std::make_unique<MemoryAllocator>(*this);
 }
 
 std::vector<const char*> VulkanDevice::getRequiredExtensions() const {
-	uint32_t glfwExtensionCount = 0;
-	auto glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
-
-	std::vector extensions(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	std::vector<const char*> extensions;
+	if (!headless) {
+		uint32_t glfwExtensionCount = 0;
+		auto glfwExtensions = glfwGetRequiredInstanceExtensions(&glfwExtensionCount);
+		extensions.assign(glfwExtensions, glfwExtensions + glfwExtensionCount);
+	}
 	if (enableValidationLayers) {
 		extensions.push_back(vk::EXTDebugUtilsExtensionName);
 	}
@@ -216,6 +505,10 @@ std::vector<const char*> VulkanDevice::getRequiredExtensions() const {
 	return extensions;
 }
 
+bool VulkanDevice::hasDeviceExtension(const char* extensionName) const {
+	return hasExtension(physicalDevice.enumerateDeviceExtensionProperties(), extensionName);
+}
+
 uint32_t VulkanDevice::findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties) const {
 	vk::PhysicalDeviceMemoryProperties memProperties = physicalDevice.getMemoryProperties();
 
@@ -228,15 +521,19 @@ uint32_t VulkanDevice::findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFla
 	throw std::runtime_error("failed to find suitable memory type!");
 }
 
+bool VulkanDevice::supportsFormat(vk::Format format, vk::ImageTiling tiling, vk::FormatFeatureFlags features) const {
+	vk::FormatProperties props = physicalDevice.getFormatProperties(format);
+	vk::FormatFeatureFlags available = tiling == vk::ImageTiling::eLinear ? props.linearTilingFeatures : props.optimalTilingFeatures;
+	return (available & features) == features;
+}
+
 vk::Format VulkanDevice::findSupportedFormat(
 	const std::vector<vk::Format>& candidates,
 	vk::ImageTiling tiling,
 	vk::FormatFeatureFlags features) const
 {
 	auto formatIt = std::ranges::find_if(candidates, [&](auto const format) {
-		vk::FormatProperties props = physicalDevice.getFormatProperties(format);
-		return (((tiling == vk::ImageTiling::eLinear) && ((props.linearTilingFeatures & features) == features)) ||
-				((tiling == vk::ImageTiling::eOptimal) && ((props.optimalTilingFeatures & features) == features)));
+		return supportsFormat(format, tiling, features);
 	});
 	if (formatIt == candidates.end()) {
 		throw std::runtime_error("failed to find supported format!");
@@ -1,16 +1,36 @@
 #pragma once
 
 #include "../utils/VulkanCommon.hpp"
+#include "MemoryAllocator.hpp"
+#include <memory>
 #include <vector>
 #include <string>
 
 // Forward declaration
 struct GLFWwindow;
 
+// Optional features enabled on the logical device, known after createLogicalDevice;
+// subsystems read these to pick their fast paths
+struct DeviceCapabilities {
+	bool timelineSemaphores = false;       // SyncManager falls back to fences
+	bool dynamicRendering = false;         // With synchronization2; the renderer falls back to a render pass
+	bool descriptorIndexing = false;       // Bindless texture array; otherwise one descriptor set per texture
+	bool drawIndirectCount = false;        // GpuCulling compacts visible draws and the GPU writes their count
+	bool multiDrawIndirect = false;        // With drawIndirectFirstInstance, which selects the SceneInstance
+	bool fillModeNonSolid = false;         // Wireframe pipelines
+	bool samplerAnisotropy = false;
+	bool pipelineStatisticsQuery = false;  // GpuProfiler's per-pass statistics
+	bool inheritedQueries = false;         // Secondaries run inside the statistics query; otherwise it pauses around them
+};
+
 class VulkanDevice {
 public:
 	// Constructor: creates instance, picks physical device, creates logical device
-	VulkanDevice(const std::vector<const char*>& validationLayers, bool enableValidation);
+	// Headless devices need no window system: no surface, no swapchain, no GLFW
+	// A non-empty deviceSelector picks the suitable GPU whose name contains it (case-insensitive)
+	// or whose UUID it spells in hex; otherwise the best-scoring GPU is used
+	VulkanDevice(const std::vector<const char*>& validationLayers, bool enableValidation, bool headless = false,
+				 const std::string& deviceSelector = "");
 	~VulkanDevice() = default;
 
 	// Delete copy constructor and assignment operator (RAII, non-copyable)
@@ -24,7 +44,7 @@ public:
 	// Surface creation (requires GLFW window)
 	void createSurface(GLFWwindow* window);
 
-	// Device initialization (must be called after createSurface)
+	// Device initialization (must be called after createSurface, unless headless)
 	void createLogicalDevice();
 
 	// Accessors
@@ -33,11 +53,21 @@ public:
 	vk::raii::PhysicalDevice& getPhysicalDevice() { return physicalDevice; }
 	vk::raii::Device& getDevice() { return device; }
 	vk::raii::Queue& getGraphicsQueue() { return graphicsQueue; }
+	vk::raii::Queue& getTransferQueue() { return hasDedicatedTransferQueue() ? transferQueue : graphicsQueue; }
+	vk::raii::Queue& getComputeQueue() { return hasAsyncComputeQueue() ? computeQueue : graphicsQueue; }
 	vk::raii::SurfaceKHR& getSurface() { return surface; }
 	uint32_t getGraphicsQueueFamily() const { return graphicsQueueFamily; }
+	uint32_t getTransferQueueFamily() const { return hasDedicatedTransferQueue() ? transferQueueFamily : graphicsQueueFamily; }
+	bool hasDedicatedTransferQueue() const { return transferQueueFamily != ~0u && transferQueueFamily != graphicsQueueFamily; }
+	uint32_t getComputeQueueFamily() const { return hasAsyncComputeQueue() ? computeQueueFamily : graphicsQueueFamily; }
+	bool hasAsyncComputeQueue() const { return computeQueueFamily != ~0u && computeQueueFamily != graphicsQueueFamily; }
+	const DeviceCapabilities& getCapabilities() const { return capabilities; }
+	bool isHeadless() const { return headless; }
+	MemoryAllocator& getAllocator() { return *allocator; }
 
 	// Utility functions
 	uint32_t findMemoryType(uint32_t typeFilter, vk::MemoryPropertyFlags properties) const;
+	bool supportsFormat(vk::Format format, vk::ImageTiling tiling, vk::FormatFeatureFlags features) const;
 	vk::Format findSupportedFormat(
 		const std::vector<vk::Format>& candidates,
 		vk::ImageTiling tiling,
@@ -53,19 +83,33 @@ private:
 	vk::raii::Device device = nullptr;
 	vk::raii::Queue graphicsQueue = nullptr;
 	uint32_t graphicsQueueFamily = ~0;
+	vk::raii::Queue transferQueue = nullptr;
+	uint32_t transferQueueFamily = ~0;  // Chosen in pickPhysicalDevice, ~0 if none besides graphics
+	vk::raii::Queue computeQueue = nullptr;
+	uint32_t computeQueueFamily = ~0;   // Likewise; may be the transfer family, sharing its queue
+
+	// Declared after device so it is destroyed (and its blocks freed) first
+	std::unique_ptr<MemoryAllocator> allocator;
 
 	// Configuration
 	bool enableValidationLayers;
+	bool headless;
 	std::vector<const char*> validationLayers;
 	std::vector<const char*> requiredDeviceExtensions;
+	std::string deviceSelector;
+	DeviceCapabilities capabilities;
 
 	// Initialization functions
 	void createInstance();
 	void setupDebugMessenger();
 	void pickPhysicalDevice();
+	bool isDeviceSuitable(const vk::raii::PhysicalDevice& candidate) const;
+	void pickTransferQueueFamily();
+	void pickComputeQueueFamily();
 
 	// Helper functions
 	std::vector<const char*> getRequiredExtensions() const;
+	bool hasDeviceExtension(const char* extensionName) const;
 #ifdef __linux__
 	// Linux: Use C API types for compatibility with llvmpipe
 	static VKAPI_ATTR VkBool32 VKAPI_CALL debugCallback(
@@ -0,0 +1,285 @@
+#include "FDFLoader.hpp"
+#include "src/utils/FileUtils.hpp"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <exception>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    constexpr uint32_t DEFAULT_COLOR = 0xFFFFFF;     // FdF convention: uncolored points are white
+    constexpr size_t MIN_BYTES_PER_THREAD = 1 << 20;  // Below this, thread startup dominates
+
+    struct Line {
+        const char* begin;
+        const char* end;
+    };
+
+    inline bool isSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+    }
+
+    inline bool isDigit(char c) {
+        return static_cast<unsigned>(c - '0') <= 9;
+    }
+
+    inline int hexValue(char c) {
+        if (isDigit(c)) return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    // FdF colors are sRGB; the swapchain is sRGB-encoded, so vertex colors must be linear
+    const std::array<float, 256>& srgbToLinearTable() {
+        static const std::array<float, 256> table = [] {
+            std::array<float, 256> t{};
+            for (int i = 0; i < 256; i++) {
+                float c = static_cast<float>(i) / 255.0f;
+                t[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+            }
+            return t;
+        }();
+        return table;
+    }
+
+    [[noreturn]] void parseError(const std::string& filename, size_t row, const char* what) {
+        throw std::runtime_error("Failed to parse FDF file: " + filename + " (line " + std::to_string(row + 1) + "): " + what);
+    }
+
+    /**
+     * Scan one row, calling emit(column, height, color) per point.
+     * Returns the number of points in the row.
+     */
+    template<typename Emit>
+    size_t scanRow(const Line& line, const std::string& filename, size_t row, Emit&& emit) {
+        const char* p = line.begin;
+        const char* end = line.end;
+        size_t column = 0;
+
+        while (true) {
+            while (p < end && isSpace(*p)) ++p;
+            if (p >= end) break;
+
+            bool negative = false;
+            if (*p == '-' || *p == '+') {
+                negative = (*p == '-');
+                ++p;
+            }
+            if (p >= end || !isDigit(*p)) {
+                parseError(filename, row, "expected integer height");
+            }
+            int64_t value = 0;
+            while (p < end && isDigit(*p)) {
+                value = value * 10 + (*p - '0');
+                if (value > INT32_MAX) {
+                    parseError(filename, row, "height out of range");
+                }
+                ++p;
+            }
+
+            uint32_t color = DEFAULT_COLOR;
+            if (p < end && *p == ',') {
+                ++p;
+                if (end - p < 2 || p[0] != '0' || (p[1] != 'x' && p[1] != 'X')) {
+                    parseError(filename, row, "expected 0x color after ','");
+                }
+                p += 2;
+                uint32_t parsed = 0;
+                int digits = 0;
+                for (int h; p < end && (h = hexValue(*p)) >= 0; ++p, ++digits) {
+                    parsed = (parsed << 4) | static_cast<uint32_t>(h);
+                }
+                if (digits == 0 || digits > 8) {
+                    parseError(filename, row, "invalid color");
+                }
+                color = parsed & 0xFFFFFF;
+            }
+
+            if (p < end && !isSpace(*p)) {
+                parseError(filename, row, "unexpected character");
+            }
+
+            emit(column, static_cast<int32_t>(negative ? -value : value), color);
+            ++column;
+        }
+        return column;
+    }
+
+    /**
+     * Map and validate the file, then call prepare(width, height) once and
+     * emit(row, column, height, color) for every point, rows split across threads.
+     */
+    template<typename Prepare, typename Emit>
+    FDFLoadStats parseFile(const std::string& filename, Prepare&& prepare, Emit&& emit) {
+        auto startTime = std::chrono::steady_clock::now();
+
+        FileUtils::MappedFile file(filename);
+        const char* data = file.data();
+        const char* dataEnd = data + file.size();
+
+        // Split into lines (memchr runs at memory bandwidth), dropping trailing blank lines
+        std::vector<Line> lines;
+        for (const char* p = data; p < dataEnd;) {
+            const char* newline = static_cast<const char*>(memchr(p, '\n', static_cast<size_t>(dataEnd - p)));
+            const char* lineEnd = newline ? newline : dataEnd;
+            lines.push_back({ p, lineEnd });
+            p = lineEnd + 1;
+        }
+        while (!lines.empty() && std::all_of(lines.back().begin, lines.back().end, isSpace)) {
+            lines.pop_back();
+        }
+        if (lines.empty()) {
+            throw std::runtime_error("Failed to parse FDF file: " + filename + " (empty map)");
+        }
+
+        // The first row fixes the width; every other row must match
+        size_t width = scanRow(lines[0], filename, 0, [](size_t, int32_t, uint32_t) {});
+        size_t height = lines.size();
+        if (width == 0) {
+            parseError(filename, 0, "empty row");
+        }
+
+        prepare(width, height);
+
+        auto parseRows = [&](size_t firstRow, size_t lastRow) {
+            for (size_t row = firstRow; row < lastRow; row++) {
+                size_t count = scanRow(lines[row], filename, row, [&](size_t column, int32_t z, uint32_t color) {
+                    if (column >= width) {
+                        parseError(filename, row, "row is longer than the first row");
+                    }
+                    emit(row, column, z, color);
+                });
+                if (count != width) {
+                    parseError(filename, row, "row is shorter than the first row");
+                }
+            }
+        };
+
+        // Split rows into contiguous blocks, one per thread
+        size_t maxThreads = std::max<size_t>(1, std::thread::hardware_concurrency());
+        size_t threadCount = std::clamp<size_t>(file.size() / MIN_BYTES_PER_THREAD, 1, std::min(maxThreads, height));
+
+        if (threadCount == 1) {
+            parseRows(0, height);
+        } else {
+            std::vector<std::thread> workers;
+            std::vector<std::exception_ptr> errors(threadCount);
+            workers.reserve(threadCount);
+            for (size_t t = 0; t < threadCount; t++) {
+                size_t firstRow = height * t / threadCount;
+                size_t lastRow = height * (t + 1) / threadCount;
+                workers.emplace_back([&, t, firstRow, lastRow] {
+                    try {
+                        parseRows(firstRow, lastRow);
+                    } catch (...) {
+                        errors[t] = std::current_exception();
+                    }
+                });
+            }
+            for (auto& worker : workers) {
+                worker.join();
+            }
+            for (auto& error : errors) {
+                if (error) {
+                    std::rethrow_exception(error);
+                }
+            }
+        }
+
+        FDFLoadStats stats;
+        stats.width = static_cast<uint32_t>(width);
+        stats.height = static_cast<uint32_t>(height);
+        stats.fileBytes = file.size();
+        stats.threadCount = static_cast<uint32_t>(threadCount);
+        stats.parseSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        return stats;
+    }
+}
+
+FDFLoadStats FDFLoader::load(const std::string& filename,
+                             std::vector<Vertex>& vertices,
+                             std::vector<uint32_t>& indices) {
+    // Center the grid and scale the longer side to unit length; heights share the scale
+    float scale = 0.0f, originX = 0.0f, originY = 0.0f, uScale = 0.0f, vScale = 0.0f;
+    size_t width = 0;
+    const auto& linear = srgbToLinearTable();
+
+    FDFLoadStats stats = parseFile(filename,
+        [&](size_t w, size_t h) {
+            width = w;
+            vertices.clear();
+            vertices.resize(w * h);
+            scale = gridScale(static_cast<uint32_t>(w), static_cast<uint32_t>(h));
+            originX = 0.5f * static_cast<float>(w - 1);
+            originY = 0.5f * static_cast<float>(h - 1);
+            uScale = 1.0f / static_cast<float>(std::max<size_t>(w - 1, 1));
+            vScale = 1.0f / static_cast<float>(std::max<size_t>(h - 1, 1));
+        },
+        [&](size_t row, size_t column, int32_t z, uint32_t color) {
+            Vertex& vertex = vertices[row * width + column];
+            vertex.pos = { (static_cast<float>(column) - originX) * scale, (static_cast<float>(row) - originY) * scale,
+                           static_cast<float>(z) * scale };
+            vertex.color = { linear[(color >> 16) & 0xFF], linear[(color >> 8) & 0xFF], linear[color & 0xFF] };
+            vertex.texCoord = { static_cast<float>(column) * uScale, static_cast<float>(row) * vScale };
+        });
+
+    generateGridIndices(stats.width, stats.height, indices);
+    return stats;
+}
+
+FDFLoadStats FDFLoader::loadHeightmap(const std::string& filename, HeightmapData& heightmap) {
+    // Set by any thread that sees an explicit color; relaxed is enough, threads are joined before reading
+    std::atomic<bool> hasColors = false;
+
+    FDFLoadStats stats = parseFile(filename,
+        [&](size_t w, size_t h) {
+            heightmap.width = static_cast<uint32_t>(w);
+            heightmap.height = static_cast<uint32_t>(h);
+            heightmap.heights.assign(w * h, 0.0f);
+            heightmap.colors.assign(w * h, DEFAULT_COLOR);
+        },
+        [&](size_t row, size_t column, int32_t z, uint32_t color) {
+            size_t index = row * heightmap.width + column;
+            heightmap.heights[index] = static_cast<float>(z);
+            heightmap.colors[index] = color;
+            if (color != DEFAULT_COLOR && !hasColors.load(std::memory_order_relaxed)) {
+                hasColors.store(true, std::memory_order_relaxed);
+            }
+        });
+
+    // Uncolored maps draw white; skip the color buffer entirely
+    if (!hasColors.load()) {
+        heightmap.colors.clear();
+        heightmap.colors.shrink_to_fit();
+    }
+    return stats;
+}
+
+float FDFLoader::gridScale(uint32_t width, uint32_t height) {
+    return 1.0f / static_cast<float>(std::max<uint32_t>(std::max(width, height) - 1, 1));
+}
+
+void FDFLoader::generateGridIndices(uint32_t width, uint32_t height, std::vector<uint32_t>& indices) {
+    indices.clear();
+    if (width < 2 || height < 2) {
+        return;
+    }
+    indices.resize(static_cast<size_t>(width - 1) * (height - 1) * 6);
+
+    uint32_t* out = indices.data();
+    for (uint32_t row = 0; row + 1 < height; row++) {
+        for (uint32_t column = 0; column + 1 < width; column++) {
+            uint32_t i0 = row * width + column;  // (x, y)
+            uint32_t i1 = i0 + 1;                // (x + 1, y)
+            uint32_t i2 = i0 + width;            // (x, y + 1)
+            uint32_t i3 = i2 + 1;                // (x + 1, y + 1)
+            *out++ = i0; *out++ = i1; *out++ = i2;
+            *out++ = i1; *out++ = i3; *out++ = i2;
+        }
+    }
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "src/utils/Vertex.hpp"
+#include <vector>
+#include <string>
+#include <cstdint>
+
+/**
+ * @brief Timing and size information from one FDF parse
+ */
+struct FDFLoadStats {
+    uint32_t width = 0;         // Points per row
+    uint32_t height = 0;        // Number of rows
+    size_t fileBytes = 0;
+    double parseSeconds = 0.0;  // Mapping + parsing, excluding index generation
+    uint32_t threadCount = 0;
+
+    double throughputMBps() const {
+        return parseSeconds > 0.0 ? static_cast<double>(fileBytes) / (1024.0 * 1024.0) / parseSeconds : 0.0;
+    }
+};
+
+/**
+ * @brief Compact heightmap grid for GPU-side vertex reconstruction
+ *
+ * Positions are implicit from the row-major point index; only the height and,
+ * if the map has any, the packed color of each point are stored.
+ */
+struct HeightmapData {
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::vector<float> heights;     // Raw map heights, width * height
+    std::vector<uint32_t> colors;   // sRGB 0xRRGGBB per point, empty if the map has no colors
+
+    size_t getPointCount() const { return static_cast<size_t>(width) * height; }
+};
+
+/**
+ * @brief FdF heightmap loader utility
+ *
+ * Parses `.fdf` maps: rows of whitespace-separated integer heights, each
+ * optionally followed by `,0xRRGGBB`. The file is memory-mapped and scanned
+ * in place without allocations or iostreams; row blocks are parsed on
+ * multiple threads straight into the output vertex array.
+ */
+class FDFLoader {
+public:
+    /**
+     * @brief Load heightmap as a grid of vertices
+     * @param filename Path to FDF file
+     * @param vertices Output vertex data, row-major (width * height), centered and
+     *                 scaled so the longer grid side spans [-0.5, 0.5]; z is height
+     * @param indices Output triangle-list index data (see generateGridIndices)
+     * @return Grid dimensions and parse throughput
+     * @throws std::runtime_error if the file can't be read or is malformed
+     */
+    static FDFLoadStats load(const std::string& filename,
+                             std::vector<Vertex>& vertices,
+                             std::vector<uint32_t>& indices);
+
+    /**
+     * @brief Load heightmap as a compact height/color grid
+     * @param filename Path to FDF file
+     * @param heightmap Output grid; colors stay empty unless some point carries one
+     * @return Grid dimensions and parse throughput
+     * @throws std::runtime_error if the file can't be read or is malformed
+     */
+    static FDFLoadStats loadHeightmap(const std::string& filename, HeightmapData& heightmap);
+
+    /**
+     * @brief Uniform scale that maps the longer grid side to unit length
+     */
+    static float gridScale(uint32_t width, uint32_t height);
+
+    /**
+     * @brief Build the implicit triangle-list pattern of a width x height grid
+     *
+     * Two counter-clockwise triangles per cell; the pattern depends only on the
+     * grid size, so it can be shared by every grid of the same dimensions.
+     */
+    static void generateGridIndices(uint32_t width, uint32_t height, std::vector<uint32_t>& indices);
+
+private:
+    FDFLoader() = delete;  // Static utility class, no instances
+};
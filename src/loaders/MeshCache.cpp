@@ -0,0 +1,191 @@
+#include "MeshCache.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <string_view>
+#include <system_error>
+
+namespace {
+    constexpr char MAGIC[8] = { 'M', 'E', 'S', 'H', 'C', 'A', 'C', 'H' };
+    constexpr uint64_t BLOB_ALIGNMENT = 16;
+
+    struct CacheHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t vertexFormat;
+        uint32_t vertexStride;
+        uint32_t indexSize;
+        uint32_t vertexCount;
+        uint32_t indexCount;
+        uint32_t processingKey;
+        uint32_t reserved;
+        uint64_t sourceSize;
+        int64_t sourceModified;
+        MeshPushConstants quantization;
+        uint64_t pathLength;      // Canonical source path follows the header
+        uint64_t vertexOffset;    // Blob offsets from the start of the file
+        uint64_t vertexBytes;
+        uint64_t indexOffset;
+        uint64_t indexBytes;
+    };
+
+    struct SourceKey {
+        std::string path;
+        uint64_t size;
+        int64_t modified;
+    };
+
+    uint64_t alignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    uint32_t vertexStride(VertexFormat format) {
+        return format == VertexFormat::Packed ? sizeof(PackedVertex) : sizeof(Vertex);
+    }
+
+    std::optional<SourceKey> sourceKey(const std::string& sourcePath) {
+        std::error_code error;
+        std::filesystem::path canonical = std::filesystem::canonical(sourcePath, error);
+        if (error) {
+            return std::nullopt;
+        }
+        uint64_t size = std::filesystem::file_size(canonical, error);
+        if (error) {
+            return std::nullopt;
+        }
+        auto modified = std::filesystem::last_write_time(canonical, error);
+        if (error) {
+            return std::nullopt;
+        }
+        return SourceKey{ canonical.string(), size, static_cast<int64_t>(modified.time_since_epoch().count()) };
+    }
+}
+
+std::string MeshCache::cachePath(const std::string& sourcePath) {
+    return sourcePath + ".meshcache";
+}
+
+std::optional<MeshCacheFile> MeshCache::load(const std::string& sourcePath, VertexFormat vertexFormat,
+                                             uint32_t processingKey) {
+    auto key = sourceKey(sourcePath);
+    if (!key) {
+        return std::nullopt;
+    }
+
+    std::error_code error;
+    if (!std::filesystem::exists(cachePath(sourcePath), error)) {
+        return std::nullopt;
+    }
+
+    try {
+        FileUtils::MappedFile file(cachePath(sourcePath));
+        if (file.size() < sizeof(CacheHeader)) {
+            return std::nullopt;
+        }
+
+        CacheHeader header;
+        memcpy(&header, file.data(), sizeof(header));
+        if (memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+            header.version != VERSION ||
+            header.vertexFormat != static_cast<uint32_t>(vertexFormat) ||
+            header.processingKey != processingKey ||
+            header.vertexStride != vertexStride(vertexFormat) ||
+            (header.indexSize != 2 && header.indexSize != 4) ||
+            header.sourceSize != key->size ||
+            header.sourceModified != key->modified) {
+            return std::nullopt;
+        }
+
+        // Every range must lie inside the file before anything points into it
+        const uint64_t fileSize = file.size();
+        if (header.pathLength > fileSize - sizeof(CacheHeader) ||
+            header.vertexBytes != uint64_t{ header.vertexCount } * header.vertexStride ||
+            header.indexBytes != uint64_t{ header.indexCount } * header.indexSize ||
+            header.vertexOffset > fileSize || header.vertexBytes > fileSize - header.vertexOffset ||
+            header.indexOffset > fileSize || header.indexBytes > fileSize - header.indexOffset) {
+            return std::nullopt;
+        }
+
+        std::string_view cachedPath(file.data() + sizeof(CacheHeader), header.pathLength);
+        if (cachedPath != key->path) {
+            return std::nullopt;
+        }
+
+        const auto* base = reinterpret_cast<const std::byte*>(file.data());
+        MeshBlobView blobs{
+            .vertexFormat = vertexFormat,
+            .indexSize = header.indexSize,
+            .quantization = header.quantization,
+            .vertexCount = header.vertexCount,
+            .indexCount = header.indexCount,
+            .vertexData = { base + header.vertexOffset, header.vertexBytes },
+            .indexData = { base + header.indexOffset, header.indexBytes }
+        };
+        // Spans point into the mapping, which moves along without remapping
+        return MeshCacheFile(std::move(file), blobs);
+    } catch (const std::runtime_error&) {
+        return std::nullopt;
+    }
+}
+
+bool MeshCache::store(const std::string& sourcePath, const MeshBlobView& blobs, uint32_t processingKey) {
+    auto key = sourceKey(sourcePath);
+    if (!key) {
+        return false;
+    }
+
+    CacheHeader header{};
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.vertexFormat = static_cast<uint32_t>(blobs.vertexFormat);
+    header.vertexStride = vertexStride(blobs.vertexFormat);
+    header.indexSize = blobs.indexSize;
+    header.vertexCount = blobs.vertexCount;
+    header.indexCount = blobs.indexCount;
+    header.processingKey = processingKey;
+    header.sourceSize = key->size;
+    header.sourceModified = key->modified;
+    header.quantization = blobs.quantization;
+    header.pathLength = key->path.size();
+    header.vertexOffset = alignUp(sizeof(CacheHeader) + header.pathLength, BLOB_ALIGNMENT);
+    header.vertexBytes = blobs.vertexData.size();
+    header.indexOffset = alignUp(header.vertexOffset + header.vertexBytes, BLOB_ALIGNMENT);
+    header.indexBytes = blobs.indexData.size();
+
+    const std::string finalPath = cachePath(sourcePath);
+    const std::string tempPath = finalPath + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+
+        const char padding[BLOB_ALIGNMENT] = {};
+        auto padTo = [&](uint64_t offset) {
+            uint64_t position = static_cast<uint64_t>(out.tellp());
+            out.write(padding, static_cast<std::streamsize>(offset - position));
+        };
+
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(key->path.data(), static_cast<std::streamsize>(key->path.size()));
+        padTo(header.vertexOffset);
+        out.write(reinterpret_cast<const char*>(blobs.vertexData.data()), static_cast<std::streamsize>(header.vertexBytes));
+        padTo(header.indexOffset);
+        out.write(reinterpret_cast<const char*>(blobs.indexData.data()), static_cast<std::streamsize>(header.indexBytes));
+        if (!out) {
+            out.close();
+            std::error_code removeError;
+            std::filesystem::remove(tempPath, removeError);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, finalPath, error);
+    if (error) {
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
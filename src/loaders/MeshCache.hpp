@@ -0,0 +1,83 @@
+#pragma once
+
+#include "src/utils/Vertex.hpp"
+#include "src/utils/FileUtils.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+
+/**
+ * @brief GPU-ready mesh data, exactly as it is uploaded
+ *
+ * Vertex data is already in its final layout (Vertex or quantized PackedVertex) and
+ * indices are already narrowed to their final width.
+ */
+struct MeshBlobView {
+    VertexFormat vertexFormat = VertexFormat::Standard;
+    uint32_t indexSize = 4;              // Bytes per index: 2 or 4
+    MeshPushConstants quantization{};    // Only meaningful for VertexFormat::Packed
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+    std::span<const std::byte> vertexData;
+    std::span<const std::byte> indexData;
+};
+
+/**
+ * @brief Memory-mapped cache file; the blob view points into the mapping
+ */
+class MeshCacheFile {
+public:
+    MeshCacheFile(FileUtils::MappedFile file, const MeshBlobView& blobs)
+        : file(std::move(file)), blobs(blobs) {}
+
+    const MeshBlobView& getBlobs() const { return blobs; }
+
+private:
+    FileUtils::MappedFile file;
+    MeshBlobView blobs;
+};
+
+/**
+ * @brief Versioned binary cache of processed meshes, stored next to the source file
+ *
+ * A cache file is a fixed header followed by the raw vertex and index blobs. It is
+ * keyed on the source's canonical path, size and modification time plus the vertex
+ * format and a caller-defined processing key (e.g. which optimization passes ran);
+ * any mismatch, a different format VERSION or a truncated file counts as a miss.
+ * Hits are memory-mapped and need no parsing at all.
+ */
+class MeshCache {
+public:
+    // Bump whenever the header, a vertex layout or mesh processing changes
+    static constexpr uint32_t VERSION = 3;
+
+    /**
+     * @brief Cache file path for a source model
+     */
+    static std::string cachePath(const std::string& sourcePath);
+
+    /**
+     * @brief Map the cache of a source model if it is present and current
+     * @param sourcePath Path of the source model
+     * @param vertexFormat Vertex layout the caller wants
+     * @param processingKey Must match the key the cache was stored with
+     * @return Mapped cache on a hit, std::nullopt on a miss
+     */
+    static std::optional<MeshCacheFile> load(const std::string& sourcePath, VertexFormat vertexFormat,
+                                             uint32_t processingKey = 0);
+
+    /**
+     * @brief Write (replace) the cache of a source model
+     *
+     * Written to a temporary file and renamed, so readers never see a partial cache.
+     * @param processingKey Identifies the processing applied to the blobs
+     * @return false if the cache couldn't be written; the cache is an optimization only
+     */
+    static bool store(const std::string& sourcePath, const MeshBlobView& blobs, uint32_t processingKey = 0);
+
+private:
+    MeshCache() = delete;  // Static utility class, no instances
+};
@@ -1,8 +1,87 @@
 #include "OBJLoader.hpp"
 #include <tiny_obj_loader.h>
-#include <unordered_map>
+#include <algorithm>
+#include <bit>
 #include <stdexcept>
 
+namespace {
+    /**
+     * Open-addressing map from tinyobj index triples to output vertex indices.
+     * Linear probing over a power-of-two table kept at most half full; never erases.
+     */
+    class IndexTripleMap {
+    public:
+        explicit IndexTripleMap(size_t expectedKeys)
+            : mask(std::bit_ceil(std::max<size_t>(expectedKeys * 2, 16)) - 1),
+              slots(mask + 1) {
+        }
+
+        /**
+         * Find the value stored for the triple, or insert newValue.
+         * Returns the stored value and whether it was inserted.
+         */
+        std::pair<uint32_t, bool> findOrInsert(const tinyobj::index_t& key, uint32_t newValue) {
+            for (size_t i = hash(key) & mask;; i = (i + 1) & mask) {
+                Slot& slot = slots[i];
+                if (slot.value == EMPTY) {
+                    slot = { key.vertex_index, key.texcoord_index, key.normal_index, newValue };
+                    if (++count * 2 > slots.size()) {
+                        grow();
+                    }
+                    return { newValue, true };
+                }
+                if (slot.vertex == key.vertex_index &&
+                    slot.texcoord == key.texcoord_index &&
+                    slot.normal == key.normal_index) {
+                    return { slot.value, false };
+                }
+            }
+        }
+
+    private:
+        static constexpr uint32_t EMPTY = UINT32_MAX;
+
+        struct Slot {
+            int32_t vertex = 0;
+            int32_t texcoord = 0;
+            int32_t normal = 0;
+            uint32_t value = EMPTY;
+        };
+
+        size_t mask;
+        std::vector<Slot> slots;
+        size_t count = 0;
+
+        static size_t hash(int32_t vertex, int32_t texcoord, int32_t normal) {
+            // Multiply-xorshift mix; sequential grid indices spread across the table
+            uint64_t h = static_cast<uint32_t>(vertex) * 0x9E3779B97F4A7C15ull;
+            h ^= (static_cast<uint32_t>(texcoord) + 0x632BE59BD9B4E019ull) * 0xC2B2AE3D27D4EB4Full;
+            h ^= (static_cast<uint32_t>(normal) + 0x165667B19E3779F9ull) * 0x94D049BB133111EBull;
+            h ^= h >> 31;
+            return static_cast<size_t>(h);
+        }
+
+        static size_t hash(const tinyobj::index_t& key) {
+            return hash(key.vertex_index, key.texcoord_index, key.normal_index);
+        }
+
+        void grow() {
+            std::vector<Slot> old = std::move(slots);
+            mask = old.size() * 2 - 1;
+            slots.assign(mask + 1, Slot{});
+            for (const Slot& slot : old) {
+                if (slot.value != EMPTY) {
+                    size_t i = hash(slot.vertex, slot.texcoord, slot.normal) & mask;
+                    while (slots[i].value != EMPTY) {
+                        i = (i + 1) & mask;
+                    }
+                    slots[i] = slot;
+                }
+            }
+        }
+    };
+}
+
 void OBJLoader::load(const std::string& filename,
                      std::vector<Vertex>& vertices,
                      std::vector<uint32_t>& indices) {
@@ -16,16 +95,36 @@ void OBJLoader::load(const std::string& filename,
         throw std::runtime_error("Failed to load OBJ file: " + filename + "\n" + warn + err);
     }
 
+    buildVertices(attrib, shapes, vertices, indices);
+}
+
+void OBJLoader::buildVertices(const tinyobj::attrib_t& attrib,
+                              const std::vector<tinyobj::shape_t>& shapes,
+                              std::vector<Vertex>& vertices,
+                              std::vector<uint32_t>& indices) {
     // Clear output vectors
     vertices.clear();
     indices.clear();
 
-    // Map for vertex deduplication
-    std::unordered_map<Vertex, uint32_t> uniqueVertices;
+    size_t cornerCount = 0;
+    for (const auto& shape : shapes) {
+        cornerCount += shape.mesh.indices.size();
+    }
+    indices.reserve(cornerCount);
+
+    // Closed meshes share each vertex between ~4-6 corners; size for a quarter and grow past it
+    IndexTripleMap uniqueVertices(cornerCount / 4);
+    const bool hasColors = attrib.colors.size() == attrib.vertices.size();
 
     // Process all shapes
     for (const auto& shape : shapes) {
         for (const auto& index : shape.mesh.indices) {
+            auto [vertexIndex, inserted] = uniqueVertices.findOrInsert(index, static_cast<uint32_t>(vertices.size()));
+            indices.push_back(vertexIndex);
+            if (!inserted) {
+                continue;
+            }
+
             Vertex vertex{};
 
             // Position
@@ -45,16 +144,18 @@ void OBJLoader::load(const std::string& filename,
                 vertex.texCoord = {0.0f, 0.0f};
             }
 
-            // Default color (white)
-            vertex.color = {1.0f, 1.0f, 1.0f};
-
-            // Vertex deduplication
-            if (!uniqueVertices.contains(vertex)) {
-                uniqueVertices[vertex] = static_cast<uint32_t>(vertices.size());
-                vertices.push_back(vertex);
+            // Per-vertex color ("v x y z r g b"); tinyobj fills white when absent
+            if (hasColors) {
+                vertex.color = {
+                    attrib.colors[3 * index.vertex_index + 0],
+                    attrib.colors[3 * index.vertex_index + 1],
+                    attrib.colors[3 * index.vertex_index + 2]
+                };
+            } else {
+                vertex.color = {1.0f, 1.0f, 1.0f};
             }
 
-            indices.push_back(uniqueVertices[vertex]);
+            vertices.push_back(vertex);
         }
     }
 }
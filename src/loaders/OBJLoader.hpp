@@ -4,6 +4,11 @@
 #include <vector>
 #include <string>
 
+namespace tinyobj {
+    struct attrib_t;
+    struct shape_t;
+}
+
 /**
  * @brief OBJ file loader utility
  *
@@ -23,6 +28,21 @@ public:
                     std::vector<Vertex>& vertices,
                     std::vector<uint32_t>& indices);
 
+    /**
+     * @brief Build deduplicated vertices from parsed OBJ data
+     *
+     * Corners are deduplicated on their (vertex, texcoord, normal) index triple with a
+     * single probe into an open-addressing table, instead of hashing whole vertices.
+     * @param attrib Parsed attribute arrays
+     * @param shapes Parsed shapes
+     * @param vertices Output vertex data
+     * @param indices Output index data
+     */
+    static void buildVertices(const tinyobj::attrib_t& attrib,
+                              const std::vector<tinyobj::shape_t>& shapes,
+                              std::vector<Vertex>& vertices,
+                              std::vector<uint32_t>& indices);
+
 private:
     OBJLoader() = delete;  // Static utility class, no instances
 };
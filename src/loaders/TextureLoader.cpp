@@ -0,0 +1,343 @@
+#include "TextureLoader.hpp"
+#include "src/utils/FileUtils.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <iostream>
+#include <numeric>
+#include <optional>
+#include <stdexcept>
+
+namespace {
+    constexpr uint8_t KTX2_IDENTIFIER[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+
+    struct KTX2Header {
+        uint8_t identifier[12];
+        uint32_t vkFormat;
+        uint32_t typeSize;
+        uint32_t pixelWidth;
+        uint32_t pixelHeight;
+        uint32_t pixelDepth;
+        uint32_t layerCount;
+        uint32_t faceCount;
+        uint32_t levelCount;
+        uint32_t supercompressionScheme;
+        uint32_t dfdByteOffset;
+        uint32_t dfdByteLength;
+        uint32_t kvdByteOffset;
+        uint32_t kvdByteLength;
+        uint64_t sgdByteOffset;
+        uint64_t sgdByteLength;
+    };
+    static_assert(sizeof(KTX2Header) == 80, "KTX2 header must match the file layout");
+
+    struct KTX2Level {
+        uint64_t byteOffset;
+        uint64_t byteLength;
+        uint64_t uncompressedByteLength;
+    };
+
+    struct BlockInfo {
+        uint32_t width;
+        uint32_t height;
+        uint32_t bytes;
+    };
+
+    std::optional<BlockInfo> blockInfo(vk::Format format) {
+        switch (format) {
+            case vk::Format::eR8G8B8A8Unorm:
+            case vk::Format::eR8G8B8A8Srgb:
+                return BlockInfo{ 1, 1, 4 };
+            case vk::Format::eBc7UnormBlock:
+            case vk::Format::eBc7SrgbBlock:
+            case vk::Format::eEtc2R8G8B8A8UnormBlock:
+            case vk::Format::eEtc2R8G8B8A8SrgbBlock:
+                return BlockInfo{ 4, 4, 16 };
+            case vk::Format::eEtc2R8G8B8UnormBlock:
+            case vk::Format::eEtc2R8G8B8SrgbBlock:
+            case vk::Format::eEtc2R8G8B8A1UnormBlock:
+            case vk::Format::eEtc2R8G8B8A1SrgbBlock:
+                return BlockInfo{ 4, 4, 8 };
+            case vk::Format::eAstc4x4UnormBlock:   case vk::Format::eAstc4x4SrgbBlock:   return BlockInfo{ 4, 4, 16 };
+            case vk::Format::eAstc5x4UnormBlock:   case vk::Format::eAstc5x4SrgbBlock:   return BlockInfo{ 5, 4, 16 };
+            case vk::Format::eAstc5x5UnormBlock:   case vk::Format::eAstc5x5SrgbBlock:   return BlockInfo{ 5, 5, 16 };
+            case vk::Format::eAstc6x5UnormBlock:   case vk::Format::eAstc6x5SrgbBlock:   return BlockInfo{ 6, 5, 16 };
+            case vk::Format::eAstc6x6UnormBlock:   case vk::Format::eAstc6x6SrgbBlock:   return BlockInfo{ 6, 6, 16 };
+            case vk::Format::eAstc8x5UnormBlock:   case vk::Format::eAstc8x5SrgbBlock:   return BlockInfo{ 8, 5, 16 };
+            case vk::Format::eAstc8x6UnormBlock:   case vk::Format::eAstc8x6SrgbBlock:   return BlockInfo{ 8, 6, 16 };
+            case vk::Format::eAstc8x8UnormBlock:   case vk::Format::eAstc8x8SrgbBlock:   return BlockInfo{ 8, 8, 16 };
+            case vk::Format::eAstc10x5UnormBlock:  case vk::Format::eAstc10x5SrgbBlock:  return BlockInfo{ 10, 5, 16 };
+            case vk::Format::eAstc10x6UnormBlock:  case vk::Format::eAstc10x6SrgbBlock:  return BlockInfo{ 10, 6, 16 };
+            case vk::Format::eAstc10x8UnormBlock:  case vk::Format::eAstc10x8SrgbBlock:  return BlockInfo{ 10, 8, 16 };
+            case vk::Format::eAstc10x10UnormBlock: case vk::Format::eAstc10x10SrgbBlock: return BlockInfo{ 10, 10, 16 };
+            case vk::Format::eAstc12x10UnormBlock: case vk::Format::eAstc12x10SrgbBlock: return BlockInfo{ 12, 10, 16 };
+            case vk::Format::eAstc12x12UnormBlock: case vk::Format::eAstc12x12SrgbBlock: return BlockInfo{ 12, 12, 16 };
+            default:
+                return std::nullopt;
+        }
+    }
+
+    [[noreturn]] void ktx2Error(const std::string& filename, const char* what) {
+        throw std::runtime_error("Failed to load KTX2 file: " + filename + ": " + what);
+    }
+}
+
+TextureLoader::TextureLoader(VulkanDevice& device, UploadManager& uploadManager, JobSystem& jobs)
+    : device(device), uploadManager(uploadManager), jobs(jobs) {
+}
+
+TextureLoader::~TextureLoader() {
+    // Queued decodes return at once; the wait covers the ones already decoding
+    stopping = true;
+    jobs.wait(decodeJobs);
+}
+
+std::shared_ptr<const Texture> TextureLoader::acquire(const std::string& path) {
+    std::error_code error;
+    std::filesystem::path canonical = std::filesystem::weakly_canonical(path, error);
+    std::string key = error ? path : canonical.string();
+
+    if (auto it = entries.find(key); it != entries.end()) {
+        if (auto existing = it->second.lock()) {
+            return existing;
+        }
+    }
+
+    // Textures every owner released stay as expired entries; drop them as new ones come in
+    std::erase_if(entries, [](const auto& entry) { return entry.second.expired(); });
+    auto texture = std::make_shared<Texture>();
+    entries[key] = texture;
+    jobs.submit([this, texture, path] { decodeJob(texture, path); }, &decodeJobs);
+    return texture;
+}
+
+void TextureLoader::update() {
+    std::vector<Decoded> finished;
+    {
+        std::lock_guard lock(mutex);
+        finished.swap(decoded);
+    }
+    if (finished.empty()) {
+        return;
+    }
+
+    for (Decoded& result : finished) {
+        stage(result);
+    }
+    UploadTicket ticket = uploadManager.flush();
+    for (Decoded& result : finished) {
+        if (result.texture->image) {
+            result.texture->uploadTicket = ticket;
+        }
+    }
+}
+
+bool TextureLoader::isReady(const Texture& texture) {
+    return texture.image && uploadManager.isComplete(texture.uploadTicket);
+}
+
+void TextureLoader::decodeJob(std::shared_ptr<Texture> texture, const std::string& path) {
+    if (stopping) {
+        return;
+    }
+
+    Decoded result{ .texture = std::move(texture), .path = path };
+    auto startTime = std::chrono::steady_clock::now();
+    try {
+        result.data = decode(result.path);
+    } catch (const std::exception& e) {
+        result.error = e.what();
+    }
+    result.decodeSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+
+    std::lock_guard lock(mutex);
+    decoded.push_back(std::move(result));
+}
+
+TextureData TextureLoader::decode(const std::string& path) const {
+    std::filesystem::path filePath(path);
+    if (filePath.extension() == ".ktx2") {
+        TextureData texture = loadKTX2(path);
+        if (!isSampleable(texture.format)) {
+            throw std::runtime_error("device can't sample " + vk::to_string(texture.format) + " textures: " + path);
+        }
+        return texture;
+    }
+
+    // Prefer a precompressed sibling (texture.ktx2 next to texture.png) the device can sample
+    std::filesystem::path compressed = std::filesystem::path(filePath).replace_extension(".ktx2");
+    std::error_code error;
+    if (std::filesystem::exists(compressed, error)) {
+        try {
+            TextureData texture = loadKTX2(compressed.string());
+            if (isSampleable(texture.format)) {
+                return texture;
+            }
+            std::cout << "Texture: device can't sample " << vk::to_string(texture.format) << ", using " << path << std::endl;
+        } catch (const std::exception& e) {
+            std::cerr << "Warning: " << e.what() << ", using " << path << std::endl;
+        }
+    }
+    return loadImage(path);
+}
+
+bool TextureLoader::isSampleable(vk::Format format) const {
+    return device.supportsFormat(format, vk::ImageTiling::eOptimal,
+        vk::FormatFeatureFlagBits::eSampledImage | vk::FormatFeatureFlagBits::eSampledImageFilterLinear);
+}
+
+void TextureLoader::stage(Decoded& result) {
+    Texture& texture = *result.texture;
+    if (!result.error.empty()) {
+        std::cerr << "Failed to load texture " << result.path << ": " << result.error << std::endl;
+        texture.failed = true;
+        return;
+    }
+    if (result.texture.use_count() == 1) {
+        return;  // Released while decoding; nobody wants the image anymore
+    }
+
+    const TextureData& data = result.data;
+
+    // Precomputed chains upload as-is; a single level gets a full chain blitted on the GPU
+    uint32_t mipLevels = data.getLevelCount();
+    vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled;
+    bool generateMips = mipLevels == 1 && device.supportsFormat(data.format, vk::ImageTiling::eOptimal,
+        vk::FormatFeatureFlagBits::eBlitSrc | vk::FormatFeatureFlagBits::eBlitDst |
+        vk::FormatFeatureFlagBits::eSampledImageFilterLinear);
+    if (generateMips) {
+        mipLevels = VulkanImage::fullMipChain(data.width, data.height);
+        usage |= vk::ImageUsageFlagBits::eTransferSrc;
+    }
+
+    texture.image = std::make_unique<VulkanImage>(device,
+        data.width, data.height,
+        data.format,
+        vk::ImageTiling::eOptimal,
+        usage,
+        vk::MemoryPropertyFlagBits::eDeviceLocal,
+        vk::ImageAspectFlagBits::eColor,
+        mipLevels);
+    texture.image->createSampler();
+
+    // Straight from the decoder's output into staging memory
+    uploadManager.uploadImage(*texture.image, data.pixels.data(), data.pixels.size(), data.levelOffsets);
+    // The batch holds the texture, so a user that releases it before the upload completes
+    // (like a texture replaced while loading) doesn't destroy the image under the copies
+    uploadManager.keepAlive(result.texture);
+
+    vk::DeviceSize gpuBytes = 0, rgbaBytes = 0;
+    for (uint32_t level = 0; level < mipLevels; level++) {
+        uint32_t levelWidth = std::max(data.width >> level, 1u);
+        uint32_t levelHeight = std::max(data.height >> level, 1u);
+        gpuBytes += levelSize(data.format, levelWidth, levelHeight);
+        rgbaBytes += levelSize(vk::Format::eR8G8B8A8Srgb, levelWidth, levelHeight);
+    }
+    std::cout << "Texture: " << result.path << " " << data.width << "x" << data.height << " "
+              << vk::to_string(data.format) << ", " << mipLevels << " mip levels ("
+              << (generateMips ? "generated" : "precomputed") << "), " << gpuBytes / 1024 << " KB ("
+              << rgbaBytes / 1024 << " KB as RGBA8), decoded in "
+              << static_cast<int>(result.decodeSeconds * 1000.0) << " ms" << std::endl;
+}
+
+TextureData TextureLoader::loadImage(const std::string& filename) {
+    int texWidth, texHeight, texChannels;
+    stbi_uc* decoded = stbi_load(filename.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+    if (!decoded) {
+        throw std::runtime_error("failed to load texture image: " + filename);
+    }
+
+    TextureData texture;
+    texture.format = vk::Format::eR8G8B8A8Srgb;
+    texture.width = static_cast<uint32_t>(texWidth);
+    texture.height = static_cast<uint32_t>(texHeight);
+    texture.pixels = { decoded, static_cast<size_t>(texWidth) * texHeight * 4 };
+    texture.levelOffsets = { 0 };
+    texture.storage = std::shared_ptr<const void>(decoded, [](const void* pixels) {
+        stbi_image_free(const_cast<void*>(pixels));
+    });
+    return texture;
+}
+
+TextureData TextureLoader::loadKTX2(const std::string& filename) {
+    auto file = std::make_shared<FileUtils::MappedFile>(filename);
+    auto bytes = std::span(reinterpret_cast<const unsigned char*>(file->data()), file->size());
+
+    KTX2Header header;
+    if (bytes.size() < sizeof(header)) {
+        ktx2Error(filename, "truncated header");
+    }
+    memcpy(&header, bytes.data(), sizeof(header));
+
+    if (memcmp(header.identifier, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0) {
+        ktx2Error(filename, "not a KTX2 file");
+    }
+    if (header.supercompressionScheme != 0) {
+        ktx2Error(filename, "supercompressed textures are not supported");
+    }
+    if (header.pixelWidth == 0 || header.pixelHeight == 0 || header.pixelDepth > 1 ||
+        header.layerCount > 1 || header.faceCount != 1) {
+        ktx2Error(filename, "only single 2D images are supported");
+    }
+
+    auto format = static_cast<vk::Format>(header.vkFormat);
+    if (!isSupportedFormat(format)) {
+        ktx2Error(filename, ("unsupported format " + vk::to_string(format)).c_str());
+    }
+
+    // levelCount 0 asks the loader to generate mips; only the base level is stored then
+    uint32_t storedLevels = std::max(header.levelCount, 1u);
+    size_t levelIndexEnd = sizeof(header) + sizeof(KTX2Level) * storedLevels;
+    if (storedLevels > 32 || bytes.size() < levelIndexEnd) {
+        ktx2Error(filename, "truncated level index");
+    }
+
+    std::vector<KTX2Level> levels(storedLevels);
+    memcpy(levels.data(), bytes.data() + sizeof(header), sizeof(KTX2Level) * storedLevels);
+
+    // Levels are stored smallest first, each aligned to lcm(block size, 4); view the span covering all
+    const uint64_t alignment = std::lcm<uint64_t>(blockInfo(format)->bytes, 4);
+    uint64_t first = UINT64_MAX, last = 0;
+    for (uint32_t level = 0; level < storedLevels; level++) {
+        uint32_t levelWidth = std::max(header.pixelWidth >> level, 1u);
+        uint32_t levelHeight = std::max(header.pixelHeight >> level, 1u);
+        const KTX2Level& entry = levels[level];
+        if (entry.byteLength != levelSize(format, levelWidth, levelHeight) ||
+            entry.byteOffset % alignment != 0 ||
+            entry.byteOffset > bytes.size() || entry.byteLength > bytes.size() - entry.byteOffset) {
+            ktx2Error(filename, "level data out of range or of unexpected size");
+        }
+        first = std::min(first, entry.byteOffset);
+        last = std::max(last, entry.byteOffset + entry.byteLength);
+    }
+
+    TextureData texture;
+    texture.format = format;
+    texture.width = header.pixelWidth;
+    texture.height = header.pixelHeight;
+    texture.pixels = bytes.subspan(static_cast<size_t>(first), static_cast<size_t>(last - first));
+    for (const KTX2Level& entry : levels) {
+        texture.levelOffsets.push_back(entry.byteOffset - first);
+    }
+    texture.storage = std::move(file);
+    return texture;
+}
+
+bool TextureLoader::isSupportedFormat(vk::Format format) {
+    return blockInfo(format).has_value();
+}
+
+vk::DeviceSize TextureLoader::levelSize(vk::Format format, uint32_t width, uint32_t height) {
+    auto block = blockInfo(format);
+    if (!block) {
+        throw std::invalid_argument("levelSize: unsupported format " + vk::to_string(format));
+    }
+    vk::DeviceSize blocksX = (width + block->width - 1) / block->width;
+    vk::DeviceSize blocksY = (height + block->height - 1) / block->height;
+    return blocksX * blocksY * block->bytes;
+}
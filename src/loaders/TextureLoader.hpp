@@ -0,0 +1,144 @@
+#pragma once
+
+#include "src/utils/VulkanCommon.hpp"
+#include "src/core/VulkanDevice.hpp"
+#include "src/resources/VulkanImage.hpp"
+#include "src/rendering/UploadManager.hpp"
+#include "src/core/JobSystem.hpp"
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * @brief CPU-side texture ready for upload
+ *
+ * Views one or more mip levels of a single 2D image in place, in the decoder's
+ * output or the mapped file, so the only copy on the way to the GPU is the one
+ * into staging memory. Level i starts at levelOffsets[i] and is (width >> i) x
+ * (height >> i), at least 1x1; offsets are multiples of the texel block size.
+ */
+struct TextureData {
+    vk::Format format = vk::Format::eUndefined;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    std::span<const unsigned char> pixels;
+    std::vector<vk::DeviceSize> levelOffsets;  // One entry per stored level, level 0 first
+    std::shared_ptr<const void> storage;       // Keeps pixels alive
+
+    uint32_t getLevelCount() const { return static_cast<uint32_t>(levelOffsets.size()); }
+};
+
+/**
+ * @brief GPU texture shared by everyone who acquired the same path
+ */
+struct Texture {
+    std::unique_ptr<VulkanImage> image;  // Null until decoded and its upload recorded
+    UploadTicket uploadTicket = 0;
+    bool failed = false;                 // Decoding failed; the error was logged
+};
+
+/**
+ * @brief Asynchronous texture loader with a shared texture cache
+ *
+ * acquire() returns immediately; files are decoded as JobSystem jobs and
+ * update() turns finished decodes into images and batches their uploads, so the
+ * main thread never blocks on image decoding. Textures are cached by canonical
+ * path and held weakly, released when the last user goes away.
+ *
+ * Common image formats are decoded with stb_image into RGBA8 sRGB. KTX2 containers
+ * holding precomputed mip chains in BC7, ASTC (LDR) or ETC2 formats (or plain RGBA8)
+ * are read in place; supercompressed (Basis/Zstd) payloads are rejected since they'd
+ * need a transcoder. For a non-KTX2 path, a .ktx2 file next to it is preferred when
+ * the device can sample its format.
+ */
+class TextureLoader {
+public:
+    /**
+     * @brief Create an empty loader
+     * @param device Vulkan device reference
+     * @param uploadManager Upload manager for staging operations
+     * @param jobs Pool the decodes run on (outlives this)
+     */
+    TextureLoader(VulkanDevice& device, UploadManager& uploadManager, JobSystem& jobs);
+
+    /**
+     * @brief Abandons decodes that haven't started and waits for the running ones
+     */
+    ~TextureLoader();
+
+    // Disable copy and move (jobs reference the loader)
+    TextureLoader(const TextureLoader&) = delete;
+    TextureLoader& operator=(const TextureLoader&) = delete;
+    TextureLoader(TextureLoader&&) = delete;
+    TextureLoader& operator=(TextureLoader&&) = delete;
+
+    /**
+     * @brief Get the texture of a file, queueing its decode on first use
+     */
+    std::shared_ptr<const Texture> acquire(const std::string& path);
+
+    /**
+     * @brief Create images for finished decodes and submit their uploads (call once per frame)
+     */
+    void update();
+
+    /**
+     * @brief Whether the texture's image exists and finished uploading
+     */
+    bool isReady(const Texture& texture);
+
+    /**
+     * @brief Decode an image with stb_image into a single RGBA8 sRGB level
+     * @throws std::runtime_error if the file can't be decoded
+     */
+    static TextureData loadImage(const std::string& filename);
+
+    /**
+     * @brief Read every mip level stored in a KTX2 file
+     * @throws std::runtime_error if the file is malformed, supercompressed, not a
+     *         single 2D image, or uses a format outside isSupportedFormat()
+     */
+    static TextureData loadKTX2(const std::string& filename);
+
+    /**
+     * @brief Whether loadKTX2 accepts this format (independent of device support)
+     */
+    static bool isSupportedFormat(vk::Format format);
+
+    /**
+     * @brief Byte size of one width x height level of a supported format
+     */
+    static vk::DeviceSize levelSize(vk::Format format, uint32_t width, uint32_t height);
+
+private:
+    struct Decoded {
+        std::shared_ptr<Texture> texture;
+        std::string path;
+        TextureData data;
+        std::string error;      // Set instead of data if decoding threw
+        double decodeSeconds = 0.0;
+    };
+
+    VulkanDevice& device;
+    UploadManager& uploadManager;
+    JobSystem& jobs;
+
+    std::map<std::string, std::weak_ptr<const Texture>> entries;
+
+    // Shared with the decode jobs
+    std::mutex mutex;
+    std::vector<Decoded> decoded;
+    std::atomic<bool> stopping{ false };
+    JobGroup decodeJobs;
+
+    void decodeJob(std::shared_ptr<Texture> texture, const std::string& path);
+    TextureData decode(const std::string& path) const;
+    bool isSampleable(vk::Format format) const;
+    void stage(Decoded& result);
+};
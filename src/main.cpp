@@ -4,9 +4,9 @@
 #include <stdexcept>
 #include <cstdlib>
 
-int main() {
+int main(int argc, char* argv[]) {
     try {
-        Application app;
+        Application app(argc, argv);
         app.run();
     }
     catch (const std::exception& e) {
@@ -0,0 +1,275 @@
+#include "BindlessDescriptors.hpp"
+#include "../utils/Vertex.hpp"
+#include <algorithm>
+#include <array>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    // Below this a bindless array isn't worth having; every desktop and mobile driver exceeds it
+    constexpr uint32_t MIN_TEXTURES = 64;
+    // Large enough for any one element the shaders declare on those bindings
+    constexpr vk::DeviceSize PLACEHOLDER_BUFFER_SIZE = 256;
+}
+
+BindlessDescriptors::BindlessDescriptors(VulkanDevice& device, uint32_t frameCount)
+    : device(device), bindless(device.getCapabilities().descriptorIndexing) {
+    if (!bindless) {
+        textureCapacity = MAX_MATERIAL_SETS;
+        createLayouts();
+        createSets(frameCount);
+        return;
+    }
+
+    auto properties = device.getPhysicalDevice().getProperties2<
+        vk::PhysicalDeviceProperties2,
+        vk::PhysicalDeviceDescriptorIndexingProperties>();
+    const auto& limits = properties.get<vk::PhysicalDeviceDescriptorIndexingProperties>();
+    textureCapacity = std::min({
+        MAX_TEXTURES,
+        limits.maxPerStageDescriptorUpdateAfterBindSamplers,
+        limits.maxPerStageDescriptorUpdateAfterBindSampledImages,
+        limits.maxDescriptorSetUpdateAfterBindSamplers,
+        limits.maxDescriptorSetUpdateAfterBindSampledImages
+    });
+    if (textureCapacity < MIN_TEXTURES) {
+        throw std::runtime_error("device supports only " + std::to_string(textureCapacity) +
+                                 " update-after-bind textures per stage");
+    }
+
+    createLayouts();
+    createSets(frameCount);
+}
+
+void BindlessDescriptors::createLayouts() {
+    std::array frameBindings = {
+        vk::DescriptorSetLayoutBinding(
+            0,
+            vk::DescriptorType::eUniformBufferDynamic,
+            1,
+            vk::ShaderStageFlagBits::eVertex,
+            nullptr),
+        // ObjectData array, indexed by the per-draw push constant
+        vk::DescriptorSetLayoutBinding(
+            1,
+            vk::DescriptorType::eStorageBufferDynamic,
+            1,
+            vk::ShaderStageFlagBits::eVertex,
+            nullptr),
+        // Heightmap heights and the attributes TerrainCompute derived, read by vertHeightmapMain
+        vk::DescriptorSetLayoutBinding(
+            2,
+            vk::DescriptorType::eStorageBuffer,
+            1,
+            vk::ShaderStageFlagBits::eVertex,
+            nullptr),
+        vk::DescriptorSetLayoutBinding(
+            3,
+            vk::DescriptorType::eStorageBuffer,
+            1,
+            vk::ShaderStageFlagBits::eVertex,
+            nullptr),
+        // MeshScene instances, read by vertSceneMain
+        vk::DescriptorSetLayoutBinding(
+            4,
+            vk::DescriptorType::eStorageBuffer,
+            1,
+            vk::ShaderStageFlagBits::eVertex,
+            nullptr),
+        // Neighbor steps of the GPU-culled tiles, read by vertHeightmapTileMain
+        vk::DescriptorSetLayoutBinding(
+            5,
+            vk::DescriptorType::eStorageBuffer,
+            1,
+            vk::ShaderStageFlagBits::eVertex,
+            nullptr)
+    };
+    frameSetLayout = vk::raii::DescriptorSetLayout(device.getDevice(), vk::DescriptorSetLayoutCreateInfo{
+        .bindingCount = static_cast<uint32_t>(frameBindings.size()),
+        .pBindings = frameBindings.data()
+    });
+
+    // Slots past the ones written are never sampled, and writing a free slot
+    // must not disturb frames still reading the others
+    vk::DescriptorBindingFlags textureFlags =
+        vk::DescriptorBindingFlagBits::ePartiallyBound |
+        vk::DescriptorBindingFlagBits::eUpdateAfterBind |
+        vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending;
+    vk::DescriptorSetLayoutBindingFlagsCreateInfo textureFlagsInfo{
+        .bindingCount = 1,
+        .pBindingFlags = &textureFlags
+    };
+    vk::DescriptorSetLayoutBinding textureBinding(
+        0,
+        vk::DescriptorType::eCombinedImageSampler,
+        bindless ? textureCapacity : 1,
+        vk::ShaderStageFlagBits::eFragment,
+        nullptr);
+    vk::DescriptorSetLayoutCreateInfo textureLayoutInfo{
+        .bindingCount = 1,
+        .pBindings = &textureBinding
+    };
+    if (bindless) {
+        textureLayoutInfo.pNext = &textureFlagsInfo;
+        textureLayoutInfo.flags = vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool;
+    }
+    textureSetLayout = vk::raii::DescriptorSetLayout(device.getDevice(), textureLayoutInfo);
+
+    // One range large enough for every vertex path's constants plus the object index
+    vk::PushConstantRange pushConstantRange{
+        .stageFlags = vk::ShaderStageFlagBits::eVertex,
+        .offset = 0,
+        .size = OBJECT_INDEX_OFFSET + sizeof(uint32_t)
+    };
+    std::array setLayouts = { *frameSetLayout, *textureSetLayout };
+    pipelineLayout = vk::raii::PipelineLayout(device.getDevice(), vk::PipelineLayoutCreateInfo{
+        .setLayoutCount = static_cast<uint32_t>(setLayouts.size()),
+        .pSetLayouts = setLayouts.data(),
+        .pushConstantRangeCount = 1,
+        .pPushConstantRanges = &pushConstantRange
+    });
+}
+
+void BindlessDescriptors::createSets(uint32_t frameCount) {
+    placeholderBuffer = std::make_unique<VulkanBuffer>(device, PLACEHOLDER_BUFFER_SIZE,
+        vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    std::array framePoolSizes {
+        vk::DescriptorPoolSize(vk::DescriptorType::eUniformBufferDynamic, frameCount),
+        vk::DescriptorPoolSize(vk::DescriptorType::eStorageBufferDynamic, frameCount),
+        vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, 4 * frameCount)
+    };
+    framePool = vk::raii::DescriptorPool(device.getDevice(), vk::DescriptorPoolCreateInfo{
+        .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+        .maxSets = frameCount,
+        .poolSizeCount = static_cast<uint32_t>(framePoolSizes.size()),
+        .pPoolSizes = framePoolSizes.data()
+    });
+
+    // The array, or a single-texture set per slot, allocated as slots are first used
+    vk::DescriptorPoolSize texturePoolSize(vk::DescriptorType::eCombinedImageSampler, textureCapacity);
+    texturePool = vk::raii::DescriptorPool(device.getDevice(), vk::DescriptorPoolCreateInfo{
+        .flags = bindless
+            ? vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet | vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind
+            : vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+        .maxSets = bindless ? 1 : textureCapacity,
+        .poolSizeCount = 1,
+        .pPoolSizes = &texturePoolSize
+    });
+
+    std::vector<vk::DescriptorSetLayout> frameLayouts(frameCount, *frameSetLayout);
+    frameSets = device.getDevice().allocateDescriptorSets(vk::DescriptorSetAllocateInfo{
+        .descriptorPool = framePool,
+        .descriptorSetCount = frameCount,
+        .pSetLayouts = frameLayouts.data()
+    });
+
+    if (!bindless) {
+        return;
+    }
+    auto textureSets = device.getDevice().allocateDescriptorSets(vk::DescriptorSetAllocateInfo{
+        .descriptorPool = texturePool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &*textureSetLayout
+    });
+    textureSet = std::move(textureSets.front());
+}
+
+void BindlessDescriptors::writeFrameSet(uint32_t frame, const FrameBuffers& buffers) {
+    std::array<vk::DescriptorBufferInfo, 6> bufferInfos{
+        vk::DescriptorBufferInfo{ .buffer = buffers.ring, .offset = 0, .range = sizeof(UniformBufferObject) },
+        vk::DescriptorBufferInfo{ .buffer = buffers.ring, .offset = 0, .range = MAX_OBJECTS * sizeof(ObjectData) },
+        vk::DescriptorBufferInfo{ .buffer = buffers.heights, .offset = 0, .range = vk::WholeSize },
+        vk::DescriptorBufferInfo{ .buffer = buffers.terrainAttributes, .offset = 0, .range = vk::WholeSize },
+        vk::DescriptorBufferInfo{ .buffer = buffers.sceneInstances, .offset = 0, .range = vk::WholeSize },
+        vk::DescriptorBufferInfo{ .buffer = buffers.tileNeighbors, .offset = 0, .range = vk::WholeSize }
+    };
+    std::array<vk::DescriptorType, 6> types = {
+        vk::DescriptorType::eUniformBufferDynamic,
+        vk::DescriptorType::eStorageBufferDynamic,
+        vk::DescriptorType::eStorageBuffer,
+        vk::DescriptorType::eStorageBuffer,
+        vk::DescriptorType::eStorageBuffer,
+        vk::DescriptorType::eStorageBuffer
+    };
+
+    // Unused bindings are only read by pipelines that aren't drawn without their buffers. They
+    // still get the placeholder: a skipped write would keep the descriptor of a destroyed buffer
+    std::vector<vk::WriteDescriptorSet> writes;
+    for (uint32_t binding = 0; binding < bufferInfos.size(); binding++) {
+        if (!bufferInfos[binding].buffer) {
+            bufferInfos[binding].buffer = placeholderBuffer->getHandle();
+        }
+        writes.push_back(vk::WriteDescriptorSet{
+            .dstSet = frameSets[frame],
+            .dstBinding = binding,
+            .dstArrayElement = 0,
+            .descriptorCount = 1,
+            .descriptorType = types[binding],
+            .pBufferInfo = &bufferInfos[binding]
+        });
+    }
+    device.getDevice().updateDescriptorSets(writes, {});
+}
+
+uint32_t BindlessDescriptors::addTexture(std::shared_ptr<const Texture> texture) {
+    uint32_t slot;
+    if (!freeSlots.empty()) {
+        slot = freeSlots.back();
+        freeSlots.pop_back();
+    } else if (slots.size() < textureCapacity) {
+        slot = static_cast<uint32_t>(slots.size());
+        slots.emplace_back();
+        if (!bindless) {
+            auto sets = device.getDevice().allocateDescriptorSets(vk::DescriptorSetAllocateInfo{
+                .descriptorPool = texturePool,
+                .descriptorSetCount = 1,
+                .pSetLayouts = &*textureSetLayout
+            });
+            materialSets.push_back(std::move(sets.front()));
+        }
+    } else {
+        throw std::runtime_error(std::string(bindless ? "bindless texture array" : "material descriptor pool") +
+                                 " is full (" + std::to_string(textureCapacity) + " slots)");
+    }
+
+    // A reused slot's own set is idle: the frames that could bind it have retired
+    vk::DescriptorImageInfo imageInfo{
+        .sampler = texture->image->getSampler(),
+        .imageView = texture->image->getImageView(),
+        .imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal
+    };
+    device.getDevice().updateDescriptorSets(vk::WriteDescriptorSet{
+        .dstSet = bindless ? *textureSet : *materialSets[slot],
+        .dstBinding = 0,
+        .dstArrayElement = bindless ? slot : 0,
+        .descriptorCount = 1,
+        .descriptorType = vk::DescriptorType::eCombinedImageSampler,
+        .pImageInfo = &imageInfo
+    }, {});
+
+    slots[slot] = std::move(texture);
+    return slot;
+}
+
+void BindlessDescriptors::releaseTexture(uint32_t slot, uint64_t frameSerial) {
+    pendingReleases.push_back({ slot, frameSerial });
+}
+
+void BindlessDescriptors::retireFrames(uint64_t frameSerial) {
+    while (!pendingReleases.empty() && pendingReleases.front().frameSerial <= frameSerial) {
+        uint32_t slot = pendingReleases.front().slot;
+        pendingReleases.pop_front();
+        slots[slot].reset();
+        freeSlots.push_back(slot);
+    }
+}
+
+void BindlessDescriptors::bind(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame,
+                               std::span<const uint32_t, 2> dynamicOffsets, uint32_t textureSlot) const {
+    std::array sets = { *frameSets[frame], bindless ? *textureSet : *materialSets[textureSlot] };
+    commandBuffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eGraphics,
+        *pipelineLayout,
+        FRAME_SET, sets, vk::ArrayProxy<const uint32_t>(static_cast<uint32_t>(dynamicOffsets.size()), dynamicOffsets.data()));
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include "../utils/VulkanCommon.hpp"
+#include "../core/VulkanDevice.hpp"
+#include "../loaders/TextureLoader.hpp"
+#include "../resources/VulkanBuffer.hpp"
+#include <deque>
+#include <memory>
+#include <span>
+#include <vector>
+
+/**
+ * @brief Descriptor-indexing layout shared by every pipeline
+ *
+ * Set 0 holds per-frame data: the uniforms and the ObjectData array, both bound
+ * at dynamic offsets into the staging ring, plus the heightmap buffers, the
+ * MeshScene instance buffer and the frame's GPU-culled tile neighbors. Set 1 is
+ * a single partially bound, update-after-bind array holding every live texture.
+ *
+ * Draws select their ObjectData through the push constant at OBJECT_INDEX_OFFSET
+ * and the object names its texture slot, so both sets are bound once per frame
+ * and no descriptor is touched between draws. New textures are written into free
+ * slots while earlier frames are still in flight; a released slot is reused only
+ * after the last frame that could sample it has retired.
+ *
+ * Without descriptor indexing (DeviceCapabilities::descriptorIndexing) set 1 holds
+ * a single texture instead and every slot gets a set of its own, bound with the
+ * material that samples it; pipelines then use the shader build without the
+ * runtime array (getShaderPath()). A slot's set is written only while no frame in
+ * flight can use it, so the sets need no update-after-bind either.
+ */
+class BindlessDescriptors {
+public:
+    /**
+     * @brief Buffers behind the per-frame set's bindings; null ones stay unwritten
+     */
+    struct FrameBuffers {
+        vk::Buffer ring;                      // Uniforms and objects are carved from it
+        vk::Buffer heights = nullptr;         // Heightmap heights and terrain attributes, both or neither
+        vk::Buffer terrainAttributes = nullptr;
+        vk::Buffer sceneInstances = nullptr;  // MeshScene instance buffer
+        vk::Buffer tileNeighbors = nullptr;   // TerrainCulling's for this frame
+    };
+
+    static constexpr uint32_t FRAME_SET = 0;
+    static constexpr uint32_t TEXTURE_SET = 1;
+    static constexpr uint32_t MAX_TEXTURES = 4096;      // Clamped to the device's update-after-bind limits
+    static constexpr uint32_t MAX_MATERIAL_SETS = 256;  // Texture slots without descriptor indexing
+    static constexpr uint32_t MAX_OBJECTS = 256;        // ObjectData entries visible per frame
+
+    /**
+     * @brief Create the set layouts, the shared pipeline layout and all sets
+     * @param device Vulkan device reference; the texture array needs its descriptor indexing features
+     * @param frameCount Number of per-frame sets (frames in flight)
+     * @throws std::runtime_error if the device can't hold even a small texture array
+     */
+    BindlessDescriptors(VulkanDevice& device, uint32_t frameCount);
+
+    ~BindlessDescriptors() = default;
+
+    // Disable copy and move (pipelines reference the layout)
+    BindlessDescriptors(const BindlessDescriptors&) = delete;
+    BindlessDescriptors& operator=(const BindlessDescriptors&) = delete;
+    BindlessDescriptors(BindlessDescriptors&&) = delete;
+    BindlessDescriptors& operator=(BindlessDescriptors&&) = delete;
+
+    // Accessors
+    vk::PipelineLayout getPipelineLayout() const { return *pipelineLayout; }
+    bool isBindless() const { return bindless; }
+    const char* getShaderPath() const { return bindless ? "shaders/slang.spv" : "shaders/slang_single_texture.spv"; }
+    uint32_t getTextureCapacity() const { return textureCapacity; }
+    uint32_t getTextureCount() const { return static_cast<uint32_t>(slots.size() - freeSlots.size()); }  // Includes pending releases
+
+    /**
+     * @brief Point a frame's set at the ring and the scene's buffers
+     * @param frame Frame-in-flight slot; its previous frame must have retired
+     *
+     * Null buffers are bound to a small placeholder, so no binding keeps a descriptor
+     * of a buffer destroyed since.
+     */
+    void writeFrameSet(uint32_t frame, const FrameBuffers& buffers);
+
+    /**
+     * @brief Write a texture into a free array slot, keeping it alive until released
+     * @return Slot index for ObjectData::textureIndex
+     * @throws std::runtime_error if every slot is taken
+     */
+    uint32_t addTexture(std::shared_ptr<const Texture> texture);
+
+    /**
+     * @brief Free a slot once every frame up to frameSerial has retired
+     */
+    void releaseTexture(uint32_t slot, uint64_t frameSerial);
+
+    /**
+     * @brief All frames up to and including frameSerial have retired
+     */
+    void retireFrames(uint64_t frameSerial);
+
+    /**
+     * @brief Bind both sets for the frame
+     * @param dynamicOffsets Ring offsets of the frame's uniforms and objects, in that order
+     * @param textureSlot Slot the draws sample; only selects the set without descriptor indexing
+     */
+    void bind(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame,
+              std::span<const uint32_t, 2> dynamicOffsets, uint32_t textureSlot) const;
+
+private:
+    struct PendingRelease {
+        uint32_t slot;
+        uint64_t frameSerial;
+    };
+
+    VulkanDevice& device;
+    bool bindless;
+    uint32_t textureCapacity = 0;
+
+    vk::raii::DescriptorSetLayout frameSetLayout = nullptr;
+    vk::raii::DescriptorSetLayout textureSetLayout = nullptr;
+    vk::raii::PipelineLayout pipelineLayout = nullptr;
+
+    vk::raii::DescriptorPool framePool = nullptr;
+    vk::raii::DescriptorPool texturePool = nullptr;  // Update-after-bind pools can't hold dynamic buffers
+    std::vector<vk::raii::DescriptorSet> frameSets;
+    vk::raii::DescriptorSet textureSet = nullptr;       // The bindless array
+    std::vector<vk::raii::DescriptorSet> materialSets;  // One per slot without descriptor indexing
+    std::unique_ptr<VulkanBuffer> placeholderBuffer;    // Bound in place of absent storage buffers, never read
+
+    std::vector<std::shared_ptr<const Texture>> slots;  // Grows up to textureCapacity
+    std::vector<uint32_t> freeSlots;                      // Released and retired, ready for reuse
+    std::deque<PendingRelease> pendingReleases;           // In release order, so serials ascend
+
+    void createLayouts();
+    void createSets(uint32_t frameCount);
+};
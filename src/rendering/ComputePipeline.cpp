@@ -0,0 +1,52 @@
+#include "ComputePipeline.hpp"
+#include "../utils/FileUtils.hpp"
+
+ComputePipeline::ComputePipeline(
+    VulkanDevice& device,
+    const std::string& shaderPath,
+    const std::string& entryPoint,
+    std::span<const vk::DescriptorSetLayout> setLayouts,
+    uint32_t pushConstantSize,
+    vk::PipelineCache pipelineCache)
+    : device(device) {
+
+    vk::PushConstantRange pushConstantRange{
+        .stageFlags = vk::ShaderStageFlagBits::eCompute,
+        .offset = 0,
+        .size = pushConstantSize
+    };
+    pipelineLayout = vk::raii::PipelineLayout(device.getDevice(), vk::PipelineLayoutCreateInfo{
+        .setLayoutCount = static_cast<uint32_t>(setLayouts.size()),
+        .pSetLayouts = setLayouts.data(),
+        .pushConstantRangeCount = pushConstantSize > 0 ? 1u : 0u,
+        .pPushConstantRanges = &pushConstantRange
+    });
+
+    const FileUtils::MappedFile shaderFile(shaderPath);
+    const std::span<const char> code = shaderFile.span();
+    vk::raii::ShaderModule shaderModule(device.getDevice(), vk::ShaderModuleCreateInfo{
+        .codeSize = code.size(),
+        .pCode = reinterpret_cast<const uint32_t*>(code.data())
+    });
+
+    vk::ComputePipelineCreateInfo pipelineInfo{
+        .stage = {
+            .stage = vk::ShaderStageFlagBits::eCompute,
+            .module = shaderModule,
+            .pName = entryPoint.c_str()
+        },
+        .layout = *pipelineLayout
+    };
+    pipeline = vk::raii::Pipeline(device.getDevice(), pipelineCache, pipelineInfo);
+}
+
+void ComputePipeline::bind(const vk::raii::CommandBuffer& commandBuffer) const {
+    commandBuffer.bindPipeline(vk::PipelineBindPoint::eCompute, *pipeline);
+}
+
+void ComputePipeline::bindSets(const vk::raii::CommandBuffer& commandBuffer,
+                               std::span<const vk::DescriptorSet> sets) const {
+    commandBuffer.bindDescriptorSets(
+        vk::PipelineBindPoint::eCompute, *pipelineLayout, 0,
+        vk::ArrayProxy<const vk::DescriptorSet>(static_cast<uint32_t>(sets.size()), sets.data()), {});
+}
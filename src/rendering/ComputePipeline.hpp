@@ -0,0 +1,67 @@
+#pragma once
+
+#include "../utils/VulkanCommon.hpp"
+#include "../core/VulkanDevice.hpp"
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Compute pipeline with its own pipeline layout
+ *
+ * Unlike graphics pipelines, which all share BindlessDescriptors' layout, each
+ * compute pass declares the sets it reads and writes, plus one push constant
+ * range visible to the compute stage.
+ */
+class ComputePipeline {
+public:
+    /**
+     * @brief Build the layout and the pipeline
+     * @param device Vulkan device reference
+     * @param shaderPath Path to compiled shader SPIR-V file
+     * @param entryPoint Compute entry point in the module
+     * @param setLayouts Descriptor set layouts, in set order
+     * @param pushConstantSize Bytes of push constants (0 for none)
+     * @param pipelineCache Cache to compile through (optional)
+     */
+    ComputePipeline(
+        VulkanDevice& device,
+        const std::string& shaderPath,
+        const std::string& entryPoint,
+        std::span<const vk::DescriptorSetLayout> setLayouts,
+        uint32_t pushConstantSize = 0,
+        vk::PipelineCache pipelineCache = nullptr);
+
+    ~ComputePipeline() = default;
+
+    // Disable copy, enable move construction only
+    ComputePipeline(const ComputePipeline&) = delete;
+    ComputePipeline& operator=(const ComputePipeline&) = delete;
+    ComputePipeline(ComputePipeline&&) = default;
+    ComputePipeline& operator=(ComputePipeline&&) = delete;
+
+    // Accessors
+    vk::Pipeline getPipeline() const { return *pipeline; }
+    vk::PipelineLayout getPipelineLayout() const { return *pipelineLayout; }
+
+    // Bind pipeline to command buffer
+    void bind(const vk::raii::CommandBuffer& commandBuffer) const;
+
+    /**
+     * @brief Bind descriptor sets starting at set 0
+     */
+    void bindSets(const vk::raii::CommandBuffer& commandBuffer, std::span<const vk::DescriptorSet> sets) const;
+
+    /**
+     * @brief Push the whole constant range
+     */
+    template<typename T>
+    void push(const vk::raii::CommandBuffer& commandBuffer, const T& constants) const {
+        commandBuffer.pushConstants<T>(*pipelineLayout, vk::ShaderStageFlagBits::eCompute, 0, constants);
+    }
+
+private:
+    VulkanDevice& device;
+    vk::raii::PipelineLayout pipelineLayout = nullptr;
+    vk::raii::Pipeline pipeline = nullptr;
+};
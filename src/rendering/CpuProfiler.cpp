@@ -0,0 +1,191 @@
+#include "CpuProfiler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <stdexcept>
+#include <thread>
+
+namespace {
+    constexpr uint32_t RING_MASK = CpuProfiler::RING_SIZE - 1;
+    static_assert((CpuProfiler::RING_SIZE & RING_MASK) == 0, "RING_SIZE must be a power of two");
+
+    std::atomic<uint64_t> nextProfilerId{ 1 };
+
+    // The ring this thread last recorded into, and which profiler owns it
+    struct CachedRing {
+        uint64_t owner = 0;
+        void* ring = nullptr;
+    };
+    thread_local CachedRing cachedRing;
+}
+
+const char* getFramePhaseName(FramePhase phase) {
+    switch (phase) {
+        case FramePhase::FenceWait: return "fence wait";
+        case FramePhase::Acquire: return "acquire";
+        case FramePhase::Update: return "update";
+        case FramePhase::Record: return "record";
+        case FramePhase::Submit: return "submit";
+        case FramePhase::Present: return "present";
+        default: return "unknown";
+    }
+}
+
+void LatencyHistogram::add(uint64_t durationNs) {
+    const uint64_t bucket = std::min<uint64_t>(durationNs / (BUCKET_US * 1000ull), BUCKET_COUNT - 1);
+    buckets[bucket]++;
+    count++;
+    totalNs += durationNs;
+    maxNs = std::max(maxNs, durationNs);
+}
+
+double LatencyHistogram::percentileMs(double fraction) const {
+    if (count == 0) {
+        return 0.0;
+    }
+
+    // Nearest rank, as GpuProfiler reports it
+    const uint64_t rank = std::clamp<uint64_t>(
+        static_cast<uint64_t>(std::ceil(fraction * static_cast<double>(count))), 1, count);
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < BUCKET_COUNT; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(static_cast<double>((i + 1) * BUCKET_US) / 1e3, getMaxMs());
+        }
+    }
+    return getMaxMs();
+}
+
+CpuProfiler::CpuProfiler()
+    : id(nextProfilerId.fetch_add(1, std::memory_order_relaxed)),
+      lastFrameEnd(std::chrono::steady_clock::now()) {}
+
+CpuProfiler::~CpuProfiler() = default;
+
+CpuProfiler::ThreadRing& CpuProfiler::threadRing() {
+    if (cachedRing.owner != id) {
+        // The thread last recorded into another profiler; it may already have a ring here
+        const std::thread::id thread = std::this_thread::get_id();
+        std::lock_guard lock(registryMutex);
+        auto it = std::find_if(rings.begin(), rings.end(), [&](const auto& ring) { return ring->thread == thread; });
+        if (it == rings.end()) {
+            rings.push_back(std::make_unique<ThreadRing>());
+            rings.back()->thread = thread;
+            it = rings.end() - 1;
+        }
+        cachedRing = { id, it->get() };
+    }
+    return *static_cast<ThreadRing*>(cachedRing.ring);
+}
+
+void CpuProfiler::record(FramePhase phase, std::chrono::steady_clock::time_point start,
+                         std::chrono::steady_clock::time_point end) {
+    ThreadRing& ring = threadRing();
+    const uint64_t head = ring.head.load(std::memory_order_relaxed);
+    if (head - ring.tail.load(std::memory_order_acquire) >= RING_SIZE) {
+        ring.dropped.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    ring.samples[head & RING_MASK] = {
+        .phase = phase,
+        .durationNs = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count())
+    };
+    ring.head.store(head + 1, std::memory_order_release);
+}
+
+void CpuProfiler::endFrame() {
+    const auto now = std::chrono::steady_clock::now();
+    const uint64_t frameNs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(now - lastFrameEnd).count());
+    lastFrameEnd = now;
+
+    // A phase can run several times a frame (waits before and inside drawFrame,
+    // scopes on worker threads); the frame's row and histograms use the total
+    std::array<uint64_t, PHASE_COUNT> phaseNs{};
+    std::array<bool, PHASE_COUNT> phaseSeen{};
+    {
+        std::lock_guard lock(registryMutex);
+        for (const auto& ring : rings) {
+            const uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+            const uint64_t head = ring->head.load(std::memory_order_acquire);
+            for (uint64_t i = tail; i < head; i++) {
+                const Sample& sample = ring->samples[i & RING_MASK];
+                const size_t phase = static_cast<size_t>(sample.phase);
+                phaseNs[phase] += sample.durationNs;
+                phaseSeen[phase] = true;
+            }
+            ring->tail.store(head, std::memory_order_release);
+            droppedSamples += ring->dropped.exchange(0, std::memory_order_relaxed);
+        }
+    }
+
+    // The first call only marks where frame timing starts
+    if (frameCount++ > 0) {
+        frameHistogram.add(frameNs);
+    }
+    for (size_t phase = 0; phase < PHASE_COUNT; phase++) {
+        if (phaseSeen[phase]) {
+            phaseHistograms[phase].add(phaseNs[phase]);
+        }
+    }
+
+    if (stream.is_open()) {
+        stream << frameCount << ',' << static_cast<double>(frameNs) / 1e6;
+        for (uint64_t ns : phaseNs) {
+            stream << ',' << static_cast<double>(ns) / 1e6;
+        }
+        stream << '\n';
+    }
+}
+
+void CpuProfiler::reset() {
+    endFrame();  // Drains the rings so their samples aren't counted later
+    phaseHistograms = {};
+    frameHistogram = {};
+    frameCount = 0;
+    droppedSamples = 0;
+}
+
+void CpuProfiler::streamTo(const std::string& path) {
+    stream = std::ofstream(path, std::ios::trunc);
+    if (!stream) {
+        throw std::runtime_error("failed to open CPU profile file: " + path);
+    }
+
+    stream << std::fixed << std::setprecision(4) << "frame,frame_ms";
+    for (size_t phase = 0; phase < PHASE_COUNT; phase++) {
+        std::string column = getFramePhaseName(static_cast<FramePhase>(phase));
+        std::ranges::replace(column, ' ', '_');
+        stream << ',' << column << "_ms";
+    }
+    stream << '\n';
+}
+
+void CpuProfiler::writeReport(std::ostream& out) const {
+    const auto row = [&out](const char* name, const LatencyHistogram& histogram) {
+        out << "  " << std::left << std::setw(12) << name << std::right
+            << " p50 " << std::setw(8) << histogram.percentileMs(0.50)
+            << " p95 " << std::setw(8) << histogram.percentileMs(0.95)
+            << " p99 " << std::setw(8) << histogram.percentileMs(0.99)
+            << " mean " << std::setw(8) << histogram.getMeanMs()
+            << " max " << std::setw(8) << histogram.getMaxMs() << " ms\n";
+    };
+
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::fixed << std::setprecision(3);
+    out << "CPU frame timing over " << frameHistogram.getCount() << " frames:\n";
+    row("frame", frameHistogram);
+    for (size_t phase = 0; phase < PHASE_COUNT; phase++) {
+        if (phaseHistograms[phase].getCount() > 0) {
+            row(getFramePhaseName(static_cast<FramePhase>(phase)), phaseHistograms[phase]);
+        }
+    }
+    if (droppedSamples > 0) {
+        out << "  (" << droppedSamples << " samples dropped)\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
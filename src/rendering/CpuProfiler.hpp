@@ -0,0 +1,171 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief CPU phases of Renderer::drawFrame
+ */
+enum class FramePhase : uint8_t {
+    FenceWait,  // Waiting for the frame slot (and, in low-latency mode, the GPU queue)
+    Acquire,
+    Update,     // Uniforms and per-object data
+    Record,
+    Submit,
+    Present,
+    Count
+};
+
+const char* getFramePhaseName(FramePhase phase);
+
+/**
+ * @brief Fixed-bucket latency histogram with percentile queries
+ *
+ * 10 us buckets up to 100 ms; longer samples land in the last bucket.
+ */
+class LatencyHistogram {
+public:
+    static constexpr uint32_t BUCKET_US = 10;
+    static constexpr uint32_t BUCKET_COUNT = 10000;
+
+    LatencyHistogram() : buckets(BUCKET_COUNT, 0) {}
+
+    void add(uint64_t durationNs);
+
+    uint64_t getCount() const { return count; }
+    double getMeanMs() const { return count ? static_cast<double>(totalNs) / static_cast<double>(count) / 1e6 : 0.0; }
+    double getMaxMs() const { return static_cast<double>(maxNs) / 1e6; }
+
+    /**
+     * @brief Upper edge of the bucket holding the given fraction of samples, in ms
+     */
+    double percentileMs(double fraction) const;
+
+private:
+    std::vector<uint32_t> buckets;
+    uint64_t count = 0;
+    uint64_t totalNs = 0;
+    uint64_t maxNs = 0;
+};
+
+/**
+ * @brief Low-overhead CPU scope timing for frame phases
+ *
+ * CpuScope writes one sample into the calling thread's own ring: a single-producer,
+ * single-consumer buffer whose head the thread publishes with a release store, so
+ * recording never takes a lock. A thread's ring is registered on its first sample
+ * and looked up again if the thread recorded into another profiler in between.
+ * endFrame(), called on the render thread once per frame, drains every ring into
+ * per-phase histograms and a frame-time histogram, and can stream one CSV row per
+ * frame. A ring that fills up between drains drops samples; rings live as long as
+ * the profiler, which suits the renderer's long-lived worker threads.
+ */
+class CpuProfiler {
+public:
+    static constexpr uint32_t RING_SIZE = 1024;  // Samples per thread between drains (power of two)
+
+    CpuProfiler();
+    ~CpuProfiler();
+
+    // Disable copy and move (threads cache their ring's address)
+    CpuProfiler(const CpuProfiler&) = delete;
+    CpuProfiler& operator=(const CpuProfiler&) = delete;
+    CpuProfiler(CpuProfiler&&) = delete;
+    CpuProfiler& operator=(CpuProfiler&&) = delete;
+
+    /**
+     * @brief Record a phase sample from any thread
+     */
+    void record(FramePhase phase, std::chrono::steady_clock::time_point start,
+                std::chrono::steady_clock::time_point end);
+
+    /**
+     * @brief Close the frame: drain the rings, update the histograms, stream its row
+     */
+    void endFrame();
+
+    /**
+     * @brief Discard the samples so far, e.g. after warm-up; the next endFrame starts timing again
+     */
+    void reset();
+
+    /**
+     * @brief Append one CSV row per frame (frame time and per-phase totals, in ms) to a file
+     * @throws std::runtime_error if the file can't be opened
+     */
+    void streamTo(const std::string& path);
+
+    /**
+     * @brief Print p50/p95/p99, mean and max of the frame time and of every phase
+     */
+    void writeReport(std::ostream& out) const;
+
+    const LatencyHistogram& getFrameHistogram() const { return frameHistogram; }
+    const LatencyHistogram& getPhaseHistogram(FramePhase phase) const { return phaseHistograms[static_cast<size_t>(phase)]; }
+    uint64_t getDroppedSamples() const { return droppedSamples; }
+
+private:
+    struct Sample {
+        FramePhase phase;
+        uint64_t durationNs;
+    };
+
+    struct ThreadRing {
+        std::array<Sample, RING_SIZE> samples;
+        std::atomic<uint64_t> head{ 0 };  // Written by the owning thread
+        std::atomic<uint64_t> tail{ 0 };  // Written by endFrame
+        std::atomic<uint64_t> dropped{ 0 };
+        std::thread::id thread;           // Owning thread, found again after it recorded elsewhere
+    };
+
+    static constexpr size_t PHASE_COUNT = static_cast<size_t>(FramePhase::Count);
+
+    const uint64_t id;  // Tells a thread's cached ring apart from another profiler's
+
+    std::mutex registryMutex;  // Taken only when a thread switches to this profiler
+    std::vector<std::unique_ptr<ThreadRing>> rings;
+
+    std::array<LatencyHistogram, PHASE_COUNT> phaseHistograms;
+    LatencyHistogram frameHistogram;
+    std::chrono::steady_clock::time_point lastFrameEnd;
+    uint64_t frameCount = 0;
+    uint64_t droppedSamples = 0;
+    std::ofstream stream;
+
+    ThreadRing& threadRing();
+};
+
+/**
+ * @brief RAII phase scope; does nothing without a profiler
+ */
+class CpuScope {
+public:
+    CpuScope(CpuProfiler* profiler, FramePhase phase)
+        : profiler(profiler), phase(phase),
+          start(profiler ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point{}) {}
+
+    ~CpuScope() {
+        if (profiler) {
+            profiler->record(phase, start, std::chrono::steady_clock::now());
+        }
+    }
+
+    CpuScope(const CpuScope&) = delete;
+    CpuScope& operator=(const CpuScope&) = delete;
+    CpuScope(CpuScope&&) = delete;
+    CpuScope& operator=(CpuScope&&) = delete;
+
+private:
+    CpuProfiler* profiler;
+    FramePhase phase;
+    std::chrono::steady_clock::time_point start;
+};
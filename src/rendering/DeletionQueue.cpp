@@ -0,0 +1,7 @@
+#include "DeletionQueue.hpp"
+
+void DeletionQueue::retireFrames(uint64_t frameSerial) {
+    while (!entries.empty() && entries.front().frameSerial <= frameSerial) {
+        entries.pop_front();
+    }
+}
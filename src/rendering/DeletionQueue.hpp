@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <memory>
+
+/**
+ * @brief Keeps GPU objects alive until the frames that may still use them have retired
+ *
+ * Objects replaced while frames are in flight (swapchains, framebuffers, attachments,
+ * descriptor sets) are handed over with the serial of the last frame submitted before
+ * the replacement, instead of waiting for the device to idle. Entries are destroyed
+ * in order once retireFrames() reaches their serial.
+ */
+class DeletionQueue {
+public:
+    DeletionQueue() = default;
+
+    /**
+     * @brief Destroys whatever is still queued; the device must be idle
+     */
+    ~DeletionQueue() = default;
+
+    // Disable copy and move
+    DeletionQueue(const DeletionQueue&) = delete;
+    DeletionQueue& operator=(const DeletionQueue&) = delete;
+    DeletionQueue(DeletionQueue&&) = delete;
+    DeletionQueue& operator=(DeletionQueue&&) = delete;
+
+    /**
+     * @brief Take ownership of an object until frameSerial has retired
+     * @param frameSerial Last frame that may use the object; 0 destroys it at the next retireFrames
+     * @param object Any movable owner (RAII handle, unique_ptr, struct of those)
+     */
+    template <typename T>
+    void retire(uint64_t frameSerial, T object) {
+        entries.push_back({ frameSerial, std::make_unique<Holder<T>>(std::move(object)) });
+    }
+
+    /**
+     * @brief All frames up to and including frameSerial have retired
+     */
+    void retireFrames(uint64_t frameSerial);
+
+private:
+    struct Retired {
+        virtual ~Retired() = default;
+    };
+
+    template <typename T>
+    struct Holder final : Retired {
+        explicit Holder(T object) : object(std::move(object)) {}
+        T object;
+    };
+
+    struct Entry {
+        uint64_t frameSerial;
+        std::unique_ptr<Retired> object;
+    };
+
+    std::deque<Entry> entries;  // Serials never decrease
+};
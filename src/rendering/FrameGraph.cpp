@@ -0,0 +1,264 @@
+#include "FrameGraph.hpp"
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace {
+    // Layout transitions of combined depth/stencil formats must name both aspects
+    vk::ImageAspectFlags barrierAspects(vk::Format format, vk::ImageAspectFlags aspect) {
+        if (format == vk::Format::eD32SfloatS8Uint || format == vk::Format::eD24UnormS8Uint ||
+            format == vk::Format::eD16UnormS8Uint) {
+            aspect |= vk::ImageAspectFlagBits::eStencil;
+        }
+        return aspect;
+    }
+
+    bool overlaps(const RenderTargetDesc& a, const RenderTargetDesc& b) {
+        return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+    }
+}
+
+FrameGraphPass& FrameGraphPass::read(FrameGraphResource resource, const ResourceUse& use) {
+    graph.addUse(pass, { .resource = resource, .use = use });
+    return *this;
+}
+
+FrameGraphPass& FrameGraphPass::write(FrameGraphResource resource, const ResourceUse& use) {
+    graph.addUse(pass, { .resource = resource, .use = use, .write = true });
+    return *this;
+}
+
+FrameGraphPass& FrameGraphPass::renderPassWrite(FrameGraphResource resource, const ResourceUse& use,
+                                                vk::ImageLayout finalLayout) {
+    graph.addUse(pass, { .resource = resource, .use = use, .write = true, .renderPassLayout = finalLayout });
+    return *this;
+}
+
+FrameGraphPass& FrameGraphPass::sideEffects() {
+    graph.passes[pass].sideEffects = true;
+    return *this;
+}
+
+FrameGraph::FrameGraph(bool synchronization2) : synchronization2(synchronization2) {}
+
+FrameGraphResource FrameGraph::createTarget(const char* name, const RenderTargetDesc& desc) {
+    resources.push_back(Resource{
+        .name = name,
+        .kind = ResourceKind::Target,
+        .desc = desc,
+        .range = { barrierAspects(desc.format, desc.aspect), 0, 1, 0, 1 }
+    });
+    return static_cast<FrameGraphResource>(resources.size() - 1);
+}
+
+FrameGraphResource FrameGraph::importImage(const char* name, const vk::ImageSubresourceRange& range,
+                                           const ResourceUse& initial, vk::ImageLayout finalLayout, bool persistent) {
+    resources.push_back(Resource{
+        .name = name,
+        .kind = ResourceKind::Image,
+        .range = range,
+        .initial = initial,
+        .finalLayout = finalLayout,
+        .persistent = persistent
+    });
+    return static_cast<FrameGraphResource>(resources.size() - 1);
+}
+
+FrameGraphResource FrameGraph::importBuffer(const char* name, bool persistent) {
+    resources.push_back(Resource{ .name = name, .kind = ResourceKind::Buffer, .persistent = persistent });
+    return static_cast<FrameGraphResource>(resources.size() - 1);
+}
+
+void FrameGraph::bindImage(FrameGraphResource resource, vk::Image image) {
+    Resource& imported = resources.at(resource);
+    if (imported.kind != ResourceKind::Image) {
+        throw std::invalid_argument(std::string("FrameGraph: ") + imported.name + " isn't an imported image");
+    }
+    if (imported.persistent && imported.image != image) {
+        imported.state = {
+            .layout = imported.initial.layout,
+            .writeStages = imported.initial.stages,
+            .writeAccess = imported.initial.access
+        };
+    }
+    imported.image = image;
+}
+
+FrameGraphPass FrameGraph::addPass(const char* name, RecordFunction record) {
+    if (targets) {
+        throw std::runtime_error("FrameGraph: passes can't be added after compile");
+    }
+    passes.push_back(Pass{ .name = name, .record = std::move(record) });
+    return FrameGraphPass(*this, static_cast<uint32_t>(passes.size() - 1));
+}
+
+void FrameGraph::setPassEnabled(uint32_t pass, bool enabled) {
+    passes.at(pass).enabled = enabled;
+}
+
+void FrameGraph::addUse(uint32_t pass, const Use& use) {
+    if (targets) {
+        throw std::runtime_error("FrameGraph: passes can't change after compile");
+    }
+    const Resource& resource = resources.at(use.resource);
+
+    // One use per resource and pass, so the pass gets one barrier for it
+    std::vector<Use>& uses = passes[pass].uses;
+    auto existing = std::ranges::find(uses, use.resource, &Use::resource);
+    if (existing == uses.end()) {
+        uses.push_back(use);
+        return;
+    }
+    if (resource.kind != ResourceKind::Buffer &&
+        (existing->use.layout != use.use.layout || existing->renderPassLayout != use.renderPassLayout)) {
+        throw std::invalid_argument(std::string("FrameGraph: ") + passes[pass].name + " uses " + resource.name +
+                                    " in two layouts");
+    }
+    existing->use.stages |= use.use.stages;
+    existing->use.access |= use.use.access;
+    existing->write = existing->write || use.write;
+}
+
+void FrameGraph::compile(VulkanDevice& device, vk::Extent2D extent) {
+    if (targets) {
+        throw std::runtime_error("FrameGraph: already compiled");
+    }
+
+    // Walk back from the outputs: a pass lives if it has side effects or writes
+    // something a later live pass, or a later frame, uses
+    std::vector<bool> needed(resources.size());
+    for (FrameGraphResource id = 0; id < resources.size(); id++) {
+        needed[id] = resources[id].kind != ResourceKind::Target || !resources[id].desc.transient;
+    }
+    for (auto pass = passes.rbegin(); pass != passes.rend(); ++pass) {
+        pass->live = pass->sideEffects || std::ranges::any_of(pass->uses, [&](const Use& use) {
+            return use.write && needed[use.resource];
+        });
+        if (pass->live) {
+            for (const Use& use : pass->uses) {
+                needed[use.resource] = true;
+            }
+        }
+    }
+
+    // Targets span the live passes using them, numbered in recording order
+    constexpr uint32_t UNUSED = std::numeric_limits<uint32_t>::max();
+    for (Resource& resource : resources) {
+        resource.desc.firstPass = UNUSED;
+        resource.desc.lastPass = 0;
+    }
+    uint32_t order = 0;
+    for (const Pass& pass : passes) {
+        if (!pass.live) {
+            stats.culledPassCount++;
+            continue;
+        }
+        for (const Use& use : pass.uses) {
+            RenderTargetDesc& desc = resources[use.resource].desc;
+            desc.firstPass = std::min(desc.firstPass, order);
+            desc.lastPass = std::max(desc.lastPass, order);
+        }
+        order++;
+    }
+    stats.passCount = static_cast<uint32_t>(passes.size());
+
+    std::vector<RenderTargetDesc> descs;
+    for (Resource& resource : resources) {
+        if (resource.kind == ResourceKind::Target && resource.desc.firstPass != UNUSED) {
+            resource.target = static_cast<RenderTargetId>(descs.size());
+            descs.push_back(resource.desc);
+        }
+    }
+    targets = std::make_unique<RenderTargets>(device, extent, descs);
+    for (Resource& resource : resources) {
+        if (resource.target) {
+            resource.image = targets->get(*resource.target).getImage();
+        }
+    }
+}
+
+void FrameGraph::addBarrier(Resource& resource, const Use& use) {
+    BarrierAccess access{
+        .use = use.use,
+        .write = use.write,
+        .image = resource.kind != ResourceKind::Buffer,
+        .handle = resource.image,
+        .range = resource.range,
+        .renderPassLayout = use.renderPassLayout
+    };
+
+    // A transient target's contents don't survive the frame, but its memory may have been
+    // used through any target it can alias since its own last use
+    access.discard = resource.kind == ResourceKind::Target && resource.desc.transient && !resource.used;
+    if (access.discard) {
+        for (const Resource& other : resources) {
+            if (&other != &resource && other.target && other.desc.transient && !overlaps(other.desc, resource.desc)) {
+                access.aliasStages |= other.state.writeStages | other.state.readStages;
+                access.aliasAccess |= other.state.writeAccess;
+            }
+        }
+    }
+    resource.used = true;
+    barriers.add(resource.state, access);
+}
+
+void FrameGraph::flushBarriers(const vk::raii::CommandBuffer& commandBuffer) {
+    if (barriers.empty()) {
+        return;
+    }
+    stats.barrierCount++;
+    stats.imageBarrierCount += static_cast<uint32_t>(barriers.getImageBarriers().size());
+    barriers.record(commandBuffer, synchronization2);
+}
+
+void FrameGraph::execute(const vk::raii::CommandBuffer& commandBuffer, GpuProfiler* profiler, uint32_t frame) {
+    if (!targets) {
+        throw std::runtime_error("FrameGraph: execute before compile");
+    }
+    stats.barrierCount = 0;
+    stats.imageBarrierCount = 0;
+    for (Resource& resource : resources) {
+        resource.used = false;
+        if (resource.kind != ResourceKind::Target && !resource.persistent) {
+            resource.state = {
+                .layout = resource.initial.layout,
+                .writeStages = resource.initial.stages,
+                .writeAccess = resource.initial.access
+            };
+        }
+    }
+
+    for (const Pass& pass : passes) {
+        if (!pass.live || !pass.enabled) {
+            continue;
+        }
+        GpuScope scope(profiler, commandBuffer, frame, pass.name);
+        for (const Use& use : pass.uses) {
+            Resource& resource = resources[use.resource];
+            if (resource.kind == ResourceKind::Image && !resource.image) {
+                throw std::runtime_error(std::string("FrameGraph: ") + pass.name + " uses " + resource.name +
+                                         ", which isn't bound");
+            }
+            addBarrier(resource, use);
+        }
+        flushBarriers(commandBuffer);
+        pass.record(commandBuffer);
+    }
+
+    // Hand the imported images over in their final layouts, all in one barrier
+    for (Resource& resource : resources) {
+        if (resource.used) {
+            barriers.handOff(resource.state, resource.image, resource.range, resource.finalLayout);
+        }
+    }
+    flushBarriers(commandBuffer);
+}
+
+const RenderTarget& FrameGraph::getTarget(FrameGraphResource resource) const {
+    const Resource& target = resources.at(resource);
+    if (!target.target) {
+        throw std::out_of_range(std::string("FrameGraph: ") + target.name + " isn't an allocated target");
+    }
+    return targets->get(*target.target);
+}
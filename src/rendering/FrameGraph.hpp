@@ -0,0 +1,224 @@
+#pragma once
+
+#include "../utils/VulkanCommon.hpp"
+#include "../core/VulkanDevice.hpp"
+#include "RenderTargets.hpp"
+#include "FrameGraphBarriers.hpp"
+#include "GpuProfiler.hpp"
+#include <functional>
+#include <memory>
+#include <optional>
+#include <vector>
+
+/**
+ * @brief Index of an image or buffer declared to a FrameGraph
+ */
+using FrameGraphResource = uint32_t;
+
+class FrameGraph;
+
+/**
+ * @brief Declares what one pass of a FrameGraph reads and writes, returned by FrameGraph::addPass
+ *
+ * Declaring a resource twice in one pass merges the uses; an image must be used in one layout.
+ */
+class FrameGraphPass {
+public:
+    /**
+     * @brief The pass only reads the resource
+     * @throws std::invalid_argument if the pass already uses the image in another layout
+     */
+    FrameGraphPass& read(FrameGraphResource resource, const ResourceUse& use);
+
+    /**
+     * @brief The pass writes the resource (and may read it); keeps the writer alive when a later pass reads it
+     * @throws std::invalid_argument if the pass already uses the image in another layout
+     */
+    FrameGraphPass& write(FrameGraphResource resource, const ResourceUse& use);
+
+    /**
+     * @brief Attachment of a render pass that starts it from eUndefined and leaves it in finalLayout
+     *
+     * The graph still orders the pass after earlier accesses, but leaves both layout
+     * transitions to the render pass and its subpass dependencies.
+     */
+    FrameGraphPass& renderPassWrite(FrameGraphResource resource, const ResourceUse& use, vk::ImageLayout finalLayout);
+
+    /**
+     * @brief Never cull the pass, e.g. when it only writes host-visible results
+     */
+    FrameGraphPass& sideEffects();
+
+    uint32_t getIndex() const { return pass; }
+
+private:
+    friend class FrameGraph;
+
+    FrameGraphPass(FrameGraph& graph, uint32_t pass) : graph(graph), pass(pass) {}
+
+    FrameGraph& graph;
+    uint32_t pass;
+};
+
+/**
+ * @brief Barriers and culling of the last compiled or executed graph
+ */
+struct FrameGraphStats {
+    uint32_t passCount = 0;
+    uint32_t culledPassCount = 0;    // Passes no output depends on, never recorded
+    uint32_t barrierCount = 0;       // Pipeline barriers of the last execute, at most one per pass plus the final one
+    uint32_t imageBarrierCount = 0;  // Layout transitions among them; other hazards share one memory barrier
+};
+
+/**
+ * @brief A frame's passes and the resources they use, recorded with the barriers between them
+ *
+ * Passes are declared once in recording order, with the images and buffers they read
+ * and write, then compile() culls the ones no output depends on and allocates the
+ * graph's own render targets. Outputs are imported resources, non-transient targets
+ * (they outlive the frame) and passes marked with sideEffects().
+ *
+ * execute() records the enabled passes, each preceded by at most one pipeline barrier
+ * merging everything it needs: a layout transition per image that changes layout, and
+ * a single global memory barrier for every other read-after-write, write-after-read or
+ * write-after-write hazard, buffers included (which is why buffers are never bound to a
+ * handle). Reads of an already visible write need no barrier. Each resource's state
+ * carries over to the next execute, so the first pass of a frame waits on the last
+ * pass of the previous one; imported resources that aren't persistent start every
+ * frame from their initial use instead.
+ *
+ * Transient targets get their pass ranges from the live passes, so RenderTargets
+ * aliases those whose ranges are disjoint; each one is transitioned from eUndefined
+ * at its first use in the frame, after every transient target it may share memory with.
+ *
+ * Without synchronization2 (the render pass fallback) the barriers are recorded with
+ * vkCmdPipelineBarrier, so only stages and accesses it has may be declared.
+ */
+class FrameGraph {
+public:
+    using RecordFunction = std::function<void(const vk::raii::CommandBuffer&)>;
+
+    /**
+     * @param synchronization2 Record with pipelineBarrier2 (comes with dynamic rendering)
+     */
+    explicit FrameGraph(bool synchronization2);
+
+    ~FrameGraph() = default;
+
+    // Disable copy and move (passes keep a reference to the graph)
+    FrameGraph(const FrameGraph&) = delete;
+    FrameGraph& operator=(const FrameGraph&) = delete;
+    FrameGraph(FrameGraph&&) = delete;
+    FrameGraph& operator=(FrameGraph&&) = delete;
+
+    /**
+     * @brief A render target the graph allocates at compile(); the pass range in desc is filled in
+     */
+    FrameGraphResource createTarget(const char* name, const RenderTargetDesc& desc);
+
+    /**
+     * @brief An image owned elsewhere, bound with bindImage() before each execute that uses it
+     * @param range Subresources the passes use
+     * @param initial Last use before the graph, e.g. the acquire semaphore's wait stage
+     * @param finalLayout Layout left after the last pass; eUndefined leaves the last pass's one
+     * @param persistent Carry the state across executes instead of restarting from initial
+     */
+    FrameGraphResource importImage(const char* name, const vk::ImageSubresourceRange& range, const ResourceUse& initial,
+                                   vk::ImageLayout finalLayout = vk::ImageLayout::eUndefined, bool persistent = false);
+
+    /**
+     * @brief A buffer owned elsewhere; per frame slot ones restart each frame, their last use fenced
+     */
+    FrameGraphResource importBuffer(const char* name, bool persistent = false);
+
+    /**
+     * @brief Set an imported image's handle; a persistent image bound to a new handle starts over from its initial use
+     *
+     * Binding null forgets a destroyed persistent image, whose handle may be reused.
+     */
+    void bindImage(FrameGraphResource resource, vk::Image image);
+
+    /**
+     * @brief Append a pass, recorded in declaration order
+     * @param name Also the GPU profiler scope of the pass and its barrier
+     */
+    FrameGraphPass addPass(const char* name, RecordFunction record);
+
+    /**
+     * @brief Skip a pass, and its barriers, in the next executes; its targets stay allocated
+     */
+    void setPassEnabled(uint32_t pass, bool enabled);
+
+    /**
+     * @brief Cull the passes and allocate the targets at extent
+     * @throws std::runtime_error if already compiled
+     */
+    void compile(VulkanDevice& device, vk::Extent2D extent);
+
+    /**
+     * @brief Record the enabled live passes with their barriers, then the final layouts
+     * @param profiler Times each pass under its name (optional)
+     * @throws std::runtime_error if not compiled or a used imported image isn't bound
+     */
+    void execute(const vk::raii::CommandBuffer& commandBuffer, GpuProfiler* profiler = nullptr, uint32_t frame = 0);
+
+    /**
+     * @brief A target created by createTarget()
+     * @throws std::out_of_range if the resource isn't a target or all its passes were culled
+     */
+    const RenderTarget& getTarget(FrameGraphResource resource) const;
+
+    const RenderTargetStats& getTargetStats() const { return targets->getStats(); }
+    const FrameGraphStats& getStats() const { return stats; }
+
+private:
+    friend class FrameGraphPass;
+
+    enum class ResourceKind {
+        Target,
+        Image,
+        Buffer
+    };
+
+    struct Resource {
+        const char* name;
+        ResourceKind kind;
+        RenderTargetDesc desc;                 // Targets only
+        std::optional<RenderTargetId> target;  // Unset when no live pass uses it
+        vk::ImageSubresourceRange range;
+        ResourceUse initial;
+        vk::ImageLayout finalLayout = vk::ImageLayout::eUndefined;
+        bool persistent = false;
+        vk::Image image;                       // Bound or allocated handle
+        ResourceState state;
+        bool used = false;                     // Already used in the executing frame
+    };
+
+    struct Use {
+        FrameGraphResource resource;
+        ResourceUse use;
+        bool write = false;
+        std::optional<vk::ImageLayout> renderPassLayout;  // Final layout the render pass leaves
+    };
+
+    struct Pass {
+        const char* name;
+        RecordFunction record;
+        std::vector<Use> uses;
+        bool sideEffects = false;
+        bool live = false;
+        bool enabled = true;
+    };
+
+    bool synchronization2;
+    std::vector<Resource> resources;
+    std::vector<Pass> passes;
+    std::unique_ptr<RenderTargets> targets;
+    FrameGraphStats stats;
+
+    BarrierBatch barriers;  // The barrier being batched before the next pass
+
+    void addUse(uint32_t pass, const Use& use);
+    void addBarrier(Resource& resource, const Use& use);
+    void flushBarriers(const vk::raii::CommandBuffer& commandBuffer);
+};
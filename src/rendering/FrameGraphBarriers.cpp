@@ -0,0 +1,138 @@
+#include "FrameGraphBarriers.hpp"
+
+namespace {
+    // Synchronization2's flags keep the original bits in their low 32 bits
+    vk::PipelineStageFlags legacyStages(vk::PipelineStageFlags2 stages) {
+        return vk::PipelineStageFlags(static_cast<VkPipelineStageFlags>(static_cast<VkPipelineStageFlags2>(stages)));
+    }
+
+    vk::AccessFlags legacyAccess(vk::AccessFlags2 access) {
+        return vk::AccessFlags(static_cast<VkAccessFlags>(static_cast<VkAccessFlags2>(access)));
+    }
+}
+
+void BarrierBatch::add(ResourceState& state, const BarrierAccess& access) {
+    const ResourceUse& use = access.use;
+    const bool renderPass = access.renderPassLayout.has_value();
+    vk::PipelineStageFlags2 srcStages = access.discard ? access.aliasStages : vk::PipelineStageFlags2{};
+    vk::AccessFlags2 srcAccess = access.discard ? access.aliasAccess : vk::AccessFlags2{};
+
+    // Writes and layout transitions wait for every earlier access; reads only for a write not yet visible to them
+    const bool transition = access.image && !renderPass && (access.discard || use.layout != state.layout);
+    const bool writes = access.write || transition;
+    if (writes) {
+        srcStages |= state.writeStages | state.readStages;
+        srcAccess |= state.writeAccess;
+    } else if ((use.stages & ~state.visibleStages) || (use.access & ~state.visibleAccess)) {
+        srcStages |= state.writeStages;
+        srcAccess |= state.writeAccess;
+    }
+
+    if (transition) {
+        imageBarriers.push_back(vk::ImageMemoryBarrier2{
+            .srcStageMask = srcStages,
+            .srcAccessMask = srcAccess,
+            .dstStageMask = use.stages,
+            .dstAccessMask = use.access,
+            .oldLayout = access.discard ? vk::ImageLayout::eUndefined : state.layout,
+            .newLayout = use.layout,
+            .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+            .image = access.handle,
+            .subresourceRange = access.range
+        });
+    } else if (srcStages) {
+        memoryBarrier.srcStageMask |= srcStages;
+        memoryBarrier.srcAccessMask |= srcAccess;
+        memoryBarrier.dstStageMask |= use.stages;
+        memoryBarrier.dstAccessMask |= srcAccess ? use.access : vk::AccessFlags2{};
+    }
+
+    if (writes) {
+        // A write isn't visible anywhere yet; a transition for a read already is to that read
+        state.writeStages = use.stages;
+        state.writeAccess = access.write ? use.access : vk::AccessFlags2{};
+        state.readStages = access.write ? vk::PipelineStageFlags2{} : use.stages;
+        state.visibleStages = access.write ? vk::PipelineStageFlags2{} : use.stages;
+        state.visibleAccess = access.write ? vk::AccessFlags2{} : use.access;
+    } else {
+        state.readStages |= use.stages;
+        if (srcStages) {
+            state.visibleStages |= use.stages;
+            state.visibleAccess |= use.access;
+        }
+    }
+    if (access.image) {
+        state.layout = renderPass ? *access.renderPassLayout : use.layout;
+    }
+}
+
+void BarrierBatch::handOff(ResourceState& state, vk::Image image, const vk::ImageSubresourceRange& range,
+                           vk::ImageLayout finalLayout) {
+    if (finalLayout == vk::ImageLayout::eUndefined || state.layout == finalLayout) {
+        return;
+    }
+    imageBarriers.push_back(vk::ImageMemoryBarrier2{
+        .srcStageMask = state.writeStages | state.readStages,
+        .srcAccessMask = state.writeAccess,
+        .dstStageMask = vk::PipelineStageFlagBits2::eBottomOfPipe,
+        .dstAccessMask = {},
+        .oldLayout = state.layout,
+        .newLayout = finalLayout,
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = image,
+        .subresourceRange = range
+    });
+    state = { .layout = finalLayout, .writeStages = vk::PipelineStageFlagBits2::eAllCommands };
+}
+
+void BarrierBatch::record(const vk::raii::CommandBuffer& commandBuffer, bool synchronization2) {
+    const bool memory = static_cast<bool>(memoryBarrier.srcStageMask);
+    if (!memory && imageBarriers.empty()) {
+        return;
+    }
+
+    if (synchronization2) {
+        vk::DependencyInfo dependencyInfo{
+            .memoryBarrierCount = memory ? 1u : 0u,
+            .pMemoryBarriers = &memoryBarrier,
+            .imageMemoryBarrierCount = static_cast<uint32_t>(imageBarriers.size()),
+            .pImageMemoryBarriers = imageBarriers.data()
+        };
+        commandBuffer.pipelineBarrier2(dependencyInfo);
+    } else {
+        // One stage mask pair for the whole call; empty ones aren't allowed
+        vk::PipelineStageFlags srcStages = legacyStages(memoryBarrier.srcStageMask);
+        vk::PipelineStageFlags dstStages = legacyStages(memoryBarrier.dstStageMask);
+        const vk::MemoryBarrier legacyMemoryBarrier{
+            .srcAccessMask = legacyAccess(memoryBarrier.srcAccessMask),
+            .dstAccessMask = legacyAccess(memoryBarrier.dstAccessMask)
+        };
+        legacyImageBarriers.clear();
+        for (const vk::ImageMemoryBarrier2& barrier : imageBarriers) {
+            srcStages |= legacyStages(barrier.srcStageMask);
+            dstStages |= legacyStages(barrier.dstStageMask);
+            legacyImageBarriers.push_back(vk::ImageMemoryBarrier{
+                .srcAccessMask = legacyAccess(barrier.srcAccessMask),
+                .dstAccessMask = legacyAccess(barrier.dstAccessMask),
+                .oldLayout = barrier.oldLayout,
+                .newLayout = barrier.newLayout,
+                .srcQueueFamilyIndex = barrier.srcQueueFamilyIndex,
+                .dstQueueFamilyIndex = barrier.dstQueueFamilyIndex,
+                .image = barrier.image,
+                .subresourceRange = barrier.subresourceRange
+            });
+        }
+        commandBuffer.pipelineBarrier(
+            srcStages ? srcStages : vk::PipelineStageFlags(vk::PipelineStageFlagBits::eTopOfPipe),
+            dstStages ? dstStages : vk::PipelineStageFlags(vk::PipelineStageFlagBits::eBottomOfPipe),
+            {}, vk::ArrayProxy<const vk::MemoryBarrier>(memory ? 1u : 0u, &legacyMemoryBarrier), {}, legacyImageBarriers);
+    }
+    clear();
+}
+
+void BarrierBatch::clear() {
+    imageBarriers.clear();
+    memoryBarrier = vk::MemoryBarrier2{};
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include "../utils/VulkanCommon.hpp"
+#include <optional>
+#include <vector>
+
+/**
+ * @brief Stages and accesses of one use of a resource, and the layout an image needs for it
+ */
+struct ResourceUse {
+    vk::PipelineStageFlags2 stages;
+    vk::AccessFlags2 access;
+    vk::ImageLayout layout = vk::ImageLayout::eUndefined;  // Ignored for buffers
+};
+
+/**
+ * @brief What the accesses of a resource so far require of the next one
+ */
+struct ResourceState {
+    vk::ImageLayout layout = vk::ImageLayout::eUndefined;
+    vk::PipelineStageFlags2 writeStages;    // Last write, or layout transition
+    vk::AccessFlags2 writeAccess;
+    vk::PipelineStageFlags2 readStages;     // Reads since then
+    vk::PipelineStageFlags2 visibleStages;  // Where the last write is already visible
+    vk::AccessFlags2 visibleAccess;
+};
+
+/**
+ * @brief One access to synchronize with the earlier accesses of its resource
+ */
+struct BarrierAccess {
+    ResourceUse use;
+    bool write = false;
+    bool image = false;                               // Layout tracked; buffers only get memory dependencies
+    vk::Image handle;                                 // Images only
+    vk::ImageSubresourceRange range;
+    std::optional<vk::ImageLayout> renderPassLayout;  // The render pass transitions the image and leaves it in this layout
+    bool discard = false;                             // Contents are dead: transition from eUndefined
+    vk::PipelineStageFlags2 aliasStages;              // Earlier accesses of aliased memory, waited for by a discard
+    vk::AccessFlags2 aliasAccess;
+};
+
+/**
+ * @brief The barriers needed before one pass, merged into a single pipeline barrier
+ *
+ * Each image that changes layout gets an image barrier; every other read-after-write,
+ * write-after-read or write-after-write hazard widens one global memory barrier. Reads
+ * of a write that is already visible to them add nothing.
+ */
+class BarrierBatch {
+public:
+    BarrierBatch() = default;
+
+    BarrierBatch(const BarrierBatch&) = delete;
+    BarrierBatch& operator=(const BarrierBatch&) = delete;
+
+    /**
+     * @brief Add what the access needs and advance the resource's state past it
+     */
+    void add(ResourceState& state, const BarrierAccess& access);
+
+    /**
+     * @brief Transition an image to the layout its owner expects after the graph, if it isn't there yet
+     */
+    void handOff(ResourceState& state, vk::Image image, const vk::ImageSubresourceRange& range,
+                 vk::ImageLayout finalLayout);
+
+    bool empty() const { return !memoryBarrier.srcStageMask && imageBarriers.empty(); }
+
+    /**
+     * @brief Global memory dependency; no source stages when nothing needs it
+     */
+    const vk::MemoryBarrier2& getMemoryBarrier() const { return memoryBarrier; }
+    const std::vector<vk::ImageMemoryBarrier2>& getImageBarriers() const { return imageBarriers; }
+
+    /**
+     * @brief Record the batch as one pipeline barrier, then clear it
+     * @param synchronization2 Use pipelineBarrier2; otherwise vkCmdPipelineBarrier with the legacy flags
+     */
+    void record(const vk::raii::CommandBuffer& commandBuffer, bool synchronization2);
+
+    void clear();
+
+private:
+    // Kept across batches to avoid per-frame allocations
+    std::vector<vk::ImageMemoryBarrier2> imageBarriers;
+    vk::MemoryBarrier2 memoryBarrier;
+    std::vector<vk::ImageMemoryBarrier> legacyImageBarriers;
+};
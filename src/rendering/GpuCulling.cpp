@@ -0,0 +1,251 @@
+#include "GpuCulling.hpp"
+#include <algorithm>
+#include <array>
+
+GpuCulling::GpuCulling(VulkanDevice& device, const std::string& shaderPath, const MeshScene& scene,
+                       const RenderTarget& depthImage, uint32_t frameCount, vk::PipelineCache pipelineCache)
+    : device(device), scene(scene), depthImage(&depthImage), frameCount(frameCount) {
+
+    createLayouts();
+
+    std::array reduceLayouts = { *reduceSetLayout };
+    reducePipeline = std::make_unique<ComputePipeline>(device, shaderPath, "depthReduceMain",
+        reduceLayouts, static_cast<uint32_t>(sizeof(ReducePushConstants)), pipelineCache);
+    std::array cullLayouts = { *cullSetLayout };
+    cullPipeline = std::make_unique<ComputePipeline>(device, shaderPath, "cullSceneMain",
+        cullLayouts, static_cast<uint32_t>(sizeof(CullPushConstants)), pipelineCache);
+
+    // Resizing once per frame keeps up to one retired generation per frame in flight alive
+    const uint32_t generations = frameCount + 1;
+    std::array poolSizes {
+        vk::DescriptorPoolSize(vk::DescriptorType::eSampledImage, generations * (MAX_PYRAMID_LEVELS + frameCount)),
+        vk::DescriptorPoolSize(vk::DescriptorType::eStorageImage, generations * MAX_PYRAMID_LEVELS),
+        vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, generations * 4 * frameCount),
+        vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, generations * frameCount)
+    };
+    descriptorPool = vk::raii::DescriptorPool(device.getDevice(), vk::DescriptorPoolCreateInfo{
+        .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+        .maxSets = generations * (MAX_PYRAMID_LEVELS + frameCount),
+        .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+        .pPoolSizes = poolSizes.data()
+    });
+
+    for (uint32_t frame = 0; frame < frameCount; frame++) {
+        culledCommands.push_back(std::make_unique<VulkanBuffer>(device,
+            static_cast<vk::DeviceSize>(scene.getInstanceCapacity()) * sizeof(vk::DrawIndexedIndirectCommand),
+            vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eDeviceLocal));
+        drawCounts.push_back(std::make_unique<VulkanBuffer>(device, sizeof(uint32_t),
+            vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer |
+            vk::BufferUsageFlagBits::eTransferDst,
+            vk::MemoryPropertyFlagBits::eDeviceLocal));
+        views.push_back(std::make_unique<VulkanBuffer>(device, sizeof(CullViews),
+            vk::BufferUsageFlagBits::eUniformBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent));
+        views.back()->map();
+    }
+
+    // A count draw may only read up to maxDrawIndirectCount commands
+    compacts = device.getCapabilities().drawIndirectCount && scene.drawsIndirect() &&
+               scene.getInstanceCapacity() <= device.getPhysicalDevice().getProperties().limits.maxDrawIndirectCount;
+
+    createPyramid();
+}
+
+void GpuCulling::createLayouts() {
+    std::array reduceBindings = {
+        vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eSampledImage, 1, vk::ShaderStageFlagBits::eCompute, nullptr),
+        vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eStorageImage, 1, vk::ShaderStageFlagBits::eCompute, nullptr)
+    };
+    reduceSetLayout = vk::raii::DescriptorSetLayout(device.getDevice(), vk::DescriptorSetLayoutCreateInfo{
+        .bindingCount = static_cast<uint32_t>(reduceBindings.size()),
+        .pBindings = reduceBindings.data()
+    });
+
+    // Numbered after the reduction's bindings, as culling.slang declares them
+    std::array cullBindings = {
+        vk::DescriptorSetLayoutBinding(2, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr),
+        vk::DescriptorSetLayoutBinding(3, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr),
+        vk::DescriptorSetLayoutBinding(4, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr),
+        vk::DescriptorSetLayoutBinding(5, vk::DescriptorType::eSampledImage, 1, vk::ShaderStageFlagBits::eCompute, nullptr),
+        vk::DescriptorSetLayoutBinding(6, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr),
+        vk::DescriptorSetLayoutBinding(7, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr)
+    };
+    cullSetLayout = vk::raii::DescriptorSetLayout(device.getDevice(), vk::DescriptorSetLayoutCreateInfo{
+        .bindingCount = static_cast<uint32_t>(cullBindings.size()),
+        .pBindings = cullBindings.data()
+    });
+}
+
+void GpuCulling::setDepthImage(const RenderTarget& depth, DeletionQueue& deletionQueue, uint64_t lastFrameSerial) {
+    deletionQueue.retire(lastFrameSerial, PyramidResources{
+        .pyramid = std::move(pyramid),
+        .levelViews = std::move(levelViews),
+        .reduceSets = std::move(reduceSets),
+        .cullSets = std::move(cullSets)
+    });
+    levelViews.clear();
+    reduceSets.clear();
+    cullSets.clear();
+
+    depthImage = &depth;
+    createPyramid();
+}
+
+void GpuCulling::createPyramid() {
+    const uint32_t width = std::max((depthImage->getWidth() + 1) / 2, 1u);
+    const uint32_t height = std::max((depthImage->getHeight() + 1) / 2, 1u);
+    const uint32_t levels = std::min(VulkanImage::fullMipChain(width, height), MAX_PYRAMID_LEVELS);
+    pyramid = std::make_unique<VulkanImage>(device,
+        width, height,
+        vk::Format::eR32Sfloat,
+        vk::ImageTiling::eOptimal,
+        vk::ImageUsageFlagBits::eStorage | vk::ImageUsageFlagBits::eSampled,
+        vk::MemoryPropertyFlagBits::eDeviceLocal,
+        vk::ImageAspectFlagBits::eColor,
+        levels);
+    pyramidValid = false;
+
+    for (uint32_t level = 0; level < levels; level++) {
+        levelViews.emplace_back(device.getDevice(), vk::ImageViewCreateInfo{
+            .image = pyramid->getImage(),
+            .viewType = vk::ImageViewType::e2D,
+            .format = vk::Format::eR32Sfloat,
+            .subresourceRange = { vk::ImageAspectFlagBits::eColor, level, 1, 0, 1 }
+        });
+    }
+
+    std::vector<vk::DescriptorSetLayout> layouts(levels, *reduceSetLayout);
+    reduceSets = device.getDevice().allocateDescriptorSets(vk::DescriptorSetAllocateInfo{
+        .descriptorPool = descriptorPool,
+        .descriptorSetCount = levels,
+        .pSetLayouts = layouts.data()
+    });
+
+    std::vector<vk::DescriptorImageInfo> imageInfos;
+    imageInfos.reserve(2 * levels);
+    std::vector<vk::WriteDescriptorSet> writes;
+    for (uint32_t level = 0; level < levels; level++) {
+        imageInfos.push_back(level == 0
+            ? vk::DescriptorImageInfo{ .imageView = depthImage->getImageView(), .imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal }
+            : vk::DescriptorImageInfo{ .imageView = *levelViews[level - 1], .imageLayout = vk::ImageLayout::eGeneral });
+        writes.push_back(vk::WriteDescriptorSet{
+            .dstSet = reduceSets[level],
+            .dstBinding = 0,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eSampledImage,
+            .pImageInfo = &imageInfos.back()
+        });
+        imageInfos.push_back(vk::DescriptorImageInfo{ .imageView = *levelViews[level], .imageLayout = vk::ImageLayout::eGeneral });
+        writes.push_back(vk::WriteDescriptorSet{
+            .dstSet = reduceSets[level],
+            .dstBinding = 1,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eStorageImage,
+            .pImageInfo = &imageInfos.back()
+        });
+    }
+    device.getDevice().updateDescriptorSets(writes, {});
+
+    allocateCullSets();
+    writeCullSets();
+}
+
+void GpuCulling::allocateCullSets() {
+    std::vector<vk::DescriptorSetLayout> layouts(frameCount, *cullSetLayout);
+    cullSets = device.getDevice().allocateDescriptorSets(vk::DescriptorSetAllocateInfo{
+        .descriptorPool = descriptorPool,
+        .descriptorSetCount = frameCount,
+        .pSetLayouts = layouts.data()
+    });
+}
+
+void GpuCulling::writeCullSets() {
+    vk::DescriptorImageInfo pyramidInfo{ .imageView = pyramid->getImageView(), .imageLayout = vk::ImageLayout::eGeneral };
+    vk::DescriptorBufferInfo instanceInfo{ .buffer = scene.getInstanceBuffer(), .offset = 0, .range = vk::WholeSize };
+    vk::DescriptorBufferInfo sourceInfo{ .buffer = scene.getDrawCommandBuffer(), .offset = 0, .range = vk::WholeSize };
+
+    std::vector<vk::DescriptorBufferInfo> culledInfos;
+    culledInfos.reserve(cullSets.size());
+    std::vector<vk::DescriptorBufferInfo> countInfos;
+    countInfos.reserve(cullSets.size());
+    std::vector<vk::DescriptorBufferInfo> viewInfos;
+    viewInfos.reserve(cullSets.size());
+    std::vector<vk::WriteDescriptorSet> writes;
+    for (size_t frame = 0; frame < cullSets.size(); frame++) {
+        culledInfos.push_back({ .buffer = culledCommands[frame]->getHandle(), .offset = 0, .range = vk::WholeSize });
+        countInfos.push_back({ .buffer = drawCounts[frame]->getHandle(), .offset = 0, .range = vk::WholeSize });
+        viewInfos.push_back({ .buffer = views[frame]->getHandle(), .offset = 0, .range = sizeof(CullViews) });
+        writes.push_back({ .dstSet = cullSets[frame], .dstBinding = 2, .descriptorCount = 1,
+                           .descriptorType = vk::DescriptorType::eStorageBuffer, .pBufferInfo = &instanceInfo });
+        writes.push_back({ .dstSet = cullSets[frame], .dstBinding = 3, .descriptorCount = 1,
+                           .descriptorType = vk::DescriptorType::eStorageBuffer, .pBufferInfo = &sourceInfo });
+        writes.push_back({ .dstSet = cullSets[frame], .dstBinding = 4, .descriptorCount = 1,
+                           .descriptorType = vk::DescriptorType::eStorageBuffer, .pBufferInfo = &culledInfos.back() });
+        writes.push_back({ .dstSet = cullSets[frame], .dstBinding = 5, .descriptorCount = 1,
+                           .descriptorType = vk::DescriptorType::eSampledImage, .pImageInfo = &pyramidInfo });
+        writes.push_back({ .dstSet = cullSets[frame], .dstBinding = 6, .descriptorCount = 1,
+                           .descriptorType = vk::DescriptorType::eStorageBuffer, .pBufferInfo = &countInfos.back() });
+        writes.push_back({ .dstSet = cullSets[frame], .dstBinding = 7, .descriptorCount = 1,
+                           .descriptorType = vk::DescriptorType::eUniformBuffer, .pBufferInfo = &viewInfos.back() });
+    }
+    device.getDevice().updateDescriptorSets(writes, {});
+}
+
+void GpuCulling::cull(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame,
+                      const glm::mat4& viewProj, uint32_t drawCount) {
+    // The last draw reading the count finished with the frame slot's fence; the shader appends from zero
+    if (compacts) {
+        commandBuffer.fillBuffer(drawCounts[frame]->getHandle(), 0, sizeof(uint32_t), 0);
+        vk::MemoryBarrier clearBarrier{
+            .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+            .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+        };
+        commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader,
+                                      {}, clearBarrier, {}, {});
+    }
+
+    // The frame slot's last dispatch retired with its fence, so its views can be rewritten
+    const CullViews frameViews{ .viewProj = viewProj, .previousViewProj = pyramidValid ? pyramidViewProj : viewProj };
+    views[frame]->copyData(&frameViews, sizeof(frameViews));
+    pyramidViewProj = viewProj;
+
+    CullPushConstants constants{
+        .depthSize = glm::vec2(depthImage->getWidth(), depthImage->getHeight()),
+        .pyramidLevels = pyramid->getMipLevels(),
+        .drawCount = drawCount,
+        .occlusion = pyramidValid ? 1u : 0u,
+        .compact = compacts ? 1u : 0u
+    };
+    std::array sets = { *cullSets[frame] };
+    cullPipeline->bind(commandBuffer);
+    cullPipeline->bindSets(commandBuffer, sets);
+    cullPipeline->push(commandBuffer, constants);
+    commandBuffer.dispatch((drawCount + CULL_WORKGROUP_SIZE - 1) / CULL_WORKGROUP_SIZE, 1, 1);
+}
+
+void GpuCulling::buildPyramid(const vk::raii::CommandBuffer& commandBuffer) {
+    reducePipeline->bind(commandBuffer);
+    glm::uvec2 sourceSize(depthImage->getWidth(), depthImage->getHeight());
+    const vk::MemoryBarrier levelBarrier{
+        .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+        .dstAccessMask = vk::AccessFlagBits::eShaderRead
+    };
+    for (uint32_t level = 0; level < pyramid->getMipLevels(); level++) {
+        const glm::uvec2 targetSize = glm::max((sourceSize + 1u) / 2u, glm::uvec2(1));
+        std::array sets = { *reduceSets[level] };
+        reducePipeline->bindSets(commandBuffer, sets);
+        reducePipeline->push(commandBuffer, ReducePushConstants{ .sourceSize = sourceSize, .targetSize = targetSize });
+        commandBuffer.dispatch((targetSize.x + REDUCE_WORKGROUP_SIZE - 1) / REDUCE_WORKGROUP_SIZE,
+                               (targetSize.y + REDUCE_WORKGROUP_SIZE - 1) / REDUCE_WORKGROUP_SIZE, 1);
+
+        // The next level reads this one; the pass's own uses are ordered by its caller
+        if (level + 1 < pyramid->getMipLevels()) {
+            commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eComputeShader,
+                                          {}, levelBarrier, {}, {});
+        }
+        sourceSize = targetSize;
+    }
+
+    pyramidValid = true;
+}
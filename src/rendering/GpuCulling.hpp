@@ -0,0 +1,161 @@
+#pragma once
+
+#include "../utils/VulkanCommon.hpp"
+#include "../core/VulkanDevice.hpp"
+#include "../resources/VulkanBuffer.hpp"
+#include "../resources/VulkanImage.hpp"
+#include "RenderTargets.hpp"
+#include "ComputePipeline.hpp"
+#include "DeletionQueue.hpp"
+#include "../scene/MeshScene.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Compute-shader frustum and occlusion culling of a MeshScene's indirect draws
+ *
+ * Each frame, cull() runs one thread per indirect command before the render pass:
+ * the instance's bounds are tested against the frustum and against a max-depth
+ * pyramid (HiZ) of the previous frame's depth buffer, and the command is copied
+ * into the frame's own indirect buffer with instanceCount zeroed if it was culled.
+ * buildPyramid() then reduces this frame's depth after the render pass.
+ *
+ * With the drawIndirectCount capability the visible commands are instead compacted to
+ * the front of the buffer and their count written beside it, so the draw skips culled
+ * commands on the GPU's command processor rather than issuing them with no instances.
+ *
+ * Occlusion uses last frame's depth, so each box is projected with both this
+ * frame's matrix and the one that depth was drawn with, and tested over the union
+ * of the two screen rects at the nearer of their depths: a moving camera or scene
+ * can't leave it tested against texels of what it used to cover. An object that
+ * just came out from behind an occluder can still appear one frame late. The test
+ * is skipped until the pyramid holds a frame's depth, e.g. after setDepthImage().
+ */
+class GpuCulling {
+public:
+    /**
+     * @brief Create the pipelines, the per-frame culled command buffers and the pyramid
+     * @param device Vulkan device reference
+     * @param shaderPath Path to the compiled culling shaders
+     * @param scene Scene whose instances and draw commands are culled (outlives this)
+     * @param depthImage Single-sampled depth the pyramid is built from (stored, with eSampled usage)
+     * @param frameCount Number of frames in flight
+     * @param pipelineCache Cache to compile through (optional)
+     */
+    GpuCulling(VulkanDevice& device, const std::string& shaderPath, const MeshScene& scene,
+               const RenderTarget& depthImage, uint32_t frameCount, vk::PipelineCache pipelineCache = nullptr);
+
+    ~GpuCulling() = default;
+
+    // Disable copy and move (descriptor sets reference the buffers)
+    GpuCulling(const GpuCulling&) = delete;
+    GpuCulling& operator=(const GpuCulling&) = delete;
+    GpuCulling(GpuCulling&&) = delete;
+    GpuCulling& operator=(GpuCulling&&) = delete;
+
+    /**
+     * @brief Rebuild the pyramid for a new depth buffer; occlusion is off until the next build
+     *
+     * The old pyramid and descriptor sets may still be used by frames in flight,
+     * so they go to the deletion queue rather than being destroyed.
+     * @param lastFrameSerial Last frame submitted with the old depth buffer
+     */
+    void setDepthImage(const RenderTarget& depthImage, DeletionQueue& deletionQueue, uint64_t lastFrameSerial);
+
+    /**
+     * @brief Record the culling dispatch
+     *
+     * The caller orders it after the pyramid's last build and before the draws reading
+     * the output as indirect commands; the pyramid is used in eGeneral throughout.
+     * @param viewProj Clip matrix of the scene's space (proj * view * scene model)
+     * @param drawCount Commands to cull, from the front of the scene's command buffer
+     */
+    void cull(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame,
+              const glm::mat4& viewProj, uint32_t drawCount);
+
+    /**
+     * @brief Record the pyramid reduction of the depth buffer the render pass wrote
+     *
+     * The caller orders it after the depth writes (possibly the resolve of a multisampled
+     * depth) and this frame's cull, with the depth in eShaderReadOnlyOptimal.
+     */
+    void buildPyramid(const vk::raii::CommandBuffer& commandBuffer);
+
+    /**
+     * @brief Indirect buffer cull() filled for the frame
+     */
+    vk::Buffer getCulledCommands(uint32_t frame) const { return culledCommands[frame]->getHandle(); }
+
+    /**
+     * @brief Count of the compacted commands cull() wrote for the frame, or null if it keeps them in place
+     */
+    vk::Buffer getDrawCountBuffer(uint32_t frame) const { return compacts ? drawCounts[frame]->getHandle() : nullptr; }
+
+    /**
+     * @brief Max-depth pyramid cull() reads and buildPyramid() writes, replaced by setDepthImage()
+     */
+    vk::Image getPyramidImage() const { return pyramid->getImage(); }
+
+    bool compactsDraws() const { return compacts; }
+
+private:
+    static constexpr uint32_t CULL_WORKGROUP_SIZE = 64;   // numthreads of cullSceneMain
+    static constexpr uint32_t REDUCE_WORKGROUP_SIZE = 8;  // numthreads of depthReduceMain, per axis
+    static constexpr uint32_t MAX_PYRAMID_LEVELS = 16;    // Enough for 64K depth buffers
+
+    // A pyramid and the sets reading it, replaced as a whole on resize
+    struct PyramidResources {
+        std::unique_ptr<VulkanImage> pyramid;
+        std::vector<vk::raii::ImageView> levelViews;
+        std::vector<vk::raii::DescriptorSet> reduceSets;
+        std::vector<vk::raii::DescriptorSet> cullSets;
+    };
+
+    struct ReducePushConstants {
+        glm::uvec2 sourceSize;
+        glm::uvec2 targetSize;
+    };
+
+    // Matches CullViews in culling.slang
+    struct CullViews {
+        glm::mat4 viewProj;
+        glm::mat4 previousViewProj;
+    };
+
+    struct CullPushConstants {
+        glm::vec2 depthSize;
+        uint32_t pyramidLevels;
+        uint32_t drawCount;
+        uint32_t occlusion;
+        uint32_t compact;
+    };
+
+    VulkanDevice& device;
+    const MeshScene& scene;
+    const RenderTarget* depthImage = nullptr;
+
+    vk::raii::DescriptorSetLayout reduceSetLayout = nullptr;
+    vk::raii::DescriptorSetLayout cullSetLayout = nullptr;
+    vk::raii::DescriptorPool descriptorPool = nullptr;
+    std::unique_ptr<ComputePipeline> reducePipeline;
+    std::unique_ptr<ComputePipeline> cullPipeline;
+
+    std::vector<std::unique_ptr<VulkanBuffer>> culledCommands;  // One per frame in flight
+    std::vector<std::unique_ptr<VulkanBuffer>> drawCounts;      // Likewise; bound even when not compacting
+    std::vector<std::unique_ptr<VulkanBuffer>> views;           // Mapped CullViews per frame in flight
+    bool compacts = false;
+    std::vector<vk::raii::DescriptorSet> cullSets;
+
+    std::unique_ptr<VulkanImage> pyramid;
+    std::vector<vk::raii::ImageView> levelViews;     // Single-level views for the reduction
+    std::vector<vk::raii::DescriptorSet> reduceSets;  // Level i reads level i - 1 (level 0 the depth)
+    uint32_t frameCount;
+    bool pyramidValid = false;                       // Holds a frame's depth
+    glm::mat4 pyramidViewProj{ 1.0f };               // Matrix of the last culled frame, whose depth the pyramid reduces
+
+    void createLayouts();
+    void createPyramid();
+    void allocateCullSets();
+    void writeCullSets();
+};
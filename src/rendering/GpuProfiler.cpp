@@ -0,0 +1,240 @@
+#include "GpuProfiler.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <stdexcept>
+
+namespace {
+    constexpr vk::QueryPipelineStatisticFlags STATISTIC_FLAGS =
+        vk::QueryPipelineStatisticFlagBits::eInputAssemblyVertices |
+        vk::QueryPipelineStatisticFlagBits::eInputAssemblyPrimitives |
+        vk::QueryPipelineStatisticFlagBits::eVertexShaderInvocations |
+        vk::QueryPipelineStatisticFlagBits::eClippingPrimitives |
+        vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations |
+        vk::QueryPipelineStatisticFlagBits::eComputeShaderInvocations;
+    constexpr uint32_t STATISTIC_COUNT = 6;  // Written in flag bit order, as GpuPipelineStatistics lists them
+
+    // Nearest-rank percentile of sorted samples
+    double percentile(const std::vector<double>& sorted, double fraction) {
+        size_t rank = static_cast<size_t>(std::ceil(fraction * static_cast<double>(sorted.size())));
+        return sorted[std::clamp<size_t>(rank, 1, sorted.size()) - 1];
+    }
+}
+
+bool GpuProfiler::isSupported(VulkanDevice& device) {
+    auto queueFamilies = device.getPhysicalDevice().getQueueFamilyProperties();
+    return device.getPhysicalDevice().getProperties().limits.timestampPeriod > 0.0f &&
+        queueFamilies[device.getGraphicsQueueFamily()].timestampValidBits > 0;
+}
+
+GpuProfiler::GpuProfiler(VulkanDevice& device, uint32_t frameCount) {
+    timestampPeriodNs = device.getPhysicalDevice().getProperties().limits.timestampPeriod;
+    uint32_t validBits = device.getPhysicalDevice().getQueueFamilyProperties()[device.getGraphicsQueueFamily()].timestampValidBits;
+    timestampMask = validBits >= 64 ? ~0ull : (1ull << validBits) - 1;
+    if (device.getCapabilities().pipelineStatisticsQuery) {
+        statisticFlags = STATISTIC_FLAGS;
+        inheritsStatistics = device.getCapabilities().inheritedQueries;
+    }
+
+    frames.resize(frameCount);
+    for (FrameQueries& queries : frames) {
+        queries.timestamps = vk::raii::QueryPool(device.getDevice(), vk::QueryPoolCreateInfo{
+            .queryType = vk::QueryType::eTimestamp,
+            .queryCount = 2 * MAX_SCOPES
+        });
+        if (statisticFlags) {
+            queries.statistics = vk::raii::QueryPool(device.getDevice(), vk::QueryPoolCreateInfo{
+                .queryType = vk::QueryType::ePipelineStatistics,
+                .queryCount = MAX_STATISTIC_SEGMENTS,
+                .pipelineStatistics = statisticFlags
+            });
+        }
+        queries.scopes.reserve(MAX_SCOPES);
+    }
+}
+
+void GpuProfiler::beginFrame(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame) {
+    FrameQueries& queries = frames[frame];
+    {
+        std::lock_guard lock(mutex);
+        queries.scopes.clear();
+        queries.recorded = true;
+        queries.frameNumber = ++frameCounter;
+    }
+    commandBuffer.resetQueryPool(*queries.timestamps, 0, 2 * MAX_SCOPES);
+    queries.statisticSegments = 0;
+    queries.statisticsActive = false;
+    if (statisticFlags) {
+        commandBuffer.resetQueryPool(*queries.statistics, 0, MAX_STATISTIC_SEGMENTS);
+        resumeStatistics(commandBuffer, frame);
+    }
+    queries.frameScope = beginScope(commandBuffer, frame, "frame");
+}
+
+void GpuProfiler::endFrame(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame) {
+    FrameQueries& queries = frames[frame];
+    endScope(commandBuffer, frame, queries.frameScope);
+    pauseStatistics(commandBuffer, frame);
+}
+
+void GpuProfiler::pauseStatistics(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame) {
+    FrameQueries& queries = frames[frame];
+    if (queries.statisticsActive) {
+        commandBuffer.endQuery(*queries.statistics, queries.statisticSegments - 1);
+        queries.statisticsActive = false;
+    }
+}
+
+void GpuProfiler::resumeStatistics(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame) {
+    FrameQueries& queries = frames[frame];
+    if (statisticFlags && !queries.statisticsActive && queries.statisticSegments < MAX_STATISTIC_SEGMENTS) {
+        commandBuffer.beginQuery(*queries.statistics, queries.statisticSegments++, {});
+        queries.statisticsActive = true;
+    }
+}
+
+uint32_t GpuProfiler::beginScope(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame, const char* name) {
+    FrameQueries& queries = frames[frame];
+    uint32_t query;
+    {
+        std::lock_guard lock(mutex);
+        if (queries.scopes.size() >= MAX_SCOPES) {
+            return ~0u;
+        }
+        query = 2 * static_cast<uint32_t>(queries.scopes.size());
+        queries.scopes.push_back({ name, query });
+    }
+    commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eTopOfPipe, *queries.timestamps, query);
+    return query;
+}
+
+void GpuProfiler::endScope(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame, uint32_t scope) {
+    if (scope == ~0u) {
+        return;
+    }
+    commandBuffer.writeTimestamp(vk::PipelineStageFlagBits::eBottomOfPipe, *frames[frame].timestamps, scope + 1);
+}
+
+void GpuProfiler::collect(uint32_t frame) {
+    FrameQueries& queries = frames[frame];
+    if (!queries.recorded || queries.scopes.empty()) {
+        return;
+    }
+    queries.recorded = false;
+
+    // The frame retired, so everything is available; no eWait
+    const uint32_t queryCount = 2 * static_cast<uint32_t>(queries.scopes.size());
+    auto [result, ticks] = queries.timestamps.getResults<uint64_t>(
+        0, queryCount, queryCount * sizeof(uint64_t), sizeof(uint64_t), vk::QueryResultFlagBits::e64);
+    if (result != vk::Result::eSuccess) {
+        return;
+    }
+
+    if (traceOrigin == 0) {
+        traceOrigin = ticks[0] & timestampMask;
+    }
+    for (const ScopeRecord& scope : queries.scopes) {
+        const uint64_t begin = ticks[scope.query] & timestampMask;
+        const uint64_t end = ticks[scope.query + 1] & timestampMask;
+        if (end < begin) {
+            continue;  // Counter wrapped
+        }
+        const double durationMs = static_cast<double>(end - begin) * timestampPeriodNs / 1e6;
+
+        History& scopeHistory = history[scope.name];
+        if (scopeHistory.samples.size() < HISTORY_SIZE) {
+            scopeHistory.samples.push_back(durationMs);
+        } else {
+            scopeHistory.samples[scopeHistory.next] = durationMs;
+        }
+        scopeHistory.next = (scopeHistory.next + 1) % HISTORY_SIZE;
+
+        if (begin >= traceOrigin) {
+            trace.push_back({
+                .name = scope.name,
+                .frameNumber = queries.frameNumber,
+                .startUs = static_cast<double>(begin - traceOrigin) * timestampPeriodNs / 1e3,
+                .durationUs = durationMs * 1e3
+            });
+        }
+    }
+    while (trace.size() > MAX_TRACE_EVENTS) {
+        trace.pop_front();
+    }
+
+    if (statisticFlags && queries.statisticSegments > 0) {
+        const uint32_t segments = queries.statisticSegments;
+        auto [statisticsResult, values] = queries.statistics.getResults<uint64_t>(
+            0, segments, segments * STATISTIC_COUNT * sizeof(uint64_t), STATISTIC_COUNT * sizeof(uint64_t),
+            vk::QueryResultFlagBits::e64);
+        if (statisticsResult == vk::Result::eSuccess) {
+            // Segments are consecutive parts of the frame; their counts add up
+            std::array<uint64_t, STATISTIC_COUNT> totals{};
+            for (uint32_t segment = 0; segment < segments; segment++) {
+                for (uint32_t i = 0; i < STATISTIC_COUNT; i++) {
+                    totals[i] += values[segment * STATISTIC_COUNT + i];
+                }
+            }
+            pipelineStatistics = {
+                .inputVertices = totals[0],
+                .inputPrimitives = totals[1],
+                .vertexInvocations = totals[2],
+                .clippingPrimitives = totals[3],
+                .fragmentInvocations = totals[4],
+                .computeInvocations = totals[5]
+            };
+        }
+    }
+}
+
+std::vector<GpuScopeStats> GpuProfiler::getScopeStats() const {
+    std::vector<GpuScopeStats> stats;
+    stats.reserve(history.size());
+    for (const auto& [name, scopeHistory] : history) {
+        std::vector<double> sorted = scopeHistory.samples;
+        std::ranges::sort(sorted);
+        double total = 0.0;
+        for (double sample : sorted) {
+            total += sample;
+        }
+        stats.push_back({
+            .name = name,
+            .samples = static_cast<uint32_t>(sorted.size()),
+            .averageMs = total / static_cast<double>(sorted.size()),
+            .p50Ms = percentile(sorted, 0.50),
+            .p95Ms = percentile(sorted, 0.95),
+            .p99Ms = percentile(sorted, 0.99)
+        });
+    }
+    return stats;
+}
+
+void GpuProfiler::resetStatistics() {
+    history.clear();
+    trace.clear();
+}
+
+void GpuProfiler::writeChromeTrace(const std::string& path) const {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        throw std::runtime_error("failed to open trace file: " + path);
+    }
+
+    // Complete ("X") events on one track; nesting follows from the times
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+    bool first = true;
+    for (const TraceEvent& event : trace) {
+        out << (first ? "\n" : ",\n")
+            << "{\"name\":\"" << event.name << "\",\"cat\":\"gpu\",\"ph\":\"X\",\"pid\":0,\"tid\":0,"
+            << "\"ts\":" << event.startUs << ",\"dur\":" << event.durationUs
+            << ",\"args\":{\"frame\":" << event.frameNumber << "}}";
+        first = false;
+    }
+    out << "\n]}\n";
+    if (!out) {
+        throw std::runtime_error("failed to write trace file: " + path);
+    }
+}
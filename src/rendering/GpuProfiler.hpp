@@ -0,0 +1,212 @@
+#pragma once
+
+#include "../utils/VulkanCommon.hpp"
+#include "../core/VulkanDevice.hpp"
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Timing of one named GPU scope over the recent frames
+ */
+struct GpuScopeStats {
+    std::string name;
+    uint32_t samples = 0;
+    double averageMs = 0.0;
+    double p50Ms = 0.0;
+    double p95Ms = 0.0;
+    double p99Ms = 0.0;
+};
+
+/**
+ * @brief Pipeline statistics of the last collected frame
+ */
+struct GpuPipelineStatistics {
+    uint64_t inputVertices = 0;
+    uint64_t inputPrimitives = 0;
+    uint64_t vertexInvocations = 0;
+    uint64_t clippingPrimitives = 0;
+    uint64_t fragmentInvocations = 0;
+    uint64_t computeInvocations = 0;
+};
+
+/**
+ * @brief GPU timestamp and pipeline-statistics profiler with per-frame query pools
+ *
+ * Each frame slot owns a timestamp pool and, if the device supports it, a pipeline
+ * statistics pool. beginFrame() resets them from the frame's command buffer and
+ * opens a "frame" scope around everything recorded until endFrame(); GpuScope
+ * brackets named regions with a pair of timestamps. Scopes may be recorded in
+ * secondary buffers from several threads.
+ *
+ * Secondaries can only run inside the statistics query with the inheritedQueries
+ * feature. Without it the primary brackets executeCommands with pauseStatistics()
+ * and resumeStatistics(), which split the query into segments summed at collect();
+ * what the secondaries draw then goes uncounted.
+ *
+ * Results are read with collect() once the slot's previous frame has retired, so
+ * they are always available and reading never stalls. Each scope keeps a rolling
+ * window of samples for averages and percentiles, and recent frames are kept as
+ * events for writeChromeTrace().
+ */
+class GpuProfiler {
+public:
+    static constexpr uint32_t MAX_SCOPES = 64;        // Per frame, including "frame"
+    static constexpr uint32_t HISTORY_SIZE = 256;     // Samples per scope for the statistics
+    static constexpr size_t MAX_TRACE_EVENTS = 100000;
+    static constexpr uint32_t MAX_STATISTIC_SEGMENTS = 4;  // Statistics queries per frame, split by pauses
+
+    /**
+     * @brief Whether the graphics queue can write timestamps at all
+     */
+    static bool isSupported(VulkanDevice& device);
+
+    /**
+     * @brief Create the query pools
+     * @param device Vulkan device reference
+     * @param frameCount Number of frame slots
+     */
+    GpuProfiler(VulkanDevice& device, uint32_t frameCount);
+
+    ~GpuProfiler() = default;
+
+    // Disable copy and move
+    GpuProfiler(const GpuProfiler&) = delete;
+    GpuProfiler& operator=(const GpuProfiler&) = delete;
+    GpuProfiler(GpuProfiler&&) = delete;
+    GpuProfiler& operator=(GpuProfiler&&) = delete;
+
+    /**
+     * @brief Read the results the slot's previous frame wrote; call after it retired
+     */
+    void collect(uint32_t frame);
+
+    /**
+     * @brief Reset the slot's queries and open the frame scope; record outside a render pass
+     */
+    void beginFrame(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame);
+
+    /**
+     * @brief Close the frame scope; record outside a render pass
+     */
+    void endFrame(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame);
+
+    /**
+     * @brief Write a scope's opening timestamp
+     * @param name String literal (kept by pointer until collected)
+     * @return Scope handle for endScope, or ~0u if the frame ran out of queries
+     */
+    uint32_t beginScope(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame, const char* name);
+    void endScope(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame, uint32_t scope);
+
+    /**
+     * @brief Statistics counted while secondaries run, for their inheritance info; none without inheritedQueries
+     */
+    vk::QueryPipelineStatisticFlags getStatisticFlags() const { return inheritsStatistics ? statisticFlags : vk::QueryPipelineStatisticFlags{}; }
+
+    /**
+     * @brief Whether the frames count pipeline statistics at all
+     */
+    bool hasStatistics() const { return !!statisticFlags; }
+
+    /**
+     * @brief Whether secondaries may run while the statistics query is active
+     */
+    bool inheritsQueries() const { return inheritsStatistics || !statisticFlags; }
+
+    /**
+     * @brief End the frame's statistics segment before executing secondaries; record outside a render pass
+     */
+    void pauseStatistics(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame);
+
+    /**
+     * @brief Start the next segment after them (the rest of the frame goes uncounted past MAX_STATISTIC_SEGMENTS)
+     */
+    void resumeStatistics(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame);
+
+    std::vector<GpuScopeStats> getScopeStats() const;
+
+    /**
+     * @brief Forget the collected samples and trace events, e.g. after warm-up
+     */
+    void resetStatistics();
+    const GpuPipelineStatistics& getPipelineStatistics() const { return pipelineStatistics; }
+
+    /**
+     * @brief Write the recent scopes as Chrome trace events (chrome://tracing, Perfetto)
+     * @throws std::runtime_error if the file can't be written
+     */
+    void writeChromeTrace(const std::string& path) const;
+
+private:
+    struct ScopeRecord {
+        const char* name;
+        uint32_t query;  // Opening timestamp; the closing one follows
+    };
+
+    struct FrameQueries {
+        vk::raii::QueryPool timestamps = nullptr;
+        vk::raii::QueryPool statistics = nullptr;
+        std::vector<ScopeRecord> scopes;
+        uint32_t frameScope = ~0u;
+        uint32_t statisticSegments = 0;  // Begun this frame
+        bool statisticsActive = false;
+        bool recorded = false;
+        uint64_t frameNumber = 0;
+    };
+
+    struct History {
+        std::vector<double> samples;  // Ring of the last HISTORY_SIZE durations in ms
+        uint32_t next = 0;
+    };
+
+    struct TraceEvent {
+        const char* name;
+        uint64_t frameNumber;
+        double startUs;
+        double durationUs;
+    };
+
+    double timestampPeriodNs;
+    uint64_t timestampMask;
+    vk::QueryPipelineStatisticFlags statisticFlags;
+    bool inheritsStatistics = false;
+
+    std::mutex mutex;  // Guards the frame's scope list while secondaries record
+    std::vector<FrameQueries> frames;
+    uint64_t frameCounter = 0;
+
+    std::map<std::string, History> history;
+    std::deque<TraceEvent> trace;
+    uint64_t traceOrigin = 0;  // Tick of the first collected timestamp, 0 until then
+    GpuPipelineStatistics pipelineStatistics;
+};
+
+/**
+ * @brief RAII GPU scope; does nothing without a profiler
+ */
+class GpuScope {
+public:
+    GpuScope(GpuProfiler* profiler, const vk::raii::CommandBuffer& commandBuffer, uint32_t frame, const char* name)
+        : profiler(profiler), commandBuffer(commandBuffer), frame(frame),
+          scope(profiler ? profiler->beginScope(commandBuffer, frame, name) : ~0u) {}
+
+    ~GpuScope() {
+        if (profiler) {
+            profiler->endScope(commandBuffer, frame, scope);
+        }
+    }
+
+    GpuScope(const GpuScope&) = delete;
+    GpuScope& operator=(const GpuScope&) = delete;
+    GpuScope(GpuScope&&) = delete;
+    GpuScope& operator=(GpuScope&&) = delete;
+
+private:
+    GpuProfiler* profiler;
+    const vk::raii::CommandBuffer& commandBuffer;
+    uint32_t frame;
+    uint32_t scope;
+};
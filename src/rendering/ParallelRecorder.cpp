@@ -0,0 +1,137 @@
+#include "ParallelRecorder.hpp"
+#include <algorithm>
+
+ParallelRecorder::ParallelRecorder(VulkanDevice& device, uint32_t queueFamilyIndex, uint32_t frameCount,
+                                   uint32_t threadCount)
+    : device(device) {
+    if (threadCount == 0) {
+        threadCount = std::clamp<uint32_t>(std::thread::hardware_concurrency(), 1, MAX_THREADS);
+    }
+
+    contexts.resize(threadCount);
+    for (ThreadContext& context : contexts) {
+        for (uint32_t frame = 0; frame < frameCount; frame++) {
+            // Buffers are only reset together with their pool
+            context.pools.emplace_back(device.getDevice(), vk::CommandPoolCreateInfo{
+                .flags = vk::CommandPoolCreateFlagBits::eTransient,
+                .queueFamilyIndex = queueFamilyIndex
+            });
+        }
+        context.buffers.resize(frameCount);
+        context.usedBuffers.resize(frameCount, 0);
+    }
+
+    workers.reserve(threadCount - 1);
+    for (uint32_t i = 0; i + 1 < threadCount; i++) {
+        workers.emplace_back([this, i] { workerLoop(i); });
+    }
+}
+
+ParallelRecorder::~ParallelRecorder() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+    }
+    batchAvailable.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void ParallelRecorder::resetFrame(uint32_t frame) {
+    for (ThreadContext& context : contexts) {
+        if (context.usedBuffers[frame] > 0) {
+            context.pools[frame].reset();
+            context.usedBuffers[frame] = 0;
+        }
+    }
+}
+
+std::vector<vk::CommandBuffer> ParallelRecorder::record(uint32_t frame, const vk::CommandBufferInheritanceInfo& inheritance,
+                                                        uint32_t jobCount, const RecordJob& recordJob) {
+    std::vector<vk::CommandBuffer> results(jobCount);
+    std::vector<std::exception_ptr> errors(jobCount);
+    {
+        std::lock_guard lock(mutex);
+        batch = Batch{
+            .frame = frame,
+            .inheritance = &inheritance,
+            .jobCount = jobCount,
+            .recordJob = &recordJob,
+            .results = &results,
+            .errors = &errors
+        };
+        nextJob.store(0, std::memory_order_relaxed);
+        activeWorkers = static_cast<uint32_t>(workers.size());
+        batchGeneration++;
+    }
+    batchAvailable.notify_all();
+
+    // The calling thread takes jobs too instead of idling
+    runJobs(contexts.back());
+    {
+        std::unique_lock lock(mutex);
+        batchDone.wait(lock, [this] { return activeWorkers == 0; });
+    }
+
+    for (const std::exception_ptr& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+    return results;
+}
+
+void ParallelRecorder::workerLoop(uint32_t contextIndex) {
+    uint64_t seenGeneration = 0;
+    while (true) {
+        {
+            std::unique_lock lock(mutex);
+            batchAvailable.wait(lock, [&] { return stopping || batchGeneration != seenGeneration; });
+            if (stopping) {
+                return;
+            }
+            seenGeneration = batchGeneration;
+        }
+
+        runJobs(contexts[contextIndex]);
+
+        std::lock_guard lock(mutex);
+        if (--activeWorkers == 0) {
+            batchDone.notify_one();
+        }
+    }
+}
+
+void ParallelRecorder::runJobs(ThreadContext& context) {
+    const vk::CommandBufferBeginInfo beginInfo{
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit | vk::CommandBufferUsageFlagBits::eRenderPassContinue,
+        .pInheritanceInfo = batch.inheritance
+    };
+
+    for (uint32_t job = nextJob.fetch_add(1, std::memory_order_relaxed); job < batch.jobCount;
+         job = nextJob.fetch_add(1, std::memory_order_relaxed)) {
+        const vk::raii::CommandBuffer& commandBuffer = acquireBuffer(context, batch.frame);
+        commandBuffer.begin(beginInfo);
+        try {
+            (*batch.recordJob)(commandBuffer, job);
+        } catch (...) {
+            (*batch.errors)[job] = std::current_exception();
+        }
+        commandBuffer.end();
+        (*batch.results)[job] = *commandBuffer;
+    }
+}
+
+const vk::raii::CommandBuffer& ParallelRecorder::acquireBuffer(ThreadContext& context, uint32_t frame) {
+    std::vector<vk::raii::CommandBuffer>& buffers = context.buffers[frame];
+    if (context.usedBuffers[frame] == buffers.size()) {
+        vk::raii::CommandBuffers allocated(device.getDevice(), vk::CommandBufferAllocateInfo{
+            .commandPool = *context.pools[frame],
+            .level = vk::CommandBufferLevel::eSecondary,
+            .commandBufferCount = 1
+        });
+        buffers.push_back(std::move(allocated.front()));
+    }
+    return buffers[context.usedBuffers[frame]++];
+}
@@ -0,0 +1,112 @@
+#pragma once
+
+#include "../utils/VulkanCommon.hpp"
+#include "../core/VulkanDevice.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief Records secondary command buffers on a pool of threads
+ *
+ * Every recording thread (the workers plus the calling thread) owns one command
+ * pool per frame in flight, so recording never synchronizes on a pool. record()
+ * hands out job indices to whichever thread is free; each job fills one secondary
+ * buffer that the caller executes from its primary in job order.
+ *
+ * A frame's pools are reset all at once by resetFrame(), once the frame slot's
+ * previous submission has retired; buffers are reused rather than freed.
+ */
+class ParallelRecorder {
+public:
+    static constexpr uint32_t MAX_THREADS = 8;
+
+    /**
+     * @brief Function recording one job's commands into an already begun secondary buffer
+     */
+    using RecordJob = std::function<void(const vk::raii::CommandBuffer& commandBuffer, uint32_t job)>;
+
+    /**
+     * @brief Create the per-thread pools and start the workers
+     * @param device Vulkan device reference
+     * @param queueFamilyIndex Queue family the primaries are submitted to
+     * @param frameCount Number of frames in flight
+     * @param threadCount Recording threads including the caller's, 0 picks one per core (at most MAX_THREADS)
+     */
+    ParallelRecorder(VulkanDevice& device, uint32_t queueFamilyIndex, uint32_t frameCount, uint32_t threadCount = 0);
+
+    /**
+     * @brief Joins the workers; pending command buffers must have retired
+     */
+    ~ParallelRecorder();
+
+    // Disable copy and move (workers reference the recorder)
+    ParallelRecorder(const ParallelRecorder&) = delete;
+    ParallelRecorder& operator=(const ParallelRecorder&) = delete;
+    ParallelRecorder(ParallelRecorder&&) = delete;
+    ParallelRecorder& operator=(ParallelRecorder&&) = delete;
+
+    /**
+     * @brief Recording threads, counting the one that calls record()
+     */
+    uint32_t getThreadCount() const { return static_cast<uint32_t>(contexts.size()); }
+
+    /**
+     * @brief Recycle every secondary buffer recorded for the frame slot
+     * @param frame Frame-in-flight slot whose previous submission has retired
+     */
+    void resetFrame(uint32_t frame);
+
+    /**
+     * @brief Record jobCount secondary buffers in parallel and wait for all of them
+     * @param frame Frame-in-flight slot the buffers belong to
+     * @param inheritance Render pass (or dynamic rendering formats) the buffers continue
+     * @param jobCount Number of jobs; each gets its own buffer
+     * @param recordJob Called once per job, from any recording thread
+     * @return Secondary buffers in job order, ready for executeCommands
+     * @throws The first exception a job threw, after every job finished
+     */
+    std::vector<vk::CommandBuffer> record(uint32_t frame, const vk::CommandBufferInheritanceInfo& inheritance,
+                                          uint32_t jobCount, const RecordJob& recordJob);
+
+private:
+    // One recording thread's pools and buffers, indexed by frame slot
+    struct ThreadContext {
+        std::vector<vk::raii::CommandPool> pools;
+        std::vector<std::vector<vk::raii::CommandBuffer>> buffers;
+        std::vector<uint32_t> usedBuffers;
+    };
+
+    // The record() call in progress; written under the mutex before workers are woken
+    struct Batch {
+        uint32_t frame = 0;
+        const vk::CommandBufferInheritanceInfo* inheritance = nullptr;
+        uint32_t jobCount = 0;
+        const RecordJob* recordJob = nullptr;
+        std::vector<vk::CommandBuffer>* results = nullptr;
+        std::vector<std::exception_ptr>* errors = nullptr;
+    };
+
+    VulkanDevice& device;
+    std::vector<ThreadContext> contexts;  // Workers first, the caller's last
+
+    // Shared with the workers
+    std::mutex mutex;
+    std::condition_variable batchAvailable;
+    std::condition_variable batchDone;
+    uint64_t batchGeneration = 0;
+    uint32_t activeWorkers = 0;
+    bool stopping = false;
+    Batch batch;
+    std::atomic<uint32_t> nextJob{ 0 };
+
+    std::vector<std::thread> workers;
+
+    void workerLoop(uint32_t contextIndex);
+    void runJobs(ThreadContext& context);
+    const vk::raii::CommandBuffer& acquireBuffer(ThreadContext& context, uint32_t frame);
+};
@@ -0,0 +1,133 @@
+#include "PipelineCache.hpp"
+#include "../utils/FileUtils.hpp"
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <system_error>
+
+namespace {
+    constexpr char MAGIC[8] = { 'P', 'I', 'P', 'E', 'C', 'A', 'C', 'H' };
+
+    struct CacheHeader {
+        char magic[8];
+        uint32_t version;
+        uint32_t vendorID;
+        uint32_t deviceID;
+        uint32_t driverVersion;
+        uint8_t pipelineCacheUUID[VK_UUID_SIZE];
+        uint64_t dataSize;
+        uint64_t checksum;  // FNV-1a of the driver blob
+    };
+
+    uint64_t fnv1a(const char* data, size_t size) {
+        uint64_t hash = 0xcbf29ce484222325ull;
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ static_cast<unsigned char>(data[i])) * 0x100000001b3ull;
+        }
+        return hash;
+    }
+
+    CacheHeader headerFor(const vk::PhysicalDeviceProperties& properties) {
+        CacheHeader header{};
+        memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = PipelineCache::VERSION;
+        header.vendorID = properties.vendorID;
+        header.deviceID = properties.deviceID;
+        header.driverVersion = properties.driverVersion;
+        memcpy(header.pipelineCacheUUID, properties.pipelineCacheUUID.data(), VK_UUID_SIZE);
+        return header;
+    }
+}
+
+PipelineCache::PipelineCache(VulkanDevice& device, std::string path)
+    : device(device), path(std::move(path)) {
+    std::vector<char> initialData = loadValidated();
+    loadedBytes = initialData.size();
+
+    vk::PipelineCacheCreateInfo createInfo{
+        .initialDataSize = initialData.size(),
+        .pInitialData = initialData.empty() ? nullptr : initialData.data()
+    };
+    cache = vk::raii::PipelineCache(device.getDevice(), createInfo);
+}
+
+PipelineCache::~PipelineCache() {
+    try {
+        if (!save()) {
+            std::cerr << "Warning: failed to write pipeline cache " << path << std::endl;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "Warning: failed to write pipeline cache " << path << ": " << e.what() << std::endl;
+    }
+}
+
+std::vector<char> PipelineCache::loadValidated() const {
+    std::error_code error;
+    if (!std::filesystem::exists(path, error)) {
+        return {};
+    }
+
+    try {
+        FileUtils::MappedFile file(path);
+        CacheHeader header;
+        if (file.size() < sizeof(header)) {
+            return {};
+        }
+        memcpy(&header, file.data(), sizeof(header));
+
+        // Blobs are only valid for the exact device and driver build that produced them
+        CacheHeader expected = headerFor(device.getPhysicalDevice().getProperties());
+        if (memcmp(header.magic, expected.magic, sizeof(MAGIC)) != 0 || header.version != expected.version) {
+            return {};
+        }
+        if (header.vendorID != expected.vendorID || header.deviceID != expected.deviceID ||
+            header.driverVersion != expected.driverVersion ||
+            memcmp(header.pipelineCacheUUID, expected.pipelineCacheUUID, VK_UUID_SIZE) != 0) {
+            std::cout << "Pipeline cache: " << path << " was built for another device or driver, starting cold" << std::endl;
+            return {};
+        }
+
+        const char* data = file.data() + sizeof(header);
+        if (header.dataSize != file.size() - sizeof(header) || header.checksum != fnv1a(data, header.dataSize)) {
+            std::cout << "Pipeline cache: " << path << " is corrupt, starting cold" << std::endl;
+            return {};
+        }
+        return std::vector<char>(data, data + header.dataSize);
+    } catch (const std::runtime_error&) {
+        return {};
+    }
+}
+
+bool PipelineCache::save() const {
+    std::vector<uint8_t> data = cache.getData();
+
+    CacheHeader header = headerFor(device.getPhysicalDevice().getProperties());
+    header.dataSize = data.size();
+    header.checksum = fnv1a(reinterpret_cast<const char*>(data.data()), data.size());
+
+    const std::string tempPath = path + ".tmp";
+    {
+        std::ofstream out(tempPath, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            return false;
+        }
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        if (!out) {
+            out.close();
+            std::error_code removeError;
+            std::filesystem::remove(tempPath, removeError);
+            return false;
+        }
+    }
+
+    std::error_code error;
+    std::filesystem::rename(tempPath, path, error);
+    if (error) {
+        std::filesystem::remove(tempPath, error);
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "../utils/VulkanCommon.hpp"
+#include "../core/VulkanDevice.hpp"
+#include <string>
+
+/**
+ * @brief vk::PipelineCache persisted across runs
+ *
+ * The driver's cache blob is stored behind a small header that records the
+ * vendor, device, driver version and pipelineCacheUUID it was produced on, plus
+ * a checksum of the blob. Anything that doesn't match the current device is
+ * discarded before it reaches the driver, so a driver update or GPU swap only
+ * costs one cold start. The cache is written back on destruction.
+ */
+class PipelineCache {
+public:
+    static constexpr uint32_t VERSION = 1;
+
+    /**
+     * @brief Create the cache, seeded from path when that file is valid for this device
+     * @param device Vulkan device reference
+     * @param path Cache file location
+     */
+    PipelineCache(VulkanDevice& device, std::string path = "pipeline.cache");
+
+    /**
+     * @brief Saves the cache; failures are logged, never thrown
+     */
+    ~PipelineCache();
+
+    // Disable copy and move (saved from the destructor)
+    PipelineCache(const PipelineCache&) = delete;
+    PipelineCache& operator=(const PipelineCache&) = delete;
+    PipelineCache(PipelineCache&&) = delete;
+    PipelineCache& operator=(PipelineCache&&) = delete;
+
+    /**
+     * @brief Write the current cache contents to disk (temp file + rename)
+     * @return false if the file couldn't be written
+     */
+    bool save() const;
+
+    vk::PipelineCache getHandle() const { return *cache; }
+
+    /**
+     * @brief Whether the cache started from data saved by an earlier run
+     */
+    bool isWarm() const { return loadedBytes > 0; }
+    size_t getLoadedBytes() const { return loadedBytes; }
+
+private:
+    VulkanDevice& device;
+    std::string path;
+    vk::raii::PipelineCache cache = nullptr;
+    size_t loadedBytes = 0;
+
+    std::vector<char> loadValidated() const;
+};
@@ -0,0 +1,123 @@
+#include "PipelineRegistry.hpp"
+
+#include <iostream>
+#include <stdexcept>
+
+PipelineRegistry::PipelineRegistry(VulkanDevice& device,
+                                   const VulkanSwapchain& swapchain,
+                                   std::string shaderPath,
+                                   vk::Format depthFormat,
+                                   vk::SampleCountFlagBits samples,
+                                   vk::PipelineLayout pipelineLayout,
+                                   vk::RenderPass renderPass,
+                                   PipelineCache& pipelineCache)
+    : device(device), swapchain(swapchain), shaderPath(std::move(shaderPath)),
+      depthFormat(depthFormat), samples(samples), pipelineLayout(pipelineLayout), renderPass(renderPass), pipelineCache(pipelineCache) {
+    builder = std::thread([this] { builderLoop(); });
+}
+
+PipelineRegistry::~PipelineRegistry() {
+    {
+        std::lock_guard lock(mutex);
+        stopping = true;
+        jobs.clear();
+    }
+    jobAvailable.notify_all();
+    builder.join();
+}
+
+const VulkanPipeline& PipelineRegistry::get(const PipelineConfig& config) {
+    std::unique_lock lock(mutex);
+    if (claim(config)) {
+        lock.unlock();
+        build(config);
+        lock.lock();
+    }
+    pipelineBuilt.wait(lock, [&] {
+        const Entry& entry = entries.at(config);
+        return entry.pipeline || entry.failed;
+    });
+    if (entries.at(config).failed) {
+        throw std::runtime_error("failed to build pipeline variant for " + config.vertexEntry);
+    }
+    return *entries.at(config).pipeline;
+}
+
+const VulkanPipeline* PipelineRegistry::find(const PipelineConfig& config) {
+    {
+        std::lock_guard lock(mutex);
+        if (auto it = entries.find(config); it != entries.end()) {
+            return it->second.pipeline.get();
+        }
+        claim(config);
+        jobs.push_back(config);
+    }
+    jobAvailable.notify_one();
+    return nullptr;
+}
+
+void PipelineRegistry::prewarm(const std::vector<PipelineConfig>& configs) {
+    {
+        std::lock_guard lock(mutex);
+        for (const PipelineConfig& config : configs) {
+            if (claim(config)) {
+                jobs.push_back(config);
+            }
+        }
+    }
+    jobAvailable.notify_one();
+}
+
+bool PipelineRegistry::claim(const PipelineConfig& config) {
+    return entries.try_emplace(config).second;
+}
+
+void PipelineRegistry::build(const PipelineConfig& config) {
+    vk::Pipeline base;
+    {
+        std::lock_guard lock(mutex);
+        base = basePipeline;
+    }
+
+    std::unique_ptr<VulkanPipeline> pipeline;
+    try {
+        pipeline = std::make_unique<VulkanPipeline>(
+            device, swapchain, shaderPath, depthFormat, pipelineLayout, renderPass, config, pipelineCache.getHandle(),
+            base, samples);
+    } catch (const std::exception& e) {
+        std::cerr << "Failed to build pipeline variant (" << config.vertexEntry << ", "
+                  << vk::to_string(config.topology) << ", " << vk::to_string(config.polygonMode) << "): "
+                  << e.what() << std::endl;
+        {
+            std::lock_guard lock(mutex);
+            entries.at(config).failed = true;
+        }
+        pipelineBuilt.notify_all();
+        return;
+    }
+
+    {
+        std::lock_guard lock(mutex);
+        if (!basePipeline) {
+            basePipeline = pipeline->getPipeline();
+        }
+        entries.at(config).pipeline = std::move(pipeline);
+    }
+    pipelineBuilt.notify_all();
+}
+
+void PipelineRegistry::builderLoop() {
+    while (true) {
+        PipelineConfig config;
+        {
+            std::unique_lock lock(mutex);
+            jobAvailable.wait(lock, [this] { return stopping || !jobs.empty(); });
+            if (stopping) {
+                return;
+            }
+            config = std::move(jobs.front());
+            jobs.pop_front();
+        }
+        build(config);
+    }
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "../utils/VulkanCommon.hpp"
+#include "../core/VulkanDevice.hpp"
+#include "VulkanPipeline.hpp"
+#include "VulkanSwapchain.hpp"
+#include "PipelineCache.hpp"
+
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+/**
+ * @brief Graphics pipeline variants keyed by their PipelineConfig state hash
+ *
+ * Variants are built once and kept for the registry's lifetime, so switching
+ * state per draw is a lookup. Missing variants can be built on a background
+ * thread (prewarm, find) while the caller keeps drawing with one it already
+ * has. Every build goes through the shared PipelineCache and derives from the
+ * first pipeline built.
+ */
+class PipelineRegistry {
+public:
+    /**
+     * @brief Start the background builder
+     * @param device Vulkan device reference
+     * @param swapchain Swapchain for the color format
+     * @param shaderPath Path to compiled shader SPIR-V file
+     * @param depthFormat Depth buffer format
+     * @param samples Rasterization samples of every variant (the attachments' MSAA count)
+     * @param pipelineLayout Layout shared by every variant
+     * @param renderPass Render pass without dynamic rendering, ignored with it
+     * @param pipelineCache Cache every variant compiles through
+     */
+    PipelineRegistry(VulkanDevice& device,
+                     const VulkanSwapchain& swapchain,
+                     std::string shaderPath,
+                     vk::Format depthFormat,
+                     vk::SampleCountFlagBits samples,
+                     vk::PipelineLayout pipelineLayout,
+                     vk::RenderPass renderPass,
+                     PipelineCache& pipelineCache);
+
+    /**
+     * @brief Finishes the build in progress, drops queued ones and joins the builder
+     */
+    ~PipelineRegistry();
+
+    // Disable copy and move (the builder references the registry)
+    PipelineRegistry(const PipelineRegistry&) = delete;
+    PipelineRegistry& operator=(const PipelineRegistry&) = delete;
+    PipelineRegistry(PipelineRegistry&&) = delete;
+    PipelineRegistry& operator=(PipelineRegistry&&) = delete;
+
+    /**
+     * @brief Get a variant, building it on the calling thread if nobody has yet
+     *
+     * Waits instead if the background builder is already working on it.
+     * @throws std::runtime_error if the variant failed to build
+     */
+    const VulkanPipeline& get(const PipelineConfig& config);
+
+    /**
+     * @brief Get a variant if it's built, otherwise queue it and return nullptr
+     *
+     * Variants that failed to build stay nullptr; the failure is logged once.
+     */
+    const VulkanPipeline* find(const PipelineConfig& config);
+
+    /**
+     * @brief Queue background builds for variants that will be needed later
+     */
+    void prewarm(const std::vector<PipelineConfig>& configs);
+
+private:
+    struct ConfigHash {
+        size_t operator()(const PipelineConfig& config) const { return config.hash(); }
+    };
+
+    struct Entry {
+        std::unique_ptr<VulkanPipeline> pipeline;  // Null while building
+        bool failed = false;                       // Build threw; never retried
+    };
+
+    VulkanDevice& device;
+    const VulkanSwapchain& swapchain;
+    std::string shaderPath;
+    vk::Format depthFormat;
+    vk::SampleCountFlagBits samples;
+    vk::PipelineLayout pipelineLayout;
+    vk::RenderPass renderPass;
+    PipelineCache& pipelineCache;
+
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable pipelineBuilt;
+    std::unordered_map<PipelineConfig, Entry, ConfigHash> entries;
+    std::deque<PipelineConfig> jobs;
+    vk::Pipeline basePipeline = nullptr;
+    bool stopping = false;
+
+    std::thread builder;
+
+    // Returns false if the variant already exists or is being built; call with mutex held
+    bool claim(const PipelineConfig& config);
+    void build(const PipelineConfig& config);
+    void builderLoop();
+};
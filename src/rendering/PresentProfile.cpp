@@ -0,0 +1,49 @@
+#include "PresentProfile.hpp"
+#include <array>
+
+namespace {
+    constexpr std::array PROFILES = {
+        PresentProfile::Balanced, PresentProfile::MaxThroughput,
+        PresentProfile::LowLatency, PresentProfile::PowerSaver
+    };
+}
+
+PresentProfileSettings getPresentProfileSettings(PresentProfile profile) {
+    switch (profile) {
+        case PresentProfile::MaxThroughput:
+            return { .present = { .presentModes = { vk::PresentModeKHR::eImmediate, vk::PresentModeKHR::eMailbox },
+                                  .minImageCount = 3 },
+                     .framesInFlight = 3 };
+        case PresentProfile::LowLatency:
+            // Mailbox needs a third image so rendering never waits for the one being scanned out
+            return { .present = { .presentModes = { vk::PresentModeKHR::eMailbox, vk::PresentModeKHR::eImmediate },
+                                  .minImageCount = 3 },
+                     .framesInFlight = 1 };
+        case PresentProfile::PowerSaver:
+            return { .present = { .presentModes = { vk::PresentModeKHR::eFifoRelaxed },
+                                  .minImageCount = 0 },
+                     .framesInFlight = 1 };
+        case PresentProfile::Balanced:
+            break;
+    }
+    return { .present = {}, .framesInFlight = 2 };
+}
+
+const char* getPresentProfileName(PresentProfile profile) {
+    switch (profile) {
+        case PresentProfile::MaxThroughput: return "max-throughput";
+        case PresentProfile::LowLatency: return "low-latency";
+        case PresentProfile::PowerSaver: return "power-saver";
+        case PresentProfile::Balanced: break;
+    }
+    return "balanced";
+}
+
+std::optional<PresentProfile> parsePresentProfile(std::string_view name) {
+    for (PresentProfile profile : PROFILES) {
+        if (name == getPresentProfileName(profile)) {
+            return profile;
+        }
+    }
+    return std::nullopt;
+}
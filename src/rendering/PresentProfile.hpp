@@ -0,0 +1,35 @@
+#pragma once
+
+#include "VulkanSwapchain.hpp"
+#include <optional>
+#include <string_view>
+
+/**
+ * @brief Named presentation trade-offs, switchable at runtime
+ */
+enum class PresentProfile {
+    Balanced,       // Mailbox, triple buffered, two frames in flight (the default)
+    MaxThroughput,  // Immediate (uncapped, may tear) with the deepest frame queue, for benchmarks
+    LowLatency,     // Mailbox or immediate with a single frame in flight
+    PowerSaver      // FIFO relaxed with the surface's minimum image count, for kiosks
+};
+
+/**
+ * @brief Everything a profile sets together
+ */
+struct PresentProfileSettings {
+    PresentConfig present;
+    uint32_t framesInFlight;
+};
+
+PresentProfileSettings getPresentProfileSettings(PresentProfile profile);
+
+/**
+ * @brief Command-line name of a profile, e.g. "max-throughput"
+ */
+const char* getPresentProfileName(PresentProfile profile);
+
+/**
+ * @brief Profile for a command-line name; empty if unknown
+ */
+std::optional<PresentProfile> parsePresentProfile(std::string_view name);
@@ -0,0 +1,128 @@
+#include "RenderTargets.hpp"
+#include <algorithm>
+#include <array>
+
+namespace {
+    // Whether one of the memory types allowed by typeBits is lazily allocated
+    bool hasLazyMemory(const vk::PhysicalDeviceMemoryProperties& properties, uint32_t typeBits) {
+        for (uint32_t i = 0; i < properties.memoryTypeCount; i++) {
+            if ((typeBits & (1u << i)) &&
+                (properties.memoryTypes[i].propertyFlags & vk::MemoryPropertyFlagBits::eLazilyAllocated)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool overlaps(const RenderTargetDesc& a, const RenderTargetDesc& b) {
+        return a.firstPass <= b.lastPass && b.firstPass <= a.lastPass;
+    }
+
+    // Targets bound to one allocation; only transient targets with disjoint passes share one
+    struct AliasGroup {
+        std::vector<RenderTargetId> members;
+        vk::MemoryRequirements requirements;
+        bool lazy = false;
+    };
+}
+
+RenderTargets::RenderTargets(VulkanDevice& device, vk::Extent2D extent, std::span<const RenderTargetDesc> descs)
+    : device(device), extent(extent) {
+    const vk::PhysicalDeviceMemoryProperties memoryProperties = device.getPhysicalDevice().getMemoryProperties();
+
+    std::vector<AliasGroup> groups;
+    for (RenderTargetId id = 0; id < descs.size(); id++) {
+        auto target = std::make_unique<RenderTarget>();
+        target->desc = descs[id];
+        target->extent = extent;
+
+        vk::ImageUsageFlags usage = target->desc.usage;
+        if (target->desc.transient) {
+            usage |= vk::ImageUsageFlagBits::eTransientAttachment;
+        }
+        target->image = vk::raii::Image(device.getDevice(), vk::ImageCreateInfo{
+            .imageType = vk::ImageType::e2D,
+            .format = target->desc.format,
+            .extent = { extent.width, extent.height, 1 },
+            .mipLevels = 1,
+            .arrayLayers = 1,
+            .samples = target->desc.samples,
+            .tiling = vk::ImageTiling::eOptimal,
+            .usage = usage,
+            .sharingMode = vk::SharingMode::eExclusive
+        });
+
+        const vk::MemoryRequirements requirements = target->image.getMemoryRequirements();
+        const bool lazy = target->desc.transient && hasLazyMemory(memoryProperties, requirements.memoryTypeBits);
+
+        // Join the first group whose members are all transient, used in other passes and
+        // placeable in a common memory type of the same kind
+        auto group = std::ranges::find_if(groups, [&](const AliasGroup& candidate) {
+            const uint32_t commonBits = candidate.requirements.memoryTypeBits & requirements.memoryTypeBits;
+            return target->desc.transient && candidate.lazy == lazy && commonBits != 0 &&
+                   hasLazyMemory(memoryProperties, commonBits) == lazy &&
+                   std::ranges::all_of(candidate.members, [&](RenderTargetId member) {
+                       return targets[member]->desc.transient && !overlaps(targets[member]->desc, target->desc);
+                   });
+        });
+        if (group == groups.end()) {
+            groups.push_back(AliasGroup{ .members = { id }, .requirements = requirements, .lazy = lazy });
+        } else {
+            group->members.push_back(id);
+            group->requirements.size = std::max(group->requirements.size, requirements.size);
+            group->requirements.alignment = std::max(group->requirements.alignment, requirements.alignment);
+            group->requirements.memoryTypeBits &= requirements.memoryTypeBits;
+        }
+
+        stats.targetCount++;
+        stats.transientCount += target->desc.transient ? 1 : 0;
+        stats.aliasedBytes += requirements.size;  // Less the memory actually bound, below
+        targets.push_back(std::move(target));
+    }
+
+    for (const AliasGroup& group : groups) {
+        const vk::MemoryPropertyFlags properties = group.lazy
+            ? vk::MemoryPropertyFlagBits::eDeviceLocal | vk::MemoryPropertyFlagBits::eLazilyAllocated
+            : vk::MemoryPropertyFlags(vk::MemoryPropertyFlagBits::eDeviceLocal);
+        memory.push_back(device.getAllocator().allocate(group.requirements, properties, false));
+        stats.bytes += group.requirements.size;
+
+        for (RenderTargetId member : group.members) {
+            RenderTarget& target = *targets[member];
+            target.image.bindMemory(memory.back().getMemory(), memory.back().getOffset());
+            target.lazilyAllocated = group.lazy;
+            stats.lazilyAllocatedCount += group.lazy ? 1 : 0;
+            target.imageView = vk::raii::ImageView(device.getDevice(), vk::ImageViewCreateInfo{
+                .image = *target.image,
+                .viewType = vk::ImageViewType::e2D,
+                .format = target.desc.format,
+                .subresourceRange = { target.desc.aspect, 0, 1, 0, 1 }
+            });
+        }
+    }
+    stats.aliasedBytes -= stats.bytes;
+}
+
+vk::SampleCountFlagBits RenderTargets::supportedSamples(VulkanDevice& device, uint32_t requested) {
+    const vk::PhysicalDeviceLimits limits = device.getPhysicalDevice().getProperties().limits;
+    const vk::SampleCountFlags usable = limits.framebufferColorSampleCounts & limits.framebufferDepthSampleCounts;
+
+    constexpr std::array counts = {
+        vk::SampleCountFlagBits::e64, vk::SampleCountFlagBits::e32, vk::SampleCountFlagBits::e16,
+        vk::SampleCountFlagBits::e8, vk::SampleCountFlagBits::e4, vk::SampleCountFlagBits::e2
+    };
+    for (vk::SampleCountFlagBits count : counts) {
+        if (static_cast<uint32_t>(count) <= requested && (usable & count)) {
+            return count;
+        }
+    }
+    return vk::SampleCountFlagBits::e1;
+}
+
+vk::ResolveModeFlagBits RenderTargets::depthResolveMode(VulkanDevice& device, vk::ResolveModeFlagBits preferred) {
+    const vk::ResolveModeFlags supported = device.getPhysicalDevice().getProperties2<
+        vk::PhysicalDeviceProperties2,
+        vk::PhysicalDeviceDepthStencilResolveProperties
+    >().get<vk::PhysicalDeviceDepthStencilResolveProperties>().supportedDepthResolveModes;
+    return (supported & preferred) ? preferred : vk::ResolveModeFlagBits::eSampleZero;
+}
@@ -0,0 +1,113 @@
+#pragma once
+
+#include "../utils/VulkanCommon.hpp"
+#include "../core/VulkanDevice.hpp"
+#include "../core/MemoryAllocator.hpp"
+#include <memory>
+#include <span>
+#include <vector>
+
+/**
+ * @brief What a render target holds and which passes of the frame use it
+ */
+struct RenderTargetDesc {
+    vk::Format format = vk::Format::eUndefined;
+    vk::ImageUsageFlags usage;  // Attachment usage, plus e.g. eSampled for stored targets
+    vk::ImageAspectFlags aspect = vk::ImageAspectFlagBits::eColor;
+    vk::SampleCountFlagBits samples = vk::SampleCountFlagBits::e1;
+    bool transient = false;     // Cleared or discarded on load and never stored
+    uint32_t firstPass = 0;     // Passes of the frame using it, in recording order; transient
+    uint32_t lastPass = 0;      // targets whose ranges don't overlap share memory
+};
+
+/**
+ * @brief Index of a target in the descriptions its RenderTargets was built from
+ */
+using RenderTargetId = uint32_t;
+
+/**
+ * @brief One attachment image and its view, with VulkanImage's accessors
+ */
+class RenderTarget {
+public:
+    vk::Image getImage() const { return *image; }
+    vk::ImageView getImageView() const { return *imageView; }
+    vk::Format getFormat() const { return desc.format; }
+    uint32_t getWidth() const { return extent.width; }
+    uint32_t getHeight() const { return extent.height; }
+    vk::SampleCountFlagBits getSamples() const { return desc.samples; }
+    bool isTransient() const { return desc.transient; }
+    bool isLazilyAllocated() const { return lazilyAllocated; }
+
+private:
+    friend class RenderTargets;
+
+    RenderTargetDesc desc;
+    vk::Extent2D extent;
+    vk::raii::Image image = nullptr;
+    vk::raii::ImageView imageView = nullptr;
+    bool lazilyAllocated = false;
+};
+
+/**
+ * @brief Memory bound to a RenderTargets' images
+ */
+struct RenderTargetStats {
+    uint32_t targetCount = 0;
+    uint32_t transientCount = 0;
+    uint32_t lazilyAllocatedCount = 0;  // Transient targets the device may never back with memory
+    vk::DeviceSize bytes = 0;           // Bound memory after aliasing, lazily allocated included
+    vk::DeviceSize aliasedBytes = 0;    // Saved by transient targets sharing memory
+};
+
+/**
+ * @brief The attachments of one swapchain size, allocated together
+ *
+ * Transient targets get eTransientAttachment usage and lazily allocated memory where
+ * the device has it: tile-based GPUs (Apple through MoltenVK, most mobile parts) then
+ * keep them in tile memory and never commit VRAM for them. Transient targets used by
+ * disjoint pass ranges are bound to the same memory, since neither's contents survive
+ * its passes; every pass must therefore start them from eUndefined.
+ *
+ * Sizes are fixed: a resize builds a new RenderTargets and retires the old one through
+ * the DeletionQueue, like the swapchain's other attachments.
+ */
+class RenderTargets {
+public:
+    /**
+     * @brief Create and bind every target at the extent
+     * @param device Vulkan device reference
+     * @param extent Size of every target
+     * @param descs Targets to create; their indices are the RenderTargetIds
+     */
+    RenderTargets(VulkanDevice& device, vk::Extent2D extent, std::span<const RenderTargetDesc> descs);
+
+    ~RenderTargets() = default;
+
+    // Disable copy and move (callers keep references to the targets)
+    RenderTargets(const RenderTargets&) = delete;
+    RenderTargets& operator=(const RenderTargets&) = delete;
+    RenderTargets(RenderTargets&&) = delete;
+    RenderTargets& operator=(RenderTargets&&) = delete;
+
+    const RenderTarget& get(RenderTargetId id) const { return *targets[id]; }
+    vk::Extent2D getExtent() const { return extent; }
+    const RenderTargetStats& getStats() const { return stats; }
+
+    /**
+     * @brief Highest sample count up to the requested one usable for color and depth attachments
+     */
+    static vk::SampleCountFlagBits supportedSamples(VulkanDevice& device, uint32_t requested);
+
+    /**
+     * @brief The preferred depth resolve mode if the device supports it, eSampleZero (always supported) otherwise
+     */
+    static vk::ResolveModeFlagBits depthResolveMode(VulkanDevice& device, vk::ResolveModeFlagBits preferred);
+
+private:
+    VulkanDevice& device;
+    vk::Extent2D extent;
+    std::vector<MemoryAllocation> memory;  // Declared first, so the images are destroyed before it
+    std::vector<std::unique_ptr<RenderTarget>> targets;
+    RenderTargetStats stats;
+};
@@ -1,116 +1,572 @@
 #include "Renderer.hpp"
 
-#define STB_IMAGE_IMPLEMENTATION
-#include <stb_image.h>
-
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
 #include <stdexcept>
+#include <tuple>
+
+namespace {
+    const PipelineConfig MESH_PIPELINE{};
+    const PipelineConfig PACKED_MESH_PIPELINE{ .vertexEntry = "vertPackedMain", .vertexFormat = VertexFormat::Packed };
+    const PipelineConfig INSTANCED_MESH_PIPELINE{ .vertexEntry = "vertInstancedMain", .instanced = true };
+    const PipelineConfig PACKED_INSTANCED_MESH_PIPELINE{
+        .vertexEntry = "vertPackedInstancedMain", .vertexFormat = VertexFormat::Packed, .instanced = true };
+    const PipelineConfig HEIGHTMAP_PIPELINE{ .vertexEntry = "vertHeightmapMain", .vertexFormat = VertexFormat::None };
+    const PipelineConfig HEIGHTMAP_TILE_PIPELINE{ .vertexEntry = "vertHeightmapTileMain", .vertexFormat = VertexFormat::None };
+    const PipelineConfig SCENE_PIPELINE{ .vertexEntry = "vertSceneMain", .vertexFormat = VertexFormat::Packed };
+
+    // Fixed ObjectData slots of the scene's objects
+    constexpr uint32_t MESH_OBJECT = 0;
+    constexpr uint32_t HEIGHTMAP_OBJECT = 1;
+    constexpr uint32_t SCENE_OBJECT = 2;
+
+    // Below this many tile draws per thread, a secondary buffer costs more than it saves
+    constexpr uint32_t MIN_TILE_DRAWS_PER_JOB = 256;
+
+    const std::array<vk::ClearValue, 2> CLEAR_VALUES = {
+        vk::ClearColorValue(0.0f, 0.0f, 0.0f, 1.0f),
+        vk::ClearDepthStencilValue(1.0f, 0)
+    };
+
+    // How the frame graph's passes use their resources
+    const ResourceUse COLOR_ATTACHMENT{
+        .stages = vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+        .access = vk::AccessFlagBits2::eColorAttachmentWrite,
+        .layout = vk::ImageLayout::eColorAttachmentOptimal
+    };
+    // Resolves write in the color output stage, also into a depth target
+    const ResourceUse DEPTH_ATTACHMENT{
+        .stages = vk::PipelineStageFlagBits2::eEarlyFragmentTests | vk::PipelineStageFlagBits2::eLateFragmentTests |
+                  vk::PipelineStageFlagBits2::eColorAttachmentOutput,
+        .access = vk::AccessFlagBits2::eDepthStencilAttachmentRead | vk::AccessFlagBits2::eDepthStencilAttachmentWrite |
+                  vk::AccessFlagBits2::eColorAttachmentWrite,
+        .layout = vk::ImageLayout::eDepthStencilAttachmentOptimal
+    };
+    const ResourceUse INDIRECT_READ{
+        .stages = vk::PipelineStageFlagBits2::eDrawIndirect,
+        .access = vk::AccessFlagBits2::eIndirectCommandRead
+    };
+    // GPU-culled tiles' neighbor steps, beside their indirect commands
+    const ResourceUse TILE_NEIGHBOR_READ{
+        .stages = vk::PipelineStageFlagBits2::eVertexShader,
+        .access = vk::AccessFlagBits2::eShaderRead
+    };
+    // The draw count is cleared by a transfer before the dispatch appends to it
+    const ResourceUse CULL_OUTPUT{
+        .stages = vk::PipelineStageFlagBits2::eTransfer | vk::PipelineStageFlagBits2::eComputeShader,
+        .access = vk::AccessFlagBits2::eTransferWrite | vk::AccessFlagBits2::eShaderWrite
+    };
+    const ResourceUse DEPTH_SAMPLED{
+        .stages = vk::PipelineStageFlagBits2::eComputeShader,
+        .access = vk::AccessFlagBits2::eShaderRead,
+        .layout = vk::ImageLayout::eShaderReadOnlyOptimal
+    };
+    // The pyramid stays in eGeneral: written as a storage image, read as a sampled one
+    const ResourceUse PYRAMID_READ{
+        .stages = vk::PipelineStageFlagBits2::eComputeShader,
+        .access = vk::AccessFlagBits2::eShaderRead,
+        .layout = vk::ImageLayout::eGeneral
+    };
+    const ResourceUse PYRAMID_WRITE{
+        .stages = vk::PipelineStageFlagBits2::eComputeShader,
+        .access = vk::AccessFlagBits2::eShaderRead | vk::AccessFlagBits2::eShaderWrite,
+        .layout = vk::ImageLayout::eGeneral
+    };
+}
 
 Renderer::Renderer(GLFWwindow* window,
                    const std::vector<const char*>& validationLayers,
-                   bool enableValidation)
+                   bool enableValidation,
+                   PresentProfile profile,
+                   uint32_t msaaSamples,
+                   const std::string& deviceSelector)
+    : Renderer(window, vk::Extent2D{}, validationLayers, enableValidation, profile, msaaSamples, deviceSelector) {
+}
+
+Renderer::Renderer(vk::Extent2D offscreenExtent,
+                   const std::vector<const char*>& validationLayers,
+                   bool enableValidation,
+                   PresentProfile profile,
+                   uint32_t msaaSamples,
+                   const std::string& deviceSelector)
+    : Renderer(nullptr, offscreenExtent, validationLayers, enableValidation, profile, msaaSamples, deviceSelector) {
+}
+
+Renderer::Renderer(GLFWwindow* window,
+                   vk::Extent2D offscreenExtent,
+                   const std::vector<const char*>& validationLayers,
+                   bool enableValidation,
+                   PresentProfile profile,
+                   uint32_t requestedSamples,
+                   const std::string& deviceSelector)
     : window(window),
+      presentProfile(profile),
+      framesInFlight(getPresentProfileSettings(profile).framesInFlight),
       startTime(std::chrono::high_resolution_clock::now()) {
 
-    // Create Vulkan device
-    device = std::make_unique<VulkanDevice>(validationLayers, enableValidation);
-    device->createSurface(window);
+    // Create Vulkan device; without a window it is headless
+    device = std::make_unique<VulkanDevice>(validationLayers, enableValidation, window == nullptr, deviceSelector);
+    if (window) {
+        device->createSurface(window);
+    }
     device->createLogicalDevice();
 
-    // Create swapchain
-    swapchain = std::make_unique<VulkanSwapchain>(*device, window);
+    // Create swapchain, or one offscreen target per frame slot so none is reused while in flight
+    if (window) {
+        swapchain = std::make_unique<VulkanSwapchain>(*device, window, getPresentProfileSettings(profile).present);
+    } else {
+        swapchain = std::make_unique<VulkanSwapchain>(*device, offscreenExtent, MAX_FRAMES_IN_FLIGHT);
+    }
 
-    // Create depth resources
-    createDepthResources();
+    // MSAA resolves within the pass, which the render pass fallback doesn't set up; the depth
+    // resolve into GpuCulling's depth prefers the farthest sample, keeping occlusion conservative
+    if (swapchain->usesDynamicRendering()) {
+        msaaSamples = RenderTargets::supportedSamples(*device, requestedSamples);
+        if (msaaSamples != vk::SampleCountFlagBits::e1) {
+            depthResolveMode = RenderTargets::depthResolveMode(*device, vk::ResolveModeFlagBits::eMax);
+        }
+    }
+    if (static_cast<uint32_t>(msaaSamples) != std::max(requestedSamples, 1u)) {
+        std::cout << "MSAA: " << requestedSamples << "x requested, using " << static_cast<uint32_t>(msaaSamples)
+                  << "x" << (swapchain->usesDynamicRendering() ? "" : " (render pass fallback)") << std::endl;
+    }
 
-    // Platform-specific pipeline creation
-#ifdef __linux__
-    // Linux: Create render pass and framebuffers for traditional rendering
-    swapchain->createRenderPass(findDepthFormat());
-    std::vector<vk::ImageView> depthViews(swapchain->getImageCount(), depthImage->getImageView());
-    swapchain->createFramebuffers(depthViews);
+    // Depth is only read back once a scene with GPU culling loads, except on the fallback
+    depthReadback = !swapchain->usesDynamicRendering();
+    createFrameGraph();
+    const RenderTargetStats& targetStats = frameGraph->getTargetStats();
+    std::cout << "Render targets: " << targetStats.targetCount << " (" << targetStats.transientCount << " transient, "
+              << targetStats.lazilyAllocatedCount << " lazily allocated), "
+              << std::fixed << std::setprecision(1) << static_cast<double>(targetStats.bytes) / (1024.0 * 1024.0) << " MB, "
+              << static_cast<double>(targetStats.aliasedBytes) / (1024.0 * 1024.0) << " MB saved by aliasing, "
+              << static_cast<uint32_t>(msaaSamples) << "x MSAA" << std::endl;
+
+    // Descriptor layout shared by every pipeline
+    descriptors = std::make_unique<BindlessDescriptors>(*device, MAX_FRAMES_IN_FLIGHT);
+    std::cout << "Textures: " << (descriptors->isBindless()
+                                  ? "bindless array"
+                                  : "one descriptor set each (no descriptor indexing)")
+              << ", " << descriptors->getTextureCapacity() << " slots" << std::endl;
+
+    // Pipelines compile through the persistent cache; time them to track cold starts
+    pipelineCache = std::make_unique<PipelineCache>(*device);
+    auto pipelineStart = std::chrono::steady_clock::now();
+
+    // Dynamic rendering where the device supports it, a render pass and framebuffers otherwise
+    if (!swapchain->usesDynamicRendering()) {
+        swapchain->createRenderPass(findDepthFormat());
+        std::vector<vk::ImageView> depthViews(swapchain->getImageCount(), frameGraph->getTarget(*depthTarget).getImageView());
+        swapchain->createFramebuffers(depthViews);
+    }
+    std::cout << "Rendering: " << (swapchain->usesDynamicRendering()
+                                   ? "dynamic rendering"
+                                   : "render pass (no dynamic rendering/synchronization2)") << std::endl;
 
-    // Create pipeline with render pass
-    pipeline = std::make_unique<VulkanPipeline>(
-        *device, *swapchain, "shaders/slang.spv", findDepthFormat(), swapchain->getRenderPass());
-#else
-    // macOS/Windows: Create pipeline with dynamic rendering
-    pipeline = std::make_unique<VulkanPipeline>(
-        *device, *swapchain, "shaders/slang.spv", findDepthFormat());
-#endif
+    pipelines = std::make_unique<PipelineRegistry>(
+        *device, *swapchain, descriptors->getShaderPath(), findDepthFormat(), msaaSamples, descriptors->getPipelineLayout(),
+        swapchain->usesDynamicRendering() ? nullptr : swapchain->getRenderPass(), *pipelineCache);
+
+    // Filled variants are needed for the first frame; the rest build in the background
+    for (const PipelineConfig* config : { &MESH_PIPELINE, &PACKED_MESH_PIPELINE, &HEIGHTMAP_PIPELINE }) {
+        pipelines->get(*config);
+    }
+
+    double pipelineMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - pipelineStart).count();
+    std::cout << "Pipelines: created in " << std::fixed << std::setprecision(1) << pipelineMs << " ms ("
+              << (pipelineCache->isWarm()
+                  ? "warm cache, " + std::to_string(pipelineCache->getLoadedBytes() / 1024) + " KB loaded"
+                  : std::string("cold, no usable cache")) << ")" << std::endl;
+
+    wireframeSupported = device->getCapabilities().fillModeNonSolid;
+    pipelines->prewarm({
+        SCENE_PIPELINE,
+        withRenderMode(SCENE_PIPELINE, RenderMode::Wireframe, false),
+        withRenderMode(MESH_PIPELINE, RenderMode::Wireframe, false),
+        withRenderMode(PACKED_MESH_PIPELINE, RenderMode::Wireframe, false),
+        PACKED_INSTANCED_MESH_PIPELINE,
+        withRenderMode(PACKED_INSTANCED_MESH_PIPELINE, RenderMode::Wireframe, false),
+        withRenderMode(HEIGHTMAP_PIPELINE, RenderMode::Wireframe, true),
+        withRenderMode(HEIGHTMAP_PIPELINE, RenderMode::Lines, true),
+        HEIGHTMAP_TILE_PIPELINE,
+        withRenderMode(HEIGHTMAP_TILE_PIPELINE, RenderMode::Wireframe, true),
+        withRenderMode(HEIGHTMAP_TILE_PIPELINE, RenderMode::Lines, true)
+    });
 
     // Create command manager
     commandManager = std::make_unique<CommandManager>(
         *device, device->getGraphicsQueueFamily(), MAX_FRAMES_IN_FLIGHT);
+    recorder = std::make_unique<ParallelRecorder>(
+        *device, device->getGraphicsQueueFamily(), MAX_FRAMES_IN_FLIGHT);
+    if (GpuProfiler::isSupported(*device)) {
+        profiler = std::make_unique<GpuProfiler>(*device, MAX_FRAMES_IN_FLIGHT);
+    }
 
-    // Create uniform buffers
-    createUniformBuffers();
-
-    // Create descriptor pool and sets
-    createDescriptorPool();
-    createDescriptorSets();
+    // Create persistently mapped staging ring and the upload manager that stages through it
+    stagingRing = std::make_unique<StagingRing>(*device);
+    uniformAlignment = device->getPhysicalDevice().getProperties().limits.minUniformBufferOffsetAlignment;
+    storageAlignment = device->getPhysicalDevice().getProperties().limits.minStorageBufferOffsetAlignment;
+    uploadManager = std::make_unique<UploadManager>(*device, *stagingRing);
+    gridIndexCache = std::make_unique<GridIndexCache>(*device, *uploadManager);
+    terrainCompute = std::make_unique<TerrainCompute>(*device, "shaders/terrain.spv", pipelineCache->getHandle());
+    std::cout << "Terrain compute: " << (terrainCompute->isAsync()
+        ? "async compute queue (family " + std::to_string(device->getComputeQueueFamily()) + ")"
+        : std::string("graphics queue")) << std::endl;
+    jobSystem = std::make_unique<JobSystem>();
+    textureLoader = std::make_unique<TextureLoader>(*device, *uploadManager, *jobSystem);
+
+    // Point the per-frame sets at the ring by the first frame; heightmap buffers are added by loadModel
+    updateFrameSets();
+
+    // White 1x1 texture until (or instead of) loadTexture, so vertex colors show through
+    createDefaultTexture();
 
     // Create sync manager
     syncManager = std::make_unique<SyncManager>(
         *device, MAX_FRAMES_IN_FLIGHT, swapchain->getImageCount());
+    std::cout << "Frame sync: " << (syncManager->usesTimeline() ? "timeline semaphore" : "fences") << std::endl;
+    logPresentProfile();
 }
 
-void Renderer::loadModel(const std::string& modelPath) {
-    mesh = std::make_unique<Mesh>(*device, *commandManager);
-    mesh->loadFromOBJ(modelPath);
+void Renderer::loadModel(const std::string& modelPath, bool liveHeightmap) {
+    const uint64_t generation = ++modelGeneration;
+    pendingLoads++;
+    JobSystem* jobs = jobSystem.get();
+
+    if (modelPath.ends_with(".fdf")) {
+        jobs->submit([this, jobs, modelPath, liveHeightmap, generation] {
+            auto data = std::make_shared<HeightmapData>();
+            FDFLoadStats stats{};
+            std::string error;
+            try {
+                stats = FDFLoader::loadHeightmap(modelPath, *data);
+            } catch (const std::exception& e) {
+                error = e.what();
+            }
+
+            jobs->publish([this, modelPath, data, stats, error, liveHeightmap, generation] {
+                pendingLoads--;
+                if (generation != modelGeneration) {
+                    return;
+                }
+                if (!error.empty()) {
+                    // A bad file shouldn't take the running scene down with it
+                    std::cerr << "Failed to load " << modelPath << ": " << error << "; keeping the current scene" << std::endl;
+                    return;
+                }
+
+                retireModel();
+                heightmap = std::make_unique<Heightmap>(*device, *uploadManager, *gridIndexCache, *terrainCompute);
+                heightmap->setUpdatable(liveHeightmap);
+                // Without multi-draw every tile would be its own indirect call; selectTiles does better
+                heightmap->setGpuCulled(device->getCapabilities().multiDrawIndirect);
+                heightmap->setData(*data);
+                if (heightmap->isGpuCulled()) {
+                    terrainCulling = std::make_unique<TerrainCulling>(*device, "shaders/culling.spv", *heightmap,
+                                                                      MAX_FRAMES_IN_FLIGHT, pipelineCache->getHandle());
+                }
+
+                // What the same grid would cost as expanded vertices plus 32-bit indices
+                const double expandedBytes = static_cast<double>(stats.width) * stats.height * sizeof(Vertex) +
+                    static_cast<double>(stats.width - 1) * (stats.height - 1) * 6 * sizeof(uint32_t);
+                const double mib = 1024.0 * 1024.0;
+                std::cout << "FDF: " << stats.width << "x" << stats.height << " points, "
+                          << std::fixed << std::setprecision(1)
+                          << static_cast<double>(stats.fileBytes) / mib << " MB parsed in "
+                          << stats.parseSeconds * 1000.0 << " ms (" << stats.throughputMBps() << " MB/s, "
+                          << stats.threadCount << " threads), "
+                          << static_cast<double>(heightmap->getGpuBytes()) / mib << " MB on GPU ("
+                          << expandedBytes / mib << " MB as vertices), tiles culled "
+                          << (!terrainCulling ? "on the CPU"
+                              : terrainCulling->compactsDraws() ? "on the GPU, compacted count draw"
+                              : "on the GPU") << std::endl;
+                updateFrameSets();
+            });
+        });
+        return;
+    }
+
+    jobs->submit([this, jobs, modelPath, generation] {
+        // Quantized vertices halve vertex fetch bandwidth
+        auto blobs = std::make_shared<MeshBlobs>();
+        std::string error;
+        auto loadStart = std::chrono::steady_clock::now();
+        try {
+            *blobs = Mesh::parseOBJ(modelPath, VertexFormat::Packed, MeshOptimizationOptions{ .overdraw = true });
+        } catch (const std::exception& e) {
+            error = e.what();
+        }
+        double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+
+        jobs->publish([this, modelPath, blobs, error, loadMs, generation] {
+            pendingLoads--;
+            if (generation != modelGeneration) {
+                return;
+            }
+            if (!error.empty()) {
+                std::cerr << "Failed to load " << modelPath << ": " << error << "; keeping the current scene" << std::endl;
+                return;
+            }
+
+            retireModel();
+            mesh = std::make_unique<Mesh>(*device, *uploadManager, VertexFormat::Packed);
+            mesh->setBlobs(*blobs);
+            std::cout << "OBJ: " << mesh->getVertexCount() << " vertices, " << mesh->getIndexCount() << " indices in "
+                      << std::fixed << std::setprecision(1) << loadMs << " ms ("
+                      << (blobs->cached ? "mesh cache hit" : "parsed, cache written") << ")" << std::endl;
+            if (const auto& optimized = mesh->getOptimizationStats()) {
+                std::cout << "OBJ: ACMR " << std::setprecision(3) << optimized->acmrBefore << " -> "
+                          << optimized->acmrAfter << " (optimized in " << std::setprecision(1)
+                          << optimized->seconds * 1000.0 << " ms)" << std::endl;
+            }
+            updateFrameSets();
+        });
+    });
 }
 
-void Renderer::loadTexture(const std::string& texturePath) {
-    int texWidth, texHeight, texChannels;
-    stbi_uc* pixels = stbi_load(texturePath.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
-    vk::DeviceSize imageSize = texWidth * texHeight * 4;
+void Renderer::retireModel() {
+    // Frames in flight still draw the old model, and their sets point at its heights;
+    // it outlives them, and each slot's set moves to the new one before the slot is reused
+    deletionQueue.retire(frameSerial, std::move(terrainCulling));
+    deletionQueue.retire(frameSerial, std::move(heightmap));
+    deletionQueue.retire(frameSerial, std::move(mesh));
+}
 
-    if (!pixels) {
-        throw std::runtime_error("failed to load texture image: " + texturePath);
+void Renderer::loadScene(const std::vector<std::string>& modelPaths, uint32_t instancesPerMesh) {
+    const uint64_t generation = ++sceneGeneration;
+    if (modelPaths.empty() || instancesPerMesh == 0) {
+        buildScene({}, 0);
+        return;
     }
 
-    // Create staging buffer
-    VulkanBuffer stagingBuffer(*device, imageSize,
-        vk::BufferUsageFlagBits::eTransferSrc,
-        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    pendingLoads++;
+    JobSystem* jobs = jobSystem.get();
+    auto loadStart = std::chrono::steady_clock::now();
+    jobs->submit([this, jobs, modelPaths, instancesPerMesh, generation, loadStart] {
+        // One parse per distinct file; two parses of a file would race writing its cache
+        std::vector<std::string> files = modelPaths;
+        std::sort(files.begin(), files.end());
+        files.erase(std::unique(files.begin(), files.end()), files.end());
+
+        auto parsed = std::make_shared<std::vector<MeshBlobs>>(files.size());
+        std::vector<std::string> errors(files.size());
+        JobGroup parses;
+        for (size_t i = 0; i < files.size(); i++) {
+            jobs->submit([&, i] {
+                try {
+                    (*parsed)[i] = Mesh::parseOBJ(files[i], VertexFormat::Packed, MeshOptimizationOptions{ .overdraw = true });
+                } catch (const std::exception& e) {
+                    errors[i] = e.what();
+                }
+            }, &parses);
+        }
+        jobs->wait(parses);
 
-    stagingBuffer.map();
-    stagingBuffer.copyData(pixels, imageSize);
-    stagingBuffer.unmap();
+        std::string error;
+        for (const std::string& message : errors) {
+            if (!message.empty()) {
+                error = message;
+                break;
+            }
+        }
 
-    stbi_image_free(pixels);
+        jobs->publish([this, modelPaths, files = std::move(files), parsed, error, instancesPerMesh, generation, loadStart] {
+            pendingLoads--;
+            if (generation != sceneGeneration) {
+                return;
+            }
+            if (!error.empty()) {
+                std::cerr << "Failed to load scene: " << error << "; keeping the current scene" << std::endl;
+                return;
+            }
 
-    // Create texture image
-    textureImage = std::make_unique<VulkanImage>(*device,
-        texWidth, texHeight,
-        vk::Format::eR8G8B8A8Srgb,
-        vk::ImageTiling::eOptimal,
-        vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
-        vk::MemoryPropertyFlagBits::eDeviceLocal,
-        vk::ImageAspectFlagBits::eColor);
+            std::vector<const MeshBlobs*> meshes;
+            for (const std::string& path : modelPaths) {
+                meshes.push_back(&(*parsed)[std::lower_bound(files.begin(), files.end(), path) - files.begin()]);
+            }
+            buildScene(meshes, instancesPerMesh);
+
+            double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - loadStart).count();
+            std::cout << "Scene: " << scene->getMeshCount() << " meshes, " << scene->getInstanceCount()
+                      << " instances in " << std::fixed << std::setprecision(1) << loadMs << " ms, "
+                      << static_cast<double>(scene->getGpuBytes()) / (1024.0 * 1024.0) << " MB on GPU, "
+                      << (!culling ? "no GPU culling (drawIndexed fallback)"
+                          : culling->compactsDraws() ? "GPU frustum and occlusion culling, compacted count draws"
+                          : "GPU frustum and occlusion culling") << std::endl;
+        });
+    });
+}
 
-    // Transition and copy
-    auto commandBuffer = commandManager->beginSingleTimeCommands();
-    textureImage->transitionLayout(*commandBuffer, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal);
-    textureImage->copyFromBuffer(*commandBuffer, stagingBuffer);
-    textureImage->transitionLayout(*commandBuffer, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal);
-    commandManager->endSingleTimeCommands(*commandBuffer);
+void Renderer::buildScene(const std::vector<const MeshBlobs*>& meshes, uint32_t instancesPerMesh) {
+    // Like retireModel; culling sets retired earlier are queued ahead of the pool they belong to
+    deletionQueue.retire(frameSerial, std::move(culling));
+    deletionQueue.retire(frameSerial, std::move(scene));
+    if (cullPass) {
+        frameGraph->bindImage(pyramidImage, nullptr);  // A new pyramid may get the old handle back
+    }
+    if (meshes.empty() || instancesPerMesh == 0) {
+        setDepthReadback(false);
+        updateFrameSets();
+        return;
+    }
+
+    scene = std::make_unique<MeshScene>(*device, *uploadManager);
+    std::vector<uint32_t> meshIds;
+    for (const MeshBlobs* blobs : meshes) {
+        meshIds.push_back(scene->addMesh(blobs->view));
+    }
+
+    // Square grid over [-1, 1]^2, each mesh scaled to fit its cell. Instances are added
+    // mesh by mesh, so the drawIndexed fallback draws each mesh's copies in one call
+    const uint32_t total = static_cast<uint32_t>(meshIds.size()) * instancesPerMesh;
+    const uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(total))));
+    const float cell = 2.0f / static_cast<float>(side);
+    for (uint32_t i = 0; i < total; i++) {
+        const SceneMesh& mesh = scene->getMesh(meshIds[i / instancesPerMesh]);
+        const glm::vec3 center = glm::vec3(mesh.quantization.positionCenter);
+        const glm::vec3 extent = glm::vec3(mesh.quantization.positionExtent);
+        const float scale = 0.45f * cell / std::max({ extent.x, extent.y, extent.z });
+        const glm::vec3 cellCenter(-1.0f + (static_cast<float>(i % side) + 0.5f) * cell,
+                                   -1.0f + (static_cast<float>(i / side) + 0.5f) * cell, 0.0f);
+        scene->addInstance(meshIds[i / instancesPerMesh],
+            glm::translate(glm::mat4(1.0f), cellCenter) * glm::scale(glm::mat4(1.0f), glm::vec3(scale)) *
+            glm::translate(glm::mat4(1.0f), -center));
+    }
+    scene->commit();
+
+    // Without multi-draw the fallback draws from the CPU commands, which the GPU can't cull
+    setDepthReadback(scene->drawsIndirect());
+    if (scene->drawsIndirect()) {
+        culling = std::make_unique<GpuCulling>(*device, "shaders/culling.spv", *scene, frameGraph->getTarget(*depthTarget),
+                                               MAX_FRAMES_IN_FLIGHT, pipelineCache->getHandle());
+    }
+
+    updateFrameSets();
+}
+
+void Renderer::setModelInstances(uint32_t count) {
+    if (!modelInstances) {
+        if (count == 0) {
+            return;
+        }
+        modelInstances = std::make_unique<MeshInstances>(*device, MAX_FRAMES_IN_FLIGHT);
+    }
+    if (count > modelInstances->getCapacity()) {
+        throw std::invalid_argument("model instance count exceeds MeshInstances capacity");
+    }
+
+    // Square grid over [-1, 1]^2 like loadScene's; the model is about unit size, so it fills its cell
+    modelInstances->clear();
+    const uint32_t side = static_cast<uint32_t>(std::ceil(std::sqrt(static_cast<double>(count))));
+    const float cell = 2.0f / static_cast<float>(std::max(side, 1u));
+    for (uint32_t i = 0; i < count; i++) {
+        const glm::vec3 cellCenter(-1.0f + (static_cast<float>(i % side) + 0.5f) * cell,
+                                   -1.0f + (static_cast<float>(i / side) + 0.5f) * cell, 0.0f);
+        const float hue = static_cast<float>(i) / static_cast<float>(count);
+        const glm::vec3 tint = glm::clamp(
+            glm::abs(glm::fract(glm::vec3(hue) + glm::vec3(0.0f, 2.0f, 1.0f) / 3.0f) * 6.0f - 3.0f) - 1.0f, 0.0f, 1.0f);
+        modelInstances->add(glm::translate(glm::mat4(1.0f), cellCenter) * glm::scale(glm::mat4(1.0f), glm::vec3(0.5f * cell)),
+                            glm::vec4(glm::mix(glm::vec3(1.0f), tint, 0.5f), 1.0f));
+    }
+    std::cout << "Model: " << count << " instances in one instanced draw" << std::endl;
+}
+
+void Renderer::loadTexture(const std::string& texturePath) {
+    // Bound in drawFrame once decoded and uploaded; the current texture stays until then
+    pendingTexture = textureLoader->acquire(texturePath);
+}
 
-    // Create sampler
-    textureImage->createSampler();
+bool Renderer::isSceneReady() const {
+    return pendingLoads == 0 && !pendingTexture && texture && textureLoader->isReady(*texture) &&
+        (!mesh || mesh->isReady()) && (!heightmap || heightmap->isReady());
+}
+
+std::string Renderer::getDeviceName() const {
+    return std::string(device->getPhysicalDevice().getProperties().deviceName.data());
+}
 
-    // Update descriptor sets with texture
-    updateDescriptorSets();
+void Renderer::waitForNextFrame() {
+    CpuScope scope(&cpuProfiler, FramePhase::FenceWait);
+    if (lowLatency) {
+        // The last submitted frame finishes last; once it has, the GPU is idle
+        syncManager->waitForFrame(lastSubmittedFrame, frameSerials[lastSubmittedFrame]);
+    }
+    syncManager->waitForFrame(currentFrame, frameSerials[currentFrame]);
 }
 
 void Renderer::drawFrame() {
-    // Wait for the current frame's fence
-    syncManager->waitForFence(currentFrame);
+    // A profile requested during input polling is applied between frames
+    if (pendingPresentProfile) {
+        PresentProfile profile = *pendingPresentProfile;
+        pendingPresentProfile.reset();
+        setPresentProfile(profile);
+    }
+
+    // Wait for the slot's previous frame (returns at once after waitForNextFrame)
+    {
+        CpuScope scope(&cpuProfiler, FramePhase::FenceWait);
+        syncManager->waitForFrame(currentFrame, frameSerials[currentFrame]);
+    }
+    // Frames complete in submission order, so every frame up to the slot's has retired.
+    // A slot taken into use after a frames-in-flight change may hold an older serial
+    retiredSerial = std::max(retiredSerial, frameSerials[currentFrame]);
+
+    // The slot's previous frame has retired; recycle its ring space, secondary buffers and finished upload batches
+    stagingRing->retireFrames(retiredSerial);
+    recorder->resetFrame(currentFrame);
+    if (profiler) {
+        profiler->collect(currentFrame);
+    }
+    if (terrainCulling) {
+        terrainCulling->collect(currentFrame);
+    }
+    uploadManager->collect();
+    terrainCompute->collect();
+
+    // Swap in finished model and scene loads before anything reads them this frame
+    jobSystem->runPublished();
+    if (scene) {
+        scene->update();
+    }
+    if (heightmap) {
+        heightmap->update(retiredSerial, frameSerial);
+    }
+
+    descriptors->retireFrames(retiredSerial);
+    deletionQueue.retireFrames(retiredSerial);
+
+    // Swap in a requested texture once uploaded. It goes into a free slot, so frames
+    // in flight keep sampling the old one, whose slot frees once they've retired
+    textureLoader->update();
+    if (pendingTexture && textureLoader->isReady(*pendingTexture)) {
+        descriptors->releaseTexture(textureSlot, frameSerial);
+        textureSlot = descriptors->addTexture(pendingTexture);
+        texture = std::move(pendingTexture);
+    } else if (pendingTexture && pendingTexture->failed) {
+        pendingTexture.reset();
+    }
+
+    // Point the slot's set at buffers replaced since it was last recorded
+    if (frameSetsDirty[currentFrame]) {
+        writeFrameSet(currentFrame);
+    }
+
+    // Resizes since the last frame are applied at once
+    if (swapchainDirty) {
+        recreateSwapchain();
+    }
 
     // Acquire next swapchain image
-    auto [result, imageIndex] = swapchain->acquireNextImage(
-        UINT64_MAX,
-        syncManager->getImageAvailableSemaphore(currentFrame),
-        nullptr);
+    vk::Result result;
+    uint32_t imageIndex;
+    {
+        CpuScope scope(&cpuProfiler, FramePhase::Acquire);
+        std::tie(result, imageIndex) = swapchain->acquireNextImage(
+            UINT64_MAX,
+            syncManager->getImageAvailableSemaphore(currentFrame),
+            nullptr);
+    }
 
     if (result == vk::Result::eErrorOutOfDateKHR) {
         recreateSwapchain();
@@ -120,47 +576,99 @@ void Renderer::drawFrame() {
         throw std::runtime_error("failed to acquire swap chain image!");
     }
 
-    updateUniformBuffer(currentFrame);
+    frameSerials[currentFrame] = ++frameSerial;
+    {
+        CpuScope scope(&cpuProfiler, FramePhase::Update);
+        updateUniformBuffer(currentFrame);
+        updateObjects(currentFrame);
+        if (modelInstances) {
+            modelInstances->update(currentFrame);
+        }
+    }
 
-    // Reset fence and record command buffer
-    syncManager->resetFence(currentFrame);
-    commandManager->getCommandBuffer(currentFrame).reset();
-    recordCommandBuffer(imageIndex);
+    // Record and submit; the submission signals the frame's serial
+    {
+        CpuScope scope(&cpuProfiler, FramePhase::Record);
+        commandManager->getCommandBuffer(currentFrame).reset();
+        recordCommandBuffer(imageIndex);
+    }
+    {
+        CpuScope scope(&cpuProfiler, FramePhase::Submit);
+        syncManager->submitFrame(device->getGraphicsQueue(), *commandManager->getCommandBuffer(currentFrame),
+                                 currentFrame, imageIndex, frameSerial, !swapchain->isOffscreen());
+    }
 
-    // Submit command buffer
-    vk::PipelineStageFlags waitDestinationStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput);
-    vk::Semaphore waitSemaphores[] = { syncManager->getImageAvailableSemaphore(currentFrame) };
-    vk::Semaphore signalSemaphores[] = { syncManager->getRenderFinishedSemaphore(imageIndex) };
+    // Offscreen targets are only rendered
+    if (!swapchain->isOffscreen()) {
+        present(imageIndex);
+    }
 
-    const vk::SubmitInfo submitInfo{
-        .waitSemaphoreCount = 1,
-        .pWaitSemaphores = waitSemaphores,
-        .pWaitDstStageMask = &waitDestinationStageMask,
-        .commandBufferCount = 1,
-        .pCommandBuffers = &*commandManager->getCommandBuffer(currentFrame),
-        .signalSemaphoreCount = 1,
-        .pSignalSemaphores = signalSemaphores
-    };
-    device->getGraphicsQueue().submit(submitInfo, syncManager->getInFlightFence(currentFrame));
+    lastSubmittedFrame = currentFrame;
+    currentFrame = (currentFrame + 1) % framesInFlight;
+    cpuProfiler.endFrame();
+}
 
-    // Present
+void Renderer::present(uint32_t imageIndex) {
     vk::SwapchainKHR swapchainHandle = swapchain->getSwapchain();
+    vk::Semaphore renderFinished = syncManager->getRenderFinishedSemaphore(imageIndex);
     const vk::PresentInfoKHR presentInfoKHR{
         .waitSemaphoreCount = 1,
-        .pWaitSemaphores = signalSemaphores,
+        .pWaitSemaphores = &renderFinished,
         .swapchainCount = 1,
         .pSwapchains = &swapchainHandle,
         .pImageIndices = &imageIndex
     };
-    result = device->getGraphicsQueue().presentKHR(presentInfoKHR);
+    vk::Result result;
+    {
+        CpuScope scope(&cpuProfiler, FramePhase::Present);
+        result = device->getGraphicsQueue().presentKHR(presentInfoKHR);
+    }
 
     if (result == vk::Result::eErrorOutOfDateKHR || result == vk::Result::eSuboptimalKHR) {
-        recreateSwapchain();
+        swapchainDirty = true;
     } else if (result != vk::Result::eSuccess) {
         throw std::runtime_error("failed to present swap chain image!");
     }
+}
+
+void Renderer::setPresentProfile(PresentProfile profile) {
+    PresentProfileSettings settings = getPresentProfileSettings(profile);
+    presentProfile = profile;
+    setFramesInFlight(settings.framesInFlight);
+    swapchain->setPresentConfig(settings.present);
+    recreateSwapchain();
+    logPresentProfile();
+}
 
-    currentFrame = (currentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+void Renderer::logPresentProfile() const {
+    if (swapchain->isOffscreen()) {
+        std::cout << "Offscreen: " << swapchain->getExtent().width << "x" << swapchain->getExtent().height << ", "
+                  << framesInFlight << " frames in flight" << std::endl;
+        return;
+    }
+    std::cout << "Present profile: " << getPresentProfileName(presentProfile) << " ("
+              << vk::to_string(swapchain->getPresentMode()) << ", " << swapchain->getImageCount() << " images, "
+              << framesInFlight << " frames in flight)" << std::endl;
+}
+
+void Renderer::setFramesInFlight(uint32_t count) {
+    if (count == 0 || count > MAX_FRAMES_IN_FLIGHT) {
+        throw std::invalid_argument("frames in flight must be between 1 and " + std::to_string(MAX_FRAMES_IN_FLIGHT));
+    }
+    if (count == framesInFlight) {
+        return;
+    }
+    // Nothing is drained: frames left in slots beyond the new count retire by their
+    // serials (waitIdle covers every slot at teardown), and slots added have none
+    // in flight. Continue from the used slot holding the oldest frame, which is the
+    // cheapest to wait for
+    framesInFlight = count;
+    currentFrame = 0;
+    for (uint32_t frame = 1; frame < count; frame++) {
+        if (frameSerials[frame] < frameSerials[currentFrame]) {
+            currentFrame = frame;
+        }
+    }
 }
 
 void Renderer::waitIdle() {
@@ -168,111 +676,187 @@ void Renderer::waitIdle() {
 }
 
 void Renderer::handleFramebufferResize() {
-    recreateSwapchain();
+    // Resize events arrive many times per frame while dragging; rebuild once, before the next acquire
+    swapchainDirty = true;
 }
 
-void Renderer::createDepthResources() {
-    vk::Format depthFormat = findDepthFormat();
+void Renderer::createFrameGraph() {
+    const vk::Format depthFormat = findDepthFormat();
+    const bool multisampled = msaaSamples != vk::SampleCountFlagBits::e1;
+    const bool dynamicRendering = swapchain->usesDynamicRendering();
+
+    // Synchronization2 comes with dynamic rendering
+    frameGraph = std::make_unique<FrameGraph>(dynamicRendering);
+
+    // Acquired images are waited on in the color output stage and don't keep their contents
+    swapchainImage = frameGraph->importImage("swapchain", { vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 },
+        { .stages = vk::PipelineStageFlagBits2::eColorAttachmentOutput, .layout = vk::ImageLayout::eUndefined },
+        swapchain->getFinalLayout());
+    const FrameGraphResource culledDraws = frameGraph->importBuffer("culled draws");
+    const FrameGraphResource terrainDraws = frameGraph->importBuffer("terrain draws");
+
+    // The graph fills in the pass ranges, so transient targets share memory across passes
+    depthTarget.reset();
+    msaaColorTarget.reset();
+    msaaDepthTarget.reset();
+    if (multisampled) {
+        msaaColorTarget = frameGraph->createTarget("msaa color", {
+            .format = swapchain->getFormat(), .usage = vk::ImageUsageFlagBits::eColorAttachment,
+            .samples = msaaSamples, .transient = true });
+        msaaDepthTarget = frameGraph->createTarget("msaa depth", {
+            .format = depthFormat, .usage = vk::ImageUsageFlagBits::eDepthStencilAttachment,
+            .aspect = vk::ImageAspectFlagBits::eDepth, .samples = msaaSamples, .transient = true });
+    }
+    if (depthReadback) {
+        // Sampled by GpuCulling's depth pyramid reduction
+        depthTarget = frameGraph->createTarget("depth", {
+            .format = depthFormat,
+            .usage = vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eSampled,
+            .aspect = vk::ImageAspectFlagBits::eDepth });
+    } else if (!multisampled) {
+        depthTarget = frameGraph->createTarget("depth", {
+            .format = depthFormat, .usage = vk::ImageUsageFlagBits::eDepthStencilAttachment,
+            .aspect = vk::ImageAspectFlagBits::eDepth, .transient = true });
+    }
 
-    depthImage = std::make_unique<VulkanImage>(*device,
-        swapchain->getExtent().width, swapchain->getExtent().height,
-        depthFormat,
-        vk::ImageTiling::eOptimal,
-        vk::ImageUsageFlagBits::eDepthStencilAttachment,
-        vk::MemoryPropertyFlagBits::eDeviceLocal,
-        vk::ImageAspectFlagBits::eDepth);
-}
+    // Cull the scene's draws against last frame's depth before the pass draws them; the
+    // pyramid persists across frames, as each frame's cull reads the one the last frame built
+    cullPass.reset();
+    pyramidPass.reset();
+    if (depthReadback) {
+        pyramidImage = frameGraph->importImage("depth pyramid",
+            { vk::ImageAspectFlagBits::eColor, 0, VK_REMAINING_MIP_LEVELS, 0, 1 }, {}, vk::ImageLayout::eUndefined, true);
+        cullPass = frameGraph->addPass("cull", [this](const vk::raii::CommandBuffer& commandBuffer) {
+            culling->cull(commandBuffer, currentFrame, frameUniforms.proj * frameUniforms.view * frameUniforms.model,
+                          scene->getDrawCount());
+        }).read(pyramidImage, PYRAMID_READ).write(culledDraws, CULL_OUTPUT).getIndex();
+    }
+
+    // Tiles of a GPU-culled heightmap; enabled in frames that draw them
+    terrainCullPass = frameGraph->addPass("terrain cull", [this](const vk::raii::CommandBuffer& commandBuffer) {
+        const DrawPlan& plan = sceneRecording.plan;
+        terrainCulling->cull(commandBuffer, currentFrame, plan.heightmapClip, plan.heightmapEye, plan.heightmapPrimitive);
+    }).write(terrainDraws, CULL_OUTPUT).getIndex();
+
+    FrameGraphPass scenePass = frameGraph->addPass("render pass",
+                                                   [this, dynamicRendering](const vk::raii::CommandBuffer& commandBuffer) {
+        if (dynamicRendering) {
+            recordSceneRendering(commandBuffer);
+        } else {
+            recordSceneRenderPass(commandBuffer);
+        }
+    });
+    scenePass.read(culledDraws, INDIRECT_READ).read(terrainDraws, INDIRECT_READ).read(terrainDraws, TILE_NEIGHBOR_READ);
+    if (dynamicRendering) {
+        scenePass.write(swapchainImage, COLOR_ATTACHMENT);
+        if (multisampled) {
+            scenePass.write(*msaaColorTarget, COLOR_ATTACHMENT).write(*msaaDepthTarget, DEPTH_ATTACHMENT);
+        }
+        if (depthTarget) {
+            scenePass.write(*depthTarget, DEPTH_ATTACHMENT);
+        }
+    } else {
+        // The render pass moves both attachments out of eUndefined, and the image on to its final layout
+        scenePass.renderPassWrite(swapchainImage, COLOR_ATTACHMENT, swapchain->getFinalLayout())
+                 .renderPassWrite(*depthTarget, DEPTH_ATTACHMENT, vk::ImageLayout::eDepthStencilAttachmentOptimal);
+    }
 
-void Renderer::createUniformBuffers() {
-    uniformBuffers.clear();
+    // Reduce this frame's depth for the next frame's occlusion test
+    if (depthReadback) {
+        pyramidPass = frameGraph->addPass("depth pyramid", [this](const vk::raii::CommandBuffer& commandBuffer) {
+            culling->buildPyramid(commandBuffer);
+        }).read(*depthTarget, DEPTH_SAMPLED).write(pyramidImage, PYRAMID_WRITE).getIndex();
+    }
 
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        vk::DeviceSize bufferSize = sizeof(UniformBufferObject);
-        auto uniformBuffer = std::make_unique<VulkanBuffer>(*device, bufferSize,
-            vk::BufferUsageFlagBits::eUniformBuffer,
-            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    frameGraph->compile(*device, swapchain->getExtent());
+}
 
-        // Map the buffer for persistent mapping
-        uniformBuffer->map();
-        uniformBuffers.emplace_back(std::move(uniformBuffer));
+void Renderer::setDepthReadback(bool enabled) {
+    // The fallback's render pass and framebuffers are built for a stored depth
+    enabled = enabled || !swapchain->usesDynamicRendering();
+    if (enabled == depthReadback) {
+        return;
     }
+    depthReadback = enabled;
+    deletionQueue.retire(frameSerial, std::move(frameGraph));
+    createFrameGraph();
 }
 
-void Renderer::createDescriptorPool() {
-    std::array poolSizes {
-        vk::DescriptorPoolSize(vk::DescriptorType::eUniformBuffer, MAX_FRAMES_IN_FLIGHT),
-        vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, MAX_FRAMES_IN_FLIGHT)
-    };
-    vk::DescriptorPoolCreateInfo poolInfo{
-        .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
-        .maxSets = MAX_FRAMES_IN_FLIGHT,
-        .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
-        .pPoolSizes = poolSizes.data()
-    };
-    descriptorPool = vk::raii::DescriptorPool(device->getDevice(), poolInfo);
+void Renderer::createDefaultTexture() {
+    const uint32_t whitePixel = 0xFFFFFFFF;
+
+    auto white = std::make_shared<Texture>();
+    white->image = std::make_unique<VulkanImage>(*device,
+        1, 1,
+        vk::Format::eR8G8B8A8Srgb,
+        vk::ImageTiling::eOptimal,
+        vk::ImageUsageFlagBits::eTransferDst | vk::ImageUsageFlagBits::eSampled,
+        vk::MemoryPropertyFlagBits::eDeviceLocal,
+        vk::ImageAspectFlagBits::eColor);
+
+    uploadManager->uploadImage(*white->image, &whitePixel, sizeof(whitePixel));
+    white->uploadTicket = uploadManager->flush();
+
+    white->image->createSampler();
+    textureSlot = descriptors->addTexture(white);
+    texture = std::move(white);
 }
 
-void Renderer::createDescriptorSets() {
-    std::vector<vk::DescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, pipeline->getDescriptorSetLayout());
-    vk::DescriptorSetAllocateInfo allocInfo{
-        .descriptorPool = descriptorPool,
-        .descriptorSetCount = static_cast<uint32_t>(layouts.size()),
-        .pSetLayouts = layouts.data()
-    };
+void Renderer::updateFrameSets() {
+    // Sets of frames in flight can't be rewritten; each slot's is once its frame retired
+    frameSetsDirty.fill(true);
+}
 
-    descriptorSets.clear();
-    descriptorSets = device->getDevice().allocateDescriptorSets(allocInfo);
-}
-
-void Renderer::updateDescriptorSets() {
-    if (!textureImage) {
-        return;  // Texture not loaded yet
-    }
-
-    for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-        vk::DescriptorBufferInfo bufferInfo{
-            .buffer = uniformBuffers[i]->getHandle(),
-            .offset = 0,
-            .range = sizeof(UniformBufferObject)
-        };
-        vk::DescriptorImageInfo imageInfo{
-            .sampler = textureImage->getSampler(),
-            .imageView = textureImage->getImageView(),
-            .imageLayout = vk::ImageLayout::eShaderReadOnlyOptimal
-        };
-        std::array descriptorWrites{
-            vk::WriteDescriptorSet{
-                .dstSet = descriptorSets[i],
-                .dstBinding = 0,
-                .dstArrayElement = 0,
-                .descriptorCount = 1,
-                .descriptorType = vk::DescriptorType::eUniformBuffer,
-                .pBufferInfo = &bufferInfo
-            },
-            vk::WriteDescriptorSet{
-                .dstSet = descriptorSets[i],
-                .dstBinding = 1,
-                .dstArrayElement = 0,
-                .descriptorCount = 1,
-                .descriptorType = vk::DescriptorType::eCombinedImageSampler,
-                .pImageInfo = &imageInfo
-            }
-        };
-        device->getDevice().updateDescriptorSets(descriptorWrites, {});
+void Renderer::writeFrameSet(uint32_t frame) {
+    BindlessDescriptors::FrameBuffers buffers{ .ring = stagingRing->getBuffer().getHandle() };
+    if (heightmap && heightmap->hasData()) {
+        buffers.heights = heightmap->getHeightBuffer();
+        buffers.terrainAttributes = heightmap->getAttributeBuffer();
+    }
+    if (scene) {
+        buffers.sceneInstances = scene->getInstanceBuffer();
     }
+    buffers.tileNeighbors = terrainCulling ? terrainCulling->getNeighborBuffer(frame) : nullptr;
+    descriptors->writeFrameSet(frame, buffers);
+    frameSetsDirty[frame] = false;
 }
 
 void Renderer::recordCommandBuffer(uint32_t imageIndex) {
-    commandManager->getCommandBuffer(currentFrame).begin({});
+    const vk::raii::CommandBuffer& commandBuffer = commandManager->getCommandBuffer(currentFrame);
+    commandBuffer.begin({});
+    if (profiler) {
+        profiler->beginFrame(commandBuffer, currentFrame);
+    }
 
-    // Clear values
-    std::array<vk::ClearValue, 2> clearValues = {
-        vk::ClearColorValue(0.0f, 0.0f, 0.0f, 1.0f),
-        vk::ClearDepthStencilValue(1.0f, 0)
-    };
+    // Tiles are culled and pipelines picked here, so recording threads only read
+    sceneRecording.imageIndex = imageIndex;
+    sceneRecording.plan = planSceneDraws();
+    sceneRecording.jobs = recordingJobs(sceneRecording.plan);
 
-#ifdef __linux__
-    // Linux: Use traditional render pass
+    // GPU culling's passes only run once the scene has draws to cull
+    const bool gpuCulled = culling && scene->hasDraws();
+    if (cullPass) {
+        frameGraph->setPassEnabled(*cullPass, gpuCulled);
+        frameGraph->setPassEnabled(*pyramidPass, gpuCulled);
+    }
+    if (gpuCulled) {
+        frameGraph->bindImage(pyramidImage, culling->getPyramidImage());
+    }
+    frameGraph->setPassEnabled(terrainCullPass, sceneRecording.plan.tilesOnGpu);
+    frameGraph->bindImage(swapchainImage, swapchain->getImages()[imageIndex]);
+    frameGraph->execute(commandBuffer, profiler.get(), currentFrame);
+
+    if (profiler) {
+        profiler->endFrame(commandBuffer, currentFrame);
+    }
+    commandBuffer.end();
+}
+
+void Renderer::recordSceneRenderPass(const vk::raii::CommandBuffer& commandBuffer) {
+    const uint32_t imageIndex = sceneRecording.imageIndex;
+    const uint32_t jobs = sceneRecording.jobs;
+
+    // Fallback: traditional render pass, which also transitions the attachments
     vk::RenderPassBeginInfo renderPassInfo{
         .renderPass = swapchain->getRenderPass(),
         .framebuffer = swapchain->getFramebuffer(imageIndex),
@@ -280,88 +864,63 @@ void Renderer::recordCommandBuffer(uint32_t imageIndex) {
             .offset = {0, 0},
             .extent = swapchain->getExtent()
         },
-        .clearValueCount = static_cast<uint32_t>(clearValues.size()),
-        .pClearValues = clearValues.data()
+        .clearValueCount = static_cast<uint32_t>(CLEAR_VALUES.size()),
+        .pClearValues = CLEAR_VALUES.data()
     };
 
-    commandManager->getCommandBuffer(currentFrame).beginRenderPass(renderPassInfo, vk::SubpassContents::eInline);
-
-    // Bind pipeline and draw
-    pipeline->bind(commandManager->getCommandBuffer(currentFrame));
-    commandManager->getCommandBuffer(currentFrame).setViewport(
-        0, vk::Viewport(0.0f, 0.0f,
-                       static_cast<float>(swapchain->getExtent().width),
-                       static_cast<float>(swapchain->getExtent().height),
-                       0.0f, 1.0f));
-    commandManager->getCommandBuffer(currentFrame).setScissor(
-        0, vk::Rect2D(vk::Offset2D(0, 0), swapchain->getExtent()));
-
-    if (mesh && mesh->hasData()) {
-        mesh->bind(commandManager->getCommandBuffer(currentFrame));
-        commandManager->getCommandBuffer(currentFrame).bindDescriptorSets(
-            vk::PipelineBindPoint::eGraphics,
-            pipeline->getPipelineLayout(),
-            0, *descriptorSets[currentFrame], nullptr);
-        mesh->draw(commandManager->getCommandBuffer(currentFrame));
-    }
-
-    commandManager->getCommandBuffer(currentFrame).endRenderPass();
-#else
-    // macOS/Windows: Use dynamic rendering (Vulkan 1.3)
-    // Transition swapchain image to COLOR_ATTACHMENT_OPTIMAL
-    transitionImageLayout(
-        imageIndex,
-        vk::ImageLayout::eUndefined,
-        vk::ImageLayout::eColorAttachmentOptimal,
-        {},
-        vk::AccessFlagBits2::eColorAttachmentWrite,
-        vk::PipelineStageFlagBits2::eTopOfPipe,
-        vk::PipelineStageFlagBits2::eColorAttachmentOutput
-    );
+    // Queries can only stay active across executeCommands with inheritedQueries, and end outside the pass
+    const bool pauseStatistics = jobs > 1 && profiler && !profiler->inheritsQueries();
+    if (pauseStatistics) {
+        profiler->pauseStatistics(commandBuffer, currentFrame);
+    }
+    commandBuffer.beginRenderPass(renderPassInfo,
+        jobs > 1 ? vk::SubpassContents::eSecondaryCommandBuffers : vk::SubpassContents::eInline);
+    recordScene(commandBuffer, sceneRecording.plan, jobs, vk::CommandBufferInheritanceInfo{
+        .renderPass = swapchain->getRenderPass(),
+        .subpass = 0,
+        .framebuffer = swapchain->getFramebuffer(imageIndex),
+        .pipelineStatistics = profiler ? profiler->getStatisticFlags() : vk::QueryPipelineStatisticFlags{}
+    });
+    commandBuffer.endRenderPass();
+    if (pauseStatistics) {
+        profiler->resumeStatistics(commandBuffer, currentFrame);
+    }
+}
 
-    // Transition depth image to depth attachment optimal layout
-    vk::ImageMemoryBarrier2 depthBarrier = {
-        .srcStageMask = vk::PipelineStageFlagBits2::eTopOfPipe,
-        .srcAccessMask = {},
-        .dstStageMask = vk::PipelineStageFlagBits2::eEarlyFragmentTests | vk::PipelineStageFlagBits2::eLateFragmentTests,
-        .dstAccessMask = vk::AccessFlagBits2::eDepthStencilAttachmentRead | vk::AccessFlagBits2::eDepthStencilAttachmentWrite,
-        .oldLayout = vk::ImageLayout::eUndefined,
-        .newLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
-        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .image = depthImage->getImage(),
-        .subresourceRange = {
-            .aspectMask = vk::ImageAspectFlagBits::eDepth,
-            .baseMipLevel = 0,
-            .levelCount = 1,
-            .baseArrayLayer = 0,
-            .layerCount = 1
-        }
-    };
-    vk::DependencyInfo depthDependencyInfo = {
-        .imageMemoryBarrierCount = 1,
-        .pImageMemoryBarriers = &depthBarrier
-    };
-    commandManager->getCommandBuffer(currentFrame).pipelineBarrier2(depthDependencyInfo);
+void Renderer::recordSceneRendering(const vk::raii::CommandBuffer& commandBuffer) {
+    const uint32_t imageIndex = sceneRecording.imageIndex;
+    const uint32_t jobs = sceneRecording.jobs;
+    const bool multisampled = msaaSamples != vk::SampleCountFlagBits::e1;
 
-    // Setup rendering attachments
+    // The frame graph has the attachments in their layouts. With MSAA the samples stay in the
+    // transient targets and only their resolve is written out, into the swapchain image and the stored depth
     vk::RenderingAttachmentInfo colorAttachmentInfo = {
-        .imageView = swapchain->getImageView(imageIndex),
+        .imageView = multisampled ? frameGraph->getTarget(*msaaColorTarget).getImageView() : swapchain->getImageView(imageIndex),
         .imageLayout = vk::ImageLayout::eColorAttachmentOptimal,
+        .resolveMode = multisampled ? vk::ResolveModeFlagBits::eAverage : vk::ResolveModeFlagBits::eNone,
+        .resolveImageView = multisampled ? swapchain->getImageView(imageIndex) : nullptr,
+        .resolveImageLayout = vk::ImageLayout::eColorAttachmentOptimal,
         .loadOp = vk::AttachmentLoadOp::eClear,
-        .storeOp = vk::AttachmentStoreOp::eStore,
-        .clearValue = clearValues[0]
+        .storeOp = multisampled ? vk::AttachmentStoreOp::eDontCare : vk::AttachmentStoreOp::eStore,
+        .clearValue = CLEAR_VALUES[0]
     };
 
+    const RenderTarget& depthAttachment = frameGraph->getTarget(multisampled ? *msaaDepthTarget : *depthTarget);
+    const bool resolveDepth = multisampled && depthTarget.has_value();
     vk::RenderingAttachmentInfo depthAttachmentInfo = {
-        .imageView = depthImage->getImageView(),
+        .imageView = depthAttachment.getImageView(),
         .imageLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
+        .resolveMode = resolveDepth ? depthResolveMode : vk::ResolveModeFlagBits::eNone,
+        .resolveImageView = resolveDepth ? frameGraph->getTarget(*depthTarget).getImageView() : nullptr,
+        .resolveImageLayout = vk::ImageLayout::eDepthStencilAttachmentOptimal,
         .loadOp = vk::AttachmentLoadOp::eClear,
-        .storeOp = vk::AttachmentStoreOp::eDontCare,
-        .clearValue = clearValues[1]
+        // A stored depth is read back by the depth pyramid
+        .storeOp = depthAttachment.isTransient() ? vk::AttachmentStoreOp::eDontCare : vk::AttachmentStoreOp::eStore,
+        .clearValue = CLEAR_VALUES[1]
     };
 
     vk::RenderingInfo renderingInfo = {
+        .flags = jobs > 1 ? vk::RenderingFlagBits::eContentsSecondaryCommandBuffers : vk::RenderingFlags{},
         .renderArea = { .offset = { 0, 0 }, .extent = swapchain->getExtent() },
         .layerCount = 1,
         .colorAttachmentCount = 1,
@@ -369,95 +928,231 @@ void Renderer::recordCommandBuffer(uint32_t imageIndex) {
         .pDepthAttachment = &depthAttachmentInfo
     };
 
-    // Begin rendering
-    commandManager->getCommandBuffer(currentFrame).beginRendering(renderingInfo);
-    pipeline->bind(commandManager->getCommandBuffer(currentFrame));
-    commandManager->getCommandBuffer(currentFrame).setViewport(
+    // Secondaries inherit the attachment formats instead of a render pass
+    const vk::Format colorFormat = swapchain->getFormat();
+    vk::CommandBufferInheritanceRenderingInfo renderingInheritance{
+        .colorAttachmentCount = 1,
+        .pColorAttachmentFormats = &colorFormat,
+        .depthAttachmentFormat = depthAttachment.getFormat(),
+        .rasterizationSamples = msaaSamples
+    };
+
+    // Queries can only stay active across executeCommands with inheritedQueries, and end outside the pass
+    const bool pauseStatistics = jobs > 1 && profiler && !profiler->inheritsQueries();
+    if (pauseStatistics) {
+        profiler->pauseStatistics(commandBuffer, currentFrame);
+    }
+    commandBuffer.beginRendering(renderingInfo);
+    recordScene(commandBuffer, sceneRecording.plan, jobs, vk::CommandBufferInheritanceInfo{
+        .pNext = &renderingInheritance,
+        .pipelineStatistics = profiler ? profiler->getStatisticFlags() : vk::QueryPipelineStatisticFlags{}
+    });
+    commandBuffer.endRendering();
+    if (pauseStatistics) {
+        profiler->resumeStatistics(commandBuffer, currentFrame);
+    }
+}
+
+Renderer::DrawPlan Renderer::planSceneDraws() {
+    DrawPlan plan;
+
+    // Draw once buffers and texture finished uploading
+    if (!texture || !textureLoader->isReady(*texture)) {
+        return plan;
+    }
+
+    if (mesh && mesh->isReady()) {
+        const bool packed = mesh->getVertexFormat() == VertexFormat::Packed;
+        plan.meshInstances = modelInstances ? modelInstances->getDrawCount(currentFrame) : 0;
+        const PipelineConfig& filled = plan.meshInstances > 0
+            ? (packed ? PACKED_INSTANCED_MESH_PIPELINE : INSTANCED_MESH_PIPELINE)
+            : (packed ? PACKED_MESH_PIPELINE : MESH_PIPELINE);
+        PipelineConfig config = withRenderMode(filled, renderMode, false);
+        plan.meshPipeline = &selectPipeline(config, filled);
+    }
+
+    if (heightmap && heightmap->isReady()) {
+        // Cull and pick LODs in the heightmap's object space; the terrain cull pass does it on the GPU
+        const glm::mat4 modelView = frameUniforms.view * frameUniforms.model;
+        plan.heightmapClip = frameUniforms.proj * modelView;
+        plan.heightmapEye = glm::vec3(glm::inverse(modelView)[3]);
+        plan.tilesOnGpu = terrainCulling != nullptr;
+        if (!plan.tilesOnGpu) {
+            heightmap->selectTiles(plan.heightmapClip, plan.heightmapEye);
+        }
+
+        const PipelineConfig& filled = plan.tilesOnGpu ? HEIGHTMAP_TILE_PIPELINE : HEIGHTMAP_PIPELINE;
+        PipelineConfig config = withRenderMode(filled, renderMode, true);
+        plan.heightmapPipeline = &selectPipeline(config, filled);
+        plan.heightmapPrimitive =
+            config.topology == vk::PrimitiveTopology::eLineList ? GridPrimitive::Lines : GridPrimitive::Triangles;
+        plan.tileDraws = plan.tilesOnGpu ? 0 : heightmap->getDrawCount();
+    }
+
+    if (scene && scene->hasDraws()) {
+        PipelineConfig config = withRenderMode(SCENE_PIPELINE, renderMode, false);
+        plan.scenePipeline = &selectPipeline(config, SCENE_PIPELINE);
+    }
+    return plan;
+}
+
+uint32_t Renderer::recordingJobs(const DrawPlan& plan) const {
+    // Only terrain tiles issue enough draws to be worth splitting
+    return std::clamp<uint32_t>(plan.tileDraws / MIN_TILE_DRAWS_PER_JOB, 1, recorder->getThreadCount());
+}
+
+void Renderer::recordScene(const vk::raii::CommandBuffer& commandBuffer, const DrawPlan& plan, uint32_t jobs,
+                           const vk::CommandBufferInheritanceInfo& inheritance) {
+    if (jobs <= 1) {
+        recordSceneDraws(commandBuffer, plan, 0, plan.tileDraws, true);
+        return;
+    }
+
+    // Tiles split evenly; the first job also takes the single mesh and scene draws
+    std::vector<vk::CommandBuffer> secondaries = recorder->record(currentFrame, inheritance, jobs,
+        [&](const vk::raii::CommandBuffer& secondary, uint32_t job) {
+            const uint32_t firstTile = static_cast<uint32_t>(static_cast<uint64_t>(plan.tileDraws) * job / jobs);
+            const uint32_t endTile = static_cast<uint32_t>(static_cast<uint64_t>(plan.tileDraws) * (job + 1) / jobs);
+            recordSceneDraws(secondary, plan, firstTile, endTile - firstTile, job == 0);
+        });
+    commandBuffer.executeCommands(secondaries);
+}
+
+void Renderer::recordSceneDraws(const vk::raii::CommandBuffer& commandBuffer, const DrawPlan& plan,
+                                uint32_t firstTile, uint32_t tileCount, bool singleDraws) const {
+    // Secondary buffers inherit no state, so each sets everything it draws with
+    commandBuffer.setViewport(
         0, vk::Viewport(0.0f, 0.0f,
                        static_cast<float>(swapchain->getExtent().width),
                        static_cast<float>(swapchain->getExtent().height),
                        0.0f, 1.0f));
-    commandManager->getCommandBuffer(currentFrame).setScissor(
+    commandBuffer.setScissor(
         0, vk::Rect2D(vk::Offset2D(0, 0), swapchain->getExtent()));
 
-    // Draw mesh
-    if (mesh && mesh->hasData()) {
-        mesh->bind(commandManager->getCommandBuffer(currentFrame));
-        commandManager->getCommandBuffer(currentFrame).bindDescriptorSets(
-            vk::PipelineBindPoint::eGraphics,
-            pipeline->getPipelineLayout(),
-            0, *descriptorSets[currentFrame], nullptr);
-        mesh->draw(commandManager->getCommandBuffer(currentFrame));
-    }
-
-    commandManager->getCommandBuffer(currentFrame).endRendering();
-
-    // Transition swapchain image to PRESENT_SRC
-    transitionImageLayout(
-        imageIndex,
-        vk::ImageLayout::eColorAttachmentOptimal,
-        vk::ImageLayout::ePresentSrcKHR,
-        vk::AccessFlagBits2::eColorAttachmentWrite,
-        {},
-        vk::PipelineStageFlagBits2::eColorAttachmentOutput,
-        vk::PipelineStageFlagBits2::eBottomOfPipe
-    );
-#endif
+    if (!plan.meshPipeline && !plan.heightmapPipeline && !plan.scenePipeline) {
+        return;
+    }
+
+    // Bound once: every pipeline shares the layout and draws differ only in push constants
+    // (every object samples the scene texture, so its material set is the only one needed)
+    const std::array dynamicOffsets = { uniformOffset, objectOffset };
+    descriptors->bind(commandBuffer, currentFrame, dynamicOffsets, textureSlot);
+    const vk::PipelineLayout layout = descriptors->getPipelineLayout();
+
+    if (singleDraws && plan.meshPipeline) {
+        GpuScope scope(profiler.get(), commandBuffer, currentFrame, "mesh");
+        plan.meshPipeline->bind(commandBuffer);
+        mesh->bind(commandBuffer, layout);
+        commandBuffer.pushConstants<uint32_t>(layout, vk::ShaderStageFlagBits::eVertex, OBJECT_INDEX_OFFSET, MESH_OBJECT);
+        if (plan.meshInstances > 0) {
+            // Every copy in one call, whatever the count
+            modelInstances->bind(commandBuffer, currentFrame);
+            mesh->draw(commandBuffer, plan.meshInstances);
+        } else {
+            mesh->draw(commandBuffer);
+        }
+    }
+
+    // GPU-culled tiles are one indirect draw, CPU-selected ones split across the jobs
+    if (plan.heightmapPipeline && (plan.tilesOnGpu ? singleDraws : tileCount > 0)) {
+        GpuScope scope(profiler.get(), commandBuffer, currentFrame, "terrain");
+        plan.heightmapPipeline->bind(commandBuffer);
+        commandBuffer.pushConstants<uint32_t>(layout, vk::ShaderStageFlagBits::eVertex, OBJECT_INDEX_OFFSET, HEIGHTMAP_OBJECT);
+        if (plan.tilesOnGpu) {
+            heightmap->drawIndirect(commandBuffer, layout, terrainCulling->getCommands(currentFrame),
+                                    terrainCulling->getDrawCountBuffer(currentFrame));
+        } else {
+            heightmap->draw(commandBuffer, layout, plan.heightmapPrimitive, firstTile, tileCount);
+        }
+    }
+
+    // Every scene instance in one indirect draw, whatever the object count; culled ones have no instances
+    if (singleDraws && plan.scenePipeline) {
+        GpuScope scope(profiler.get(), commandBuffer, currentFrame, "scene");
+        plan.scenePipeline->bind(commandBuffer);
+        commandBuffer.pushConstants<uint32_t>(layout, vk::ShaderStageFlagBits::eVertex, OBJECT_INDEX_OFFSET, SCENE_OBJECT);
+        scene->draw(commandBuffer, culling ? culling->getCulledCommands(currentFrame) : nullptr,
+                    culling ? culling->getDrawCountBuffer(currentFrame) : nullptr);
+    }
+}
 
-    commandManager->getCommandBuffer(currentFrame).end();
+void Renderer::setRenderMode(RenderMode mode) {
+    if (mode == RenderMode::Wireframe && !wireframeSupported) {
+        std::cout << "Wireframe needs the fillModeNonSolid feature, which this device lacks" << std::endl;
+        return;
+    }
+    renderMode = mode;
+}
+
+PipelineConfig Renderer::withRenderMode(PipelineConfig config, RenderMode mode, bool gridLines) const {
+    if (mode == RenderMode::Lines && gridLines) {
+        config.topology = vk::PrimitiveTopology::eLineList;
+        config.cullMode = vk::CullModeFlagBits::eNone;
+    } else if (mode != RenderMode::Fill && wireframeSupported) {
+        config.polygonMode = vk::PolygonMode::eLine;
+        config.cullMode = vk::CullModeFlagBits::eNone;
+    }
+    return config;
+}
+
+const VulkanPipeline& Renderer::selectPipeline(PipelineConfig& config, const PipelineConfig& filled) {
+    if (config == filled) {
+        return pipelines->get(filled);
+    }
+    // A variant still building in the background draws filled meanwhile instead of stalling
+    if (const VulkanPipeline* variant = pipelines->find(config)) {
+        return *variant;
+    }
+    config = filled;
+    return pipelines->get(filled);
 }
 
 void Renderer::updateUniformBuffer(uint32_t currentImage) {
     auto currentTime = std::chrono::high_resolution_clock::now();
     float time = std::chrono::duration<float>(currentTime - startTime).count();
 
+    const CameraPose pose = camera.value_or(CameraPose{ .modelAngle = time * glm::radians(90.0f) });
+
     UniformBufferObject ubo{};
-    ubo.model = glm::rotate(glm::mat4(1.0f), time * glm::radians(90.0f), glm::vec3(0.0f, 0.0f, 1.0f));
-    ubo.view = glm::lookAt(glm::vec3(2.0f, 2.0f, 2.0f), glm::vec3(0.0f, 0.0f, 0.0f), glm::vec3(0.0f, 0.0f, 1.0f));
+    ubo.model = glm::rotate(glm::mat4(1.0f), pose.modelAngle, glm::vec3(0.0f, 0.0f, 1.0f));
+    ubo.view = glm::lookAt(pose.eye, pose.target, glm::vec3(0.0f, 0.0f, 1.0f));
     ubo.proj = glm::perspective(
         glm::radians(45.0f),
         static_cast<float>(swapchain->getExtent().width) / static_cast<float>(swapchain->getExtent().height),
         0.1f, 10.0f);
     ubo.proj[1][1] *= -1;
 
-    memcpy(uniformBuffers[currentImage]->getMappedData(), &ubo, sizeof(ubo));
-}
-
-void Renderer::transitionImageLayout(
-    uint32_t imageIndex,
-    vk::ImageLayout oldLayout,
-    vk::ImageLayout newLayout,
-    vk::AccessFlags2 srcAccessMask,
-    vk::AccessFlags2 dstAccessMask,
-    vk::PipelineStageFlags2 srcStageMask,
-    vk::PipelineStageFlags2 dstStageMask) {
-
-    vk::ImageMemoryBarrier2 barrier = {
-        .srcStageMask = srcStageMask,
-        .srcAccessMask = srcAccessMask,
-        .dstStageMask = dstStageMask,
-        .dstAccessMask = dstAccessMask,
-        .oldLayout = oldLayout,
-        .newLayout = newLayout,
-        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
-        .image = swapchain->getImages()[imageIndex],
-        .subresourceRange = {
-            .aspectMask = vk::ImageAspectFlagBits::eColor,
-            .baseMipLevel = 0,
-            .levelCount = 1,
-            .baseArrayLayer = 0,
-            .layerCount = 1
-        }
-    };
-    vk::DependencyInfo dependencyInfo = {
-        .imageMemoryBarrierCount = 1,
-        .pImageMemoryBarriers = &barrier
-    };
-    commandManager->getCommandBuffer(currentFrame).pipelineBarrier2(dependencyInfo);
+    auto allocation = stagingRing->allocate(sizeof(ubo), uniformAlignment,
+        RingUser::Frame, frameSerials[currentImage]);
+    if (!allocation) {
+        throw std::runtime_error("staging ring exhausted by per-frame data");
+    }
+    memcpy(allocation->mappedData, &ubo, sizeof(ubo));
+    uniformOffset = static_cast<uint32_t>(allocation->offset);
+    frameUniforms = ubo;
+}
+
+void Renderer::updateObjects(uint32_t currentImage) {
+    // The whole array is carved so the descriptor's fixed range stays inside the ring
+    const vk::DeviceSize size = BindlessDescriptors::MAX_OBJECTS * sizeof(ObjectData);
+    auto allocation = stagingRing->allocate(size, storageAlignment, RingUser::Frame, frameSerials[currentImage]);
+    if (!allocation) {
+        throw std::runtime_error("staging ring exhausted by per-frame data");
+    }
+
+    auto* objects = static_cast<ObjectData*>(allocation->mappedData);
+    for (uint32_t object : { MESH_OBJECT, HEIGHTMAP_OBJECT, SCENE_OBJECT }) {
+        objects[object] = ObjectData{ .model = frameUniforms.model, .textureIndex = textureSlot };
+    }
+    objectOffset = static_cast<uint32_t>(allocation->offset);
 }
 
 void Renderer::recreateSwapchain() {
+    swapchainDirty = false;
+    if (swapchain->isOffscreen()) {
+        return;  // Targets don't follow a window
+    }
+
     // Wait for window to be visible
     int width = 0, height = 0;
     glfwGetFramebufferSize(window, &width, &height);
@@ -466,16 +1161,25 @@ void Renderer::recreateSwapchain() {
         glfwWaitEvents();
     }
 
-    device->getDevice().waitIdle();
-
-    swapchain->recreate();
-    createDepthResources();
+    // Frames up to frameSerial may still render to or present the old objects;
+    // they are destroyed once those frames retire instead of idling the device
+    deletionQueue.retire(frameSerial, swapchain->recreate());
+    deletionQueue.retire(frameSerial, syncManager->replaceImageSemaphores(swapchain->getImageCount()));
+    deletionQueue.retire(frameSerial, std::move(frameGraph));
+    createFrameGraph();
+    if (!swapchain->usesDynamicRendering()) {
+        std::vector<vk::ImageView> depthViews(swapchain->getImageCount(), frameGraph->getTarget(*depthTarget).getImageView());
+        swapchain->createFramebuffers(depthViews);
+    }
+    if (culling) {
+        culling->setDepthImage(frameGraph->getTarget(*depthTarget), deletionQueue, frameSerial);
+    }
 }
 
 vk::Format Renderer::findDepthFormat() {
     return device->findSupportedFormat(
         {vk::Format::eD32Sfloat, vk::Format::eD32SfloatS8Uint, vk::Format::eD24UnormS8Uint},
         vk::ImageTiling::eOptimal,
-        vk::FormatFeatureFlagBits::eDepthStencilAttachment
+        vk::FormatFeatureFlagBits::eDepthStencilAttachment | vk::FormatFeatureFlagBits::eSampledImage
     );
 }
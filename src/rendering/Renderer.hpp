@@ -1,21 +1,54 @@
 #pragma once
 
 #include "src/core/VulkanDevice.hpp"
+#include "src/core/JobSystem.hpp"
 #include "src/rendering/VulkanSwapchain.hpp"
+#include "src/rendering/PresentProfile.hpp"
 #include "src/rendering/VulkanPipeline.hpp"
+#include "src/rendering/PipelineCache.hpp"
+#include "src/rendering/PipelineRegistry.hpp"
+#include "src/rendering/BindlessDescriptors.hpp"
 #include "src/rendering/CommandManager.hpp"
+#include "src/rendering/ParallelRecorder.hpp"
 #include "src/rendering/SyncManager.hpp"
+#include "src/rendering/DeletionQueue.hpp"
+#include "src/rendering/UploadManager.hpp"
+#include "src/rendering/GpuCulling.hpp"
+#include "src/rendering/TerrainCulling.hpp"
+#include "src/rendering/TerrainCompute.hpp"
+#include "src/rendering/RenderTargets.hpp"
+#include "src/rendering/FrameGraph.hpp"
+#include "src/rendering/GpuProfiler.hpp"
+#include "src/rendering/CpuProfiler.hpp"
 #include "src/resources/VulkanImage.hpp"
 #include "src/resources/VulkanBuffer.hpp"
+#include "src/resources/StagingRing.hpp"
 #include "src/scene/Mesh.hpp"
+#include "src/scene/Heightmap.hpp"
+#include "src/scene/MeshScene.hpp"
+#include "src/scene/MeshInstances.hpp"
+#include "src/scene/GridIndexCache.hpp"
+#include "src/scene/CameraPath.hpp"
+#include "src/loaders/TextureLoader.hpp"
 #include "src/utils/VulkanCommon.hpp"
 #include "src/utils/Vertex.hpp"
 
 #include <GLFW/glfw3.h>
+#include <array>
 #include <memory>
 #include <vector>
 #include <string>
 #include <chrono>
+#include <optional>
+
+/**
+ * @brief How scene geometry is rasterized
+ */
+enum class RenderMode {
+    Fill,       // Shaded triangles
+    Wireframe,  // Triangle edges, no culling
+    Lines       // Heightmap grid lines without diagonals (classic FdF); meshes draw as Wireframe
+};
 
 /**
  * @brief High-level renderer managing all Vulkan subsystems and rendering logic
@@ -25,19 +58,49 @@
  * - Manage rendering resources (textures, meshes, buffers)
  * - Handle frame rendering and presentation
  * - Coordinate swapchain recreation
- * - Manage descriptor sets
+ * - Own the bindless descriptor model and per-object data
+ * - Split draw-heavy frames into secondary command buffers recorded in parallel
+ * - Pace frames: how many are in flight, and low-latency mode
  */
 class Renderer {
 public:
+    // Per-frame resources exist for this many slots; framesInFlight of them are used
+    static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 4;
+
     /**
      * @brief Construct renderer with window
      * @param window GLFW window for surface creation
      * @param validationLayers Validation layers to enable
      * @param enableValidation Whether to enable validation
+     * @param profile Present mode, swapchain image count and frames in flight to start with
+     * @param msaaSamples Samples per pixel, resolved within the pass; clamped to what the
+     *        device supports, and 1 on the render pass fallback
+     * @param deviceSelector GPU name substring or UUID; empty picks the best-scoring GPU
      */
     Renderer(GLFWwindow* window,
              const std::vector<const char*>& validationLayers,
-             bool enableValidation);
+             bool enableValidation,
+             PresentProfile profile = PresentProfile::Balanced,
+             uint32_t msaaSamples = 1,
+             const std::string& deviceSelector = "");
+
+    /**
+     * @brief Construct headless renderer drawing into offscreen targets
+     * @param offscreenExtent Size of the targets
+     * @param validationLayers Validation layers to enable
+     * @param enableValidation Whether to enable validation
+     * @param profile Frames in flight to start with; present settings don't apply
+     * @param msaaSamples Samples per pixel, as for the windowed renderer
+     * @param deviceSelector GPU to use, as for the windowed renderer
+     *
+     * Needs no window or surface; frames are rendered but never presented.
+     */
+    Renderer(vk::Extent2D offscreenExtent,
+             const std::vector<const char*>& validationLayers,
+             bool enableValidation,
+             PresentProfile profile = PresentProfile::Balanced,
+             uint32_t msaaSamples = 1,
+             const std::string& deviceSelector = "");
 
     ~Renderer() = default;
 
@@ -49,28 +112,168 @@ public:
 
     /**
      * @brief Load model from file
-     * @param modelPath Path to model file
+     * @param modelPath Path to model file (.obj mesh or .fdf heightmap)
+     * @param liveHeightmap Make an FdF map updatable through getHeightmap()->updateRegion()
+     *
+     * FdF maps load as a Heightmap whose vertices are generated on the GPU.
+     * Returns immediately: the file is parsed on a worker and the previous model is
+     * drawn until a later drawFrame swaps the new one in. A failed load is logged by
+     * that drawFrame and keeps the previous model; a newer loadModel call supersedes
+     * one still parsing.
+     */
+    void loadModel(const std::string& modelPath, bool liveHeightmap = false);
+
+    /**
+     * @brief Load many meshes into a MeshScene drawn with indirect multi-draw
+     * @param modelPaths OBJ models, packed into shared megabuffers
+     * @param instancesPerMesh Copies of each model, laid out on a grid under the animated transform
+     *
+     * Replaces the previous scene; drawn alongside the model from loadModel. Like
+     * loadModel, returns at once: the distinct files are parsed in parallel and the
+     * scene is built by the drawFrame after the last one finished, or the failure
+     * logged and the previous scene kept.
+     */
+    void loadScene(const std::vector<std::string>& modelPaths, uint32_t instancesPerMesh = 1);
+
+    /**
+     * @brief Draw the OBJ model from loadModel as copies on a grid, in one instanced call
+     * @param count Copies, each tinted a different hue; 0 draws the model once, uninstanced
+     *
+     * Kept across loadModel; heightmaps are never instanced. Edit getModelInstances()
+     * afterwards to move or recolor single copies.
+     */
+    void setModelInstances(uint32_t count);
+
+    /**
+     * @brief Placements of the instanced model; null until setModelInstances
      */
-    void loadModel(const std::string& modelPath);
+    MeshInstances* getModelInstances() { return modelInstances.get(); }
+
+    /**
+     * @brief The loaded FdF map, for edits when loaded live; null for OBJ models
+     */
+    Heightmap* getHeightmap() { return heightmap.get(); }
 
     /**
      * @brief Load texture from file
      * @param texturePath Path to texture file
+     *
+     * Returns immediately: the file is decoded on a JobSystem worker and the
+     * previous texture stays in use until the new one finished uploading.
+     * The new texture goes into a free bindless slot; nothing else is rewritten.
      */
     void loadTexture(const std::string& texturePath);
 
+    /**
+     * @brief Whether every requested load was applied (or failed and was logged) and the model and texture finished uploading
+     */
+    bool isSceneReady() const;
+
+    /**
+     * @brief Draw from a fixed pose instead of the clock-driven spin, from the next frame on
+     */
+    void setCamera(const CameraPose& pose) { camera = pose; }
+
+    /**
+     * @brief Block until the next frame can be recorded; call right before polling input
+     *
+     * Normally this waits for the frame slot's previous submission, so up to
+     * framesInFlight frames queue on the GPU. In low-latency mode it waits for every
+     * submitted frame instead: the GPU queue is empty when input is sampled, so the
+     * frame shows the newest input at the cost of CPU/GPU overlap.
+     */
+    void waitForNextFrame();
+
     /**
      * @brief Draw a single frame
      */
     void drawFrame();
 
+    /**
+     * @brief Toggle low-latency pacing (see waitForNextFrame), from the next frame on
+     */
+    void setLowLatency(bool enabled) { lowLatency = enabled; }
+    bool isLowLatency() const { return lowLatency; }
+
+    /**
+     * @brief Switch present mode, image count and frames in flight together, between frames
+     *
+     * Recreates the swapchain without idling. Call outside drawFrame and input
+     * callbacks; requestPresentProfile defers the switch to the next frame instead.
+     */
+    void setPresentProfile(PresentProfile profile);
+
+    /**
+     * @brief Switch the present profile at the start of the next drawFrame, e.g. from an input callback
+     */
+    void requestPresentProfile(PresentProfile profile) { pendingPresentProfile = profile; }
+
+    /**
+     * @brief The requested profile if one is pending, otherwise the current one
+     */
+    PresentProfile getPresentProfile() const { return pendingPresentProfile.value_or(presentProfile); }
+
+    /**
+     * @brief Change how many frames the CPU may record ahead of the GPU, without waiting
+     *
+     * Frames submitted in slots beyond the new count retire on their own; recording
+     * continues in the used slot with the oldest frame.
+     * @param count 1 to MAX_FRAMES_IN_FLIGHT
+     * @throws std::invalid_argument if count is out of range
+     */
+    void setFramesInFlight(uint32_t count);
+    uint32_t getFramesInFlight() const { return framesInFlight; }
+
+    /**
+     * @brief Terrain tiles drawn/culled in the last recorded frame, or the last retired one when
+     *        culled on the GPU (zero without a heightmap)
+     */
+    TerrainStats getTerrainStats() const {
+        return terrainCulling ? terrainCulling->getStats() : heightmap ? heightmap->getStats() : TerrainStats{};
+    }
+
+    /**
+     * @brief GPU scope timings and pipeline statistics; null if the queue can't write timestamps
+     */
+    const GpuProfiler* getGpuProfiler() const { return profiler.get(); }
+
+    /**
+     * @brief CPU timings of the drawFrame phases (including waitForNextFrame), always recording
+     */
+    CpuProfiler& getCpuProfiler() { return cpuProfiler; }
+    GpuProfiler* getGpuProfiler() { return profiler.get(); }
+
+    /**
+     * @brief Name of the GPU frames are rendered on
+     */
+    std::string getDeviceName() const;
+
+    /**
+     * @brief Switch how geometry is rasterized, from the next frame on
+     *
+     * Variants are prebuilt in the background at startup; until one is ready the
+     * scene keeps drawing filled. Wireframe is ignored without fillModeNonSolid.
+     */
+    void setRenderMode(RenderMode mode);
+    RenderMode getRenderMode() const { return renderMode; }
+
+    /**
+     * @brief Samples per pixel the scene renders with, after clamping to the device
+     */
+    uint32_t getMsaaSamples() const { return static_cast<uint32_t>(msaaSamples); }
+
+    /**
+     * @brief Memory of the current attachments (depth and MSAA targets, not the swapchain)
+     */
+    const RenderTargetStats& getRenderTargetStats() const { return frameGraph->getTargetStats(); }
+
     /**
      * @brief Wait for device to be idle (for cleanup)
      */
     void waitIdle();
 
     /**
-     * @brief Handle framebuffer resize
+     * @brief Handle framebuffer resize; the swapchain is rebuilt once, at the next frame
      */
     void handleFramebufferResize();
 
@@ -81,50 +284,144 @@ private:
     // Core subsystems
     std::unique_ptr<VulkanDevice> device;
     std::unique_ptr<VulkanSwapchain> swapchain;
-    std::unique_ptr<VulkanPipeline> pipeline;
+    std::unique_ptr<PipelineCache> pipelineCache;
+    std::unique_ptr<BindlessDescriptors> descriptors;  // Owns the layout every pipeline uses
+    std::unique_ptr<PipelineRegistry> pipelines;
     std::unique_ptr<CommandManager> commandManager;
+    std::unique_ptr<ParallelRecorder> recorder;  // Secondary buffers for draw-heavy frames
+    std::unique_ptr<GpuProfiler> profiler;
+    CpuProfiler cpuProfiler;
     std::unique_ptr<SyncManager> syncManager;
+    std::unique_ptr<StagingRing> stagingRing;
+    std::unique_ptr<UploadManager> uploadManager;
+    std::unique_ptr<TerrainCompute> terrainCompute;  // Heightmap attributes, on the async compute queue if any
+    std::unique_ptr<JobSystem> jobSystem;  // Workers for asset loads and texture decodes
+    std::unique_ptr<TextureLoader> textureLoader;
+
+    // Loads parse on jobSystem and are applied on the main thread in drawFrame
+    uint64_t modelGeneration = 0;  // Bumped per load call; results of superseded calls are dropped
+    uint64_t sceneGeneration = 0;
+    uint32_t pendingLoads = 0;     // Submitted loads neither applied nor dropped yet
+
+    // A frame's passes and the attachments they use, rebuilt with the swapchain. The single-sampled
+    // depth is only stored while GPU culling reads it back (always on the render pass fallback);
+    // otherwise it is transient and, with MSAA, not created at all
+    std::unique_ptr<FrameGraph> frameGraph;
+    FrameGraphResource swapchainImage = 0;              // Bound to the acquired image each frame
+    FrameGraphResource pyramidImage = 0;                // GpuCulling's, with depth readback
+    std::optional<FrameGraphResource> depthTarget;      // Resolve target of msaaDepthTarget with MSAA
+    std::optional<FrameGraphResource> msaaColorTarget;  // Resolved into the swapchain image
+    std::optional<FrameGraphResource> msaaDepthTarget;
+    std::optional<uint32_t> cullPass;                   // GpuCulling's passes, with depth readback;
+    std::optional<uint32_t> pyramidPass;                // enabled in frames with culled draws
+    uint32_t terrainCullPass = 0;                       // TerrainCulling's, enabled in frames drawing its tiles
+    vk::SampleCountFlagBits msaaSamples = vk::SampleCountFlagBits::e1;
+    vk::ResolveModeFlagBits depthResolveMode = vk::ResolveModeFlagBits::eSampleZero;
+    bool depthReadback = false;
 
     // Resources
-    std::unique_ptr<VulkanImage> depthImage;
-    std::unique_ptr<VulkanImage> textureImage;
+    std::shared_ptr<const Texture> texture;         // Texture the scene should sample
+    uint32_t textureSlot = 0;                       // Its bindless array slot
+    std::shared_ptr<const Texture> pendingTexture;  // Requested, still decoding or uploading
     std::unique_ptr<Mesh> mesh;
+    std::unique_ptr<MeshInstances> modelInstances;  // Copies of mesh in one draw; drawn once while empty
+    std::unique_ptr<GridIndexCache> gridIndexCache;
+    std::unique_ptr<Heightmap> heightmap;
+    std::unique_ptr<TerrainCulling> terrainCulling;  // Culls the heightmap's tiles; null when selectTiles does
+    std::unique_ptr<MeshScene> scene;
+    std::unique_ptr<GpuCulling> culling;  // Culls the scene's indirect draws; null on the drawIndexed fallback
+
+    // Replaced swapchains, attachments and culling sets; declared after their owners so it empties first
+    DeletionQueue deletionQueue;
+    bool swapchainDirty = false;  // Resized since the last frame
 
-    // Uniform buffers (per frame in flight)
-    std::vector<std::unique_ptr<VulkanBuffer>> uniformBuffers;
+    RenderMode renderMode = RenderMode::Fill;
+    bool wireframeSupported = false;
 
-    // Descriptor management
-    vk::raii::DescriptorPool descriptorPool = nullptr;
-    std::vector<vk::raii::DescriptorSet> descriptorSets;
+    // Uniform and object data are carved from stagingRing each frame and bound with dynamic offsets
+    UniformBufferObject frameUniforms{};  // Matrices of the frame being recorded, for culling
+    uint32_t uniformOffset = 0;
+    uint32_t objectOffset = 0;
+    vk::DeviceSize uniformAlignment = 256;
+    vk::DeviceSize storageAlignment = 256;
 
     // Frame synchronization
+    PresentProfile presentProfile;
+    std::optional<PresentProfile> pendingPresentProfile;  // Applied at the top of the next drawFrame
+    uint32_t framesInFlight;
     uint32_t currentFrame = 0;
-    static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+    uint32_t lastSubmittedFrame = 0;  // Slot of the newest submission, waited for in low-latency mode
+    bool lowLatency = false;
+
+    // Monotonic frame counter; frameSerials[i] is the last frame submitted in slot i
+    uint64_t frameSerial = 0;
+    uint64_t retiredSerial = 0;  // Newest frame known to have finished
+    std::array<bool, MAX_FRAMES_IN_FLIGHT> frameSetsDirty{};  // Slot's set still points at replaced buffers
+    std::array<uint64_t, MAX_FRAMES_IN_FLIGHT> frameSerials{};
 
     // For uniform buffer animation
     std::chrono::time_point<std::chrono::high_resolution_clock> startTime;
+    std::optional<CameraPose> camera;  // Replaces the animation once set
+
+    Renderer(GLFWwindow* window,
+             vk::Extent2D offscreenExtent,
+             const std::vector<const char*>& validationLayers,
+             bool enableValidation,
+             PresentProfile profile,
+             uint32_t requestedSamples,
+             const std::string& deviceSelector);
 
     // Private initialization methods
-    void createDepthResources();
-    void createUniformBuffers();
-    void createDescriptorPool();
-    void createDescriptorSets();
-    void updateDescriptorSets();
+    void createFrameGraph();
+    void setDepthReadback(bool enabled);
+    void createDefaultTexture();
+    void updateFrameSets();
+    void writeFrameSet(uint32_t frame);
+
+    // Main-thread halves of loadModel and loadScene, run from the published load results
+    void retireModel();
+    void buildScene(const std::vector<const MeshBlobs*>& meshes, uint32_t instancesPerMesh);
+
+    // What a frame draws, chosen on the main thread before recording, which then only reads it
+    struct DrawPlan {
+        const VulkanPipeline* meshPipeline = nullptr;       // Null: not drawn this frame
+        uint32_t meshInstances = 0;                         // Copies from modelInstances; 0: drawn once
+        const VulkanPipeline* heightmapPipeline = nullptr;
+        GridPrimitive heightmapPrimitive = GridPrimitive::Triangles;
+        glm::mat4 heightmapClip{ 1.0f };                    // Clip matrix and eye of the heightmap's object space
+        glm::vec3 heightmapEye{ 0.0f };
+        bool tilesOnGpu = false;                            // The terrain cull pass selects the tiles
+        uint32_t tileDraws = 0;                             // Tiles selectTiles kept
+        const VulkanPipeline* scenePipeline = nullptr;
+    };
+
+    // What the frame graph's scene pass records, set before each execute
+    struct SceneRecording {
+        uint32_t imageIndex = 0;
+        DrawPlan plan;
+        uint32_t jobs = 1;
+    };
+    SceneRecording sceneRecording;
 
     // Rendering methods
     void recordCommandBuffer(uint32_t imageIndex);
+    void recordSceneRendering(const vk::raii::CommandBuffer& commandBuffer);
+    void recordSceneRenderPass(const vk::raii::CommandBuffer& commandBuffer);
+    void present(uint32_t imageIndex);
+    DrawPlan planSceneDraws();
+    uint32_t recordingJobs(const DrawPlan& plan) const;
+    void recordScene(const vk::raii::CommandBuffer& commandBuffer, const DrawPlan& plan, uint32_t jobs,
+                     const vk::CommandBufferInheritanceInfo& inheritance);
+    void recordSceneDraws(const vk::raii::CommandBuffer& commandBuffer, const DrawPlan& plan,
+                          uint32_t firstTile, uint32_t tileCount, bool singleDraws) const;
+    PipelineConfig withRenderMode(PipelineConfig config, RenderMode mode, bool gridLines) const;
+    const VulkanPipeline& selectPipeline(PipelineConfig& config, const PipelineConfig& filled);
     void updateUniformBuffer(uint32_t currentImage);
-    void transitionImageLayout(
-        uint32_t imageIndex,
-        vk::ImageLayout oldLayout,
-        vk::ImageLayout newLayout,
-        vk::AccessFlags2 srcAccessMask,
-        vk::AccessFlags2 dstAccessMask,
-        vk::PipelineStageFlags2 srcStageMask,
-        vk::PipelineStageFlags2 dstStageMask);
+    void updateObjects(uint32_t currentImage);
 
     // Swapchain recreation
     void recreateSwapchain();
+    void logPresentProfile() const;
 
     // Utility
     vk::Format findDepthFormat();
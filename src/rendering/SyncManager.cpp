@@ -1,26 +1,38 @@
 #include "SyncManager.hpp"
+#include <array>
 
 SyncManager::SyncManager(VulkanDevice& device, uint32_t maxFramesInFlight, uint32_t swapchainImageCount)
     : device(device), maxFramesInFlight(maxFramesInFlight) {
     imageAvailableSemaphores.reserve(maxFramesInFlight);
     renderFinishedSemaphores.reserve(swapchainImageCount);  // One per swapchain image
-    inFlightFences.reserve(maxFramesInFlight);
 
     vk::SemaphoreCreateInfo semaphoreInfo{};
-    vk::FenceCreateInfo fenceInfo{
-        .flags = vk::FenceCreateFlagBits::eSignaled  // Start signaled so first frame doesn't wait
-    };
 
     // Image available semaphores: one per frame in flight
     for (uint32_t i = 0; i < maxFramesInFlight; i++) {
         imageAvailableSemaphores.emplace_back(device.getDevice(), semaphoreInfo);
-        inFlightFences.emplace_back(device.getDevice(), fenceInfo);
     }
 
     // Render finished semaphores: one per swapchain image
     for (uint32_t i = 0; i < swapchainImageCount; i++) {
         renderFinishedSemaphores.emplace_back(device.getDevice(), semaphoreInfo);
     }
+
+    if (device.getCapabilities().timelineSemaphores) {
+        vk::SemaphoreTypeCreateInfo typeInfo{
+            .semaphoreType = vk::SemaphoreType::eTimeline,
+            .initialValue = 0  // Serials start at 1, so nothing waits on the initial value
+        };
+        timeline = vk::raii::Semaphore(device.getDevice(), vk::SemaphoreCreateInfo{ .pNext = &typeInfo });
+    } else {
+        vk::FenceCreateInfo fenceInfo{
+            .flags = vk::FenceCreateFlagBits::eSignaled  // Start signaled so first frame doesn't wait
+        };
+        inFlightFences.reserve(maxFramesInFlight);
+        for (uint32_t i = 0; i < maxFramesInFlight; i++) {
+            inFlightFences.emplace_back(device.getDevice(), fenceInfo);
+        }
+    }
 }
 
 
@@ -32,17 +44,80 @@ vk::Semaphore SyncManager::getRenderFinishedSemaphore(uint32_t frameIndex) const
     return *renderFinishedSemaphores[frameIndex];
 }
 
-vk::Fence SyncManager::getInFlightFence(uint32_t frameIndex) const {
-    return *inFlightFences[frameIndex];
+std::vector<vk::raii::Semaphore> SyncManager::replaceImageSemaphores(uint32_t swapchainImageCount) {
+    std::vector<vk::raii::Semaphore> retired = std::move(renderFinishedSemaphores);
+    renderFinishedSemaphores.clear();
+    renderFinishedSemaphores.reserve(swapchainImageCount);
+    for (uint32_t i = 0; i < swapchainImageCount; i++) {
+        renderFinishedSemaphores.emplace_back(device.getDevice(), vk::SemaphoreCreateInfo{});
+    }
+    return retired;
 }
 
-void SyncManager::waitForFence(uint32_t frameIndex) {
+void SyncManager::waitForFrame(uint32_t frameIndex, uint64_t frameSerial) {
+    if (frameSerial == 0) {
+        return;
+    }
+    if (usesTimeline()) {
+        vk::Semaphore semaphore = *timeline;
+        vk::SemaphoreWaitInfo waitInfo{
+            .semaphoreCount = 1,
+            .pSemaphores = &semaphore,
+            .pValues = &frameSerial
+        };
+        while (vk::Result::eTimeout == device.getDevice().waitSemaphores(waitInfo, UINT64_MAX)) {
+            // Wait until the timeline reaches the frame
+        }
+        return;
+    }
     while (vk::Result::eTimeout == device.getDevice().waitForFences(
         *inFlightFences[frameIndex], vk::True, UINT64_MAX)) {
         // Wait until fence is signaled
     }
 }
 
-void SyncManager::resetFence(uint32_t frameIndex) {
-    device.getDevice().resetFences(*inFlightFences[frameIndex]);
+void SyncManager::submitFrame(vk::raii::Queue& queue, vk::CommandBuffer commandBuffer,
+                              uint32_t frameIndex, uint32_t imageIndex, uint64_t frameSerial, bool presented) {
+    vk::PipelineStageFlags waitDestinationStageMask(vk::PipelineStageFlagBits::eColorAttachmentOutput);
+    vk::Semaphore waitSemaphore = *imageAvailableSemaphores[frameIndex];
+    const uint32_t waitCount = presented ? 1 : 0;
+
+    if (!usesTimeline()) {
+        device.getDevice().resetFences(*inFlightFences[frameIndex]);
+        vk::Semaphore signalSemaphore = *renderFinishedSemaphores[imageIndex];
+        const vk::SubmitInfo submitInfo{
+            .waitSemaphoreCount = waitCount,
+            .pWaitSemaphores = &waitSemaphore,
+            .pWaitDstStageMask = &waitDestinationStageMask,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &commandBuffer,
+            .signalSemaphoreCount = presented ? 1u : 0u,
+            .pSignalSemaphores = &signalSemaphore
+        };
+        queue.submit(submitInfo, *inFlightFences[frameIndex]);
+        return;
+    }
+
+    // Binary semaphores ignore their value slot; offscreen frames signal only the timeline
+    std::array signalSemaphores = { *renderFinishedSemaphores[imageIndex], *timeline };
+    std::array<uint64_t, 2> signalValues = { 0, frameSerial };
+    const uint32_t firstSignal = presented ? 0 : 1;
+    uint64_t waitValue = 0;
+    vk::TimelineSemaphoreSubmitInfo timelineInfo{
+        .waitSemaphoreValueCount = waitCount,
+        .pWaitSemaphoreValues = &waitValue,
+        .signalSemaphoreValueCount = static_cast<uint32_t>(signalValues.size()) - firstSignal,
+        .pSignalSemaphoreValues = signalValues.data() + firstSignal
+    };
+    const vk::SubmitInfo submitInfo{
+        .pNext = &timelineInfo,
+        .waitSemaphoreCount = waitCount,
+        .pWaitSemaphores = &waitSemaphore,
+        .pWaitDstStageMask = &waitDestinationStageMask,
+        .commandBufferCount = 1,
+        .pCommandBuffers = &commandBuffer,
+        .signalSemaphoreCount = static_cast<uint32_t>(signalSemaphores.size()) - firstSignal,
+        .pSignalSemaphores = signalSemaphores.data() + firstSignal
+    };
+    queue.submit(submitInfo);
 }
@@ -8,7 +8,12 @@
  * @brief Manages synchronization primitives (semaphores and fences) for frame rendering
  *
  * Handles the creation and management of semaphores for image acquisition and presentation,
- * and fences for CPU-GPU synchronization across multiple frames in flight.
+ * and CPU-GPU synchronization across multiple frames in flight.
+ *
+ * With timeline semaphores, a single timeline counts finished frames: each submission
+ * signals the frame's serial and waiting for a frame is waiting for its value, so no
+ * per-frame fences need resetting. Without them, each frame slot has a fence as before.
+ * Acquire and present still use binary semaphores, which the swapchain requires.
  */
 class SyncManager {
 public:
@@ -31,12 +36,34 @@ public:
     // Accessors for synchronization objects
     vk::Semaphore getImageAvailableSemaphore(uint32_t frameIndex) const;
     vk::Semaphore getRenderFinishedSemaphore(uint32_t imageIndex) const;  // Use image index for per-image semaphores
-    vk::Fence getInFlightFence(uint32_t frameIndex) const;
 
-    // Fence operations
-    void waitForFence(uint32_t frameIndex);
-    void resetFence(uint32_t frameIndex);
+    /**
+     * @brief Block until the GPU finished a submitted frame
+     * @param frameIndex Frame slot the frame was submitted from (used by the fence path)
+     * @param frameSerial The frame's serial, as passed to submitFrame; 0 returns immediately
+     */
+    void waitForFrame(uint32_t frameIndex, uint64_t frameSerial);
+
+    /**
+     * @brief Submit a frame's command buffer, signaling its completion as frameSerial
+     *
+     * Waits on the slot's image-available semaphore and signals the image's
+     * render-finished semaphore for presentation.
+     * @param frameSerial Increasing frame counter; must be larger than any earlier submission's
+     * @param presented False for offscreen targets: no acquire to wait for, no present to signal
+     */
+    void submitFrame(vk::raii::Queue& queue, vk::CommandBuffer commandBuffer,
+                     uint32_t frameIndex, uint32_t imageIndex, uint64_t frameSerial, bool presented = true);
+
+    /**
+     * @brief Swap in fresh render-finished semaphores for a recreated swapchain
+     *
+     * Presents of the old swapchain may still wait on the old ones.
+     * @return The old semaphores, to destroy once the frames presenting with them retired
+     */
+    std::vector<vk::raii::Semaphore> replaceImageSemaphores(uint32_t swapchainImageCount);
 
+    bool usesTimeline() const { return *timeline != VK_NULL_HANDLE; }
     uint32_t getMaxFramesInFlight() const { return maxFramesInFlight; }
 
 private:
@@ -45,5 +72,6 @@ private:
 
     std::vector<vk::raii::Semaphore> imageAvailableSemaphores;
     std::vector<vk::raii::Semaphore> renderFinishedSemaphores;
-    std::vector<vk::raii::Fence> inFlightFences;
+    vk::raii::Semaphore timeline = nullptr;     // Counts finished frames, if supported
+    std::vector<vk::raii::Fence> inFlightFences;  // Only without a timeline
 };
@@ -0,0 +1,156 @@
+#include "TerrainCompute.hpp"
+#include <array>
+
+TerrainCompute::TerrainCompute(VulkanDevice& device, const std::string& shaderPath, vk::PipelineCache pipelineCache)
+    : device(device) {
+
+    std::array bindings = {
+        vk::DescriptorSetLayoutBinding(0, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr),
+        vk::DescriptorSetLayoutBinding(1, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr),
+        vk::DescriptorSetLayoutBinding(2, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr)
+    };
+    setLayout = vk::raii::DescriptorSetLayout(device.getDevice(), vk::DescriptorSetLayoutCreateInfo{
+        .bindingCount = static_cast<uint32_t>(bindings.size()),
+        .pBindings = bindings.data()
+    });
+
+    std::array layouts = { *setLayout };
+    pipeline = std::make_unique<ComputePipeline>(device, shaderPath, "terrainAttributesMain",
+        layouts, static_cast<uint32_t>(sizeof(TerrainPushConstants)), pipelineCache);
+
+    // Sets live as long as their batch and are rewritten on reuse
+    std::array poolSizes {
+        vk::DescriptorPoolSize(vk::DescriptorType::eStorageBuffer, MAX_BATCHES * static_cast<uint32_t>(bindings.size()))
+    };
+    descriptorPool = vk::raii::DescriptorPool(device.getDevice(), vk::DescriptorPoolCreateInfo{
+        .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+        .maxSets = MAX_BATCHES,
+        .poolSizeCount = static_cast<uint32_t>(poolSizes.size()),
+        .pPoolSizes = poolSizes.data()
+    });
+
+    commandPool = vk::raii::CommandPool(device.getDevice(), vk::CommandPoolCreateInfo{
+        .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+        .queueFamilyIndex = device.getComputeQueueFamily()
+    });
+}
+
+TerrainCompute::~TerrainCompute() {
+    if (!inFlight.empty()) {
+        wait(inFlight.back()->ticket);
+    }
+}
+
+ComputeTicket TerrainCompute::submit(const Target& target, std::span<const Rows> rows) {
+    std::unique_ptr<Batch> batch = acquireBatch();
+
+    std::array bufferInfos = {
+        vk::DescriptorBufferInfo{ .buffer = target.heights, .offset = 0, .range = vk::WholeSize },
+        vk::DescriptorBufferInfo{ .buffer = target.colors, .offset = 0, .range = vk::WholeSize },
+        vk::DescriptorBufferInfo{ .buffer = target.attributes, .offset = 0, .range = vk::WholeSize }
+    };
+    std::array<vk::WriteDescriptorSet, 3> writes;
+    for (uint32_t binding = 0; binding < bufferInfos.size(); binding++) {
+        writes[binding] = vk::WriteDescriptorSet{
+            .dstSet = batch->descriptorSet,
+            .dstBinding = binding,
+            .descriptorCount = 1,
+            .descriptorType = vk::DescriptorType::eStorageBuffer,
+            .pBufferInfo = &bufferInfos[binding]
+        };
+    }
+    device.getDevice().updateDescriptorSets(writes, {});
+
+    const vk::raii::CommandBuffer& commandBuffer = batch->commandBuffer;
+    commandBuffer.begin(vk::CommandBufferBeginInfo{ .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit });
+    std::array sets = { *batch->descriptorSet };
+    pipeline->bind(commandBuffer);
+    pipeline->bindSets(commandBuffer, sets);
+    for (const Rows& range : rows) {
+        if (range.rowCount == 0) {
+            continue;
+        }
+        pipeline->push(commandBuffer, TerrainPushConstants{
+            .width = target.width,
+            .height = target.height,
+            .hasColors = target.hasColors ? 1u : 0u,
+            .pointOffset = range.pointOffset,
+            .firstRow = range.firstRow,
+            .rowCount = range.rowCount,
+            .minHeight = target.minHeight,
+            .maxHeight = target.maxHeight
+        });
+        commandBuffer.dispatch((target.width + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE,
+                               (range.rowCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1);
+    }
+    commandBuffer.end();
+
+    batch->ticket = nextTicket++;
+    vk::SubmitInfo submitInfo{
+        .commandBufferCount = 1,
+        .pCommandBuffers = &*commandBuffer
+    };
+    device.getComputeQueue().submit(submitInfo, *batch->fence);
+
+    ComputeTicket ticket = batch->ticket;
+    inFlight.push_back(std::move(batch));
+    return ticket;
+}
+
+bool TerrainCompute::isComplete(ComputeTicket ticket) {
+    if (ticket > completedTicket) {
+        collect();
+    }
+    return ticket <= completedTicket;
+}
+
+void TerrainCompute::wait(ComputeTicket ticket) {
+    while (ticket > completedTicket && !inFlight.empty()) {
+        while (vk::Result::eTimeout == device.getDevice().waitForFences(
+            *inFlight.front()->fence, vk::True, UINT64_MAX)) {
+            // Wait until the batch finished
+        }
+        completedTicket = inFlight.front()->ticket;
+        freeBatches.push_back(std::move(inFlight.front()));
+        inFlight.pop_front();
+    }
+}
+
+void TerrainCompute::collect() {
+    while (!inFlight.empty() && inFlight.front()->fence.getStatus() == vk::Result::eSuccess) {
+        completedTicket = inFlight.front()->ticket;
+        freeBatches.push_back(std::move(inFlight.front()));
+        inFlight.pop_front();
+    }
+}
+
+std::unique_ptr<TerrainCompute::Batch> TerrainCompute::acquireBatch() {
+    // Every set is taken: the oldest batch finishes first, so wait for it
+    if (freeBatches.empty() && batchCount == MAX_BATCHES) {
+        wait(inFlight.front()->ticket);
+    }
+
+    if (!freeBatches.empty()) {
+        std::unique_ptr<Batch> batch = std::move(freeBatches.back());
+        freeBatches.pop_back();
+        batch->commandBuffer.reset();
+        device.getDevice().resetFences(*batch->fence);
+        return batch;
+    }
+
+    auto batch = std::make_unique<Batch>();
+    vk::CommandBufferAllocateInfo allocInfo{
+        .commandPool = *commandPool,
+        .level = vk::CommandBufferLevel::ePrimary,
+        .commandBufferCount = 1
+    };
+    batch->commandBuffer = std::move(vk::raii::CommandBuffers(device.getDevice(), allocInfo).front());
+    batch->fence = vk::raii::Fence(device.getDevice(), vk::FenceCreateInfo{});
+    batch->descriptorSet = std::move(vk::raii::DescriptorSets(device.getDevice(), vk::DescriptorSetAllocateInfo{
+        .descriptorPool = *descriptorPool,
+        .descriptorSetCount = 1,
+        .pSetLayouts = &*setLayout
+    }).front());
+    batchCount++;
+    return batch;
+}
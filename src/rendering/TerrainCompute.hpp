@@ -0,0 +1,137 @@
+#pragma once
+
+#include "../utils/VulkanCommon.hpp"
+#include "../core/VulkanDevice.hpp"
+#include "ComputePipeline.hpp"
+#include <deque>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Identifies a submitted terrain compute batch
+ *
+ * Tickets increase monotonically in submission order; 0 never needs waiting on.
+ */
+using ComputeTicket = uint64_t;
+
+/**
+ * @brief Derives heightmap normals, slope and colors on the GPU (terrain.slang)
+ *
+ * Each submission runs one thread per grid point of the requested rows and writes
+ * the point's packed normal and its color and slope into the attribute buffer,
+ * replacing a per-vertex CPU pass over the whole map on every load or edit.
+ *
+ * Batches go to the async compute queue when the device has one, so they overlap
+ * the frame's graphics work, and to the graphics queue otherwise. Like
+ * UploadManager, completion is polled through a fence per batch: callers submit
+ * once the heights' upload completed and draw the results once isComplete().
+ */
+class TerrainCompute {
+public:
+    /**
+     * @brief Buffers and grid of one heightmap
+     */
+    struct Target {
+        vk::Buffer heights;
+        vk::Buffer colors;      // Any valid storage buffer when hasColors is false
+        vk::Buffer attributes;  // Two uint32 per point and copy, needs eStorageBuffer usage
+        uint32_t width = 0;
+        uint32_t height = 0;
+        bool hasColors = false;
+        float minHeight = 0.0f;  // Height ramp range for maps without colors
+        float maxHeight = 0.0f;
+    };
+
+    /**
+     * @brief Rows of one copy to derive
+     */
+    struct Rows {
+        uint32_t pointOffset = 0;  // Start of the copy in the buffers, in points
+        uint32_t firstRow = 0;
+        uint32_t rowCount = 0;
+    };
+
+    /**
+     * @brief Build the pipeline and the command pool on the compute queue family
+     * @param device Vulkan device reference
+     * @param shaderPath Path to the compiled terrain shader
+     * @param pipelineCache Cache to compile through (optional)
+     */
+    TerrainCompute(VulkanDevice& device, const std::string& shaderPath, vk::PipelineCache pipelineCache = nullptr);
+
+    /**
+     * @brief Waits for in-flight batches, which reference their targets' buffers
+     */
+    ~TerrainCompute();
+
+    // Disable copy and move (batches reference the device queue)
+    TerrainCompute(const TerrainCompute&) = delete;
+    TerrainCompute& operator=(const TerrainCompute&) = delete;
+    TerrainCompute(TerrainCompute&&) = delete;
+    TerrainCompute& operator=(TerrainCompute&&) = delete;
+
+    /**
+     * @brief Record one dispatch per row range and submit them as one batch
+     * @return Ticket of the batch
+     */
+    ComputeTicket submit(const Target& target, std::span<const Rows> rows);
+
+    /**
+     * @brief Non-blocking completion check
+     */
+    bool isComplete(ComputeTicket ticket);
+
+    /**
+     * @brief Block until the given batch (and all earlier ones) completed
+     */
+    void wait(ComputeTicket ticket);
+
+    /**
+     * @brief Recycle batches whose fences have signaled (call once per frame)
+     */
+    void collect();
+
+    /**
+     * @brief Whether batches run on a queue of their own beside graphics
+     */
+    bool isAsync() const { return device.hasAsyncComputeQueue(); }
+
+private:
+    static constexpr uint32_t WORKGROUP_SIZE = 8;  // numthreads of terrainAttributesMain, per axis
+    static constexpr uint32_t MAX_BATCHES = 8;     // Descriptor sets allocated up front
+
+    struct TerrainPushConstants {
+        uint32_t width;
+        uint32_t height;
+        uint32_t hasColors;
+        uint32_t pointOffset;
+        uint32_t firstRow;
+        uint32_t rowCount;
+        float minHeight;
+        float maxHeight;
+    };
+
+    struct Batch {
+        vk::raii::CommandBuffer commandBuffer = nullptr;
+        vk::raii::Fence fence = nullptr;
+        vk::raii::DescriptorSet descriptorSet = nullptr;
+        ComputeTicket ticket = 0;
+    };
+
+    VulkanDevice& device;
+    vk::raii::DescriptorSetLayout setLayout = nullptr;
+    vk::raii::DescriptorPool descriptorPool = nullptr;
+    std::unique_ptr<ComputePipeline> pipeline;
+    vk::raii::CommandPool commandPool = nullptr;
+
+    std::deque<std::unique_ptr<Batch>> inFlight;
+    std::vector<std::unique_ptr<Batch>> freeBatches;
+    uint32_t batchCount = 0;
+
+    ComputeTicket nextTicket = 1;
+    ComputeTicket completedTicket = 0;
+
+    std::unique_ptr<Batch> acquireBatch();
+};
@@ -0,0 +1,133 @@
+#include "TerrainCulling.hpp"
+#include <array>
+
+TerrainCulling::TerrainCulling(VulkanDevice& device, const std::string& shaderPath, const Heightmap& heightmap,
+                               uint32_t frameCount, vk::PipelineCache pipelineCache)
+    : device(device), heightmap(heightmap), pending(frameCount, false) {
+
+    // Numbered after GpuCulling's bindings, as culling.slang declares them
+    std::array bindings = {
+        vk::DescriptorSetLayoutBinding(8, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr),
+        vk::DescriptorSetLayoutBinding(9, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr),
+        vk::DescriptorSetLayoutBinding(10, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr),
+        vk::DescriptorSetLayoutBinding(11, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr),
+        vk::DescriptorSetLayoutBinding(12, vk::DescriptorType::eStorageBuffer, 1, vk::ShaderStageFlagBits::eCompute, nullptr)
+    };
+    setLayout = vk::raii::DescriptorSetLayout(device.getDevice(), vk::DescriptorSetLayoutCreateInfo{
+        .bindingCount = static_cast<uint32_t>(bindings.size()),
+        .pBindings = bindings.data()
+    });
+    std::array layouts = { *setLayout };
+    pipeline = std::make_unique<ComputePipeline>(device, shaderPath, "cullTilesMain",
+        layouts, static_cast<uint32_t>(sizeof(TilePushConstants)), pipelineCache);
+
+    const uint32_t tileCount = heightmap.getTileCount();
+    for (uint32_t frame = 0; frame < frameCount; frame++) {
+        commands.push_back(std::make_unique<VulkanBuffer>(device,
+            static_cast<vk::DeviceSize>(tileCount) * sizeof(vk::DrawIndexedIndirectCommand),
+            vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eDeviceLocal));
+        neighbors.push_back(std::make_unique<VulkanBuffer>(device, static_cast<vk::DeviceSize>(tileCount) * sizeof(uint32_t),
+            vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal));
+        counters.push_back(std::make_unique<VulkanBuffer>(device, 2 * sizeof(uint32_t),
+            vk::BufferUsageFlagBits::eIndirectBuffer | vk::BufferUsageFlagBits::eStorageBuffer |
+            vk::BufferUsageFlagBits::eTransferDst,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent));
+        counters.back()->map();
+    }
+
+    // A count draw may only read up to maxDrawIndirectCount commands
+    compacts = device.getCapabilities().drawIndirectCount &&
+               tileCount <= device.getPhysicalDevice().getProperties().limits.maxDrawIndirectCount;
+
+    createSets(frameCount);
+}
+
+void TerrainCulling::createSets(uint32_t frameCount) {
+    vk::DescriptorPoolSize poolSize(vk::DescriptorType::eStorageBuffer, 5 * frameCount);
+    descriptorPool = vk::raii::DescriptorPool(device.getDevice(), vk::DescriptorPoolCreateInfo{
+        .flags = vk::DescriptorPoolCreateFlagBits::eFreeDescriptorSet,
+        .maxSets = frameCount,
+        .poolSizeCount = 1,
+        .pPoolSizes = &poolSize
+    });
+    std::vector<vk::DescriptorSetLayout> layouts(frameCount, *setLayout);
+    sets = device.getDevice().allocateDescriptorSets(vk::DescriptorSetAllocateInfo{
+        .descriptorPool = descriptorPool,
+        .descriptorSetCount = frameCount,
+        .pSetLayouts = layouts.data()
+    });
+
+    // The tables hold every copy; the push constants pick the drawn one
+    const HeightmapTileTable table = heightmap.getTileTable();
+    vk::DescriptorBufferInfo rangeInfo{ .buffer = table.ranges, .offset = 0, .range = vk::WholeSize };
+    vk::DescriptorBufferInfo patternInfo{ .buffer = table.patterns, .offset = 0, .range = vk::WholeSize };
+
+    std::vector<vk::DescriptorBufferInfo> frameInfos;
+    frameInfos.reserve(3 * sets.size());
+    std::vector<vk::WriteDescriptorSet> writes;
+    for (size_t frame = 0; frame < sets.size(); frame++) {
+        writes.push_back({ .dstSet = sets[frame], .dstBinding = 8, .descriptorCount = 1,
+                           .descriptorType = vk::DescriptorType::eStorageBuffer, .pBufferInfo = &rangeInfo });
+        writes.push_back({ .dstSet = sets[frame], .dstBinding = 9, .descriptorCount = 1,
+                           .descriptorType = vk::DescriptorType::eStorageBuffer, .pBufferInfo = &patternInfo });
+        for (uint32_t binding = 10; binding <= 12; binding++) {
+            const VulkanBuffer& buffer = binding == 10 ? *commands[frame] : binding == 11 ? *neighbors[frame] : *counters[frame];
+            frameInfos.push_back({ .buffer = buffer.getHandle(), .offset = 0, .range = vk::WholeSize });
+            writes.push_back({ .dstSet = sets[frame], .dstBinding = binding, .descriptorCount = 1,
+                               .descriptorType = vk::DescriptorType::eStorageBuffer, .pBufferInfo = &frameInfos.back() });
+        }
+    }
+    device.getDevice().updateDescriptorSets(writes, {});
+}
+
+void TerrainCulling::cull(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame,
+                          const glm::mat4& modelViewProj, const glm::vec3& eye, GridPrimitive primitive) {
+    // The last draw reading the counters finished with the frame slot's fence; the shader counts from zero
+    commandBuffer.fillBuffer(counters[frame]->getHandle(), 0, 2 * sizeof(uint32_t), 0);
+    vk::MemoryBarrier clearBarrier{
+        .srcAccessMask = vk::AccessFlagBits::eTransferWrite,
+        .dstAccessMask = vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eShaderWrite
+    };
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eComputeShader,
+                                  {}, clearBarrier, {}, {});
+
+    const HeightmapTileTable table = heightmap.getTileTable();
+    TilePushConstants constants{
+        .modelViewProj = modelViewProj,
+        .eye = glm::vec4(eye, table.lodDistance),
+        .width = heightmap.getWidth(),
+        .height = heightmap.getHeight(),
+        .scale = heightmap.getScale(),
+        .tileCount = table.tileCount,
+        .rangeOffset = table.rangeOffset,
+        .lines = primitive == GridPrimitive::Lines ? 1u : 0u,
+        .compact = compacts ? 1u : 0u,
+        .padding = 0
+    };
+    std::array frameSets = { *sets[frame] };
+    pipeline->bind(commandBuffer);
+    pipeline->bindSets(commandBuffer, frameSets);
+    pipeline->push(commandBuffer, constants);
+    commandBuffer.dispatch((table.tileCount + WORKGROUP_SIZE - 1) / WORKGROUP_SIZE, 1, 1);
+
+    // The counts are read on the host after the fence; the draws' own reads are ordered by the caller
+    vk::MemoryBarrier readbackBarrier{
+        .srcAccessMask = vk::AccessFlagBits::eShaderWrite,
+        .dstAccessMask = vk::AccessFlagBits::eHostRead
+    };
+    commandBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eComputeShader, vk::PipelineStageFlagBits::eHost,
+                                  {}, readbackBarrier, {}, {});
+    pending[frame] = true;
+}
+
+void TerrainCulling::collect(uint32_t frame) {
+    if (!pending[frame]) {
+        return;
+    }
+    pending[frame] = false;
+    const auto* counts = static_cast<const uint32_t*>(counters[frame]->getMappedData());
+    stats.tilesDrawn = counts[0];
+    stats.tilesCulled = heightmap.getTileCount() - counts[0];
+    stats.trianglesDrawn = counts[1];
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "../utils/VulkanCommon.hpp"
+#include "../core/VulkanDevice.hpp"
+#include "../resources/VulkanBuffer.hpp"
+#include "ComputePipeline.hpp"
+#include "../scene/Heightmap.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Compute-shader frustum culling and LOD selection of a heightmap's tiles
+ *
+ * Replaces Heightmap::selectTiles for GPU-culled heightmaps (Heightmap::setGpuCulled).
+ * Each frame, cull() runs one thread per tile before the render pass: the tile's
+ * bounds are tested against the frustum, its LOD picked by distance as chooseLod
+ * does, and an indexed indirect command written into the frame's buffer, with the
+ * steps of its coarser neighbors beside it for the vertex shader to stitch with.
+ * Heightmap::drawIndirect() then draws every tile in one call.
+ *
+ * With the drawIndirectCount capability the visible commands are compacted to the
+ * front of the buffer and counted, as GpuCulling does for the scene; otherwise
+ * culled tiles keep their slot with no instances. Tiles are frustum-culled only:
+ * the HiZ pyramid exists only while a MeshScene is culled.
+ *
+ * The counts of visible tiles and their triangles are read back once the frame
+ * slot's fence has passed (collect()), so getStats() trails the recorded frame.
+ */
+class TerrainCulling {
+public:
+    /**
+     * @brief Create the pipeline and the per-frame command, neighbor and counter buffers
+     * @param device Vulkan device reference
+     * @param shaderPath Path to the compiled culling shaders
+     * @param heightmap GPU-culled heightmap with data (outlives this, its data not replaced)
+     * @param frameCount Number of frames in flight
+     * @param pipelineCache Cache to compile through (optional)
+     */
+    TerrainCulling(VulkanDevice& device, const std::string& shaderPath, const Heightmap& heightmap,
+                   uint32_t frameCount, vk::PipelineCache pipelineCache = nullptr);
+
+    ~TerrainCulling() = default;
+
+    // Disable copy and move (descriptor sets reference the buffers)
+    TerrainCulling(const TerrainCulling&) = delete;
+    TerrainCulling& operator=(const TerrainCulling&) = delete;
+    TerrainCulling(TerrainCulling&&) = delete;
+    TerrainCulling& operator=(TerrainCulling&&) = delete;
+
+    /**
+     * @brief Record the culling dispatch for the heightmap's current copy
+     *
+     * The caller orders it before the draws reading the output as indirect commands
+     * and the vertex shader reading the neighbor steps.
+     * @param modelViewProj Clip matrix of the heightmap's object space
+     * @param eye Camera position in object space
+     * @param primitive Selects the line patterns for a line-list pipeline
+     */
+    void cull(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame,
+              const glm::mat4& modelViewProj, const glm::vec3& eye, GridPrimitive primitive);
+
+    /**
+     * @brief Read back the counts of the slot's last cull (call once its fence has passed)
+     */
+    void collect(uint32_t frame);
+
+    /**
+     * @brief Indirect buffer cull() filled for the frame, one command slot per tile
+     */
+    vk::Buffer getCommands(uint32_t frame) const { return commands[frame]->getHandle(); }
+
+    /**
+     * @brief Count of the compacted commands cull() wrote for the frame, or null if it keeps them in place
+     */
+    vk::Buffer getDrawCountBuffer(uint32_t frame) const { return compacts ? counters[frame]->getHandle() : nullptr; }
+
+    /**
+     * @brief Neighbor steps per tile, bound for vertHeightmapTileMain
+     */
+    vk::Buffer getNeighborBuffer(uint32_t frame) const { return neighbors[frame]->getHandle(); }
+
+    bool compactsDraws() const { return compacts; }
+
+    /**
+     * @brief Tiles drawn and culled by the last collected frame
+     */
+    const TerrainStats& getStats() const { return stats; }
+
+private:
+    static constexpr uint32_t WORKGROUP_SIZE = 64;  // numthreads of cullTilesMain
+
+    // Matches TileCullParams in culling.slang
+    struct TilePushConstants {
+        glm::mat4 modelViewProj;
+        glm::vec4 eye;  // w: distance LOD 0 reaches
+        uint32_t width;
+        uint32_t height;
+        float scale;
+        uint32_t tileCount;
+        uint32_t rangeOffset;
+        uint32_t lines;
+        uint32_t compact;
+        uint32_t padding;
+    };
+
+    VulkanDevice& device;
+    const Heightmap& heightmap;
+
+    vk::raii::DescriptorSetLayout setLayout = nullptr;
+    vk::raii::DescriptorPool descriptorPool = nullptr;
+    std::unique_ptr<ComputePipeline> pipeline;
+    std::vector<vk::raii::DescriptorSet> sets;
+
+    std::vector<std::unique_ptr<VulkanBuffer>> commands;   // One per frame in flight
+    std::vector<std::unique_ptr<VulkanBuffer>> neighbors;  // Likewise
+    std::vector<std::unique_ptr<VulkanBuffer>> counters;   // Mapped visible tiles and triangles; the draw count when compacting
+    std::vector<bool> pending;                             // Slot holds counts not collected yet
+    bool compacts = false;
+    TerrainStats stats;
+
+    void createSets(uint32_t frameCount);
+};
@@ -0,0 +1,253 @@
+#include "UploadManager.hpp"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+UploadManager::UploadManager(VulkanDevice& device, StagingRing& stagingRing)
+    : device(device), stagingRing(stagingRing) {
+    vk::CommandPoolCreateInfo poolInfo{
+        .flags = vk::CommandPoolCreateFlagBits::eResetCommandBuffer,
+        .queueFamilyIndex = device.getTransferQueueFamily()
+    };
+    commandPool = vk::raii::CommandPool(device.getDevice(), poolInfo);
+
+    if (device.hasDedicatedTransferQueue()) {
+        poolInfo.queueFamilyIndex = device.getGraphicsQueueFamily();
+        graphicsCommandPool = vk::raii::CommandPool(device.getDevice(), poolInfo);
+    }
+}
+
+UploadManager::~UploadManager() {
+    if (!inFlight.empty()) {
+        wait(inFlight.back()->ticket);
+    }
+}
+
+void UploadManager::uploadBuffer(VulkanBuffer& dst, const void* data, vk::DeviceSize size, vk::DeviceSize dstOffset) {
+    Batch& batch = currentBatch();
+    StagingRegion staging = stage(batch, data, size);
+
+    vk::BufferCopy copyRegion{
+        .srcOffset = staging.offset,
+        .dstOffset = dstOffset,
+        .size = size
+    };
+    batch.commandBuffer.copyBuffer(staging.buffer, dst.getHandle(), copyRegion);
+}
+
+void UploadManager::uploadBufferRegions(VulkanBuffer& dst, const void* data, std::span<const vk::BufferCopy> regions) {
+    vk::DeviceSize size = 0;
+    for (const vk::BufferCopy& region : regions) {
+        size += region.size;
+    }
+    if (size == 0) {
+        return;
+    }
+
+    Batch& batch = currentBatch();
+    StagingRegion staging = reserveStaging(batch, size);
+
+    // Gather the ranges back to back; the copy scatters them to their destinations again
+    std::vector<vk::BufferCopy> copies;
+    copies.reserve(regions.size());
+    vk::DeviceSize packed = 0;
+    for (const vk::BufferCopy& region : regions) {
+        memcpy(static_cast<char*>(staging.mappedData) + packed,
+               static_cast<const char*>(data) + region.srcOffset, static_cast<size_t>(region.size));
+        copies.push_back({ .srcOffset = staging.offset + packed, .dstOffset = region.dstOffset, .size = region.size });
+        packed += region.size;
+    }
+    batch.commandBuffer.copyBuffer(staging.buffer, dst.getHandle(), copies);
+}
+
+void UploadManager::uploadImage(VulkanImage& dst, const void* pixels, vk::DeviceSize size,
+                                std::span<const vk::DeviceSize> levelOffsets) {
+    const vk::DeviceSize baseLevelOffset = 0;
+    std::span<const vk::DeviceSize> levels = levelOffsets.empty() ? std::span(&baseLevelOffset, 1) : levelOffsets;
+    bool generateMips = levels.size() < dst.getMipLevels();
+    if (generateMips && levels.size() != 1) {
+        throw std::invalid_argument("uploadImage needs either every mip level or only level 0");
+    }
+
+    Batch& batch = currentBatch();
+    StagingRegion staging = stage(batch, pixels, size);
+
+    bool transferQueue = device.hasDedicatedTransferQueue();
+    dst.transitionLayout(batch.commandBuffer, vk::ImageLayout::eUndefined, vk::ImageLayout::eTransferDstOptimal, transferQueue);
+    dst.copyLevelsFromBuffer(batch.commandBuffer, staging.buffer, staging.offset, levels);
+    if (generateMips) {
+        // Leaves the image shader-readable on the graphics queue
+        dst.generateMipmaps(graphicsCommands(batch));
+    } else {
+        dst.transitionLayout(batch.commandBuffer, vk::ImageLayout::eTransferDstOptimal, vk::ImageLayout::eShaderReadOnlyOptimal, transferQueue);
+    }
+}
+
+void UploadManager::keepAlive(std::shared_ptr<const void> resource) {
+    currentBatch().resources.push_back(std::move(resource));
+}
+
+UploadTicket UploadManager::flush() {
+    if (!recording) {
+        return nextTicket - 1;
+    }
+
+    std::unique_ptr<Batch> batch = std::move(recording);
+    batch->commandBuffer.end();
+    batch->ticket = nextTicket++;
+
+    if (batch->hasGraphicsWork) {
+        batch->graphicsCommandBuffer.end();
+
+        vk::SubmitInfo transferSubmit{
+            .commandBufferCount = 1,
+            .pCommandBuffers = &*batch->commandBuffer,
+            .signalSemaphoreCount = 1,
+            .pSignalSemaphores = &*batch->transferDone
+        };
+        device.getTransferQueue().submit(transferSubmit);
+
+        vk::PipelineStageFlags waitStage = vk::PipelineStageFlagBits::eTransfer;
+        vk::SubmitInfo graphicsSubmit{
+            .waitSemaphoreCount = 1,
+            .pWaitSemaphores = &*batch->transferDone,
+            .pWaitDstStageMask = &waitStage,
+            .commandBufferCount = 1,
+            .pCommandBuffers = &*batch->graphicsCommandBuffer
+        };
+        device.getGraphicsQueue().submit(graphicsSubmit, *batch->fence);
+    } else {
+        vk::SubmitInfo submitInfo{
+            .commandBufferCount = 1,
+            .pCommandBuffers = &*batch->commandBuffer
+        };
+        device.getTransferQueue().submit(submitInfo, *batch->fence);
+    }
+
+    UploadTicket ticket = batch->ticket;
+    inFlight.push_back(std::move(batch));
+    return ticket;
+}
+
+bool UploadManager::isComplete(UploadTicket ticket) {
+    if (ticket > completedTicket) {
+        collect();
+    }
+    return ticket <= completedTicket;
+}
+
+void UploadManager::wait(UploadTicket ticket) {
+    // The recording batch is submitted under nextTicket; waiting on it submits it first
+    if (ticket >= nextTicket) {
+        if (ticket > nextTicket || !recording) {
+            throw std::invalid_argument("UploadManager::wait: ticket " + std::to_string(ticket) + " was never issued");
+        }
+        flush();
+    }
+    while (ticket > completedTicket && !inFlight.empty()) {
+        while (vk::Result::eTimeout == device.getDevice().waitForFences(
+            *inFlight.front()->fence, vk::True, UINT64_MAX)) {
+            // Wait until the batch finished
+        }
+        std::unique_ptr<Batch> batch = std::move(inFlight.front());
+        inFlight.pop_front();
+        retire(std::move(batch));
+    }
+}
+
+void UploadManager::collect() {
+    // Completion is retired in submission order; a batch that finishes on the graphics
+    // queue may hold back later transfer-only ones for a frame, which is harmless
+    while (!inFlight.empty() && inFlight.front()->fence.getStatus() == vk::Result::eSuccess) {
+        std::unique_ptr<Batch> batch = std::move(inFlight.front());
+        inFlight.pop_front();
+        retire(std::move(batch));
+    }
+}
+
+UploadManager::Batch& UploadManager::currentBatch() {
+    if (recording) {
+        return *recording;
+    }
+
+    if (!freeBatches.empty()) {
+        recording = std::move(freeBatches.back());
+        freeBatches.pop_back();
+        recording->commandBuffer.reset();
+        if (recording->hasGraphicsWork) {
+            recording->graphicsCommandBuffer.reset();
+            recording->hasGraphicsWork = false;
+        }
+        device.getDevice().resetFences(*recording->fence);
+    } else {
+        recording = std::make_unique<Batch>();
+        vk::CommandBufferAllocateInfo allocInfo{
+            .commandPool = *commandPool,
+            .level = vk::CommandBufferLevel::ePrimary,
+            .commandBufferCount = 1
+        };
+        recording->commandBuffer = std::move(vk::raii::CommandBuffers(device.getDevice(), allocInfo).front());
+        recording->fence = vk::raii::Fence(device.getDevice(), vk::FenceCreateInfo{});
+    }
+
+    vk::CommandBufferBeginInfo beginInfo{
+        .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit
+    };
+    recording->commandBuffer.begin(beginInfo);
+    return *recording;
+}
+
+const vk::raii::CommandBuffer& UploadManager::graphicsCommands(Batch& batch) {
+    if (!device.hasDedicatedTransferQueue()) {
+        return batch.commandBuffer;  // Transfer work already runs on the graphics queue
+    }
+
+    if (!batch.hasGraphicsWork) {
+        if (!*batch.graphicsCommandBuffer) {
+            vk::CommandBufferAllocateInfo allocInfo{
+                .commandPool = *graphicsCommandPool,
+                .level = vk::CommandBufferLevel::ePrimary,
+                .commandBufferCount = 1
+            };
+            batch.graphicsCommandBuffer = std::move(vk::raii::CommandBuffers(device.getDevice(), allocInfo).front());
+            batch.transferDone = vk::raii::Semaphore(device.getDevice(), vk::SemaphoreCreateInfo{});
+        }
+        vk::CommandBufferBeginInfo beginInfo{
+            .flags = vk::CommandBufferUsageFlagBits::eOneTimeSubmit
+        };
+        batch.graphicsCommandBuffer.begin(beginInfo);
+        batch.hasGraphicsWork = true;
+    }
+    return batch.graphicsCommandBuffer;
+}
+
+UploadManager::StagingRegion UploadManager::stage(Batch& batch, const void* data, vk::DeviceSize size) {
+    StagingRegion region = reserveStaging(batch, size);
+    memcpy(region.mappedData, data, static_cast<size_t>(size));
+    return region;
+}
+
+UploadManager::StagingRegion UploadManager::reserveStaging(Batch& batch, vk::DeviceSize size) {
+    // The recording batch will be submitted under nextTicket, which retires its ring region
+    if (auto region = stagingRing.allocate(size, STAGING_ALIGNMENT, RingUser::Upload, nextTicket)) {
+        return { region->buffer, region->offset, region->mappedData };
+    }
+
+    // Larger than the free ring space: fall back to a buffer owned by the batch
+    auto staging = std::make_unique<VulkanBuffer>(device, size,
+        vk::BufferUsageFlagBits::eTransferSrc,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+
+    staging->map();
+    batch.stagingBuffers.push_back(std::move(staging));
+    return { batch.stagingBuffers.back()->getHandle(), 0, batch.stagingBuffers.back()->getMappedData() };
+}
+
+void UploadManager::retire(std::unique_ptr<Batch> batch) {
+    completedTicket = std::max(completedTicket, batch->ticket);
+    batch->stagingBuffers.clear();
+    batch->resources.clear();
+    stagingRing.retireUploads(completedTicket);
+    freeBatches.push_back(std::move(batch));
+}
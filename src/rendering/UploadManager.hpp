@@ -0,0 +1,156 @@
+#pragma once
+
+#include "../utils/VulkanCommon.hpp"
+#include "../core/VulkanDevice.hpp"
+#include "../resources/VulkanBuffer.hpp"
+#include "../resources/VulkanImage.hpp"
+#include "../resources/StagingRing.hpp"
+#include <deque>
+#include <memory>
+#include <span>
+#include <vector>
+
+/**
+ * @brief Identifies a submitted upload batch
+ *
+ * Tickets increase monotonically in submission order; 0 never needs waiting on.
+ */
+using UploadTicket = uint64_t;
+
+/**
+ * @brief Batches staging copies and submits them asynchronously on the transfer queue
+ *
+ * Uploads recorded between two flush() calls share one command buffer and one
+ * submission. Completion is tracked per batch with a fence, so the caller can keep
+ * rendering and poll isComplete() instead of draining the queue.
+ *
+ * Staging data is carved from the renderer's StagingRing; only uploads that don't
+ * fit in the ring fall back to a temporary staging buffer.
+ *
+ * Blits need a graphics queue, so with a dedicated transfer queue mip generation is
+ * recorded into a second command buffer that the graphics queue runs after the
+ * batch's copies, chained by a semaphore; the batch fence then signals on graphics.
+ */
+class UploadManager {
+public:
+    /**
+     * @brief Create command pool on the device's transfer queue family
+     * @param device Vulkan device reference
+     * @param stagingRing Ring buffer that staging copies are carved from
+     */
+    UploadManager(VulkanDevice& device, StagingRing& stagingRing);
+
+    /**
+     * @brief Waits for all in-flight batches before releasing their staging memory
+     */
+    ~UploadManager();
+
+    // Disable copy and move (batches reference the device queue)
+    UploadManager(const UploadManager&) = delete;
+    UploadManager& operator=(const UploadManager&) = delete;
+    UploadManager(UploadManager&&) = delete;
+    UploadManager& operator=(UploadManager&&) = delete;
+
+    /**
+     * @brief Queue a copy of host data into a device-local buffer
+     * @param dst Destination buffer (needs eTransferDst usage)
+     * @param data Source data, copied into staging memory before returning
+     * @param size Number of bytes to copy
+     * @param dstOffset Byte offset into the destination buffer
+     */
+    void uploadBuffer(VulkanBuffer& dst, const void* data, vk::DeviceSize size, vk::DeviceSize dstOffset = 0);
+
+    /**
+     * @brief Queue scattered ranges of host data into a buffer as one multi-region copy
+     * @param dst Destination buffer (needs eTransferDst usage)
+     * @param data Source data; each region's srcOffset is relative to it
+     * @param regions Ranges to copy; they are packed back to back in staging memory
+     */
+    void uploadBufferRegions(VulkanBuffer& dst, const void* data, std::span<const vk::BufferCopy> regions);
+
+    /**
+     * @brief Queue a copy of tightly packed pixels into an image, leaving it shader-readable
+     * @param dst Destination image (needs eTransferDst usage, layout undefined)
+     * @param pixels Source pixels, copied into staging memory before returning
+     * @param size Number of bytes to copy
+     * @param levelOffsets Byte offset of each supplied mip level within pixels; empty means
+     *                     level 0 at offset 0. If only level 0 is supplied and the image has
+     *                     more levels, the rest are generated with blits (dst also needs
+     *                     eTransferSrc usage and a blittable format).
+     * @throws std::invalid_argument if some but not all mip levels are supplied
+     */
+    void uploadImage(VulkanImage& dst, const void* pixels, vk::DeviceSize size,
+                     std::span<const vk::DeviceSize> levelOffsets = {});
+
+    /**
+     * @brief Hold a reference to an upload's destination until the batch being recorded completes
+     *
+     * Lets the owner drop a resource whose copies are still in flight.
+     */
+    void keepAlive(std::shared_ptr<const void> resource);
+
+    /**
+     * @brief Submit all uploads queued since the last flush
+     * @return Ticket of the submitted batch, or of the last batch if nothing was queued
+     */
+    UploadTicket flush();
+
+    /**
+     * @brief Non-blocking completion check
+     */
+    bool isComplete(UploadTicket ticket);
+
+    /**
+     * @brief Block until the given batch (and all earlier ones) completed
+     *
+     * The ticket of the batch still recording (the one its ring space is reserved
+     * under) flushes that batch first.
+     * @throws std::invalid_argument if the ticket is past the recording batch's
+     */
+    void wait(UploadTicket ticket);
+
+    /**
+     * @brief Recycle batches whose fences have signaled (call once per frame)
+     */
+    void collect();
+
+private:
+    // Covers texel size and optimalBufferCopyOffsetAlignment on common devices
+    static constexpr vk::DeviceSize STAGING_ALIGNMENT = 16;
+
+    struct StagingRegion {
+        vk::Buffer buffer;
+        vk::DeviceSize offset;
+        void* mappedData;
+    };
+
+    struct Batch {
+        vk::raii::CommandBuffer commandBuffer = nullptr;
+        vk::raii::Fence fence = nullptr;
+        // Graphics-queue follow-up work, only used with a dedicated transfer queue
+        vk::raii::CommandBuffer graphicsCommandBuffer = nullptr;
+        vk::raii::Semaphore transferDone = nullptr;
+        bool hasGraphicsWork = false;
+        std::vector<std::unique_ptr<VulkanBuffer>> stagingBuffers;
+        std::vector<std::shared_ptr<const void>> resources;  // Released when the batch retires
+        UploadTicket ticket = 0;
+    };
+
+    VulkanDevice& device;
+    StagingRing& stagingRing;
+    vk::raii::CommandPool commandPool = nullptr;
+    vk::raii::CommandPool graphicsCommandPool = nullptr;  // Only with a dedicated transfer queue
+
+    std::unique_ptr<Batch> recording;
+    std::deque<std::unique_ptr<Batch>> inFlight;
+    std::vector<std::unique_ptr<Batch>> freeBatches;
+
+    UploadTicket nextTicket = 1;
+    UploadTicket completedTicket = 0;
+
+    Batch& currentBatch();
+    const vk::raii::CommandBuffer& graphicsCommands(Batch& batch);
+    StagingRegion stage(Batch& batch, const void* data, vk::DeviceSize size);
+    StagingRegion reserveStaging(Batch& batch, vk::DeviceSize size);
+    void retire(std::unique_ptr<Batch> batch);
+};
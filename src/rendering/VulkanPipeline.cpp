@@ -1,67 +1,56 @@
 #include "VulkanPipeline.hpp"
-#include "../core/PlatformConfig.hpp"
 #include "../utils/Vertex.hpp"
 #include "../utils/FileUtils.hpp"
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <vector>
+
+size_t PipelineConfig::hash() const {
+    size_t state = static_cast<size_t>(vertexFormat) |
+                   static_cast<size_t>(topology) << 4 |
+                   static_cast<size_t>(polygonMode) << 12 |
+                   static_cast<size_t>(static_cast<VkCullModeFlags>(cullMode)) << 16 |
+                   static_cast<size_t>(depthTest) << 20 |
+                   static_cast<size_t>(instanced) << 21;
+    size_t entry = std::hash<std::string>{}(vertexEntry);
+    return entry ^ (state + 0x9e3779b97f4a7c15ull + (entry << 6) + (entry >> 2));
+}
 
 VulkanPipeline::VulkanPipeline(
     VulkanDevice& device,
     const VulkanSwapchain& swapchain,
     const std::string& shaderPath,
     vk::Format depthFormat,
-    vk::RenderPass renderPass)
-    : device(device) {
-
-    createDescriptorSetLayout();
-    createPipelineLayout();
-    createGraphicsPipeline(shaderPath, swapchain.getFormat(), depthFormat, renderPass);
-}
-
-void VulkanPipeline::createDescriptorSetLayout() {
-    std::array bindings = {
-        vk::DescriptorSetLayoutBinding(
-            0, 
-            vk::DescriptorType::eUniformBuffer, 
-            1, 
-            vk::ShaderStageFlagBits::eVertex, 
-            nullptr),
-        vk::DescriptorSetLayoutBinding(
-            1, 
-            vk::DescriptorType::eCombinedImageSampler, 
-            1, 
-            vk::ShaderStageFlagBits::eFragment, 
-            nullptr)
-    };
-
-    vk::DescriptorSetLayoutCreateInfo layoutInfo{
-        .bindingCount = static_cast<uint32_t>(bindings.size()),
-        .pBindings = bindings.data()
-    };
-
-    descriptorSetLayout = vk::raii::DescriptorSetLayout(device.getDevice(), layoutInfo);
-}
-
-void VulkanPipeline::createPipelineLayout() {
-    vk::PipelineLayoutCreateInfo pipelineLayoutInfo{
-        .setLayoutCount = 1,
-        .pSetLayouts = &*descriptorSetLayout,
-        .pushConstantRangeCount = 0
-    };
-
-    pipelineLayout = vk::raii::PipelineLayout(device.getDevice(), pipelineLayoutInfo);
+    vk::PipelineLayout pipelineLayout,
+    vk::RenderPass renderPass,
+    const PipelineConfig& config,
+    vk::PipelineCache pipelineCache,
+    vk::Pipeline basePipeline,
+    vk::SampleCountFlagBits samples)
+    : device(device), pipelineLayout(pipelineLayout) {
+
+    createGraphicsPipeline(shaderPath, swapchain.getFormat(), depthFormat, renderPass, config, pipelineCache, basePipeline, samples);
 }
 
 void VulkanPipeline::createGraphicsPipeline(
     const std::string& shaderPath,
     vk::Format colorFormat,
     vk::Format depthFormat,
-    vk::RenderPass renderPass) {
+    vk::RenderPass renderPass,
+    const PipelineConfig& config,
+    vk::PipelineCache pipelineCache,
+    vk::Pipeline basePipeline,
+    vk::SampleCountFlagBits samples) {
     
-    vk::raii::ShaderModule shaderModule = createShaderModule(FileUtils::readFile(shaderPath));
+    // SPIR-V is read straight from the page-aligned mapping; the module copies it
+    const FileUtils::MappedFile shaderFile(shaderPath);
+    vk::raii::ShaderModule shaderModule = createShaderModule(shaderFile.span());
 
     vk::PipelineShaderStageCreateInfo vertShaderStageInfo{
         .stage = vk::ShaderStageFlagBits::eVertex,
         .module = shaderModule,
-        .pName = "vertMain"
+        .pName = config.vertexEntry.c_str()
     };
 
     vk::PipelineShaderStageCreateInfo fragShaderStageInfo{
@@ -73,18 +62,30 @@ void VulkanPipeline::createGraphicsPipeline(
     vk::PipelineShaderStageCreateInfo shaderStages[] = {vertShaderStageInfo, fragShaderStageInfo};
 
     // Vertex input
-    auto bindingDescription = Vertex::getBindingDescription();
-    auto attributeDescriptions = Vertex::getAttributeDescriptions();
+    std::vector<vk::VertexInputBindingDescription> bindingDescriptions;
+    std::vector<vk::VertexInputAttributeDescription> attributeDescriptions;
+    if (config.vertexFormat == VertexFormat::Packed) {
+        bindingDescriptions.push_back(PackedVertex::getBindingDescription());
+        std::ranges::copy(PackedVertex::getAttributeDescriptions(), std::back_inserter(attributeDescriptions));
+    } else if (config.vertexFormat == VertexFormat::Standard) {
+        bindingDescriptions.push_back(Vertex::getBindingDescription());
+        std::ranges::copy(Vertex::getAttributeDescriptions(), std::back_inserter(attributeDescriptions));
+    }
+    if (config.instanced) {
+        bindingDescriptions.push_back(InstanceData::getBindingDescription());
+        std::ranges::copy(InstanceData::getAttributeDescriptions(), std::back_inserter(attributeDescriptions));
+    }
+
     vk::PipelineVertexInputStateCreateInfo vertexInputInfo{
-        .vertexBindingDescriptionCount = 1,
-        .pVertexBindingDescriptions = &bindingDescription,
+        .vertexBindingDescriptionCount = static_cast<uint32_t>(bindingDescriptions.size()),
+        .pVertexBindingDescriptions = bindingDescriptions.data(),
         .vertexAttributeDescriptionCount = static_cast<uint32_t>(attributeDescriptions.size()),
         .pVertexAttributeDescriptions = attributeDescriptions.data()
     };
 
     // Input assembly
     vk::PipelineInputAssemblyStateCreateInfo inputAssembly{
-        .topology = vk::PrimitiveTopology::eTriangleList,
+        .topology = config.topology,
         .primitiveRestartEnable = vk::False
     };
 
@@ -98,8 +99,8 @@ void VulkanPipeline::createGraphicsPipeline(
     vk::PipelineRasterizationStateCreateInfo rasterizer{
         .depthClampEnable = vk::False,
         .rasterizerDiscardEnable = vk::False,
-        .polygonMode = vk::PolygonMode::eFill,
-        .cullMode = vk::CullModeFlagBits::eBack,
+        .polygonMode = config.polygonMode,
+        .cullMode = config.cullMode,
         .frontFace = vk::FrontFace::eCounterClockwise,
         .depthBiasEnable = vk::False,
         .lineWidth = 1.0f
@@ -107,14 +108,14 @@ void VulkanPipeline::createGraphicsPipeline(
 
     // Multisampling
     vk::PipelineMultisampleStateCreateInfo multisampling{
-        .rasterizationSamples = vk::SampleCountFlagBits::e1,
+        .rasterizationSamples = samples,
         .sampleShadingEnable = vk::False
     };
 
     // Depth stencil
     vk::PipelineDepthStencilStateCreateInfo depthStencil{
-        .depthTestEnable = vk::True,
-        .depthWriteEnable = vk::True,
+        .depthTestEnable = config.depthTest ? vk::True : vk::False,
+        .depthWriteEnable = config.depthTest ? vk::True : vk::False,
         .depthCompareOp = vk::CompareOp::eLess,
         .depthBoundsTestEnable = vk::False,
         .stencilTestEnable = vk::False
@@ -147,10 +148,17 @@ void VulkanPipeline::createGraphicsPipeline(
         .pDynamicStates = dynamicStates.data()
     };
 
-    // Platform-specific pipeline creation
-    if constexpr (!Platform::USE_DYNAMIC_RENDERING) {
-        // Linux: Use traditional render pass (Vulkan 1.1)
+    // Variants differ only in a few states; derivatives let drivers reuse the base's compile
+    vk::PipelineCreateFlags flags = vk::PipelineCreateFlagBits::eAllowDerivatives;
+    if (basePipeline) {
+        flags |= vk::PipelineCreateFlagBits::eDerivative;
+    }
+
+    // Dynamic rendering unless the device lacks it
+    if (!device.getCapabilities().dynamicRendering) {
+        // Fallback: traditional render pass (llvmpipe)
         vk::GraphicsPipelineCreateInfo pipelineInfo{
+            .flags = flags,
             .stageCount = 2,
             .pStages = shaderStages,
             .pVertexInputState = &vertexInputInfo,
@@ -161,20 +169,23 @@ void VulkanPipeline::createGraphicsPipeline(
             .pDepthStencilState = &depthStencil,
             .pColorBlendState = &colorBlending,
             .pDynamicState = &dynamicState,
-            .layout = *pipelineLayout,
+            .layout = pipelineLayout,
             .renderPass = renderPass,
-            .subpass = 0
+            .subpass = 0,
+            .basePipelineHandle = basePipeline,
+            .basePipelineIndex = -1
         };
 
         graphicsPipeline = vk::raii::Pipeline(
             device.getDevice(),
-            nullptr,
+            pipelineCache,
             pipelineInfo
         );
     } else {
-        // macOS/Windows: Use dynamic rendering (Vulkan 1.3)
+        // Dynamic rendering (core in Vulkan 1.3, VK_KHR_dynamic_rendering on older Linux drivers)
         vk::StructureChain<vk::GraphicsPipelineCreateInfo, vk::PipelineRenderingCreateInfo> pipelineCreateInfoChain = {
             {
+                .flags = flags,
                 .stageCount = 2,
                 .pStages = shaderStages,
                 .pVertexInputState = &vertexInputInfo,
@@ -185,8 +196,10 @@ void VulkanPipeline::createGraphicsPipeline(
                 .pDepthStencilState = &depthStencil,
                 .pColorBlendState = &colorBlending,
                 .pDynamicState = &dynamicState,
-                .layout = *pipelineLayout,
-                .renderPass = nullptr
+                .layout = pipelineLayout,
+                .renderPass = nullptr,
+                .basePipelineHandle = basePipeline,
+                .basePipelineIndex = -1
             },
             {
                 .colorAttachmentCount = 1,
@@ -197,13 +210,13 @@ void VulkanPipeline::createGraphicsPipeline(
 
         graphicsPipeline = vk::raii::Pipeline(
             device.getDevice(),
-            nullptr,
+            pipelineCache,
             pipelineCreateInfoChain.get<vk::GraphicsPipelineCreateInfo>()
         );
     }
 }
 
-vk::raii::ShaderModule VulkanPipeline::createShaderModule(const std::vector<char>& code) {
+vk::raii::ShaderModule VulkanPipeline::createShaderModule(std::span<const char> code) {
     vk::ShaderModuleCreateInfo createInfo{
         .codeSize = code.size(),
         .pCode = reinterpret_cast<const uint32_t*>(code.data())
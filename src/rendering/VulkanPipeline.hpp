@@ -2,14 +2,40 @@
 
 #include "../utils/VulkanCommon.hpp"
 #include "../core/VulkanDevice.hpp"
+#include "../utils/Vertex.hpp"
 #include "VulkanSwapchain.hpp"
+#include <cstddef>
+#include <span>
 #include <string>
 
 /**
- * @brief Manages Vulkan graphics pipeline and associated layouts
+ * @brief Per-pipeline shader, vertex input and fixed-function state selection
  *
- * Handles descriptor set layout, pipeline layout, and graphics pipeline creation
- * with support for dynamic rendering.
+ * Everything that differs between pipeline variants; the descriptor and push
+ * constant layout is shared by all of them.
+ */
+struct PipelineConfig {
+    std::string vertexEntry = "vertMain";
+    VertexFormat vertexFormat = VertexFormat::Standard;
+    bool instanced = false;  // Adds InstanceData as binding 1
+    vk::PrimitiveTopology topology = vk::PrimitiveTopology::eTriangleList;
+    vk::PolygonMode polygonMode = vk::PolygonMode::eFill;  // eLine needs fillModeNonSolid
+    vk::CullModeFlags cullMode = vk::CullModeFlagBits::eBack;
+    bool depthTest = true;
+
+    bool operator==(const PipelineConfig&) const = default;
+
+    /**
+     * @brief Hash over every field, for keying pipeline variants
+     */
+    size_t hash() const;
+};
+
+/**
+ * @brief Manages a Vulkan graphics pipeline
+ *
+ * Handles graphics pipeline creation with support for dynamic rendering; the
+ * pipeline layout is shared and owned by BindlessDescriptors.
  */
 class VulkanPipeline {
 public:
@@ -19,14 +45,27 @@ public:
      * @param swapchain Swapchain for format information
      * @param shaderPath Path to compiled shader SPIR-V file
      * @param depthFormat Depth buffer format
-     * @param renderPass Render pass (Linux only, ignored on other platforms)
+     * @param pipelineLayout Shared layout the pipeline is built against
+     * @param renderPass Render pass without dynamic rendering, ignored with it
+     * @param config Vertex entry point and input layout
+     * @param pipelineCache Cache to compile through (optional)
+     * @param basePipeline Pipeline to derive from (optional); every pipeline allows derivatives
+     * @param samples Rasterization samples, matching the color and depth attachments
+     *
+     * All pipelines share one pipeline layout, so descriptor sets and push
+     * constants stay bound across pipeline switches.
      */
     VulkanPipeline(
         VulkanDevice& device,
         const VulkanSwapchain& swapchain,
         const std::string& shaderPath,
         vk::Format depthFormat,
-        vk::RenderPass renderPass = nullptr);
+        vk::PipelineLayout pipelineLayout,
+        vk::RenderPass renderPass = nullptr,
+        const PipelineConfig& config = {},
+        vk::PipelineCache pipelineCache = nullptr,
+        vk::Pipeline basePipeline = nullptr,
+        vk::SampleCountFlagBits samples = vk::SampleCountFlagBits::e1);
 
     ~VulkanPipeline() = default;
 
@@ -38,8 +77,7 @@ public:
 
     // Accessors
     vk::Pipeline getPipeline() const { return *graphicsPipeline; }
-    vk::PipelineLayout getPipelineLayout() const { return *pipelineLayout; }
-    vk::DescriptorSetLayout getDescriptorSetLayout() const { return *descriptorSetLayout; }
+    vk::PipelineLayout getPipelineLayout() const { return pipelineLayout; }
 
     // Bind pipeline to command buffer
     void bind(const vk::raii::CommandBuffer& commandBuffer) const;
@@ -47,17 +85,18 @@ public:
 private:
     VulkanDevice& device;
 
-    vk::raii::DescriptorSetLayout descriptorSetLayout = nullptr;
-    vk::raii::PipelineLayout pipelineLayout = nullptr;
+    vk::PipelineLayout pipelineLayout;  // Not owned
     vk::raii::Pipeline graphicsPipeline = nullptr;
 
-    void createDescriptorSetLayout();
-    void createPipelineLayout();
     void createGraphicsPipeline(
         const std::string& shaderPath,
         vk::Format colorFormat,
         vk::Format depthFormat,
-        vk::RenderPass renderPass);
+        vk::RenderPass renderPass,
+        const PipelineConfig& config,
+        vk::PipelineCache pipelineCache,
+        vk::Pipeline basePipeline,
+        vk::SampleCountFlagBits samples);
 
-    vk::raii::ShaderModule createShaderModule(const std::vector<char>& code);
+    vk::raii::ShaderModule createShaderModule(std::span<const char> code);
 };
@@ -1,18 +1,41 @@
 #include "VulkanSwapchain.hpp"
 #include <GLFW/glfw3.h>
 #include <algorithm>
+#include <array>
 #include <cassert>
 
-VulkanSwapchain::VulkanSwapchain(VulkanDevice& device, GLFWwindow* window)
-    : device(device), window(window) {
+VulkanSwapchain::VulkanSwapchain(VulkanDevice& device, GLFWwindow* window, PresentConfig config)
+    : device(device), window(window), config(std::move(config)) {
     createSwapchain();
     createImageViews();
 }
 
-void VulkanSwapchain::createSwapchain() {
+VulkanSwapchain::VulkanSwapchain(VulkanDevice& device, vk::Extent2D extent, uint32_t imageCount)
+    : device(device), window(nullptr), extent(extent) {
+    surfaceFormat = {
+        device.findSupportedFormat({ vk::Format::eB8G8R8A8Srgb, vk::Format::eR8G8B8A8Srgb },
+                                   vk::ImageTiling::eOptimal, vk::FormatFeatureFlagBits::eColorAttachment),
+        vk::ColorSpaceKHR::eSrgbNonlinear
+    };
+
+    offscreenTargets.reserve(imageCount);
+    for (uint32_t i = 0; i < imageCount; i++) {
+        offscreenTargets.push_back(std::make_unique<VulkanImage>(device,
+            extent.width, extent.height,
+            surfaceFormat.format,
+            vk::ImageTiling::eOptimal,
+            vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransferSrc,
+            vk::MemoryPropertyFlagBits::eDeviceLocal,
+            vk::ImageAspectFlagBits::eColor));
+        images.push_back(offscreenTargets.back()->getImage());
+    }
+}
+
+void VulkanSwapchain::createSwapchain(vk::SwapchainKHR oldSwapchain) {
     auto surfaceCapabilities = device.getPhysicalDevice().getSurfaceCapabilitiesKHR(*device.getSurface());
     extent = chooseExtent(surfaceCapabilities);
     surfaceFormat = chooseSurfaceFormat(device.getPhysicalDevice().getSurfaceFormatsKHR(*device.getSurface()));
+    presentMode = choosePresentMode(device.getPhysicalDevice().getSurfacePresentModesKHR(*device.getSurface()));
 
     vk::SwapchainCreateInfoKHR createInfo{
         .surface = *device.getSurface(),
@@ -25,8 +48,9 @@ void VulkanSwapchain::createSwapchain() {
         .imageSharingMode = vk::SharingMode::eExclusive,
         .preTransform = surfaceCapabilities.currentTransform,
         .compositeAlpha = vk::CompositeAlphaFlagBitsKHR::eOpaque,
-        .presentMode = choosePresentMode(device.getPhysicalDevice().getSurfacePresentModesKHR(*device.getSurface())),
-        .clipped = true
+        .presentMode = presentMode,
+        .clipped = true,
+        .oldSwapchain = oldSwapchain
     };
 
     swapchain = vk::raii::SwapchainKHR(device.getDevice(), createInfo);
@@ -49,32 +73,45 @@ void VulkanSwapchain::createImageViews() {
 }
 
 void VulkanSwapchain::cleanup() {
-#ifdef __linux__
     framebuffers.clear();
     renderPass = nullptr;
-#endif
     imageViews.clear();
+    offscreenTargets.clear();
     swapchain = nullptr;
 }
 
-void VulkanSwapchain::recreate() {
-    // Wait for device to be idle before recreating swapchain
-    device.getDevice().waitIdle();
-    
-    cleanup();
-    createSwapchain();
+VulkanSwapchain::Retired VulkanSwapchain::recreate() {
+    Retired retired;
+    if (isOffscreen()) {
+        return retired;
+    }
+    retired.imageViews = std::move(imageViews);
+    imageViews.clear();
+    // The render pass only depends on the formats, which the surface keeps
+    retired.framebuffers = std::move(framebuffers);
+    framebuffers.clear();
+    retired.swapchain = std::move(swapchain);
+
+    createSwapchain(*retired.swapchain);
     createImageViews();
+    return retired;
 }
 
 std::pair<vk::Result, uint32_t> VulkanSwapchain::acquireNextImage(
     uint64_t timeout,
     vk::Semaphore semaphore,
     vk::Fence fence) {
+    if (isOffscreen()) {
+        // Nothing to wait for, so the semaphore and fence are left alone
+        uint32_t index = nextOffscreenTarget;
+        nextOffscreenTarget = (nextOffscreenTarget + 1) % getImageCount();
+        return { vk::Result::eSuccess, index };
+    }
     return swapchain.acquireNextImage(timeout, semaphore, fence);
 }
 
-uint32_t VulkanSwapchain::chooseImageCount(const vk::SurfaceCapabilitiesKHR& capabilities) {
-    auto imageCount = std::max(3u, capabilities.minImageCount);
+uint32_t VulkanSwapchain::chooseImageCount(const vk::SurfaceCapabilitiesKHR& capabilities) const {
+    auto imageCount = std::max(config.minImageCount, capabilities.minImageCount);
     if ((0 < capabilities.maxImageCount) && (capabilities.maxImageCount < imageCount)) {
         imageCount = capabilities.maxImageCount;
     }
@@ -94,14 +131,14 @@ vk::SurfaceFormatKHR VulkanSwapchain::chooseSurfaceFormat(const std::vector<vk::
     return formats[0];
 }
 
-vk::PresentModeKHR VulkanSwapchain::choosePresentMode(const std::vector<vk::PresentModeKHR>& modes) {
-    // FIFO is always supported
-    for (const auto& mode : modes) {
-        if (mode == vk::PresentModeKHR::eMailbox) {
-            return vk::PresentModeKHR::eMailbox;
+vk::PresentModeKHR VulkanSwapchain::choosePresentMode(const std::vector<vk::PresentModeKHR>& modes) const {
+    for (vk::PresentModeKHR preferred : config.presentModes) {
+        if (std::ranges::find(modes, preferred) != modes.end()) {
+            return preferred;
         }
     }
-    
+
+    // FIFO is always supported
     return vk::PresentModeKHR::eFifo;
 }
 
@@ -119,7 +156,6 @@ vk::Extent2D VulkanSwapchain::chooseExtent(const vk::SurfaceCapabilitiesKHR& cap
     };
 }
 
-#ifdef __linux__
 void VulkanSwapchain::createRenderPass(vk::Format depthFormat) {
     // Color attachment
     vk::AttachmentDescription colorAttachment{
@@ -130,7 +166,7 @@ void VulkanSwapchain::createRenderPass(vk::Format depthFormat) {
         .stencilLoadOp = vk::AttachmentLoadOp::eDontCare,
         .stencilStoreOp = vk::AttachmentStoreOp::eDontCare,
         .initialLayout = vk::ImageLayout::eUndefined,
-        .finalLayout = vk::ImageLayout::ePresentSrcKHR
+        .finalLayout = getFinalLayout()
     };
 
     vk::AttachmentReference colorAttachmentRef{
@@ -143,7 +179,7 @@ void VulkanSwapchain::createRenderPass(vk::Format depthFormat) {
         .format = depthFormat,
         .samples = vk::SampleCountFlagBits::e1,
         .loadOp = vk::AttachmentLoadOp::eClear,
-        .storeOp = vk::AttachmentStoreOp::eDontCare,
+        .storeOp = vk::AttachmentStoreOp::eStore,  // Read back by the GPU culling depth pyramid
         .stencilLoadOp = vk::AttachmentLoadOp::eDontCare,
         .stencilStoreOp = vk::AttachmentStoreOp::eDontCare,
         .initialLayout = vk::ImageLayout::eUndefined,
@@ -188,11 +224,11 @@ void VulkanSwapchain::createRenderPass(vk::Format depthFormat) {
 
 void VulkanSwapchain::createFramebuffers(const std::vector<vk::ImageView>& depthImageViews) {
     framebuffers.clear();
-    framebuffers.reserve(imageViews.size());
+    framebuffers.reserve(getImageCount());
 
-    for (size_t i = 0; i < imageViews.size(); i++) {
+    for (uint32_t i = 0; i < getImageCount(); i++) {
         std::array attachments = {
-            *imageViews[i],
+            getImageView(i),
             depthImageViews[i]  // One depth image view per swapchain image
         };
 
@@ -208,4 +244,3 @@ void VulkanSwapchain::createFramebuffers(const std::vector<vk::ImageView>& depth
         framebuffers.emplace_back(device.getDevice(), framebufferInfo);
     }
 }
-#endif
@@ -2,14 +2,28 @@
 
 #include "../utils/VulkanCommon.hpp"
 #include "../core/VulkanDevice.hpp"
-#include "../core/PlatformConfig.hpp"
+#include "../resources/VulkanImage.hpp"
+#include <memory>
 #include <vector>
 
+/**
+ * @brief How the swapchain presents
+ */
+struct PresentConfig {
+    // In order of preference; falls back to FIFO, which is always supported
+    std::vector<vk::PresentModeKHR> presentModes = { vk::PresentModeKHR::eMailbox };
+    uint32_t minImageCount = 3;  // Clamped to the surface's limits, so 0 asks for its minimum
+};
+
 /**
  * @brief Manages Vulkan swapchain and associated image views
  *
  * Handles swapchain creation, recreation, image view management,
  * and provides utilities for swapchain configuration.
+ *
+ * An offscreen swapchain renders into VulkanImage targets instead, for headless
+ * runs without a surface: acquire hands them out round-robin, nothing is presented
+ * and frames end in eTransferSrcOptimal rather than ePresentSrcKHR.
  */
 class VulkanSwapchain {
 public:
@@ -17,8 +31,17 @@ public:
      * @brief Construct swapchain with optimal settings
      * @param device Vulkan device reference
      * @param window GLFW window for framebuffer size queries
+     * @param config Present mode preference and image count
      */
-    VulkanSwapchain(VulkanDevice& device, GLFWwindow* window);
+    VulkanSwapchain(VulkanDevice& device, GLFWwindow* window, PresentConfig config = {});
+
+    /**
+     * @brief Construct offscreen targets instead of a swapchain
+     * @param device Vulkan device reference (may be headless)
+     * @param extent Size of every target
+     * @param imageCount Targets rotated through; at least the frames in flight, so none is reused early
+     */
+    VulkanSwapchain(VulkanDevice& device, vk::Extent2D extent, uint32_t imageCount);
 
     ~VulkanSwapchain() = default;
 
@@ -28,8 +51,26 @@ public:
     VulkanSwapchain(VulkanSwapchain&&) = default;
     VulkanSwapchain& operator=(VulkanSwapchain&&) = delete;
 
+    /**
+     * @brief What a recreation replaced; destroy once frames using it have retired
+     */
+    struct Retired {
+        vk::raii::SwapchainKHR swapchain = nullptr;
+        std::vector<vk::raii::ImageView> imageViews;
+        std::vector<vk::raii::Framebuffer> framebuffers;  // Render pass path only
+    };
+
     // Swapchain operations
-    void recreate();
+    /**
+     * @brief Rebuild the swapchain for the current surface size and config
+     *
+     * The old swapchain is passed as oldSwapchain, so frames still in flight can
+     * present its images, and handed back instead of destroyed. Without dynamic
+     * rendering the render pass is kept and the framebuffers must be recreated. Offscreen targets
+     * don't follow a surface and are kept; nothing is returned.
+     */
+    Retired recreate();
+    void setPresentConfig(PresentConfig newConfig) { config = std::move(newConfig); }
     void cleanup();
     
     // Image acquisition
@@ -41,45 +82,57 @@ public:
     // Accessors
     vk::SwapchainKHR getSwapchain() const { return *swapchain; }
     const std::vector<vk::Image>& getImages() const { return images; }
-    vk::ImageView getImageView(uint32_t index) const { return *imageViews[index]; }
-    const std::vector<vk::raii::ImageView>& getImageViews() const { return imageViews; }
+    vk::ImageView getImageView(uint32_t index) const {
+        return isOffscreen() ? offscreenTargets[index]->getImageView() : *imageViews[index];
+    }
     vk::Format getFormat() const { return surfaceFormat.format; }
     vk::Extent2D getExtent() const { return extent; }
     uint32_t getImageCount() const { return static_cast<uint32_t>(images.size()); }
+    vk::PresentModeKHR getPresentMode() const { return presentMode; }
+    bool isOffscreen() const { return !offscreenTargets.empty(); }
 
-    // Platform-specific rendering support
-    bool usesDynamicRendering() const { return Platform::USE_DYNAMIC_RENDERING; }
+    /**
+     * @brief Layout a rendered image is left in: ready to present, or to copy from offscreen
+     */
+    vk::ImageLayout getFinalLayout() const {
+        return isOffscreen() ? vk::ImageLayout::eTransferSrcOptimal : vk::ImageLayout::ePresentSrcKHR;
+    }
 
-#ifdef __linux__
-    // Traditional render pass support for Vulkan 1.1 (Linux only)
+    // Dynamic rendering when the device supports it (always outside Linux)
+    bool usesDynamicRendering() const { return device.getCapabilities().dynamicRendering; }
+
+    // Traditional render pass fallback for devices without dynamic rendering (llvmpipe)
     vk::RenderPass getRenderPass() const { return *renderPass; }
     vk::Framebuffer getFramebuffer(uint32_t index) const { return *framebuffers[index]; }
     void createRenderPass(vk::Format depthFormat);
     void createFramebuffers(const std::vector<vk::ImageView>& attachments);
-#endif
 
 private:
     VulkanDevice& device;
     GLFWwindow* window;
+    PresentConfig config;
 
     vk::raii::SwapchainKHR swapchain = nullptr;
     std::vector<vk::Image> images;
     std::vector<vk::raii::ImageView> imageViews;
     vk::SurfaceFormatKHR surfaceFormat;
     vk::Extent2D extent;
+    vk::PresentModeKHR presentMode = vk::PresentModeKHR::eFifo;
+
+    // Offscreen mode only
+    std::vector<std::unique_ptr<VulkanImage>> offscreenTargets;
+    uint32_t nextOffscreenTarget = 0;
 
-#ifdef __linux__
-    // Traditional render pass resources (Vulkan 1.1)
+    // Traditional render pass resources, empty with dynamic rendering
     vk::raii::RenderPass renderPass = nullptr;
     std::vector<vk::raii::Framebuffer> framebuffers;
-#endif
 
-    void createSwapchain();
+    void createSwapchain(vk::SwapchainKHR oldSwapchain = nullptr);
     void createImageViews();
 
     // Helper functions for swapchain configuration
-    static uint32_t chooseImageCount(const vk::SurfaceCapabilitiesKHR& capabilities);
+    uint32_t chooseImageCount(const vk::SurfaceCapabilitiesKHR& capabilities) const;
     static vk::SurfaceFormatKHR chooseSurfaceFormat(const std::vector<vk::SurfaceFormatKHR>& formats);
-    static vk::PresentModeKHR choosePresentMode(const std::vector<vk::PresentModeKHR>& modes);
+    vk::PresentModeKHR choosePresentMode(const std::vector<vk::PresentModeKHR>& modes) const;
     vk::Extent2D chooseExtent(const vk::SurfaceCapabilitiesKHR& capabilities);
 };
@@ -0,0 +1,87 @@
+#include "StagingRing.hpp"
+#include <algorithm>
+#include <stdexcept>
+
+namespace {
+    uint64_t alignUp(uint64_t value, uint64_t alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+StagingRing::StagingRing(VulkanDevice& device, vk::DeviceSize capacity)
+    : capacity(capacity) {
+    if ((capacity & (capacity - 1)) != 0) {
+        throw std::invalid_argument("StagingRing capacity must be a power of two");
+    }
+
+    // eTransferSrc makes it concurrent with a dedicated transfer family, which copies
+    // from it while the graphics queue reads frame data from it
+    buffer = std::make_unique<VulkanBuffer>(device, capacity,
+        vk::BufferUsageFlagBits::eTransferSrc |
+        vk::BufferUsageFlagBits::eUniformBuffer |
+        vk::BufferUsageFlagBits::eStorageBuffer |
+        vk::BufferUsageFlagBits::eVertexBuffer |
+        vk::BufferUsageFlagBits::eIndexBuffer,
+        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+
+    // Mapped once for the ring's lifetime
+    buffer->map();
+    mappedBase = static_cast<char*>(buffer->getMappedData());
+}
+
+std::optional<RingAllocation> StagingRing::allocate(vk::DeviceSize size, vk::DeviceSize alignment,
+                                                    RingUser user, uint64_t serial) {
+    if (size > capacity) {
+        return std::nullopt;
+    }
+
+    uint64_t start = alignUp(head, alignment);
+    // Never straddle the end of the buffer; the skipped tail belongs to this region
+    if ((start % capacity) + size > capacity) {
+        start = alignUp(head, capacity);
+    }
+    if (start + size - tail > capacity) {
+        reclaim();
+        if (start + size - tail > capacity) {
+            return std::nullopt;
+        }
+    }
+
+    head = start + size;
+    if (!regions.empty() && regions.back().user == user && regions.back().serial == serial) {
+        regions.back().end = head;
+    } else {
+        regions.push_back({ head, user, serial });
+    }
+
+    vk::DeviceSize offset = start % capacity;
+    return RingAllocation{
+        .buffer = buffer->getHandle(),
+        .offset = offset,
+        .size = size,
+        .mappedData = mappedBase + offset
+    };
+}
+
+void StagingRing::retireFrames(uint64_t frameSerial) {
+    retiredFrameSerial = std::max(retiredFrameSerial, frameSerial);
+    reclaim();
+}
+
+void StagingRing::retireUploads(uint64_t ticket) {
+    retiredUploadTicket = std::max(retiredUploadTicket, ticket);
+    reclaim();
+}
+
+void StagingRing::reclaim() {
+    // Free strictly in allocation order; a live region blocks everything after it
+    while (!regions.empty()) {
+        const Region& region = regions.front();
+        uint64_t retired = region.user == RingUser::Frame ? retiredFrameSerial : retiredUploadTicket;
+        if (region.serial > retired) {
+            break;
+        }
+        tail = region.end;
+        regions.pop_front();
+    }
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "../utils/VulkanCommon.hpp"
+#include "../core/VulkanDevice.hpp"
+#include "VulkanBuffer.hpp"
+#include <deque>
+#include <memory>
+#include <optional>
+
+/**
+ * @brief GPU consumer that keeps a ring region alive
+ *
+ * Frame regions are retired by the frame's in-flight fence, upload regions by
+ * the upload batch's ticket.
+ */
+enum class RingUser {
+    Frame,
+    Upload
+};
+
+struct RingAllocation {
+    vk::Buffer buffer;
+    vk::DeviceSize offset;
+    vk::DeviceSize size;
+    void* mappedData;
+};
+
+/**
+ * @brief Persistently mapped, fence-recycled ring buffer for staging and per-frame data
+ *
+ * One host-visible buffer is mapped for the renderer's lifetime. Allocations are
+ * carved linearly and tagged with the frame serial or upload ticket reading them;
+ * space is reclaimed in order as those consumers retire, so the steady state
+ * performs no buffer creation, mapping or allocation at all.
+ */
+class StagingRing {
+public:
+    static constexpr vk::DeviceSize DEFAULT_CAPACITY = 32ull * 1024 * 1024;
+
+    /**
+     * @brief Create and map the ring buffer
+     * @param device Vulkan device reference
+     * @param capacity Size in bytes (power of two)
+     */
+    explicit StagingRing(VulkanDevice& device, vk::DeviceSize capacity = DEFAULT_CAPACITY);
+
+    ~StagingRing() = default;
+
+    // Disable copy and move
+    StagingRing(const StagingRing&) = delete;
+    StagingRing& operator=(const StagingRing&) = delete;
+    StagingRing(StagingRing&&) = delete;
+    StagingRing& operator=(StagingRing&&) = delete;
+
+    /**
+     * @brief Carve a region out of the ring
+     * @param size Bytes needed
+     * @param alignment Required offset alignment (power of two)
+     * @param user Consumer class that will read the region
+     * @param serial Frame serial or upload ticket of that consumer
+     * @return Region, or std::nullopt if the ring is currently full
+     */
+    std::optional<RingAllocation> allocate(vk::DeviceSize size, vk::DeviceSize alignment,
+                                           RingUser user, uint64_t serial);
+
+    /**
+     * @brief All frames up to and including frameSerial have retired
+     */
+    void retireFrames(uint64_t frameSerial);
+
+    /**
+     * @brief All upload batches up to and including ticket have completed
+     */
+    void retireUploads(uint64_t ticket);
+
+    VulkanBuffer& getBuffer() { return *buffer; }
+    vk::DeviceSize getCapacity() const { return capacity; }
+    vk::DeviceSize getBytesInUse() const { return head - tail; }
+
+private:
+    struct Region {
+        uint64_t end;     // Monotonic position one past the region
+        RingUser user;
+        uint64_t serial;
+    };
+
+    std::unique_ptr<VulkanBuffer> buffer;
+    char* mappedBase = nullptr;
+    vk::DeviceSize capacity;
+
+    // Monotonic byte positions; physical offset is position % capacity
+    uint64_t head = 0;
+    uint64_t tail = 0;
+    std::deque<Region> regions;
+
+    uint64_t retiredFrameSerial = 0;
+    uint64_t retiredUploadTicket = 0;
+
+    void reclaim();
+};
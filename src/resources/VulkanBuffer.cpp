@@ -1,4 +1,6 @@
 #include "VulkanBuffer.hpp"
+#include <algorithm>
+#include <vector>
 
 VulkanBuffer::VulkanBuffer(
     VulkanDevice& device,
@@ -16,29 +18,43 @@ void VulkanBuffer::createBuffer(vk::DeviceSize size, vk::BufferUsageFlags usage,
         .sharingMode = vk::SharingMode::eExclusive
     };
 
-    buffer = vk::raii::Buffer(device.getDevice(), bufferInfo);
+    // Upload sources and destinations are copied on the transfer queue (the staging ring
+    // is also read as uniform and storage memory) and storage buffers may be used on the
+    // async compute queue, while everything is read on the graphics queue
+    std::vector<uint32_t> queueFamilies = { device.getGraphicsQueueFamily() };
+    if ((usage & (vk::BufferUsageFlagBits::eTransferSrc | vk::BufferUsageFlagBits::eTransferDst)) &&
+        device.hasDedicatedTransferQueue()) {
+        queueFamilies.push_back(device.getTransferQueueFamily());
+    }
+    if ((usage & vk::BufferUsageFlagBits::eStorageBuffer) && device.hasAsyncComputeQueue() &&
+        std::find(queueFamilies.begin(), queueFamilies.end(), device.getComputeQueueFamily()) == queueFamilies.end()) {
+        queueFamilies.push_back(device.getComputeQueueFamily());
+    }
+    if (queueFamilies.size() > 1) {
+        bufferInfo.sharingMode = vk::SharingMode::eConcurrent;
+        bufferInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilies.size());
+        bufferInfo.pQueueFamilyIndices = queueFamilies.data();
+    }
 
-    vk::MemoryRequirements memRequirements = buffer.getMemoryRequirements();
-    vk::MemoryAllocateInfo allocInfo{
-        .allocationSize = memRequirements.size,
-        .memoryTypeIndex = device.findMemoryType(memRequirements.memoryTypeBits, properties)
-    };
+    buffer = vk::raii::Buffer(device.getDevice(), bufferInfo);
 
-    memory = vk::raii::DeviceMemory(device.getDevice(), allocInfo);
-    buffer.bindMemory(*memory, 0);
+    // Sub-allocate from the device's pooled memory blocks
+    memory = device.getAllocator().allocate(buffer.getMemoryRequirements(), properties);
+    buffer.bindMemory(memory.getMemory(), memory.getOffset());
 }
 
 void VulkanBuffer::map() {
+    // Host-visible blocks are persistently mapped by the allocator
     if (mappedData == nullptr) {
-        mappedData = memory.mapMemory(0, size);
+        mappedData = memory.getMappedData();
+        if (mappedData == nullptr) {
+            throw std::runtime_error("Buffer memory is not host visible");
+        }
     }
 }
 
 void VulkanBuffer::unmap() {
-    if (mappedData != nullptr) {
-        memory.unmapMemory();
-        mappedData = nullptr;
-    }
+    mappedData = nullptr;
 }
 
 void VulkanBuffer::copyData(const void* data, vk::DeviceSize copySize) {
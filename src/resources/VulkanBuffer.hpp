@@ -33,7 +33,7 @@ public:
 private:
     VulkanDevice& device;
     vk::raii::Buffer buffer = nullptr;
-    vk::raii::DeviceMemory memory = nullptr;
+    MemoryAllocation memory;
     vk::DeviceSize size;
     void* mappedData = nullptr;
 
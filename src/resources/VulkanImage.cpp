@@ -1,4 +1,8 @@
 #include "VulkanImage.hpp"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <stdexcept>
 
 VulkanImage::VulkanImage(
     VulkanDevice& device,
@@ -8,18 +12,23 @@ VulkanImage::VulkanImage(
     vk::ImageTiling tiling,
     vk::ImageUsageFlags usage,
     vk::MemoryPropertyFlags properties,
-    vk::ImageAspectFlags aspectFlags)
-    : device(device), width(width), height(height), format(format), aspectFlags(aspectFlags) {
+    vk::ImageAspectFlags aspectFlags,
+    uint32_t mipLevels)
+    : device(device), width(width), height(height), mipLevels(mipLevels), format(format), aspectFlags(aspectFlags) {
     createImage(tiling, usage, properties);
     createImageView();
 }
 
+uint32_t VulkanImage::fullMipChain(uint32_t width, uint32_t height) {
+    return static_cast<uint32_t>(std::bit_width(std::max({ width, height, 1u })));
+}
+
 void VulkanImage::createImage(vk::ImageTiling tiling, vk::ImageUsageFlags usage, vk::MemoryPropertyFlags properties) {
     vk::ImageCreateInfo imageInfo{
         .imageType = vk::ImageType::e2D,
         .format = format,
         .extent = {width, height, 1},
-        .mipLevels = 1,
+        .mipLevels = mipLevels,
         .arrayLayers = 1,
         .samples = vk::SampleCountFlagBits::e1,
         .tiling = tiling,
@@ -27,16 +36,20 @@ void VulkanImage::createImage(vk::ImageTiling tiling, vk::ImageUsageFlags usage,
         .sharingMode = vk::SharingMode::eExclusive
     };
 
-    image = vk::raii::Image(device.getDevice(), imageInfo);
+    // Upload destinations are written on the transfer queue and read on the graphics queue
+    std::array queueFamilies = { device.getGraphicsQueueFamily(), device.getTransferQueueFamily() };
+    if ((usage & vk::ImageUsageFlagBits::eTransferDst) && device.hasDedicatedTransferQueue()) {
+        imageInfo.sharingMode = vk::SharingMode::eConcurrent;
+        imageInfo.queueFamilyIndexCount = static_cast<uint32_t>(queueFamilies.size());
+        imageInfo.pQueueFamilyIndices = queueFamilies.data();
+    }
 
-    vk::MemoryRequirements memRequirements = image.getMemoryRequirements();
-    vk::MemoryAllocateInfo allocInfo{
-        .allocationSize = memRequirements.size,
-        .memoryTypeIndex = device.findMemoryType(memRequirements.memoryTypeBits, properties)
-    };
+    image = vk::raii::Image(device.getDevice(), imageInfo);
 
-    memory = vk::raii::DeviceMemory(device.getDevice(), allocInfo);
-    image.bindMemory(*memory, 0);
+    // Optimal-tiled images live in their own blocks, apart from buffers (bufferImageGranularity)
+    memory = device.getAllocator().allocate(image.getMemoryRequirements(), properties,
+                                            tiling == vk::ImageTiling::eLinear);
+    image.bindMemory(memory.getMemory(), memory.getOffset());
 }
 
 void VulkanImage::createImageView() {
@@ -44,7 +57,7 @@ void VulkanImage::createImageView() {
         .image = *image,
         .viewType = vk::ImageViewType::e2D,
         .format = format,
-        .subresourceRange = {aspectFlags, 0, 1, 0, 1}
+        .subresourceRange = {aspectFlags, 0, mipLevels, 0, 1}
     };
     imageView = vk::raii::ImageView(device.getDevice(), viewInfo);
 }
@@ -52,7 +65,8 @@ void VulkanImage::createImageView() {
 void VulkanImage::transitionLayout(
     const vk::raii::CommandBuffer& cmdBuffer,
     vk::ImageLayout oldLayout,
-    vk::ImageLayout newLayout) {
+    vk::ImageLayout newLayout,
+    bool transferQueue) {
 
     vk::ImageMemoryBarrier barrier{
         .oldLayout = oldLayout,
@@ -60,7 +74,7 @@ void VulkanImage::transitionLayout(
         .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
         .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
         .image = *image,
-        .subresourceRange = {aspectFlags, 0, 1, 0, 1}
+        .subresourceRange = {aspectFlags, 0, mipLevels, 0, 1}
     };
 
     vk::PipelineStageFlags sourceStage;
@@ -78,6 +92,13 @@ void VulkanImage::transitionLayout(
 
         sourceStage = vk::PipelineStageFlagBits::eTransfer;
         destinationStage = vk::PipelineStageFlagBits::eFragmentShader;
+
+        // A transfer-only queue has no shader stages; the graphics queue only samples the
+        // image after the upload fence has signaled, so no destination scope is needed here
+        if (transferQueue) {
+            barrier.dstAccessMask = {};
+            destinationStage = vk::PipelineStageFlagBits::eBottomOfPipe;
+        }
     } else {
         throw std::invalid_argument("unsupported layout transition!");
     }
@@ -85,9 +106,9 @@ void VulkanImage::transitionLayout(
     cmdBuffer.pipelineBarrier(sourceStage, destinationStage, {}, {}, nullptr, barrier);
 }
 
-void VulkanImage::copyFromBuffer(const vk::raii::CommandBuffer& cmdBuffer, VulkanBuffer& buffer) {
+void VulkanImage::copyFromBuffer(const vk::raii::CommandBuffer& cmdBuffer, vk::Buffer buffer, vk::DeviceSize bufferOffset) {
     vk::BufferImageCopy region{
-        .bufferOffset = 0,
+        .bufferOffset = bufferOffset,
         .bufferRowLength = 0,
         .bufferImageHeight = 0,
         .imageSubresource = {vk::ImageAspectFlagBits::eColor, 0, 0, 1},
@@ -95,7 +116,83 @@ void VulkanImage::copyFromBuffer(const vk::raii::CommandBuffer& cmdBuffer, Vulka
         .imageExtent = {width, height, 1}
     };
 
-    cmdBuffer.copyBufferToImage(buffer.getHandle(), *image, vk::ImageLayout::eTransferDstOptimal, region);
+    cmdBuffer.copyBufferToImage(buffer, *image, vk::ImageLayout::eTransferDstOptimal, region);
+}
+
+void VulkanImage::copyLevelsFromBuffer(const vk::raii::CommandBuffer& cmdBuffer, vk::Buffer buffer,
+                                       vk::DeviceSize bufferOffset, std::span<const vk::DeviceSize> levelOffsets) {
+    if (levelOffsets.size() > mipLevels) {
+        throw std::invalid_argument("more mip levels supplied than the image has");
+    }
+
+    std::vector<vk::BufferImageCopy> regions;
+    regions.reserve(levelOffsets.size());
+    for (uint32_t level = 0; level < levelOffsets.size(); level++) {
+        regions.push_back({
+            .bufferOffset = bufferOffset + levelOffsets[level],
+            .bufferRowLength = 0,
+            .bufferImageHeight = 0,
+            .imageSubresource = {vk::ImageAspectFlagBits::eColor, level, 0, 1},
+            .imageOffset = {0, 0, 0},
+            .imageExtent = {std::max(width >> level, 1u), std::max(height >> level, 1u), 1}
+        });
+    }
+
+    cmdBuffer.copyBufferToImage(buffer, *image, vk::ImageLayout::eTransferDstOptimal, regions);
+}
+
+void VulkanImage::generateMipmaps(const vk::raii::CommandBuffer& cmdBuffer) {
+    vk::ImageMemoryBarrier barrier{
+        .srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED,
+        .image = *image,
+        .subresourceRange = {aspectFlags, 0, 1, 0, 1}
+    };
+
+    int32_t mipWidth = static_cast<int32_t>(width);
+    int32_t mipHeight = static_cast<int32_t>(height);
+
+    for (uint32_t level = 1; level < mipLevels; level++) {
+        // Previous level was just written (copy or blit); make it the blit source
+        barrier.subresourceRange.baseMipLevel = level - 1;
+        barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+        barrier.newLayout = vk::ImageLayout::eTransferSrcOptimal;
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+        barrier.dstAccessMask = vk::AccessFlagBits::eTransferRead;
+        cmdBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eTransfer,
+                                  {}, {}, nullptr, barrier);
+
+        int32_t nextWidth = std::max(mipWidth / 2, 1);
+        int32_t nextHeight = std::max(mipHeight / 2, 1);
+        vk::ImageBlit blit{
+            .srcSubresource = {aspectFlags, level - 1, 0, 1},
+            .srcOffsets = std::array{ vk::Offset3D{0, 0, 0}, vk::Offset3D{mipWidth, mipHeight, 1} },
+            .dstSubresource = {aspectFlags, level, 0, 1},
+            .dstOffsets = std::array{ vk::Offset3D{0, 0, 0}, vk::Offset3D{nextWidth, nextHeight, 1} }
+        };
+        cmdBuffer.blitImage(*image, vk::ImageLayout::eTransferSrcOptimal,
+                            *image, vk::ImageLayout::eTransferDstOptimal, blit, vk::Filter::eLinear);
+
+        // Source level is final
+        barrier.oldLayout = vk::ImageLayout::eTransferSrcOptimal;
+        barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+        barrier.srcAccessMask = vk::AccessFlagBits::eTransferRead;
+        barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+        cmdBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader,
+                                  {}, {}, nullptr, barrier);
+
+        mipWidth = nextWidth;
+        mipHeight = nextHeight;
+    }
+
+    // The last level is only ever a blit destination
+    barrier.subresourceRange.baseMipLevel = mipLevels - 1;
+    barrier.oldLayout = vk::ImageLayout::eTransferDstOptimal;
+    barrier.newLayout = vk::ImageLayout::eShaderReadOnlyOptimal;
+    barrier.srcAccessMask = vk::AccessFlagBits::eTransferWrite;
+    barrier.dstAccessMask = vk::AccessFlagBits::eShaderRead;
+    cmdBuffer.pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader,
+                              {}, {}, nullptr, barrier);
 }
 
 void VulkanImage::createSampler(
@@ -104,10 +201,9 @@ void VulkanImage::createSampler(
     vk::SamplerAddressMode addressMode) {
 
     vk::PhysicalDeviceProperties properties = device.getPhysicalDevice().getProperties();
-    vk::PhysicalDeviceFeatures features = device.getPhysicalDevice().getFeatures();
 
-    // Only enable anisotropy if the device supports it
-    bool enableAnisotropy = features.samplerAnisotropy;
+    // Only enable anisotropy if the device enabled it
+    bool enableAnisotropy = device.getCapabilities().samplerAnisotropy;
 
     vk::SamplerCreateInfo samplerInfo{
         .magFilter = magFilter,
@@ -122,7 +218,7 @@ void VulkanImage::createSampler(
         .compareEnable = vk::False,
         .compareOp = vk::CompareOp::eAlways,
         .minLod = 0.0f,
-        .maxLod = 0.0f,
+        .maxLod = static_cast<float>(mipLevels),
         .borderColor = vk::BorderColor::eIntOpaqueBlack,
         .unnormalizedCoordinates = vk::False
     };
@@ -4,6 +4,7 @@
 #include "../core/VulkanDevice.hpp"
 #include "VulkanBuffer.hpp"
 #include <optional>
+#include <span>
 
 class VulkanImage {
 public:
@@ -15,7 +16,8 @@ public:
         vk::ImageTiling tiling,
         vk::ImageUsageFlags usage,
         vk::MemoryPropertyFlags properties,
-        vk::ImageAspectFlags aspectFlags);
+        vk::ImageAspectFlags aspectFlags,
+        uint32_t mipLevels = 1);
 
     ~VulkanImage() = default; // RAII handles cleanup
 
@@ -25,13 +27,34 @@ public:
     VulkanImage(VulkanImage&&) = default;
     VulkanImage& operator=(VulkanImage&&) = delete;  // Move assignment not supported due to reference member
 
-    // Layout transitions
+    /**
+     * @brief Number of levels in a full mip chain down to 1x1
+     */
+    static uint32_t fullMipChain(uint32_t width, uint32_t height);
+
+    // Layout transitions (all mip levels)
     void transitionLayout(
         const vk::raii::CommandBuffer& cmdBuffer,
         vk::ImageLayout oldLayout,
-        vk::ImageLayout newLayout);
+        vk::ImageLayout newLayout,
+        bool transferQueue = false);
+
+    void copyFromBuffer(const vk::raii::CommandBuffer& cmdBuffer, vk::Buffer buffer, vk::DeviceSize bufferOffset = 0);
+
+    /**
+     * @brief Copy tightly packed mip levels, level i starting at bufferOffset + levelOffsets[i]
+     */
+    void copyLevelsFromBuffer(const vk::raii::CommandBuffer& cmdBuffer, vk::Buffer buffer,
+                              vk::DeviceSize bufferOffset, std::span<const vk::DeviceSize> levelOffsets);
 
-    void copyFromBuffer(const vk::raii::CommandBuffer& cmdBuffer, VulkanBuffer& buffer);
+    /**
+     * @brief Fill levels 1..n by successive linear blits from level 0
+     *
+     * Expects every level in eTransferDstOptimal with level 0 written, and leaves
+     * the whole image in eShaderReadOnlyOptimal. Needs a graphics queue and a format
+     * with eBlitSrc | eBlitDst | eSampledImageFilterLinear support.
+     */
+    void generateMipmaps(const vk::raii::CommandBuffer& cmdBuffer);
 
     // Sampler operations
     void createSampler(
@@ -45,16 +68,19 @@ public:
     vk::Sampler getSampler() const { return sampler ? **sampler : nullptr; }
     uint32_t getWidth() const { return width; }
     uint32_t getHeight() const { return height; }
+    uint32_t getMipLevels() const { return mipLevels; }
+    vk::Format getFormat() const { return format; }
 
 private:
     VulkanDevice& device;
     vk::raii::Image image = nullptr;
-    vk::raii::DeviceMemory memory = nullptr;
+    MemoryAllocation memory;
     vk::raii::ImageView imageView = nullptr;
     std::optional<vk::raii::Sampler> sampler;
 
     uint32_t width;
     uint32_t height;
+    uint32_t mipLevels;
     vk::Format format;
     vk::ImageAspectFlags aspectFlags;
 
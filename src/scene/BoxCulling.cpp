@@ -0,0 +1,369 @@
+#include "BoxCulling.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define BOX_CULLING_X86 1
+#include <immintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define BOX_CULLING_NEON 1
+#include <arm_neon.h>
+#endif
+
+// GCC and Clang build the AVX2 path for its own function only and check the CPU at runtime;
+// MSVC needs the whole file built with /arch:AVX2
+#if defined(BOX_CULLING_X86) && (defined(__GNUC__) || defined(__clang__))
+#define BOX_CULLING_AVX2 1
+#define BOX_CULLING_AVX2_TARGET __attribute__((target("avx2")))
+#elif defined(BOX_CULLING_X86) && defined(__AVX2__)
+#define BOX_CULLING_AVX2 1
+#define BOX_CULLING_AVX2_TARGET
+#endif
+
+uint32_t BoxList::add(const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+    if (count % LANES == 0) {
+        for (std::vector<float>& component : components) {
+            component.resize(count + LANES, 0.0f);
+        }
+    }
+    count++;
+    set(count - 1, boundsMin, boundsMax);
+    return count - 1;
+}
+
+void BoxList::set(uint32_t box, const glm::vec3& boundsMin, const glm::vec3& boundsMax) {
+    if (box >= count) {
+        throw std::out_of_range("BoxList::set: no box " + std::to_string(box));
+    }
+    components[0][box] = boundsMin.x;
+    components[1][box] = boundsMin.y;
+    components[2][box] = boundsMin.z;
+    components[3][box] = boundsMax.x;
+    components[4][box] = boundsMax.y;
+    components[5][box] = boundsMax.z;
+}
+
+void BoxList::clear() {
+    for (std::vector<float>& component : components) {
+        component.clear();
+    }
+    count = 0;
+}
+
+void BoxList::reserve(uint32_t capacity) {
+    for (std::vector<float>& component : components) {
+        component.reserve((capacity + LANES - 1) / LANES * LANES);
+    }
+}
+
+namespace {
+    // Per plane, the component arrays holding each box's corner furthest along the normal
+    struct PlaneCorner {
+        glm::vec4 plane;
+        std::array<const float*, 3> corner;
+    };
+
+    std::array<PlaneCorner, 6> planeCorners(const Frustum& frustum, const std::array<std::vector<float>, 6>& components) {
+        std::array<PlaneCorner, 6> result;
+        for (size_t i = 0; i < frustum.planes.size(); i++) {
+            const glm::vec4& plane = frustum.planes[i];
+            result[i].plane = plane;
+            for (int axis = 0; axis < 3; axis++) {
+                result[i].corner[axis] = components[plane[axis] >= 0.0f ? 3 + axis : axis].data();
+            }
+        }
+        return result;
+    }
+
+    // Appends base + the index of every set bit, skipping lanes outside [begin, end)
+    uint32_t* appendVisible(uint32_t* out, uint32_t mask, uint32_t base, uint32_t begin, uint32_t end) {
+        if (begin > base) {
+            mask &= ~((1u << (begin - base)) - 1);
+        }
+        if (end - base < 32) {
+            mask &= (1u << (end - base)) - 1;
+        }
+        while (mask != 0) {
+            *out++ = base + static_cast<uint32_t>(std::countr_zero(mask));
+            mask &= mask - 1;
+        }
+        return out;
+    }
+
+    uint32_t* cullScalar(const std::array<PlaneCorner, 6>& planes, uint32_t begin, uint32_t end, uint32_t* out) {
+        for (uint32_t box = begin; box < end; box++) {
+            bool inside = true;
+            for (const PlaneCorner& p : planes) {
+                const glm::vec3 corner(p.corner[0][box], p.corner[1][box], p.corner[2][box]);
+                if (glm::dot(glm::vec3(p.plane), corner) + p.plane.w < 0.0f) {
+                    inside = false;
+                    break;
+                }
+            }
+            if (inside) {
+                *out++ = box;
+            }
+        }
+        return out;
+    }
+
+    VertexBounds boundsScalar(std::span<const Vertex> vertices) {
+        VertexBounds bounds;
+        for (const Vertex& vertex : vertices) {
+            bounds.posMin = glm::min(bounds.posMin, vertex.pos);
+            bounds.posMax = glm::max(bounds.posMax, vertex.pos);
+            bounds.uvMin = glm::min(bounds.uvMin, vertex.texCoord);
+            bounds.uvMax = glm::max(bounds.uvMax, vertex.texCoord);
+        }
+        return bounds;
+    }
+
+    // Vertex is pos, color, texCoord: floats 0-2 are the position and 6-7 the UV
+    static_assert(sizeof(Vertex) == 8 * sizeof(float) && offsetof(Vertex, texCoord) == 6 * sizeof(float),
+                  "the SIMD bounds paths load a Vertex as 8 floats");
+
+    VertexBounds boundsFromLanes(const float* minLanes, const float* maxLanes) {
+        VertexBounds bounds;
+        bounds.posMin = glm::vec3(minLanes[0], minLanes[1], minLanes[2]);
+        bounds.posMax = glm::vec3(maxLanes[0], maxLanes[1], maxLanes[2]);
+        bounds.uvMin = glm::vec2(minLanes[6], minLanes[7]);
+        bounds.uvMax = glm::vec2(maxLanes[6], maxLanes[7]);
+        return bounds;
+    }
+
+#ifdef BOX_CULLING_X86
+    uint32_t* cullSSE(const std::array<PlaneCorner, 6>& planes, uint32_t begin, uint32_t end, uint32_t* out) {
+        for (uint32_t base = begin & ~3u; base < end; base += 4) {
+            __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+            for (const PlaneCorner& p : planes) {
+                __m128 distance = _mm_mul_ps(_mm_set1_ps(p.plane.x), _mm_loadu_ps(p.corner[0] + base));
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(p.plane.y), _mm_loadu_ps(p.corner[1] + base)));
+                distance = _mm_add_ps(distance, _mm_mul_ps(_mm_set1_ps(p.plane.z), _mm_loadu_ps(p.corner[2] + base)));
+                distance = _mm_add_ps(distance, _mm_set1_ps(p.plane.w));
+                inside = _mm_and_ps(inside, _mm_cmpge_ps(distance, _mm_setzero_ps()));
+            }
+            out = appendVisible(out, static_cast<uint32_t>(_mm_movemask_ps(inside)), base, begin, end);
+        }
+        return out;
+    }
+
+    VertexBounds boundsSSE(std::span<const Vertex> vertices) {
+        __m128 minLo = _mm_set1_ps(std::numeric_limits<float>::max());
+        __m128 minHi = minLo;
+        __m128 maxLo = _mm_set1_ps(std::numeric_limits<float>::lowest());
+        __m128 maxHi = maxLo;
+        for (const Vertex& vertex : vertices) {
+            const float* lanes = &vertex.pos.x;
+            const __m128 lo = _mm_loadu_ps(lanes);
+            const __m128 hi = _mm_loadu_ps(lanes + 4);
+            minLo = _mm_min_ps(minLo, lo);
+            minHi = _mm_min_ps(minHi, hi);
+            maxLo = _mm_max_ps(maxLo, lo);
+            maxHi = _mm_max_ps(maxHi, hi);
+        }
+        alignas(16) float minLanes[8];
+        alignas(16) float maxLanes[8];
+        _mm_store_ps(minLanes, minLo);
+        _mm_store_ps(minLanes + 4, minHi);
+        _mm_store_ps(maxLanes, maxLo);
+        _mm_store_ps(maxLanes + 4, maxHi);
+        return boundsFromLanes(minLanes, maxLanes);
+    }
+#endif
+
+#ifdef BOX_CULLING_AVX2
+    BOX_CULLING_AVX2_TARGET
+    uint32_t* cullAVX2(const std::array<PlaneCorner, 6>& planes, uint32_t begin, uint32_t end, uint32_t* out) {
+        for (uint32_t base = begin & ~7u; base < end; base += 8) {
+            __m256 inside = _mm256_castsi256_ps(_mm256_set1_epi32(-1));
+            for (const PlaneCorner& p : planes) {
+                __m256 distance = _mm256_mul_ps(_mm256_set1_ps(p.plane.x), _mm256_loadu_ps(p.corner[0] + base));
+                distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(p.plane.y), _mm256_loadu_ps(p.corner[1] + base)));
+                distance = _mm256_add_ps(distance, _mm256_mul_ps(_mm256_set1_ps(p.plane.z), _mm256_loadu_ps(p.corner[2] + base)));
+                distance = _mm256_add_ps(distance, _mm256_set1_ps(p.plane.w));
+                inside = _mm256_and_ps(inside, _mm256_cmp_ps(distance, _mm256_setzero_ps(), _CMP_GE_OQ));
+            }
+            out = appendVisible(out, static_cast<uint32_t>(_mm256_movemask_ps(inside)), base, begin, end);
+        }
+        return out;
+    }
+
+    BOX_CULLING_AVX2_TARGET
+    VertexBounds boundsAVX2(std::span<const Vertex> vertices) {
+        __m256 minLanes = _mm256_set1_ps(std::numeric_limits<float>::max());
+        __m256 maxLanes = _mm256_set1_ps(std::numeric_limits<float>::lowest());
+        for (const Vertex& vertex : vertices) {
+            const __m256 lanes = _mm256_loadu_ps(&vertex.pos.x);
+            minLanes = _mm256_min_ps(minLanes, lanes);
+            maxLanes = _mm256_max_ps(maxLanes, lanes);
+        }
+        alignas(32) float minResult[8];
+        alignas(32) float maxResult[8];
+        _mm256_store_ps(minResult, minLanes);
+        _mm256_store_ps(maxResult, maxLanes);
+        return boundsFromLanes(minResult, maxResult);
+    }
+#endif
+
+#ifdef BOX_CULLING_NEON
+    uint32_t* cullNEON(const std::array<PlaneCorner, 6>& planes, uint32_t begin, uint32_t end, uint32_t* out) {
+        const uint32x4_t laneBits = { 1, 2, 4, 8 };
+        for (uint32_t base = begin & ~3u; base < end; base += 4) {
+            uint32x4_t inside = vdupq_n_u32(~0u);
+            for (const PlaneCorner& p : planes) {
+                float32x4_t distance = vmulq_n_f32(vld1q_f32(p.corner[0] + base), p.plane.x);
+                distance = vaddq_f32(distance, vmulq_n_f32(vld1q_f32(p.corner[1] + base), p.plane.y));
+                distance = vaddq_f32(distance, vmulq_n_f32(vld1q_f32(p.corner[2] + base), p.plane.z));
+                distance = vaddq_f32(distance, vdupq_n_f32(p.plane.w));
+                inside = vandq_u32(inside, vcgeq_f32(distance, vdupq_n_f32(0.0f)));
+            }
+            out = appendVisible(out, vaddvq_u32(vandq_u32(inside, laneBits)), base, begin, end);
+        }
+        return out;
+    }
+
+    VertexBounds boundsNEON(std::span<const Vertex> vertices) {
+        float32x4_t minLo = vdupq_n_f32(std::numeric_limits<float>::max());
+        float32x4_t minHi = minLo;
+        float32x4_t maxLo = vdupq_n_f32(std::numeric_limits<float>::lowest());
+        float32x4_t maxHi = maxLo;
+        for (const Vertex& vertex : vertices) {
+            const float* lanes = &vertex.pos.x;
+            const float32x4_t lo = vld1q_f32(lanes);
+            const float32x4_t hi = vld1q_f32(lanes + 4);
+            minLo = vminq_f32(minLo, lo);
+            minHi = vminq_f32(minHi, hi);
+            maxLo = vmaxq_f32(maxLo, lo);
+            maxHi = vmaxq_f32(maxHi, hi);
+        }
+        float minLanes[8];
+        float maxLanes[8];
+        vst1q_f32(minLanes, minLo);
+        vst1q_f32(minLanes + 4, minHi);
+        vst1q_f32(maxLanes, maxLo);
+        vst1q_f32(maxLanes + 4, maxHi);
+        return boundsFromLanes(minLanes, maxLanes);
+    }
+#endif
+
+    BoxCulling::Path detectBestPath() {
+#ifdef BOX_CULLING_AVX2
+#if defined(__GNUC__) || defined(__clang__)
+        if (__builtin_cpu_supports("avx2")) {
+            return BoxCulling::Path::AVX2;
+        }
+#else
+        return BoxCulling::Path::AVX2;
+#endif
+#endif
+#if defined(BOX_CULLING_X86)
+        return BoxCulling::Path::SSE;
+#elif defined(BOX_CULLING_NEON)
+        return BoxCulling::Path::NEON;
+#else
+        return BoxCulling::Path::Scalar;
+#endif
+    }
+}
+
+uint32_t BoxCulling::cull(const Frustum& frustum, const BoxList& boxes, std::vector<uint32_t>& visible) {
+    return cull(frustum, boxes, visible, getBestPath());
+}
+
+uint32_t BoxCulling::cull(const Frustum& frustum, const BoxList& boxes, std::vector<uint32_t>& visible, Path path) {
+    visible.clear();
+    return cullRange(frustum, boxes, 0, boxes.count, visible, path);
+}
+
+uint32_t BoxCulling::cull(const Frustum& frustum, const BoxList& boxes, uint32_t first, uint32_t count,
+                          std::vector<uint32_t>& visible) {
+    if (first > boxes.count || count > boxes.count - first) {
+        throw std::out_of_range("BoxCulling: box range exceeds the list");
+    }
+    return cullRange(frustum, boxes, first, count, visible, getBestPath());
+}
+
+uint32_t BoxCulling::cullRange(const Frustum& frustum, const BoxList& boxes, uint32_t first, uint32_t count,
+                               std::vector<uint32_t>& visible, Path path) {
+    if (!isSupported(path)) {
+        throw std::invalid_argument(std::string("BoxCulling: ") + getPathName(path) + " isn't supported here");
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    // Loads start lane-aligned and may run into the padding; lanes outside the range are masked off
+    const size_t start = visible.size();
+    visible.resize(start + count);
+    const std::array<PlaneCorner, 6> planes = planeCorners(frustum, boxes.components);
+    const uint32_t end = first + count;
+    uint32_t* out = visible.data() + start;
+    switch (path) {
+#ifdef BOX_CULLING_X86
+        case Path::SSE:  out = cullSSE(planes, first, end, out); break;
+#endif
+#ifdef BOX_CULLING_AVX2
+        case Path::AVX2: out = cullAVX2(planes, first, end, out); break;
+#endif
+#ifdef BOX_CULLING_NEON
+        case Path::NEON: out = cullNEON(planes, first, end, out); break;
+#endif
+        default:         out = cullScalar(planes, first, end, out); break;
+    }
+    visible.resize(static_cast<size_t>(out - visible.data()));
+    return static_cast<uint32_t>(visible.size() - start);
+}
+
+VertexBounds BoxCulling::computeBounds(std::span<const Vertex> vertices) {
+    return computeBounds(vertices, getBestPath());
+}
+
+VertexBounds BoxCulling::computeBounds(std::span<const Vertex> vertices, Path path) {
+    if (!isSupported(path)) {
+        throw std::invalid_argument(std::string("BoxCulling: ") + getPathName(path) + " isn't supported here");
+    }
+    switch (path) {
+#ifdef BOX_CULLING_X86
+        case Path::SSE:  return boundsSSE(vertices);
+#endif
+#ifdef BOX_CULLING_AVX2
+        case Path::AVX2: return boundsAVX2(vertices);
+#endif
+#ifdef BOX_CULLING_NEON
+        case Path::NEON: return boundsNEON(vertices);
+#endif
+        default:         return boundsScalar(vertices);
+    }
+}
+
+BoxCulling::Path BoxCulling::getBestPath() {
+    static const Path best = detectBestPath();
+    return best;
+}
+
+bool BoxCulling::isSupported(Path path) {
+    switch (path) {
+        case Path::Scalar: return true;
+#ifdef BOX_CULLING_X86
+        case Path::SSE:    return true;
+#endif
+        case Path::AVX2:   return getBestPath() == Path::AVX2;
+#ifdef BOX_CULLING_NEON
+        case Path::NEON:   return true;
+#endif
+        default:           return false;
+    }
+}
+
+const char* BoxCulling::getPathName(Path path) {
+    switch (path) {
+        case Path::SSE:  return "SSE2";
+        case Path::AVX2: return "AVX2";
+        case Path::NEON: return "NEON";
+        default:         return "scalar";
+    }
+}
@@ -0,0 +1,128 @@
+#pragma once
+
+#include "src/scene/Frustum.hpp"
+#include "src/utils/Vertex.hpp"
+
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+/**
+ * @brief Axis-aligned boxes in structure-of-arrays form, for culling several at once
+ *
+ * Each bound component is its own array, so one SIMD load reads the same component
+ * of 4 or 8 consecutive boxes. The arrays are padded to the widest path's lane count;
+ * padding boxes are never reported visible.
+ */
+class BoxList {
+public:
+    /**
+     * @brief Append a box
+     * @return Box index, reported by BoxCulling::cull
+     */
+    uint32_t add(const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+
+    /**
+     * @brief Replace a box's bounds
+     * @throws std::out_of_range if the index isn't a box
+     */
+    void set(uint32_t box, const glm::vec3& boundsMin, const glm::vec3& boundsMax);
+
+    void clear();
+    void reserve(uint32_t capacity);
+
+    uint32_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    glm::vec3 getMin(uint32_t box) const { return { components[0][box], components[1][box], components[2][box] }; }
+    glm::vec3 getMax(uint32_t box) const { return { components[3][box], components[4][box], components[5][box] }; }
+
+private:
+    friend class BoxCulling;
+
+    static constexpr uint32_t LANES = 8;  // Widest path (AVX2), so full-width loads stay in the arrays
+
+    std::array<std::vector<float>, 6> components;  // minX, minY, minZ, maxX, maxY, maxZ
+    uint32_t count = 0;
+};
+
+/**
+ * @brief Position and UV ranges of a vertex array
+ */
+struct VertexBounds {
+    glm::vec3 posMin{ std::numeric_limits<float>::max() };
+    glm::vec3 posMax{ std::numeric_limits<float>::lowest() };
+    glm::vec2 uvMin{ std::numeric_limits<float>::max() };
+    glm::vec2 uvMax{ std::numeric_limits<float>::lowest() };
+};
+
+/**
+ * @brief CPU frustum culling of BoxLists and vertex bounds, 4 or 8 lanes at a time
+ *
+ * Every path runs Frustum::intersects' test: a box is culled only when its corner
+ * furthest along some plane's normal lies behind that plane. That corner is picked per
+ * plane rather than per box, so each plane costs three multiplies, three adds and a
+ * compare per lane, and the visible boxes come out as a compacted, ascending index
+ * list the recorder iterates directly.
+ *
+ * The path is picked once at startup: AVX2 (8 boxes) when the CPU has it, SSE2
+ * (4 boxes, always present on x86-64) otherwise, NEON (4 boxes) on 64-bit ARM, and
+ * the scalar reference elsewhere. GCC and Clang compile the AVX2 path without
+ * -mavx2 and only call it after a CPUID check; MSVC includes it when built with
+ * /arch:AVX2. Every path agrees with Frustum::intersects box for box, since the
+ * lanes follow its order of operations.
+ */
+class BoxCulling {
+public:
+    enum class Path {
+        Scalar,
+        SSE,
+        AVX2,
+        NEON
+    };
+
+    /**
+     * @brief Indices of the boxes the frustum may see, ascending, on the best path
+     * @param visible Replaced with the visible indices
+     * @return Number of visible boxes
+     */
+    static uint32_t cull(const Frustum& frustum, const BoxList& boxes, std::vector<uint32_t>& visible);
+
+    /**
+     * @brief Same, on a given path (see isSupported)
+     */
+    static uint32_t cull(const Frustum& frustum, const BoxList& boxes, std::vector<uint32_t>& visible, Path path);
+
+    /**
+     * @brief Append the indices of the visible boxes among [first, first + count), ascending, on the best path
+     * @return Number of indices appended
+     * @throws std::out_of_range if the range exceeds the list
+     */
+    static uint32_t cull(const Frustum& frustum, const BoxList& boxes, uint32_t first, uint32_t count,
+                         std::vector<uint32_t>& visible);
+
+    /**
+     * @brief Position and UV bounds over vertices, on the best path
+     *
+     * Loads whole vertices and keeps the color lanes' results unused, so the
+     * array-of-structures layout needs no gather. Empty spans return the
+     * inverted (max/lowest) ranges.
+     */
+    static VertexBounds computeBounds(std::span<const Vertex> vertices);
+
+    /**
+     * @brief Same, on a given path
+     */
+    static VertexBounds computeBounds(std::span<const Vertex> vertices, Path path);
+
+    static Path getBestPath();
+    static bool isSupported(Path path);
+    static const char* getPathName(Path path);
+
+private:
+    BoxCulling() = delete;  // Static utility class, no instances
+
+    static uint32_t cullRange(const Frustum& frustum, const BoxList& boxes, uint32_t first, uint32_t count,
+                              std::vector<uint32_t>& visible, Path path);
+};
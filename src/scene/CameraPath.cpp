@@ -0,0 +1,102 @@
+#include "CameraPath.hpp"
+
+#include <glm/gtc/constants.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+    // Keyframes per revolution of the circular paths; dense enough that the chords don't show
+    constexpr uint32_t CIRCLE_KEYS = 64;
+}
+
+CameraPath CameraPath::fromName(const std::string& nameOrPath) {
+    if (nameOrPath == "spin") {
+        return spin();
+    }
+    if (nameOrPath == "orbit") {
+        return orbit();
+    }
+    if (nameOrPath == "flyover") {
+        return flyover();
+    }
+    return load(nameOrPath);
+}
+
+CameraPath CameraPath::spin() {
+    std::vector<CameraPose> keys;
+    for (uint32_t i = 0; i <= CIRCLE_KEYS; i++) {
+        keys.push_back({ .modelAngle = glm::two_pi<float>() * static_cast<float>(i) / CIRCLE_KEYS });
+    }
+    return CameraPath("spin", std::move(keys));
+}
+
+CameraPath CameraPath::orbit() {
+    // Same distance and height as the interactive view, circling instead of spinning the model
+    const float radius = glm::length(glm::vec2(2.0f, 2.0f));
+    std::vector<CameraPose> keys;
+    for (uint32_t i = 0; i <= CIRCLE_KEYS; i++) {
+        const float angle = glm::quarter_pi<float>() + glm::two_pi<float>() * static_cast<float>(i) / CIRCLE_KEYS;
+        keys.push_back({ .eye = { radius * std::cos(angle), radius * std::sin(angle), 2.0f } });
+    }
+    return CameraPath("orbit", std::move(keys));
+}
+
+CameraPath CameraPath::flyover() {
+    // Low across the model, looking ahead of the eye
+    return CameraPath("flyover", {
+        { .eye = { 2.5f, -2.5f, 0.8f }, .target = { 0.5f, -0.5f, 0.0f } },
+        { .eye = { 1.0f, -1.0f, 0.5f }, .target = { -0.5f, 0.5f, 0.0f } },
+        { .eye = { -0.5f, 0.5f, 0.5f }, .target = { -2.0f, 2.0f, 0.0f } },
+        { .eye = { -2.5f, 2.5f, 1.2f }, .target = { 0.0f, 0.0f, 0.0f } }
+    });
+}
+
+CameraPath CameraPath::load(const std::string& path) {
+    std::ifstream file(path);
+    if (!file) {
+        throw std::runtime_error("failed to open camera path: " + path);
+    }
+
+    std::vector<CameraPose> keys;
+    std::string line;
+    for (uint32_t lineNumber = 1; std::getline(file, line); lineNumber++) {
+        const size_t first = line.find_first_not_of(" \t\r");
+        if (first == std::string::npos || line[first] == '#') {
+            continue;
+        }
+        std::istringstream fields(line);
+        CameraPose pose;
+        float angleDegrees = 0.0f;
+        if (!(fields >> pose.eye.x >> pose.eye.y >> pose.eye.z
+                     >> pose.target.x >> pose.target.y >> pose.target.z >> angleDegrees)) {
+            throw std::runtime_error(path + ":" + std::to_string(lineNumber) + ": expected 7 numbers");
+        }
+        pose.modelAngle = glm::radians(angleDegrees);
+        keys.push_back(pose);
+    }
+    if (keys.empty()) {
+        throw std::runtime_error("camera path has no keyframes: " + path);
+    }
+    return CameraPath(path, std::move(keys));
+}
+
+CameraPose CameraPath::sample(float t) const {
+    if (keys.size() == 1) {
+        return keys.front();
+    }
+
+    const float position = std::clamp(t, 0.0f, 1.0f) * static_cast<float>(keys.size() - 1);
+    const size_t index = std::min(static_cast<size_t>(position), keys.size() - 2);
+    const float blend = position - static_cast<float>(index);
+    const CameraPose& from = keys[index];
+    const CameraPose& to = keys[index + 1];
+    return {
+        .eye = glm::mix(from.eye, to.eye, blend),
+        .target = glm::mix(from.target, to.target, blend),
+        .modelAngle = glm::mix(from.modelAngle, to.modelAngle, blend)
+    };
+}
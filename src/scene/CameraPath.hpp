@@ -0,0 +1,50 @@
+#pragma once
+
+#include "src/utils/VulkanCommon.hpp"
+
+#include <string>
+#include <vector>
+
+/**
+ * @brief Where the camera looks from, and how far the model is turned
+ */
+struct CameraPose {
+    glm::vec3 eye{ 2.0f, 2.0f, 2.0f };
+    glm::vec3 target{ 0.0f, 0.0f, 0.0f };
+    float modelAngle = 0.0f;  // Radians about +z, as the interactive view spins the model
+};
+
+/**
+ * @brief Scripted camera for repeatable runs: keyframes spread evenly over [0, 1]
+ *
+ * Built-in paths are "spin" (the interactive view, one model revolution), "orbit"
+ * (the eye circling the model) and "flyover" (a low pass across it). Path files
+ * hold one keyframe per line, `eye.x eye.y eye.z target.x target.y target.z angle`
+ * with the angle in degrees; blank lines and lines starting with '#' are skipped.
+ */
+class CameraPath {
+public:
+    /**
+     * @brief A built-in path by name, otherwise a path file
+     * @throws std::runtime_error if the file can't be read or has fewer than one keyframe
+     */
+    static CameraPath fromName(const std::string& nameOrPath);
+
+    static CameraPath spin();
+    static CameraPath orbit();
+    static CameraPath flyover();
+    static CameraPath load(const std::string& path);
+
+    /**
+     * @brief Pose at t in [0, 1], linearly interpolated between the neighboring keyframes
+     */
+    CameraPose sample(float t) const;
+
+    const std::string& getName() const { return name; }
+
+private:
+    CameraPath(std::string name, std::vector<CameraPose> keys) : name(std::move(name)), keys(std::move(keys)) {}
+
+    std::string name;
+    std::vector<CameraPose> keys;
+};
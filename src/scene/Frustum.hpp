@@ -0,0 +1,49 @@
+#pragma once
+
+#include "src/utils/VulkanCommon.hpp"
+
+#include <array>
+
+/**
+ * @brief View frustum as six inward-facing planes, for CPU-side culling
+ *
+ * Planes are extracted from a combined projection matrix (Gribb/Hartmann), so they
+ * live in whatever space the matrix maps from: pass proj * view * model to cull in
+ * object space.
+ */
+struct Frustum {
+    std::array<glm::vec4, 6> planes{};  // xyz = normal, w = distance; inside when dot >= 0
+
+    /**
+     * @brief Extract planes from a Vulkan clip matrix (depth range [0, 1])
+     */
+    static Frustum fromMatrix(const glm::mat4& m) {
+        auto row = [&m](int i) { return glm::vec4(m[0][i], m[1][i], m[2][i], m[3][i]); };
+
+        Frustum frustum;
+        frustum.planes[0] = row(3) + row(0);  // Left
+        frustum.planes[1] = row(3) - row(0);  // Right
+        frustum.planes[2] = row(3) + row(1);  // Bottom
+        frustum.planes[3] = row(3) - row(1);  // Top
+        frustum.planes[4] = row(2);           // Near (z >= 0)
+        frustum.planes[5] = row(3) - row(2);  // Far
+        return frustum;
+    }
+
+    /**
+     * @brief Conservative box test: false only if the box is fully outside one plane
+     */
+    bool intersects(const glm::vec3& boundsMin, const glm::vec3& boundsMax) const {
+        for (const glm::vec4& plane : planes) {
+            // Corner furthest along the plane normal
+            glm::vec3 positive(
+                plane.x >= 0.0f ? boundsMax.x : boundsMin.x,
+                plane.y >= 0.0f ? boundsMax.y : boundsMin.y,
+                plane.z >= 0.0f ? boundsMax.z : boundsMin.z);
+            if (glm::dot(glm::vec3(plane), positive) + plane.w < 0.0f) {
+                return false;
+            }
+        }
+        return true;
+    }
+};
@@ -0,0 +1,79 @@
+#include "GridIndexCache.hpp"
+
+#include <stdexcept>
+
+namespace {
+    // Sample positions along one axis: every step-th point, always including the far edge
+    std::vector<uint32_t> samplePositions(uint32_t cells, uint32_t step) {
+        std::vector<uint32_t> positions;
+        for (uint32_t p = 0; p < cells; p += step) {
+            positions.push_back(p);
+        }
+        positions.push_back(cells);
+        return positions;
+    }
+}
+
+GridIndexCache::GridIndexCache(VulkanDevice& device, UploadManager& uploadManager)
+    : device(device), uploadManager(uploadManager) {
+}
+
+std::shared_ptr<const GridIndices> GridIndexCache::acquire(const GridPattern& pattern) {
+    if (auto it = entries.find(pattern); it != entries.end()) {
+        if (auto existing = it->second.lock()) {
+            return existing;
+        }
+    }
+
+    if (pattern.columns == 0 || pattern.rows == 0 || pattern.step == 0) {
+        throw std::runtime_error("Grid pattern needs at least one cell to index");
+    }
+
+    std::vector<uint32_t> indices;
+    generateIndices(pattern, indices);
+
+    auto entry = std::make_shared<GridIndices>();
+    vk::DeviceSize bufferSize = sizeof(uint32_t) * indices.size();
+    entry->buffer = std::make_unique<VulkanBuffer>(device, bufferSize,
+        vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer,
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
+    entry->indexCount = static_cast<uint32_t>(indices.size());
+
+    uploadManager.uploadBuffer(*entry->buffer, indices.data(), bufferSize);
+    entry->uploadTicket = uploadManager.flush();
+
+    entries[pattern] = entry;
+    return entry;
+}
+
+void GridIndexCache::generateIndices(const GridPattern& pattern, std::vector<uint32_t>& indices) {
+    std::vector<uint32_t> columns = samplePositions(pattern.columns, pattern.step);
+    std::vector<uint32_t> rows = samplePositions(pattern.rows, pattern.step);
+
+    indices.clear();
+    if (pattern.primitive == GridPrimitive::Lines) {
+        indices.reserve((rows.size() * (columns.size() - 1) + columns.size() * (rows.size() - 1)) * 2);
+        for (uint32_t row : rows) {
+            for (size_t c = 0; c + 1 < columns.size(); c++) {
+                indices.insert(indices.end(), { row * pattern.stride + columns[c], row * pattern.stride + columns[c + 1] });
+            }
+        }
+        for (uint32_t column : columns) {
+            for (size_t r = 0; r + 1 < rows.size(); r++) {
+                indices.insert(indices.end(), { rows[r] * pattern.stride + column, rows[r + 1] * pattern.stride + column });
+            }
+        }
+        return;
+    }
+
+    indices.reserve((columns.size() - 1) * (rows.size() - 1) * 6);
+    for (size_t r = 0; r + 1 < rows.size(); r++) {
+        for (size_t c = 0; c + 1 < columns.size(); c++) {
+            uint32_t i0 = rows[r] * pattern.stride + columns[c];          // (x, y)
+            uint32_t i1 = rows[r] * pattern.stride + columns[c + 1];      // (x + 1, y)
+            uint32_t i2 = rows[r + 1] * pattern.stride + columns[c];      // (x, y + 1)
+            uint32_t i3 = rows[r + 1] * pattern.stride + columns[c + 1];  // (x + 1, y + 1)
+            indices.insert(indices.end(), { i0, i1, i2, i1, i3, i2 });
+        }
+    }
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "src/utils/VulkanCommon.hpp"
+#include "src/core/VulkanDevice.hpp"
+#include "src/resources/VulkanBuffer.hpp"
+#include "src/rendering/UploadManager.hpp"
+
+#include <compare>
+#include <map>
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Primitive a grid pattern is indexed for
+ */
+enum class GridPrimitive : uint32_t {
+    Triangles,  // Triangle list, two counter-clockwise triangles per cell
+    Lines       // Line list along the grid rows and columns, no diagonals (FdF wireframe)
+};
+
+/**
+ * @brief Index pattern over a rectangle of a row-major point grid
+ *
+ * Indices address points as row * stride + column relative to the rectangle's
+ * origin, so one pattern serves every tile of the same shape via vertexOffset.
+ */
+struct GridPattern {
+    uint32_t stride = 0;   // Points per row of the underlying grid
+    uint32_t columns = 0;  // Cells covered horizontally
+    uint32_t rows = 0;     // Cells covered vertically
+    uint32_t step = 1;     // Decimation: one sample every step points, plus the far edge
+    GridPrimitive primitive = GridPrimitive::Triangles;
+
+    auto operator<=>(const GridPattern&) const = default;
+};
+
+/**
+ * @brief GPU index buffer of one grid pattern
+ */
+struct GridIndices {
+    std::unique_ptr<VulkanBuffer> buffer;
+    uint32_t indexCount = 0;
+    UploadTicket uploadTicket = 0;
+};
+
+/**
+ * @brief Shares grid index buffers between all tiles and heightmaps of the same pattern
+ *
+ * A triangle pattern depends only on the grid stride, the covered cells and the
+ * decimation step, so it is generated and uploaded once per pattern. Entries are
+ * held weakly and released when the last user goes away.
+ */
+class GridIndexCache {
+public:
+    /**
+     * @brief Construct empty cache
+     * @param device Vulkan device reference
+     * @param uploadManager Upload manager for staging operations
+     */
+    GridIndexCache(VulkanDevice& device, UploadManager& uploadManager);
+
+    ~GridIndexCache() = default;
+
+    // Disable copy and move
+    GridIndexCache(const GridIndexCache&) = delete;
+    GridIndexCache& operator=(const GridIndexCache&) = delete;
+    GridIndexCache(GridIndexCache&&) = delete;
+    GridIndexCache& operator=(GridIndexCache&&) = delete;
+
+    /**
+     * @brief Get (uploading on first use) the index buffer of a pattern
+     * @throws std::runtime_error if the pattern covers no cells
+     */
+    std::shared_ptr<const GridIndices> acquire(const GridPattern& pattern);
+
+    /**
+     * @brief Build the index list of a pattern for its primitive
+     */
+    static void generateIndices(const GridPattern& pattern, std::vector<uint32_t>& indices);
+
+private:
+    VulkanDevice& device;
+    UploadManager& uploadManager;
+
+    std::map<GridPattern, std::weak_ptr<const GridIndices>> entries;
+};
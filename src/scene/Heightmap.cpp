@@ -0,0 +1,660 @@
+#include "Heightmap.hpp"
+#include "src/scene/Frustum.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+Heightmap::Heightmap(VulkanDevice& device, UploadManager& uploadManager, GridIndexCache& indexCache,
+                     TerrainCompute& terrainCompute)
+    : device(device), uploadManager(uploadManager), indexCache(indexCache), terrainCompute(terrainCompute) {
+}
+
+Heightmap::~Heightmap() {
+    terrainCompute.wait(std::max(attributeTicket, partialDeriveTicket));
+}
+
+FDFLoadStats Heightmap::loadFromFDF(const std::string& filename) {
+    HeightmapData data;
+    FDFLoadStats stats = FDFLoader::loadHeightmap(filename, data);
+    setData(data);
+    return stats;
+}
+
+void Heightmap::setData(const HeightmapData& data) {
+    if (data.width < 2 || data.height < 2) {
+        throw std::runtime_error("Heightmap needs at least 2x2 points");
+    }
+    if (data.heights.size() != data.getPointCount() ||
+        (!data.colors.empty() && data.colors.size() != data.getPointCount())) {
+        throw std::runtime_error("Heightmap data doesn't match its grid size");
+    }
+
+    width = data.width;
+    height = data.height;
+    scale = FDFLoader::gridScale(width, height);
+    buildTiles(data);
+
+    // Batches still deriving into the old buffers must finish before they're replaced
+    terrainCompute.wait(std::max(attributeTicket, partialDeriveTicket));
+    minHeight = std::numeric_limits<float>::max();
+    maxHeight = std::numeric_limits<float>::lowest();
+    for (const Tile& tile : tiles) {
+        minHeight = std::min(minHeight, tile.boundsMin.z / scale);
+        maxHeight = std::max(maxHeight, tile.boundsMax.z / scale);
+    }
+
+    // Updatable maps start with both copies filled
+    const uint32_t copies = updatable ? 2 : 1;
+    vk::DeviceSize heightBufferSize = sizeof(float) * data.heights.size();
+    heightBuffer = std::make_unique<VulkanBuffer>(device, heightBufferSize * copies,
+        vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer,
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
+    for (uint32_t copy = 0; copy < copies; copy++) {
+        uploadManager.uploadBuffer(*heightBuffer, data.heights.data(), heightBufferSize, copy * heightBufferSize);
+    }
+
+    colorBuffer.reset();
+    if (!data.colors.empty()) {
+        vk::DeviceSize colorBufferSize = sizeof(uint32_t) * data.colors.size();
+        colorBuffer = std::make_unique<VulkanBuffer>(device, colorBufferSize * copies,
+            vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eDeviceLocal);
+        for (uint32_t copy = 0; copy < copies; copy++) {
+            uploadManager.uploadBuffer(*colorBuffer, data.colors.data(), colorBufferSize, copy * colorBufferSize);
+        }
+    }
+
+    // A GPU cull reads the ranges of the copy it draws, and draws every tile from one index buffer
+    tileRangeBuffer.reset();
+    tilePatternBuffer.reset();
+    tileIndexBuffer.reset();
+    if (gpuCulled) {
+        maxDrawIndirectCount = device.getPhysicalDevice().getProperties().limits.maxDrawIndirectCount;
+        tileRangeBuffer = std::make_unique<VulkanBuffer>(device, sizeof(glm::vec2) * tiles.size() * copies,
+            vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer,
+            vk::MemoryPropertyFlagBits::eDeviceLocal);
+        for (uint32_t copy = 0; copy < copies; copy++) {
+            uploadTileRanges(copy);
+        }
+        buildTilePatterns();
+    }
+
+    uploadTicket = uploadManager.flush();
+
+    // Written only by TerrainCompute, once the heights above have landed
+    attributeBuffer = std::make_unique<VulkanBuffer>(device, 2 * sizeof(uint32_t) * data.heights.size() * copies,
+        vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal);
+    attributesSubmitted = false;
+    partialDeriving = false;
+
+    heights.clear();
+    colors.clear();
+    front = 0;
+    anyDirty = {};
+    lastReadSerial = {};
+    partialPending = false;
+    lastUpload = {};
+    if (updatable) {
+        heights = data.heights;
+        colors = data.colors;
+        for (std::vector<RowSpan>& rows : dirty) {
+            rows.assign(height, RowSpan{});
+        }
+    }
+}
+
+void Heightmap::updateRegion(uint32_t column, uint32_t row, uint32_t columns, uint32_t rows,
+                             std::span<const float> regionHeights, std::span<const uint32_t> regionColors) {
+    if (!updatable || !hasData()) {
+        throw std::invalid_argument("updateRegion needs an updatable heightmap with data");
+    }
+    if (column > width || columns > width - column || row > height || rows > height - row) {
+        throw std::invalid_argument("updateRegion rectangle leaves the grid");
+    }
+    const size_t count = static_cast<size_t>(columns) * rows;
+    if (regionHeights.size() != count || (!regionColors.empty() && (regionColors.size() != count || colors.empty()))) {
+        throw std::invalid_argument("updateRegion data doesn't match the rectangle");
+    }
+    if (count == 0) {
+        return;
+    }
+
+    for (uint32_t r = 0; r < rows; r++) {
+        const size_t target = static_cast<size_t>(row + r) * width + column;
+        std::copy_n(regionHeights.data() + static_cast<size_t>(r) * columns, columns, heights.begin() + target);
+        if (!regionColors.empty()) {
+            std::copy_n(regionColors.data() + static_cast<size_t>(r) * columns, columns, colors.begin() + target);
+        }
+
+        // Both copies lack the new values until they've been uploaded into each
+        for (uint32_t copy = 0; copy < 2; copy++) {
+            RowSpan& span = dirty[copy][row + r];
+            span = span.begin == span.end ? RowSpan{ column, column + columns }
+                                          : RowSpan{ std::min(span.begin, column), std::max(span.end, column + columns) };
+            anyDirty[copy] = true;
+        }
+    }
+
+    // Tiles share their border points, so a point on a border updates both sides
+    const uint32_t lastColumn = column + columns - 1;
+    const uint32_t lastRow = row + rows - 1;
+    const uint32_t tx0 = column > 0 ? (column - 1) / TILE_CELLS : 0;
+    const uint32_t ty0 = row > 0 ? (row - 1) / TILE_CELLS : 0;
+    const uint32_t tx1 = std::min(lastColumn / TILE_CELLS, tilesX - 1);
+    const uint32_t ty1 = std::min(lastRow / TILE_CELLS, tilesY - 1);
+    for (uint32_t ty = ty0; ty <= ty1; ty++) {
+        for (uint32_t tx = tx0; tx <= tx1; tx++) {
+            const uint32_t index = ty * tilesX + tx;
+            computeTileBounds(tiles[index], heights.data(), true);
+            tileBounds.set(tileBoxes[index], tiles[index].boundsMin, tiles[index].boundsMax);
+        }
+    }
+    refitQuadtree();
+}
+
+void Heightmap::update(uint64_t retiredSerial, uint64_t lastSubmittedSerial) {
+    if (!hasData()) {
+        return;
+    }
+
+    // Every copy's attributes in one batch, as soon as the heights are on the GPU
+    if (!attributesSubmitted && uploadManager.isComplete(uploadTicket)) {
+        std::vector<TerrainCompute::Rows> rows;
+        for (uint32_t copy = 0; copy < (updatable ? 2u : 1u); copy++) {
+            rows.push_back({ .pointOffset = copy * width * height, .firstRow = 0, .rowCount = height });
+        }
+        attributeTicket = terrainCompute.submit(computeTarget(), rows);
+        attributesSubmitted = true;
+    }
+    if (!updatable) {
+        return;
+    }
+
+    // Normals read the neighboring rows, so the rows around an edit are derived again too
+    if (partialPending && !partialDeriving && uploadManager.isComplete(partialTicket)) {
+        const uint32_t firstRow = partialRows.begin > 0 ? partialRows.begin - 1 : 0;
+        const uint32_t endRow = std::min(partialRows.end + 1, height);
+        const std::array rows = { TerrainCompute::Rows{
+            .pointOffset = (front ^ 1) * width * height, .firstRow = firstRow, .rowCount = endRow - firstRow } };
+        partialDeriveTicket = terrainCompute.submit(computeTarget(), rows);
+        partialDeriving = true;
+        lastUpload.derivedRows = endRow - firstRow;
+    }
+
+    // Frames recorded from now on draw the new copy; the old one is read until lastSubmittedSerial retires
+    if (partialDeriving && terrainCompute.isComplete(partialDeriveTicket)) {
+        lastReadSerial[front] = lastSubmittedSerial;
+        front ^= 1;
+        partialPending = false;
+        partialDeriving = false;
+    }
+
+    // One partial update at a time, each only after the full one: batches may overlap on the queues
+    const uint32_t back = front ^ 1;
+    if (!partialPending && anyDirty[back] && lastReadSerial[back] <= retiredSerial &&
+        uploadManager.isComplete(uploadTicket) && attributesSubmitted && terrainCompute.isComplete(attributeTicket)) {
+        uploadDirtyRows(back);
+        partialTicket = uploadManager.flush();
+        partialPending = true;
+    }
+}
+
+void Heightmap::uploadDirtyRows(uint32_t copy) {
+    // Row runs in point offsets; close runs merge, since the gap between them is already current in this copy
+    std::vector<vk::BufferCopy> regions;
+    partialRows = {};
+    for (uint32_t row = 0; row < height; row++) {
+        RowSpan& span = dirty[copy][row];
+        if (span.begin == span.end) {
+            continue;
+        }
+        partialRows = partialRows.begin == partialRows.end ? RowSpan{ row, row + 1 } : RowSpan{ partialRows.begin, row + 1 };
+        const vk::DeviceSize begin = static_cast<vk::DeviceSize>(row) * width + span.begin;
+        const vk::DeviceSize end = static_cast<vk::DeviceSize>(row) * width + span.end;
+        if (!regions.empty() && begin - (regions.back().srcOffset + regions.back().size) <= COALESCE_GAP_POINTS) {
+            regions.back().size = end - regions.back().srcOffset;
+        } else {
+            regions.push_back({ .srcOffset = begin, .dstOffset = begin, .size = end - begin });
+        }
+        span = {};
+    }
+    anyDirty[copy] = false;
+
+    // Heights and colors are both 4 bytes per point, so one region list serves both
+    const vk::DeviceSize copyOffset = static_cast<vk::DeviceSize>(copy) * width * height;
+    static_assert(sizeof(float) == sizeof(uint32_t));
+    lastUpload = { .regions = static_cast<uint32_t>(regions.size()) };
+    for (vk::BufferCopy& region : regions) {
+        region.srcOffset *= sizeof(float);
+        region.dstOffset = (region.dstOffset + copyOffset) * sizeof(float);
+        region.size *= sizeof(float);
+        lastUpload.bytes += region.size;
+    }
+    uploadManager.uploadBufferRegions(*heightBuffer, heights.data(), regions);
+    if (colorBuffer) {
+        uploadManager.uploadBufferRegions(*colorBuffer, colors.data(), regions);
+        lastUpload.bytes *= 2;
+    }
+
+    // The grown bounds cover the new heights once this copy is drawn
+    if (gpuCulled) {
+        uploadTileRanges(copy);
+    }
+}
+
+void Heightmap::uploadTileRanges(uint32_t copy) {
+    std::vector<glm::vec2> ranges;
+    ranges.reserve(tiles.size());
+    for (const Tile& tile : tiles) {
+        ranges.emplace_back(tile.boundsMin.z, tile.boundsMax.z);
+    }
+    const vk::DeviceSize tableSize = sizeof(glm::vec2) * ranges.size();
+    uploadManager.uploadBuffer(*tileRangeBuffer, ranges.data(), tableSize, copy * tableSize);
+}
+
+void Heightmap::buildTilePatterns() {
+    // Only the last column and row of tiles can be narrower; shapes no tile has stay empty
+    const uint32_t cellsX = width - 1;
+    const uint32_t cellsY = height - 1;
+    const std::array<uint32_t, 2> shapeColumns = { cellsX >= TILE_CELLS ? TILE_CELLS : 0, cellsX % TILE_CELLS };
+    const std::array<uint32_t, 2> shapeRows = { cellsY >= TILE_CELLS ? TILE_CELLS : 0, cellsY % TILE_CELLS };
+
+    // Indexed as [(primitive * TILE_SHAPES + shape) * MAX_LODS + lod], like cullTilesMain reads it
+    std::vector<glm::uvec2> table(2 * TILE_SHAPES * MAX_LODS, glm::uvec2(0));
+    std::vector<uint32_t> indices;
+    std::vector<uint32_t> patternIndices;
+    for (GridPrimitive primitive : { GridPrimitive::Triangles, GridPrimitive::Lines }) {
+        for (uint32_t shape = 0; shape < TILE_SHAPES; shape++) {
+            const uint32_t columns = shapeColumns[shape & 1];
+            const uint32_t rows = shapeRows[shape >> 1];
+            if (columns == 0 || rows == 0) {
+                continue;
+            }
+            for (uint32_t lod = 0; lod < MAX_LODS; lod++) {
+                GridIndexCache::generateIndices(GridPattern{
+                    .stride = width,
+                    .columns = columns,
+                    .rows = rows,
+                    .step = 1u << lod,
+                    .primitive = primitive
+                }, patternIndices);
+                table[(static_cast<uint32_t>(primitive) * TILE_SHAPES + shape) * MAX_LODS + lod] =
+                    glm::uvec2(indices.size(), patternIndices.size());
+                indices.insert(indices.end(), patternIndices.begin(), patternIndices.end());
+            }
+        }
+    }
+
+    tilePatternBuffer = std::make_unique<VulkanBuffer>(device, sizeof(glm::uvec2) * table.size(),
+        vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer,
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
+    uploadManager.uploadBuffer(*tilePatternBuffer, table.data(), sizeof(glm::uvec2) * table.size());
+    tileIndexBuffer = std::make_unique<VulkanBuffer>(device, sizeof(uint32_t) * indices.size(),
+        vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer,
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
+    uploadManager.uploadBuffer(*tileIndexBuffer, indices.data(), sizeof(uint32_t) * indices.size());
+}
+
+TerrainCompute::Target Heightmap::computeTarget() const {
+    return TerrainCompute::Target{
+        .heights = heightBuffer->getHandle(),
+        .colors = getColorBuffer(),
+        .attributes = attributeBuffer->getHandle(),
+        .width = width,
+        .height = height,
+        .hasColors = hasColors(),
+        .minHeight = minHeight,
+        .maxHeight = maxHeight
+    };
+}
+
+void Heightmap::buildTiles(const HeightmapData& data) {
+    const uint32_t cellsX = width - 1;
+    const uint32_t cellsY = height - 1;
+    tilesX = (cellsX + TILE_CELLS - 1) / TILE_CELLS;
+    tilesY = (cellsY + TILE_CELLS - 1) / TILE_CELLS;
+
+    tiles.clear();
+    tiles.resize(static_cast<size_t>(tilesX) * tilesY);
+    indexUploadTicket = 0;
+
+    for (uint32_t ty = 0; ty < tilesY; ty++) {
+        for (uint32_t tx = 0; tx < tilesX; tx++) {
+            Tile& tile = tiles[ty * tilesX + tx];
+            tile.column = tx * TILE_CELLS;
+            tile.row = ty * TILE_CELLS;
+            tile.columns = std::min(TILE_CELLS, cellsX - tile.column);
+            tile.rows = std::min(TILE_CELLS, cellsY - tile.row);
+
+            computeTileBounds(tile, data.heights.data(), false);
+
+            // Full interior tiles all share one pattern per LOD; only the last row/column differ.
+            // Line patterns are small and kept alongside, so switching primitives never waits.
+            // GPU-culled maps draw from buildTilePatterns' table instead and need none
+            tile.lodCount = MAX_LODS;
+            for (uint32_t lod = 0; lod < MAX_LODS && !gpuCulled; lod++) {
+                GridPattern pattern{
+                    .stride = width,
+                    .columns = tile.columns,
+                    .rows = tile.rows,
+                    .step = 1u << lod
+                };
+                tile.lods[lod] = indexCache.acquire(pattern);
+                pattern.primitive = GridPrimitive::Lines;
+                tile.lineLods[lod] = indexCache.acquire(pattern);
+                indexUploadTicket = std::max({ indexUploadTicket, tile.lods[lod]->uploadTicket,
+                                               tile.lineLods[lod]->uploadTicket });
+            }
+        }
+    }
+
+    nodes.clear();
+    tileBounds.clear();
+    tileBounds.reserve(static_cast<uint32_t>(tiles.size()));
+    boxTiles.clear();
+    boxTiles.reserve(tiles.size());
+    tileBoxes.assign(tiles.size(), 0);
+    buildQuadtree(0, 0, tilesX, tilesY);
+
+    tileLods.assign(tiles.size(), MAX_LODS);
+    drawList.clear();
+    drawList.reserve(tiles.size());
+}
+
+void Heightmap::computeTileBounds(Tile& tile, const float* heights, bool grow) const {
+    // Height range over the tile's points, borders included
+    float minZ = heights[static_cast<size_t>(tile.row) * width + tile.column];
+    float maxZ = minZ;
+    for (uint32_t r = tile.row; r <= tile.row + tile.rows; r++) {
+        const float* rowHeights = heights + static_cast<size_t>(r) * width;
+        auto [lo, hi] = std::minmax_element(rowHeights + tile.column, rowHeights + tile.column + tile.columns + 1);
+        minZ = std::min(minZ, *lo);
+        maxZ = std::max(maxZ, *hi);
+    }
+    if (grow) {
+        minZ = std::min(minZ, tile.boundsMin.z / scale);
+        maxZ = std::max(maxZ, tile.boundsMax.z / scale);
+    }
+
+    const float originX = 0.5f * static_cast<float>(width - 1);
+    const float originY = 0.5f * static_cast<float>(height - 1);
+    tile.boundsMin = glm::vec3(
+        (static_cast<float>(tile.column) - originX) * scale,
+        (static_cast<float>(tile.row) - originY) * scale,
+        minZ * scale);
+    tile.boundsMax = glm::vec3(
+        (static_cast<float>(tile.column + tile.columns) - originX) * scale,
+        (static_cast<float>(tile.row + tile.rows) - originY) * scale,
+        maxZ * scale);
+}
+
+int32_t Heightmap::buildQuadtree(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1) {
+    int32_t index = static_cast<int32_t>(nodes.size());
+    nodes.emplace_back();
+
+    // Small blocks are tested tile by tile in one BoxCulling run over their contiguous boxes
+    if (x1 - x0 <= LEAF_TILES && y1 - y0 <= LEAF_TILES) {
+        QuadNode& leaf = nodes[index];
+        leaf.firstBox = static_cast<int32_t>(tileBounds.size());
+        leaf.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+        leaf.boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+        for (uint32_t ty = y0; ty < y1; ty++) {
+            for (uint32_t tx = x0; tx < x1; tx++) {
+                const uint32_t tileIndex = ty * tilesX + tx;
+                const Tile& tile = tiles[tileIndex];
+                tileBoxes[tileIndex] = tileBounds.add(tile.boundsMin, tile.boundsMax);
+                boxTiles.push_back(tileIndex);
+                leaf.boundsMin = glm::min(leaf.boundsMin, tile.boundsMin);
+                leaf.boundsMax = glm::max(leaf.boundsMax, tile.boundsMax);
+            }
+        }
+        leaf.boxCount = (x1 - x0) * (y1 - y0);
+        return index;
+    }
+
+    // Split each side in half; a side no wider than a leaf stays whole
+    uint32_t xm = x1 - x0 > LEAF_TILES ? (x0 + x1) / 2 : x1;
+    uint32_t ym = y1 - y0 > LEAF_TILES ? (y0 + y1) / 2 : y1;
+    const std::array<std::array<uint32_t, 4>, 4> quadrants{{
+        { x0, y0, xm, ym }, { xm, y0, x1, ym }, { x0, ym, xm, y1 }, { xm, ym, x1, y1 }
+    }};
+
+    glm::vec3 boundsMin(std::numeric_limits<float>::max());
+    glm::vec3 boundsMax(std::numeric_limits<float>::lowest());
+    size_t childSlot = 0;
+    for (const auto& q : quadrants) {
+        if (q[0] >= q[2] || q[1] >= q[3]) {
+            continue;
+        }
+        int32_t child = buildQuadtree(q[0], q[1], q[2], q[3]);
+        // nodes may have reallocated; index instead of holding references
+        nodes[index].children[childSlot++] = child;
+        boundsMin = glm::min(boundsMin, nodes[child].boundsMin);
+        boundsMax = glm::max(boundsMax, nodes[child].boundsMax);
+    }
+    nodes[index].boundsMin = boundsMin;
+    nodes[index].boundsMax = boundsMax;
+    return index;
+}
+
+void Heightmap::refitQuadtree() {
+    // Children are built after their parent, so walking backwards visits them first
+    for (size_t i = nodes.size(); i-- > 0;) {
+        QuadNode& node = nodes[i];
+        node.boundsMin = glm::vec3(std::numeric_limits<float>::max());
+        node.boundsMax = glm::vec3(std::numeric_limits<float>::lowest());
+        if (node.firstBox >= 0) {
+            const uint32_t firstBox = static_cast<uint32_t>(node.firstBox);
+            for (uint32_t box = firstBox; box < firstBox + node.boxCount; box++) {
+                node.boundsMin = glm::min(node.boundsMin, tileBounds.getMin(box));
+                node.boundsMax = glm::max(node.boundsMax, tileBounds.getMax(box));
+            }
+            continue;
+        }
+        for (int32_t child : node.children) {
+            if (child >= 0) {
+                node.boundsMin = glm::min(node.boundsMin, nodes[child].boundsMin);
+                node.boundsMax = glm::max(node.boundsMax, nodes[child].boundsMax);
+            }
+        }
+    }
+}
+
+uint32_t Heightmap::chooseLod(const Tile& tile, const glm::vec3& eye) const {
+    glm::vec3 closest = glm::clamp(eye, tile.boundsMin, tile.boundsMax);
+    float distance = glm::length(eye - closest);
+    float ratio = distance / (LOD_DISTANCE_TILES * static_cast<float>(TILE_CELLS) * scale);
+    if (ratio < 1.0f) {
+        return 0;
+    }
+    uint32_t lod = 1 + static_cast<uint32_t>(std::floor(std::log2(ratio)));
+    return std::min(lod, tile.lodCount - 1);
+}
+
+void Heightmap::selectTiles(const glm::mat4& modelViewProj, const glm::vec3& eye) {
+    stats = {};
+    drawList.clear();
+    if (!hasData()) {
+        return;
+    }
+
+    if (gpuCulled) {
+        throw std::runtime_error("GPU-culled heightmaps are selected by TerrainCulling");
+    }
+
+    std::fill(tileLods.begin(), tileLods.end(), MAX_LODS);
+    const Frustum frustum = Frustum::fromMatrix(modelViewProj);
+
+    // Hierarchical cull: a rejected node rejects every tile below it, and the tiles
+    // of a leaf block that may be visible are tested 4 or 8 at a time
+    visibleBoxes.clear();
+    nodeStack.assign(1, 0);
+    while (!nodeStack.empty()) {
+        const QuadNode& node = nodes[nodeStack.back()];
+        nodeStack.pop_back();
+
+        if (!frustum.intersects(node.boundsMin, node.boundsMax)) {
+            continue;
+        }
+        if (node.firstBox >= 0) {
+            BoxCulling::cull(frustum, tileBounds, static_cast<uint32_t>(node.firstBox), node.boxCount, visibleBoxes);
+            continue;
+        }
+        for (int32_t child : node.children) {
+            if (child >= 0) {
+                nodeStack.push_back(child);
+            }
+        }
+    }
+
+    stats.tilesCulled = static_cast<uint32_t>(tiles.size() - visibleBoxes.size());
+    for (uint32_t box : visibleBoxes) {
+        const uint32_t tile = boxTiles[box];
+        tileLods[tile] = chooseLod(tiles[tile], eye);
+        drawList.push_back({ tile, tileLods[tile], 0 });
+    }
+
+    // Each visible tile learns which neighbors are coarser, to snap its shared borders
+    auto coarserStep = [this](uint32_t lod, int64_t tx, int64_t ty) -> uint32_t {
+        if (tx < 0 || ty < 0 || tx >= tilesX || ty >= tilesY) {
+            return 0;
+        }
+        uint32_t neighborLod = tileLods[ty * tilesX + tx];
+        return neighborLod < MAX_LODS && neighborLod > lod ? 1u << neighborLod : 0;
+    };
+    for (TileDraw& entry : drawList) {
+        int64_t tx = entry.tile % tilesX;
+        int64_t ty = entry.tile / tilesX;
+        entry.neighborSteps =
+            coarserStep(entry.lod, tx - 1, ty) |
+            (coarserStep(entry.lod, tx + 1, ty) << 8) |
+            (coarserStep(entry.lod, tx, ty - 1) << 16) |
+            (coarserStep(entry.lod, tx, ty + 1) << 24);
+
+        stats.tilesDrawn++;
+        stats.trianglesDrawn += tiles[entry.tile].lods[entry.lod]->indexCount / 3;
+    }
+}
+
+bool Heightmap::isReady() const {
+    return hasData() &&
+           uploadManager.isComplete(uploadTicket) &&
+           uploadManager.isComplete(indexUploadTicket) &&
+           attributesSubmitted && terrainCompute.isComplete(attributeTicket);
+}
+
+void Heightmap::draw(const vk::raii::CommandBuffer& commandBuffer, vk::PipelineLayout pipelineLayout,
+                     GridPrimitive primitive, uint32_t firstDraw, uint32_t drawCount) const {
+    if (!hasData()) {
+        throw std::runtime_error("Cannot draw empty heightmap");
+    }
+
+    HeightmapPushConstants constants{
+        .width = width,
+        .height = height,
+        .scale = scale,
+        .pointOffset = front * width * height
+    };
+
+    const size_t begin = std::min<size_t>(firstDraw, drawList.size());
+    const size_t end = begin + std::min<size_t>(drawCount, drawList.size() - begin);
+
+    vk::Buffer boundIndices = nullptr;
+    for (size_t i = begin; i < end; i++) {
+        const TileDraw& entry = drawList[i];
+        const Tile& tile = tiles[entry.tile];
+        const GridIndices& indices =
+            primitive == GridPrimitive::Lines ? *tile.lineLods[entry.lod] : *tile.lods[entry.lod];
+
+        if (indices.buffer->getHandle() != boundIndices) {
+            boundIndices = indices.buffer->getHandle();
+            commandBuffer.bindIndexBuffer(boundIndices, 0, vk::IndexType::eUint32);
+        }
+
+        constants.tileColumn = tile.column;
+        constants.tileRow = tile.row;
+        constants.tileColumns = tile.columns;
+        constants.tileRows = tile.rows;
+        constants.step = 1u << entry.lod;
+        constants.neighborSteps = entry.neighborSteps;
+        commandBuffer.pushConstants<HeightmapPushConstants>(
+            pipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, constants);
+
+        // Pattern indices are tile-relative; vertexOffset moves them to the tile's origin
+        int32_t vertexOffset = static_cast<int32_t>(tile.row * width + tile.column);
+        commandBuffer.drawIndexed(indices.indexCount, 1, 0, vertexOffset, 0);
+    }
+}
+
+void Heightmap::drawIndirect(const vk::raii::CommandBuffer& commandBuffer, vk::PipelineLayout pipelineLayout,
+                             vk::Buffer commands, vk::Buffer drawCountBuffer) const {
+    if (!hasData() || !gpuCulled) {
+        throw std::runtime_error("Cannot draw GPU-culled tiles of this heightmap");
+    }
+
+    // Tiles are derived from firstInstance in the shader, so one set of constants serves every draw
+    const HeightmapPushConstants constants{
+        .width = width,
+        .height = height,
+        .scale = scale,
+        .pointOffset = front * width * height
+    };
+    commandBuffer.pushConstants<HeightmapPushConstants>(pipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, constants);
+    commandBuffer.bindIndexBuffer(tileIndexBuffer->getHandle(), 0, vk::IndexType::eUint32);
+
+    const uint32_t tileCount = getTileCount();
+    if (drawCountBuffer) {
+        commandBuffer.drawIndexedIndirectCount(commands, 0, drawCountBuffer, 0, tileCount,
+                                               sizeof(vk::DrawIndexedIndirectCommand));
+        return;
+    }
+    for (uint32_t first = 0; first < tileCount; first += maxDrawIndirectCount) {
+        const uint32_t count = std::min(tileCount - first, maxDrawIndirectCount);
+        commandBuffer.drawIndexedIndirect(commands,
+                                          static_cast<vk::DeviceSize>(first) * sizeof(vk::DrawIndexedIndirectCommand),
+                                          count, sizeof(vk::DrawIndexedIndirectCommand));
+    }
+}
+
+HeightmapTileTable Heightmap::getTileTable() const {
+    if (!tileRangeBuffer) {
+        return {};
+    }
+    return HeightmapTileTable{
+        .ranges = tileRangeBuffer->getHandle(),
+        .patterns = tilePatternBuffer->getHandle(),
+        .tileCount = getTileCount(),
+        .rangeOffset = front * getTileCount(),
+        .lodDistance = LOD_DISTANCE_TILES * static_cast<float>(TILE_CELLS) * scale
+    };
+}
+
+vk::DeviceSize Heightmap::getGpuBytes() const {
+    if (!hasData()) {
+        return 0;
+    }
+    vk::DeviceSize bytes = heightBuffer->getSize() + attributeBuffer->getSize();
+    if (colorBuffer) {
+        bytes += colorBuffer->getSize();
+    }
+    if (gpuCulled) {
+        // The tile tables hold every pattern; no per-tile ones were acquired
+        return bytes + tileRangeBuffer->getSize() + tilePatternBuffer->getSize() + tileIndexBuffer->getSize();
+    }
+
+    // Count each shared pattern once
+    std::vector<const GridIndices*> counted;
+    for (const Tile& tile : tiles) {
+        for (uint32_t lod = 0; lod < tile.lodCount; lod++) {
+            for (const GridIndices* indices : { tile.lods[lod].get(), tile.lineLods[lod].get() }) {
+                if (std::find(counted.begin(), counted.end(), indices) == counted.end()) {
+                    counted.push_back(indices);
+                    bytes += indices->buffer->getSize();
+                }
+            }
+        }
+    }
+    return bytes;
+}
@@ -0,0 +1,339 @@
+#pragma once
+
+#include "src/utils/VulkanCommon.hpp"
+#include "src/utils/Vertex.hpp"
+#include "src/core/VulkanDevice.hpp"
+#include "src/resources/VulkanBuffer.hpp"
+#include "src/rendering/UploadManager.hpp"
+#include "src/rendering/TerrainCompute.hpp"
+#include "src/scene/GridIndexCache.hpp"
+#include "src/scene/BoxCulling.hpp"
+#include "src/loaders/FDFLoader.hpp"
+
+#include <array>
+#include <memory>
+#include <span>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Per-frame terrain culling and LOD counters
+ */
+struct TerrainStats {
+    uint32_t tilesDrawn = 0;
+    uint32_t tilesCulled = 0;
+    uint64_t trianglesDrawn = 0;
+};
+
+/**
+ * @brief What the last partial height upload copied
+ */
+struct HeightmapUploadStats {
+    uint32_t regions = 0;      // vk::BufferCopy regions per buffer after coalescing
+    vk::DeviceSize bytes = 0;  // Over heights and colors
+    uint32_t derivedRows = 0;  // Rows whose attributes were recomputed afterwards
+};
+
+/**
+ * @brief What a GPU tile cull reads of a heightmap (setGpuCulled); tile rectangles follow from the grid size
+ */
+struct HeightmapTileTable {
+    vk::Buffer ranges;       // Object-space z range per tile (float2), one table per copy
+    vk::Buffer patterns;     // firstIndex and indexCount (uint2) per primitive, tile shape and LOD
+    uint32_t tileCount = 0;
+    uint32_t rangeOffset = 0;  // First range of the copy drawn next
+    float lodDistance = 0.0f;  // Object-space distance LOD 0 reaches, as chooseLod uses it
+};
+
+/**
+ * @brief Tiled, level-of-detail heightmap grid drawn without a vertex buffer
+ *
+ * Responsibilities:
+ * - Upload per-point heights (and packed colors, if the map has any) as storage buffers
+ * - Derive per-point normals, slope and colors from them with TerrainCompute
+ * - Split the grid into tiles with decimated index patterns per LOD, shared via GridIndexCache
+ * - Cull tiles against the view frustum through a quadtree of bounding boxes, whose leaf
+ *   blocks of tiles are tested with BoxCulling 4 or 8 at a time
+ * - Pick a LOD per visible tile by distance and record one draw per tile
+ *
+ * Vertices are rebuilt by vertHeightmapMain from SV_VertexID and lit with the derived
+ * normals; maps without colors are tinted by height and slope. Tiles next to a coarser
+ * neighbor snap their border vertices onto the neighbor's edge in the shader, so
+ * differing LODs stay crack-free without extra index variants.
+ *
+ * GPU-culled heightmaps (setGpuCulled) leave the tile selection to a compute pass
+ * instead (TerrainCulling): they keep every pattern in one index buffer, described
+ * by getTileTable(), and drawIndirect() draws the commands the pass wrote.
+ *
+ * Updatable heightmaps (setUpdatable) hold two copies of the heights and colors
+ * in one buffer each. Frames draw the front copy, chosen per draw by a push
+ * constant; updateRegion() edits a CPU mirror and update() copies the rows each
+ * copy is missing into the back one once no frame in flight reads it, re-derives
+ * the attributes around them, then swaps.
+ */
+class Heightmap {
+public:
+    static constexpr uint32_t TILE_CELLS = 64;  // Cells per tile side; a power of two
+    static constexpr uint32_t MAX_LODS = 7;     // Steps 1, 2, ..., TILE_CELLS
+
+    /**
+     * @brief Construct empty heightmap
+     * @param device Vulkan device reference
+     * @param uploadManager Upload manager for staging operations
+     * @param indexCache Cache providing the shared tile index patterns
+     * @param terrainCompute Pass deriving the attributes, outlives the heightmap
+     */
+    Heightmap(VulkanDevice& device, UploadManager& uploadManager, GridIndexCache& indexCache,
+              TerrainCompute& terrainCompute);
+
+    /**
+     * @brief Waits for attribute passes still writing the buffers
+     */
+    ~Heightmap();
+
+    // Disable copy, enable move
+    Heightmap(const Heightmap&) = delete;
+    Heightmap& operator=(const Heightmap&) = delete;
+    Heightmap(Heightmap&&) = default;
+    Heightmap& operator=(Heightmap&&) = delete;
+
+    /**
+     * @brief Load heightmap from FdF file
+     * @param filename Path to FDF file
+     * @return Grid size and parse throughput
+     * @throws std::runtime_error if loading fails
+     */
+    FDFLoadStats loadFromFDF(const std::string& filename);
+
+    /**
+     * @brief Keep a CPU mirror and double-buffer the GPU data, so updateRegion() can edit it
+     *
+     * Call before loading; doubles the height and color buffers.
+     */
+    void setUpdatable(bool enabled) { updatable = enabled; }
+    bool isUpdatable() const { return updatable; }
+
+    /**
+     * @brief Build the tile table and shared pattern buffer a GPU tile cull draws from
+     *
+     * Call before loading; needs the multiDrawIndirect capability to draw. The tiles
+     * then get no per-tile patterns from the GridIndexCache, so selectTiles and draw
+     * can't be used.
+     */
+    void setGpuCulled(bool enabled) { gpuCulled = enabled; }
+    bool isGpuCulled() const { return gpuCulled; }
+
+    /**
+     * @brief Replace a rectangle of points; uploaded by the following update() calls
+     * @param column First point column
+     * @param row First point row
+     * @param columns Width of the rectangle in points
+     * @param rows Height of the rectangle in points
+     * @param regionHeights columns * rows heights, row-major
+     * @param regionColors columns * rows colors as in HeightmapData, or empty to keep them
+     * @throws std::invalid_argument if the heightmap isn't updatable, the rectangle
+     *         leaves the grid, or the spans don't match it
+     *
+     * Tile bounds only grow until the next setData, so culling stays conservative
+     * for frames that still draw the older heights.
+     */
+    void updateRegion(uint32_t column, uint32_t row, uint32_t columns, uint32_t rows,
+                      std::span<const float> regionHeights, std::span<const uint32_t> regionColors = {});
+
+    /**
+     * @brief Swap in a finished partial upload and start the next one (call once per frame)
+     * @param retiredSerial Every frame up to this serial has finished on the GPU
+     * @param lastSubmittedSerial Last frame submitted, which may still read the front copy
+     */
+    void update(uint64_t retiredSerial, uint64_t lastSubmittedSerial);
+
+    /**
+     * @brief Heights as the CPU mirror holds them; empty unless updatable
+     */
+    std::span<const float> getHeights() const { return heights; }
+    const HeightmapUploadStats& getLastUploadStats() const { return lastUpload; }
+
+    /**
+     * @brief Set grid data, build tiles and create GPU buffers
+     * @param data Heights and optional colors; at least 2x2 points
+     */
+    void setData(const HeightmapData& data);
+
+    /**
+     * @brief Cull tiles and choose their LODs for the next draw
+     * @param modelViewProj Clip matrix of the heightmap's object space
+     * @param eye Camera position in object space
+     * @throws std::runtime_error if the map is GPU-culled
+     */
+    void selectTiles(const glm::mat4& modelViewProj, const glm::vec3& eye);
+
+    /**
+     * @brief Record one draw per tile chosen by the last selectTiles
+     * @param commandBuffer Command buffer to record into
+     * @param pipelineLayout Layout of the bound heightmap pipeline
+     * @param primitive Triangles for a triangle-list pipeline, Lines for a line-list one
+     * @param firstDraw First tile draw to record, for splitting the draws across command buffers
+     * @param drawCount Tile draws to record from firstDraw, clamped to getDrawCount()
+     *
+     * Only reads the selection, so disjoint ranges can be recorded from several threads.
+     */
+    void draw(const vk::raii::CommandBuffer& commandBuffer, vk::PipelineLayout pipelineLayout,
+              GridPrimitive primitive = GridPrimitive::Triangles,
+              uint32_t firstDraw = 0, uint32_t drawCount = UINT32_MAX) const;
+
+    /**
+     * @brief Record the tile draws a GPU cull wrote, with the patterns of getTileTable()
+     * @param commands One vk::DrawIndexedIndirectCommand per tile, firstInstance naming the tile
+     * @param drawCountBuffer Count of the compacted commands, or null to draw every tile's slot
+     * @throws std::runtime_error if the heightmap is empty or not GPU-culled
+     */
+    void drawIndirect(const vk::raii::CommandBuffer& commandBuffer, vk::PipelineLayout pipelineLayout,
+                      vk::Buffer commands, vk::Buffer drawCountBuffer) const;
+
+    /**
+     * @brief Tile ranges and patterns for a GPU cull of the copy drawn next; empty unless GPU-culled
+     */
+    HeightmapTileTable getTileTable() const;
+
+    /**
+     * @brief Tile draws chosen by the last selectTiles
+     */
+    uint32_t getDrawCount() const { return static_cast<uint32_t>(drawList.size()); }
+
+    /**
+     * @brief Check if heightmap has data
+     */
+    bool hasData() const { return heightBuffer != nullptr; }
+
+    /**
+     * @brief Check if heights, colors and tile indices finished uploading and the attributes were derived
+     */
+    bool isReady() const;
+
+    // Accessors
+    uint32_t getWidth() const { return width; }
+    uint32_t getHeight() const { return height; }
+    float getScale() const { return scale; }
+    uint32_t getTileCount() const { return static_cast<uint32_t>(tiles.size()); }
+    bool hasColors() const { return colorBuffer != nullptr; }
+    vk::Buffer getHeightBuffer() const { return heightBuffer->getHandle(); }
+    // Falls back to the height buffer so the attribute pass's color binding is always valid
+    vk::Buffer getColorBuffer() const { return (colorBuffer ? colorBuffer : heightBuffer)->getHandle(); }
+    vk::Buffer getAttributeBuffer() const { return attributeBuffer->getHandle(); }
+    const TerrainStats& getStats() const { return stats; }
+
+    /**
+     * @brief Bytes of GPU memory used (shared index patterns counted in full)
+     */
+    vk::DeviceSize getGpuBytes() const;
+
+private:
+    // Screen-space error proxy: LOD 0 up to this many tile sizes away, one level per doubling
+    static constexpr float LOD_DISTANCE_TILES = 2.0f;
+    // Quadtree leaves cover blocks of up to this many tiles per side, tested as one BoxCulling run
+    static constexpr uint32_t LEAF_TILES = 4;
+    // Dirty runs closer than this many points are copied as one region, gap included
+    static constexpr uint32_t COALESCE_GAP_POINTS = 256;
+    // Tile shapes in the GPU pattern table: bit 0 a partial last column, bit 1 a partial last row
+    static constexpr uint32_t TILE_SHAPES = 4;
+
+    struct Tile {
+        uint32_t column = 0;   // Origin in grid points
+        uint32_t row = 0;
+        uint32_t columns = 0;  // Extent in cells
+        uint32_t rows = 0;
+        glm::vec3 boundsMin{};
+        glm::vec3 boundsMax{};
+        uint32_t lodCount = 0;
+        std::array<std::shared_ptr<const GridIndices>, MAX_LODS> lods;       // Triangle patterns
+        std::array<std::shared_ptr<const GridIndices>, MAX_LODS> lineLods;   // Line patterns, same LODs
+    };
+
+    struct QuadNode {
+        glm::vec3 boundsMin{};
+        glm::vec3 boundsMax{};
+        std::array<int32_t, 4> children{ -1, -1, -1, -1 };
+        int32_t firstBox = -1;  // Leaf's first box in tileBounds, or -1 for inner nodes
+        uint32_t boxCount = 0;  // Tiles of the leaf block
+    };
+
+    struct TileDraw {
+        uint32_t tile;
+        uint32_t lod;
+        uint32_t neighborSteps;
+    };
+
+    VulkanDevice& device;
+    UploadManager& uploadManager;
+    GridIndexCache& indexCache;
+    TerrainCompute& terrainCompute;
+    UploadTicket uploadTicket = 0;
+    UploadTicket indexUploadTicket = 0;
+
+    uint32_t width = 0;
+    uint32_t height = 0;
+    float scale = 1.0f;
+
+    std::unique_ptr<VulkanBuffer> heightBuffer;
+    std::unique_ptr<VulkanBuffer> colorBuffer;
+    std::unique_ptr<VulkanBuffer> attributeBuffer;  // Packed normal, color and slope per point and copy
+
+    // Attributes are derived once the initial upload landed; the ramp spans the heights at setData
+    bool attributesSubmitted = false;
+    ComputeTicket attributeTicket = 0;
+    float minHeight = 0.0f;
+    float maxHeight = 0.0f;
+
+    // Updatable maps: copy `front` is drawn; dirty[i] holds, per row, the columns copy i lacks
+    struct RowSpan {
+        uint32_t begin = 0;
+        uint32_t end = 0;
+    };
+    bool updatable = false;
+    std::vector<float> heights;    // CPU mirror
+    std::vector<uint32_t> colors;
+    uint32_t front = 0;
+    std::array<std::vector<RowSpan>, 2> dirty;
+    std::array<bool, 2> anyDirty{};
+    std::array<uint64_t, 2> lastReadSerial{};  // Last frame that may have drawn the copy
+    UploadTicket partialTicket = 0;
+    bool partialPending = false;   // Uploading into the back copy, then deriving its attributes
+    RowSpan partialRows;           // Rows the partial upload touched
+    ComputeTicket partialDeriveTicket = 0;
+    bool partialDeriving = false;
+    HeightmapUploadStats lastUpload;
+
+    // Tiles row-major over a tilesX x tilesY layout; quadtree root is nodes[0]. tileBounds
+    // holds the tiles' bounds leaf block by leaf block, boxTiles and tileBoxes map between the orders
+    uint32_t tilesX = 0;
+    uint32_t tilesY = 0;
+    std::vector<Tile> tiles;
+    std::vector<QuadNode> nodes;
+    BoxList tileBounds;
+    std::vector<uint32_t> boxTiles;
+    std::vector<uint32_t> tileBoxes;
+
+    // Per-frame selection; tileLods is MAX_LODS for tiles culled this frame
+    std::vector<int32_t> nodeStack;
+    std::vector<uint32_t> visibleBoxes;
+    std::vector<uint32_t> tileLods;
+    std::vector<TileDraw> drawList;
+    TerrainStats stats;
+
+    // GPU-culled maps: z ranges per tile and copy, and every pattern in one index buffer
+    bool gpuCulled = false;
+    uint32_t maxDrawIndirectCount = 1;
+    std::unique_ptr<VulkanBuffer> tileRangeBuffer;
+    std::unique_ptr<VulkanBuffer> tilePatternBuffer;  // HeightmapTileTable::patterns
+    std::unique_ptr<VulkanBuffer> tileIndexBuffer;    // The indices those patterns point into
+
+    void buildTiles(const HeightmapData& data);
+    void computeTileBounds(Tile& tile, const float* heights, bool grow) const;
+    int32_t buildQuadtree(uint32_t x0, uint32_t y0, uint32_t x1, uint32_t y1);
+    void refitQuadtree();
+    void uploadDirtyRows(uint32_t copy);
+    void buildTilePatterns();
+    void uploadTileRanges(uint32_t copy);
+    TerrainCompute::Target computeTarget() const;
+    uint32_t chooseLod(const Tile& tile, const glm::vec3& eye) const;
+};
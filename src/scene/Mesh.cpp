@@ -1,24 +1,107 @@
 #include "Mesh.hpp"
 #include "src/loaders/OBJLoader.hpp"
+#include "src/scene/BoxCulling.hpp"
 
-Mesh::Mesh(VulkanDevice& device, CommandManager& commandManager)
-    : device(device), commandManager(commandManager) {
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+namespace {
+    template<typename T>
+    T quantize(float value, float scale) {
+        return static_cast<T>(std::lround(value * scale));
+    }
+
+    /**
+     * Quantize vertices against their own position and UV bounds,
+     * returning the ranges the shader needs to undo it.
+     */
+    MeshPushConstants packVertices(const std::vector<Vertex>& vertices, std::vector<PackedVertex>& packed) {
+        const auto [posMin, posMax, uvMin, uvMax] = BoxCulling::computeBounds(vertices);
+
+        const glm::vec3 center = 0.5f * (posMin + posMax);
+        // Flat axes would divide by zero; any non-zero extent decodes them exactly
+        const glm::vec3 extent = glm::max(0.5f * (posMax - posMin), glm::vec3(1e-20f));
+        const glm::vec2 uvScale = glm::max(uvMax - uvMin, glm::vec2(1e-20f));
+
+        packed.resize(vertices.size());
+        for (size_t i = 0; i < vertices.size(); i++) {
+            const Vertex& vertex = vertices[i];
+            const glm::vec3 pos = glm::clamp((vertex.pos - center) / extent, -1.0f, 1.0f);
+            const glm::vec3 color = glm::clamp(vertex.color, 0.0f, 1.0f);
+            const glm::vec2 uv = glm::clamp((vertex.texCoord - uvMin) / uvScale, 0.0f, 1.0f);
+
+            packed[i].pos = {
+                quantize<int16_t>(pos.x, 32767.0f),
+                quantize<int16_t>(pos.y, 32767.0f),
+                quantize<int16_t>(pos.z, 32767.0f),
+                0
+            };
+            packed[i].color = {
+                quantize<uint8_t>(color.r, 255.0f),
+                quantize<uint8_t>(color.g, 255.0f),
+                quantize<uint8_t>(color.b, 255.0f),
+                255
+            };
+            packed[i].texCoord = {
+                quantize<uint16_t>(uv.x, 65535.0f),
+                quantize<uint16_t>(uv.y, 65535.0f)
+            };
+        }
+
+        return MeshPushConstants{
+            .positionCenter = glm::vec4(center, 0.0f),
+            .positionExtent = glm::vec4(extent, 0.0f),
+            .texCoordRange = glm::vec4(uvMin, uvScale)
+        };
+    }
+}
+
+Mesh::Mesh(VulkanDevice& device, UploadManager& uploadManager, VertexFormat vertexFormat)
+    : device(device), uploadManager(uploadManager), vertexFormat(vertexFormat) {
+
+    if (vertexFormat == VertexFormat::None) {
+        throw std::invalid_argument("Mesh needs a vertex buffer format");
+    }
 }
 
-Mesh::Mesh(VulkanDevice& device, CommandManager& commandManager,
+Mesh::Mesh(VulkanDevice& device, UploadManager& uploadManager,
            const std::vector<Vertex>& vertices,
-           const std::vector<uint32_t>& indices)
-    : device(device), commandManager(commandManager),
+           const std::vector<uint32_t>& indices,
+           VertexFormat vertexFormat)
+    : device(device), uploadManager(uploadManager), vertexFormat(vertexFormat),
       vertices(vertices), indices(indices) {
 
+    if (vertexFormat == VertexFormat::None) {
+        throw std::invalid_argument("Mesh needs a vertex buffer format");
+    }
+
     if (hasData()) {
         createBuffers();
     }
 }
 
-void Mesh::loadFromOBJ(const std::string& filename) {
+bool Mesh::loadFromOBJ(const std::string& filename) {
+    const uint32_t processingKey = optimization ? optimization->key() : 0;
+    if (auto cached = MeshCache::load(filename, vertexFormat, processingKey)) {
+        vertices.clear();
+        indices.clear();
+        uploadBlobs(cached->getBlobs());
+        return true;
+    }
+
     OBJLoader::load(filename, vertices, indices);
+    createBuffers(filename);
+    return false;
+}
+
+FDFLoadStats Mesh::loadFromFDF(const std::string& filename) {
+    FDFLoadStats stats = FDFLoader::load(filename, vertices, indices);
     createBuffers();
+    return stats;
 }
 
 void Mesh::setData(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices) {
@@ -27,69 +110,161 @@ void Mesh::setData(const std::vector<Vertex>& vertices, const std::vector<uint32
     createBuffers();
 }
 
-void Mesh::createBuffers() {
+void Mesh::createBuffers(const std::string& cacheSource) {
     if (vertices.empty() || indices.empty()) {
         throw std::runtime_error("Cannot create buffers for empty mesh");
     }
 
-    // Create vertex buffer
-    vk::DeviceSize vertexBufferSize = sizeof(Vertex) * vertices.size();
+    optimizationStats = encodeBlobs(vertices, indices, vertexFormat, optimization, [&](const MeshBlobView& blobs) {
+        uploadBlobs(blobs);
+        if (!cacheSource.empty()) {
+            storeCache(cacheSource, blobs, optimization);
+        }
+    });
+}
 
-    // Create staging buffer for vertices
-    VulkanBuffer vertexStagingBuffer(device, vertexBufferSize,
-        vk::BufferUsageFlagBits::eTransferSrc,
-        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+bool Mesh::loadOBJBlobs(const std::string& filename, VertexFormat vertexFormat,
+                        const std::optional<MeshOptimizationOptions>& optimization,
+                        const std::function<void(const MeshBlobView&)>& consume) {
+    const uint32_t processingKey = optimization ? optimization->key() : 0;
+    if (auto cached = MeshCache::load(filename, vertexFormat, processingKey)) {
+        consume(cached->getBlobs());
+        return true;
+    }
 
-    vertexStagingBuffer.map();
-    vertexStagingBuffer.copyData(vertices.data(), vertexBufferSize);
-    vertexStagingBuffer.unmap();
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    OBJLoader::load(filename, vertices, indices);
+    encodeBlobs(vertices, indices, vertexFormat, optimization, [&](const MeshBlobView& blobs) {
+        consume(blobs);
+        storeCache(filename, blobs, optimization);
+    });
+    return false;
+}
 
-    // Create device-local vertex buffer
-    vertexBuffer = std::make_unique<VulkanBuffer>(device, vertexBufferSize,
-        vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer,
-        vk::MemoryPropertyFlagBits::eDeviceLocal);
+MeshBlobs Mesh::parseOBJ(const std::string& filename, VertexFormat vertexFormat,
+                         const std::optional<MeshOptimizationOptions>& optimization) {
+    const uint32_t processingKey = optimization ? optimization->key() : 0;
+    if (auto cached = MeshCache::load(filename, vertexFormat, processingKey)) {
+        auto file = std::make_shared<MeshCacheFile>(std::move(*cached));
+        return MeshBlobs{ .view = file->getBlobs(), .storage = file, .cached = true };
+    }
+
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    OBJLoader::load(filename, vertices, indices);
+
+    // The encoded blobs only live for the callback; copy them out, vertices then indices
+    MeshBlobs result;
+    result.optimizationStats = encodeBlobs(vertices, indices, vertexFormat, optimization, [&](const MeshBlobView& blobs) {
+        auto bytes = std::make_shared<std::vector<std::byte>>(blobs.vertexData.size() + blobs.indexData.size());
+        std::memcpy(bytes->data(), blobs.vertexData.data(), blobs.vertexData.size());
+        std::memcpy(bytes->data() + blobs.vertexData.size(), blobs.indexData.data(), blobs.indexData.size());
+
+        result.view = blobs;
+        result.view.vertexData = std::span<const std::byte>(bytes->data(), blobs.vertexData.size());
+        result.view.indexData = std::span<const std::byte>(bytes->data() + blobs.vertexData.size(), blobs.indexData.size());
+        result.storage = bytes;
+        storeCache(filename, blobs, optimization);
+    });
+    return result;
+}
 
-    // Copy from staging to vertex buffer
-    auto commandBuffer = commandManager.beginSingleTimeCommands();
-    vertexBuffer->copyFrom(vertexStagingBuffer, *commandBuffer);
-    commandManager.endSingleTimeCommands(*commandBuffer);
+void Mesh::setBlobs(const MeshBlobs& blobs) {
+    if (blobs.view.vertexFormat != vertexFormat) {
+        throw std::invalid_argument("Mesh blobs were encoded for a different vertex format");
+    }
+    vertices.clear();
+    indices.clear();
+    optimizationStats = blobs.optimizationStats;
+    uploadBlobs(blobs.view);
+}
 
-    // Create index buffer
-    vk::DeviceSize indexBufferSize = sizeof(uint32_t) * indices.size();
+std::optional<MeshOptimizationStats> Mesh::encodeBlobs(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                                                       VertexFormat vertexFormat,
+                                                       const std::optional<MeshOptimizationOptions>& optimization,
+                                                       const std::function<void(const MeshBlobView&)>& consume) {
+    std::optional<MeshOptimizationStats> stats;
+    if (optimization) {
+        stats = MeshOptimizer::optimize(vertices, indices, *optimization);
+    }
 
-    // Create staging buffer for indices
-    VulkanBuffer indexStagingBuffer(device, indexBufferSize,
-        vk::BufferUsageFlagBits::eTransferSrc,
-        vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+    MeshBlobView blobs{
+        .vertexFormat = vertexFormat,
+        .vertexCount = static_cast<uint32_t>(vertices.size()),
+        .indexCount = static_cast<uint32_t>(indices.size())
+    };
 
-    indexStagingBuffer.map();
-    indexStagingBuffer.copyData(indices.data(), indexBufferSize);
-    indexStagingBuffer.unmap();
+    // Packed vertices are quantized into a temporary; the fp32 copy stays for CPU-side use
+    std::vector<PackedVertex> packedVertices;
+    if (vertexFormat == VertexFormat::Packed) {
+        blobs.quantization = packVertices(vertices, packedVertices);
+        blobs.vertexData = std::as_bytes(std::span(packedVertices));
+    } else {
+        blobs.vertexData = std::as_bytes(std::span(vertices));
+    }
 
-    // Create device-local index buffer
-    indexBuffer = std::make_unique<VulkanBuffer>(device, indexBufferSize,
+    // 16-bit indices for meshes with fewer than 65536 vertices
+    std::vector<uint16_t> shortIndices;
+    if (vertices.size() <= std::numeric_limits<uint16_t>::max()) {
+        shortIndices.assign(indices.begin(), indices.end());
+        blobs.indexSize = sizeof(uint16_t);
+        blobs.indexData = std::as_bytes(std::span(shortIndices));
+    } else {
+        blobs.indexSize = sizeof(uint32_t);
+        blobs.indexData = std::as_bytes(std::span(indices));
+    }
+
+    consume(blobs);
+    return stats;
+}
+
+void Mesh::storeCache(const std::string& sourcePath, const MeshBlobView& blobs,
+                      const std::optional<MeshOptimizationOptions>& optimization) {
+    const uint32_t processingKey = optimization ? optimization->key() : 0;
+    if (!MeshCache::store(sourcePath, blobs, processingKey)) {
+        std::cerr << "warning: could not write mesh cache " << MeshCache::cachePath(sourcePath) << std::endl;
+    }
+}
+
+void Mesh::uploadBlobs(const MeshBlobView& blobs) {
+    quantization = blobs.quantization;
+    vertexCount = blobs.vertexCount;
+    indexCount = blobs.indexCount;
+    indexType = blobs.indexSize == sizeof(uint16_t) ? vk::IndexType::eUint16 : vk::IndexType::eUint32;
+
+    // Create device-local vertex and index buffers
+    vertexBuffer = std::make_unique<VulkanBuffer>(device, blobs.vertexData.size(),
+        vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer,
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
+
+    indexBuffer = std::make_unique<VulkanBuffer>(device, blobs.indexData.size(),
         vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer,
         vk::MemoryPropertyFlagBits::eDeviceLocal);
 
-    // Copy from staging to index buffer
-    commandBuffer = commandManager.beginSingleTimeCommands();
-    indexBuffer->copyFrom(indexStagingBuffer, *commandBuffer);
-    commandManager.endSingleTimeCommands(*commandBuffer);
+    // Both copies go out in one batch on the transfer queue; draw once the ticket completes
+    uploadManager.uploadBuffer(*vertexBuffer, blobs.vertexData.data(), blobs.vertexData.size());
+    uploadManager.uploadBuffer(*indexBuffer, blobs.indexData.data(), blobs.indexData.size());
+    uploadTicket = uploadManager.flush();
 }
 
-void Mesh::bind(const vk::raii::CommandBuffer& commandBuffer) const {
+void Mesh::bind(const vk::raii::CommandBuffer& commandBuffer, vk::PipelineLayout pipelineLayout) const {
     if (!hasData()) {
         throw std::runtime_error("Cannot bind empty mesh");
     }
 
+    if (vertexFormat == VertexFormat::Packed) {
+        commandBuffer.pushConstants<MeshPushConstants>(
+            pipelineLayout, vk::ShaderStageFlagBits::eVertex, 0, quantization);
+    }
     commandBuffer.bindVertexBuffers(0, vertexBuffer->getHandle(), {0});
-    commandBuffer.bindIndexBuffer(indexBuffer->getHandle(), 0, vk::IndexType::eUint32);
+    commandBuffer.bindIndexBuffer(indexBuffer->getHandle(), 0, indexType);
 }
 
-void Mesh::draw(const vk::raii::CommandBuffer& commandBuffer) const {
+void Mesh::draw(const vk::raii::CommandBuffer& commandBuffer, uint32_t instanceCount, uint32_t firstInstance) const {
     if (!hasData()) {
         throw std::runtime_error("Cannot draw empty mesh");
     }
 
-    commandBuffer.drawIndexed(static_cast<uint32_t>(indices.size()), 1, 0, 0, 0);
+    commandBuffer.drawIndexed(indexCount, instanceCount, 0, 0, firstInstance);
 }
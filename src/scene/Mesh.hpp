@@ -4,11 +4,26 @@
 #include "src/utils/Vertex.hpp"
 #include "src/core/VulkanDevice.hpp"
 #include "src/resources/VulkanBuffer.hpp"
-#include "src/rendering/CommandManager.hpp"
+#include "src/rendering/UploadManager.hpp"
+#include "src/loaders/FDFLoader.hpp"
+#include "src/loaders/MeshCache.hpp"
+#include "src/scene/MeshOptimizer.hpp"
 
+#include <functional>
 #include <vector>
 #include <string>
 #include <memory>
+#include <optional>
+
+/**
+ * @brief GPU-ready mesh blobs that own their bytes, so they can be handed between threads
+ */
+struct MeshBlobs {
+    MeshBlobView view;
+    std::shared_ptr<const void> storage;  // Keeps the view's bytes alive (the mapped cache or a copy)
+    std::optional<MeshOptimizationStats> optimizationStats;  // Set when the optimizer ran on a cache miss
+    bool cached = false;                  // Came from a current cache file
+};
 
 /**
  * @brief Mesh class encapsulating vertex and index data with GPU buffers
@@ -24,20 +39,24 @@ public:
     /**
      * @brief Construct empty mesh
      * @param device Vulkan device reference
-     * @param commandManager Command manager for staging operations
+     * @param uploadManager Upload manager for staging operations
+     * @param vertexFormat GPU vertex layout (Standard or Packed)
      */
-    Mesh(VulkanDevice& device, CommandManager& commandManager);
+    Mesh(VulkanDevice& device, UploadManager& uploadManager,
+         VertexFormat vertexFormat = VertexFormat::Standard);
 
     /**
      * @brief Construct mesh with vertex and index data
      * @param device Vulkan device reference
-     * @param commandManager Command manager for staging operations
+     * @param uploadManager Upload manager for staging operations
      * @param vertices Vertex data
      * @param indices Index data
+     * @param vertexFormat GPU vertex layout (Standard or Packed)
      */
-    Mesh(VulkanDevice& device, CommandManager& commandManager,
+    Mesh(VulkanDevice& device, UploadManager& uploadManager,
          const std::vector<Vertex>& vertices,
-         const std::vector<uint32_t>& indices);
+         const std::vector<uint32_t>& indices,
+         VertexFormat vertexFormat = VertexFormat::Standard);
 
     ~Mesh() = default;
 
@@ -48,11 +67,73 @@ public:
     Mesh& operator=(Mesh&&) = delete;
 
     /**
-     * @brief Load mesh from OBJ file
+     * @brief Load mesh from OBJ file, through the binary MeshCache
      * @param filename Path to OBJ file
+     * @return true if the mesh came from a current cache file
+     * @throws std::runtime_error if loading fails
+     *
+     * A cache hit uploads straight from the mapped cache file and leaves the CPU-side
+     * vertex/index copies empty; a miss parses the OBJ and writes the cache.
+     */
+    bool loadFromOBJ(const std::string& filename);
+
+    /**
+     * @brief Load an OBJ as GPU-ready blobs through the MeshCache, without creating buffers
+     * @param filename Path to OBJ file
+     * @param vertexFormat GPU vertex layout (Standard or Packed)
+     * @param optimization Passes to run on a cache miss; also part of the cache key
+     * @param consume Called once with the blobs, which are only valid during the call
+     * @return true if the blobs came from a current cache file
+     * @throws std::runtime_error if loading fails
+     *
+     * For callers that pack meshes into shared buffers (MeshScene).
+     */
+    static bool loadOBJBlobs(const std::string& filename, VertexFormat vertexFormat,
+                             const std::optional<MeshOptimizationOptions>& optimization,
+                             const std::function<void(const MeshBlobView&)>& consume);
+
+    /**
+     * @brief Load an OBJ into owned blobs through the MeshCache, touching no GPU state
+     * @param filename Path to OBJ file
+     * @param vertexFormat GPU vertex layout (Standard or Packed)
+     * @param optimization Passes to run on a cache miss; also part of the cache key
+     * @throws std::runtime_error if loading fails
+     *
+     * Safe to call from worker threads, except concurrently for the same file (both
+     * would write its cache). Hand the result to setBlobs() or MeshScene::addMesh on
+     * the main thread.
+     */
+    static MeshBlobs parseOBJ(const std::string& filename, VertexFormat vertexFormat,
+                              const std::optional<MeshOptimizationOptions>& optimization);
+
+    /**
+     * @brief Create GPU buffers from blobs produced by parseOBJ
+     * @throws std::invalid_argument if the blobs' vertex format isn't the mesh's
+     *
+     * Leaves the CPU-side vertex/index copies empty, like a cache hit in loadFromOBJ.
+     */
+    void setBlobs(const MeshBlobs& blobs);
+
+    /**
+     * @brief Load mesh from FdF heightmap file
+     * @param filename Path to FDF file
+     * @return Grid size and parse throughput
      * @throws std::runtime_error if loading fails
      */
-    void loadFromOBJ(const std::string& filename);
+    FDFLoadStats loadFromFDF(const std::string& filename);
+
+    /**
+     * @brief Run MeshOptimizer on CPU-side data before every upload
+     * @param options Passes to run; also part of the mesh cache key
+     *
+     * Call before loading. Cached meshes were optimized when the cache was written.
+     */
+    void setOptimization(const MeshOptimizationOptions& options) { optimization = options; }
+
+    /**
+     * @brief ACMR before/after of the last optimization, if one ran for this mesh
+     */
+    const std::optional<MeshOptimizationStats>& getOptimizationStats() const { return optimizationStats; }
 
     /**
      * @brief Set mesh data and create GPU buffers
@@ -62,41 +143,86 @@ public:
     void setData(const std::vector<Vertex>& vertices, const std::vector<uint32_t>& indices);
 
     /**
-     * @brief Bind mesh buffers to command buffer
+     * @brief Bind mesh buffers (and, for packed meshes, dequantization constants)
      * @param commandBuffer Command buffer to bind to
+     * @param pipelineLayout Layout of the bound pipeline, which must match getVertexFormat()
      */
-    void bind(const vk::raii::CommandBuffer& commandBuffer) const;
+    void bind(const vk::raii::CommandBuffer& commandBuffer, vk::PipelineLayout pipelineLayout) const;
 
     /**
      * @brief Draw mesh
      * @param commandBuffer Command buffer to record draw call
+     * @param instanceCount Copies drawn by the one call; instanced pipelines read
+     *                      their placement from binding 1 (see MeshInstances)
+     * @param firstInstance First instance of the per-instance binding
      */
-    void draw(const vk::raii::CommandBuffer& commandBuffer) const;
+    void draw(const vk::raii::CommandBuffer& commandBuffer, uint32_t instanceCount = 1, uint32_t firstInstance = 0) const;
 
     /**
      * @brief Get vertex count
      */
-    size_t getVertexCount() const { return vertices.size(); }
+    size_t getVertexCount() const { return vertexCount; }
 
     /**
      * @brief Get index count
      */
-    size_t getIndexCount() const { return indices.size(); }
+    size_t getIndexCount() const { return indexCount; }
+
+    /**
+     * @brief GPU vertex layout; picks the pipeline the mesh must be drawn with
+     */
+    VertexFormat getVertexFormat() const { return vertexFormat; }
+
+    /**
+     * @brief 16-bit when the mesh has fewer than 65536 vertices, else 32-bit
+     */
+    vk::IndexType getIndexType() const { return indexType; }
 
     /**
      * @brief Check if mesh has data
      */
-    bool hasData() const { return !vertices.empty() && !indices.empty(); }
+    bool hasData() const { return vertexCount > 0 && indexCount > 0; }
+
+    /**
+     * @brief Check if the GPU buffers finished uploading and can be drawn
+     */
+    bool isReady() const { return hasData() && uploadManager.isComplete(uploadTicket); }
+
+    /**
+     * @brief Ticket of the upload batch that fills the GPU buffers
+     */
+    UploadTicket getUploadTicket() const { return uploadTicket; }
 
 private:
     VulkanDevice& device;
-    CommandManager& commandManager;
+    UploadManager& uploadManager;
+    UploadTicket uploadTicket = 0;
+
+    VertexFormat vertexFormat;
+    vk::IndexType indexType = vk::IndexType::eUint32;
+    MeshPushConstants quantization{};  // Dequantization ranges of the packed buffer
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+
+    std::optional<MeshOptimizationOptions> optimization;
+    std::optional<MeshOptimizationStats> optimizationStats;
 
+    // CPU-side source data; empty when the mesh was loaded from MeshCache
     std::vector<Vertex> vertices;
     std::vector<uint32_t> indices;
 
     std::unique_ptr<VulkanBuffer> vertexBuffer;
     std::unique_ptr<VulkanBuffer> indexBuffer;
 
-    void createBuffers();
+    // Optimize, encode vertices/indices into the GPU layout, upload, and optionally store the cache
+    void createBuffers(const std::string& cacheSource = {});
+    void uploadBlobs(const MeshBlobView& blobs);
+
+    // Optimize in place and encode into the GPU layout; blobs passed to consume live for the call
+    static std::optional<MeshOptimizationStats> encodeBlobs(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices,
+                                                            VertexFormat vertexFormat,
+                                                            const std::optional<MeshOptimizationOptions>& optimization,
+                                                            const std::function<void(const MeshBlobView&)>& consume);
+    static void storeCache(const std::string& sourcePath, const MeshBlobView& blobs,
+                           const std::optional<MeshOptimizationOptions>& optimization);
 };
@@ -0,0 +1,84 @@
+#include "MeshInstances.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+MeshInstances::MeshInstances(VulkanDevice& device, uint32_t frameCount, uint32_t capacity)
+    : capacity(capacity), slots(frameCount) {
+    for (Slot& slot : slots) {
+        slot.buffer = std::make_unique<VulkanBuffer>(device,
+            static_cast<vk::DeviceSize>(capacity) * sizeof(InstanceData),
+            vk::BufferUsageFlagBits::eVertexBuffer,
+            vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        slot.buffer->map();
+    }
+}
+
+uint32_t MeshInstances::add(const glm::mat4& model, const glm::vec4& color) {
+    if (instances.size() >= capacity) {
+        throw std::runtime_error("MeshInstances capacity reached");
+    }
+    const uint32_t instance = static_cast<uint32_t>(instances.size());
+    instances.push_back(pack(model, color));
+    markDirty(instance, instance + 1);
+    return instance;
+}
+
+void MeshInstances::set(uint32_t instance, const glm::mat4& model, const glm::vec4& color) {
+    instances.at(instance) = pack(model, color);
+    markDirty(instance, instance + 1);
+}
+
+void MeshInstances::remove(uint32_t instance) {
+    if (instance >= instances.size()) {
+        throw std::out_of_range("MeshInstances::remove: no such instance");
+    }
+    // The count shrinking is picked up by update(); only the moved entry needs copying
+    instances[instance] = instances.back();
+    instances.pop_back();
+    if (instance < instances.size()) {
+        markDirty(instance, instance + 1);
+    }
+}
+
+void MeshInstances::clear() {
+    instances.clear();
+}
+
+void MeshInstances::update(uint32_t frame) {
+    Slot& slot = slots[frame];
+    const uint32_t count = getCount();
+    const uint32_t end = std::min(slot.dirtyEnd, count);
+    if (slot.dirtyBegin < end) {
+        std::memcpy(static_cast<InstanceData*>(slot.buffer->getMappedData()) + slot.dirtyBegin,
+                    &instances[slot.dirtyBegin], (end - slot.dirtyBegin) * sizeof(InstanceData));
+    }
+    slot.count = count;
+    slot.dirtyBegin = slot.dirtyEnd = 0;
+}
+
+void MeshInstances::bind(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame) const {
+    commandBuffer.bindVertexBuffers(InstanceData::getBindingDescription().binding, slots[frame].buffer->getHandle(), {0});
+}
+
+void MeshInstances::markDirty(uint32_t begin, uint32_t end) {
+    for (Slot& slot : slots) {
+        if (slot.dirtyBegin == slot.dirtyEnd) {
+            slot.dirtyBegin = begin;
+            slot.dirtyEnd = end;
+        } else {
+            slot.dirtyBegin = std::min(slot.dirtyBegin, begin);
+            slot.dirtyEnd = std::max(slot.dirtyEnd, end);
+        }
+    }
+}
+
+InstanceData MeshInstances::pack(const glm::mat4& model, const glm::vec4& color) {
+    const glm::vec4 scaled = glm::round(glm::clamp(color, 0.0f, 1.0f) * 255.0f);
+    return InstanceData{
+        .model = model,
+        .color = { static_cast<uint8_t>(scaled.r), static_cast<uint8_t>(scaled.g),
+                   static_cast<uint8_t>(scaled.b), static_cast<uint8_t>(scaled.a) }
+    };
+}
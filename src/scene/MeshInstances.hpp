@@ -0,0 +1,102 @@
+#pragma once
+
+#include "src/utils/VulkanCommon.hpp"
+#include "src/utils/Vertex.hpp"
+#include "src/core/VulkanDevice.hpp"
+#include "src/resources/VulkanBuffer.hpp"
+
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Placements of one mesh, drawn with a single instanced call
+ *
+ * Instances live in a CPU array and in one host-visible InstanceData buffer per
+ * frame slot, bound as the per-instance vertex binding (binding 1). Edits only
+ * mark the changed range dirty in every slot; update() copies a slot's dirty range
+ * once its previous frame retired, so frames in flight never see a buffer change
+ * under them and an unchanged scene copies nothing.
+ *
+ * Dirty ranges are tracked as one span per slot, so scattered edits in a frame
+ * copy everything between them.
+ */
+class MeshInstances {
+public:
+    static constexpr uint32_t DEFAULT_CAPACITY = 65536;
+
+    /**
+     * @brief Create the per-frame instance buffers
+     * @param device Vulkan device reference
+     * @param frameCount Number of frame slots
+     * @param capacity Maximum instances
+     */
+    MeshInstances(VulkanDevice& device, uint32_t frameCount, uint32_t capacity = DEFAULT_CAPACITY);
+
+    ~MeshInstances() = default;
+
+    // Disable copy and move
+    MeshInstances(const MeshInstances&) = delete;
+    MeshInstances& operator=(const MeshInstances&) = delete;
+    MeshInstances(MeshInstances&&) = delete;
+    MeshInstances& operator=(MeshInstances&&) = delete;
+
+    /**
+     * @brief Append an instance; drawn from the next update() of each slot
+     * @return Instance index
+     * @throws std::runtime_error if the capacity is reached
+     */
+    uint32_t add(const glm::mat4& model, const glm::vec4& color = glm::vec4(1.0f));
+
+    /**
+     * @brief Replace an instance's placement and tint
+     * @throws std::out_of_range if the index isn't an instance
+     */
+    void set(uint32_t instance, const glm::mat4& model, const glm::vec4& color = glm::vec4(1.0f));
+
+    /**
+     * @brief Remove an instance by moving the last one into its index
+     * @throws std::out_of_range if the index isn't an instance
+     */
+    void remove(uint32_t instance);
+
+    /**
+     * @brief Remove every instance
+     */
+    void clear();
+
+    /**
+     * @brief Copy the slot's dirty range into its buffer; call once the slot's previous frame retired
+     */
+    void update(uint32_t frame);
+
+    /**
+     * @brief Bind the slot's buffer as the per-instance binding
+     */
+    void bind(const vk::raii::CommandBuffer& commandBuffer, uint32_t frame) const;
+
+    // Accessors
+    uint32_t getCount() const { return static_cast<uint32_t>(instances.size()); }
+    uint32_t getCapacity() const { return capacity; }
+    bool empty() const { return instances.empty(); }
+    const InstanceData& get(uint32_t instance) const { return instances.at(instance); }
+
+    /**
+     * @brief Instances the slot's buffer held after its last update
+     */
+    uint32_t getDrawCount(uint32_t frame) const { return slots[frame].count; }
+
+private:
+    struct Slot {
+        std::unique_ptr<VulkanBuffer> buffer;
+        uint32_t count = 0;       // Instances the buffer holds
+        uint32_t dirtyBegin = 0;  // [dirtyBegin, dirtyEnd) differs from the CPU array
+        uint32_t dirtyEnd = 0;
+    };
+
+    uint32_t capacity;
+    std::vector<InstanceData> instances;
+    std::vector<Slot> slots;
+
+    void markDirty(uint32_t begin, uint32_t end);
+    static InstanceData pack(const glm::mat4& model, const glm::vec4& color);
+};
@@ -0,0 +1,271 @@
+#include "MeshOptimizer.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+namespace {
+    // Forsyth scoring parameters, from "Linear-Speed Vertex Cache Optimisation"
+    constexpr int SCORE_CACHE_SIZE = 32;
+    constexpr float CACHE_DECAY_POWER = 1.5f;
+    constexpr float LAST_TRIANGLE_SCORE = 0.75f;
+    constexpr float VALENCE_BOOST_SCALE = 2.0f;
+    constexpr float VALENCE_BOOST_POWER = 0.5f;
+    constexpr uint32_t NO_TRIANGLE = std::numeric_limits<uint32_t>::max();
+
+    // 0 .. 1 for the position in the LRU cache, plus a boost for vertices with few triangles left
+    float vertexScore(int cachePosition, uint32_t remainingValence) {
+        if (remainingValence == 0) {
+            return -1.0f;  // Nothing left to draw with this vertex
+        }
+
+        float score = 0.0f;
+        if (cachePosition >= 0) {
+            if (cachePosition < 3) {
+                score = LAST_TRIANGLE_SCORE;  // Used by the last triangle; fixed so strips aren't preferred
+            } else {
+                float scaler = 1.0f / static_cast<float>(SCORE_CACHE_SIZE - 3);
+                score = std::pow(1.0f - static_cast<float>(cachePosition - 3) * scaler, CACHE_DECAY_POWER);
+            }
+        }
+        score += VALENCE_BOOST_SCALE * std::pow(static_cast<float>(remainingValence), -VALENCE_BOOST_POWER);
+        return score;
+    }
+}
+
+MeshOptimizationStats MeshOptimizer::optimize(std::vector<Vertex>& vertices,
+                                              std::vector<uint32_t>& indices,
+                                              const MeshOptimizationOptions& options) {
+    auto start = std::chrono::steady_clock::now();
+
+    MeshOptimizationStats stats;
+    stats.acmrBefore = computeACMR(indices, vertices.size(), options.cacheSize);
+
+    if (options.vertexCache) {
+        optimizeVertexCache(indices, vertices.size());
+    }
+    if (options.overdraw) {
+        optimizeOverdraw(vertices, indices, options.cacheSize);
+    }
+    if (options.vertexFetch) {
+        optimizeVertexFetch(vertices, indices);
+    }
+
+    stats.acmrAfter = computeACMR(indices, vertices.size(), options.cacheSize);
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return stats;
+}
+
+double MeshOptimizer::computeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize) {
+    if (indices.size() < 3) {
+        return 0.0;
+    }
+
+    // FIFO: a vertex is cached if it entered within the last cacheSize misses
+    std::vector<uint64_t> insertedAt(vertexCount, std::numeric_limits<uint64_t>::max());
+    uint64_t misses = 0;
+    for (uint32_t index : indices) {
+        if (insertedAt[index] == std::numeric_limits<uint64_t>::max() || misses - insertedAt[index] >= cacheSize) {
+            insertedAt[index] = misses++;
+        }
+    }
+    return static_cast<double>(misses) / static_cast<double>(indices.size() / 3);
+}
+
+void MeshOptimizer::optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // Vertex -> triangle adjacency in CSR form
+    std::vector<uint32_t> valence(vertexCount, 0);
+    for (uint32_t index : indices) {
+        valence[index]++;
+    }
+    std::vector<uint32_t> adjacencyOffset(vertexCount + 1, 0);
+    for (size_t v = 0; v < vertexCount; v++) {
+        adjacencyOffset[v + 1] = adjacencyOffset[v] + valence[v];
+    }
+    std::vector<uint32_t> adjacency(indices.size());
+    {
+        std::vector<uint32_t> fill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for (size_t i = 0; i < indices.size(); i++) {
+            adjacency[fill[indices[i]]++] = static_cast<uint32_t>(i / 3);
+        }
+    }
+
+    // Remaining (not yet emitted) triangles per vertex live at the front of each adjacency range
+    std::vector<uint32_t> remaining = valence;
+    std::vector<int> cachePosition(vertexCount, -1);
+    std::vector<float> score(vertexCount);
+    for (size_t v = 0; v < vertexCount; v++) {
+        score[v] = vertexScore(-1, remaining[v]);
+    }
+
+    std::vector<float> triangleScore(triangleCount);
+    for (size_t t = 0; t < triangleCount; t++) {
+        triangleScore[t] = score[indices[t * 3]] + score[indices[t * 3 + 1]] + score[indices[t * 3 + 2]];
+    }
+    std::vector<bool> emitted(triangleCount, false);
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+
+    // LRU cache, with room for the 3 vertices pushed in before trimming
+    std::array<uint32_t, SCORE_CACHE_SIZE + 3> cache{};
+    size_t cacheCount = 0;
+
+    uint32_t bestTriangle = NO_TRIANGLE;
+    size_t scanCursor = 0;  // Fallback when no cached vertex has triangles left
+
+    for (size_t emittedCount = 0; emittedCount < triangleCount; emittedCount++) {
+        if (bestTriangle == NO_TRIANGLE) {
+            while (emitted[scanCursor]) {
+                scanCursor++;
+            }
+            bestTriangle = static_cast<uint32_t>(scanCursor);
+        }
+
+        const uint32_t* corners = &indices[bestTriangle * 3];
+        output.insert(output.end(), { corners[0], corners[1], corners[2] });
+        emitted[bestTriangle] = true;
+
+        // Drop the triangle from its vertices' remaining lists
+        for (int c = 0; c < 3; c++) {
+            uint32_t v = corners[c];
+            uint32_t* begin = &adjacency[adjacencyOffset[v]];
+            uint32_t* end = begin + remaining[v];
+            uint32_t* it = std::find(begin, end, bestTriangle);
+            std::swap(*it, *(end - 1));
+            remaining[v]--;
+        }
+
+        // Move the triangle's vertices to the front of the cache
+        std::array<uint32_t, SCORE_CACHE_SIZE + 3> newCache{};
+        size_t newCount = 0;
+        for (int c = 0; c < 3; c++) {
+            newCache[newCount++] = corners[c];
+        }
+        for (size_t i = 0; i < cacheCount; i++) {
+            uint32_t v = cache[i];
+            if (v != corners[0] && v != corners[1] && v != corners[2]) {
+                newCache[newCount++] = v;
+            }
+        }
+
+        // Rescore everything that was or is in the cache, and their remaining triangles
+        for (size_t i = 0; i < newCount; i++) {
+            uint32_t v = newCache[i];
+            cachePosition[v] = i < SCORE_CACHE_SIZE ? static_cast<int>(i) : -1;
+            score[v] = vertexScore(cachePosition[v], remaining[v]);
+        }
+
+        bestTriangle = NO_TRIANGLE;
+        float bestScore = -1.0f;
+        for (size_t i = 0; i < newCount; i++) {
+            uint32_t v = newCache[i];
+            const uint32_t* begin = &adjacency[adjacencyOffset[v]];
+            for (uint32_t k = 0; k < remaining[v]; k++) {
+                uint32_t t = begin[k];
+                const uint32_t* tc = &indices[t * 3];
+                triangleScore[t] = score[tc[0]] + score[tc[1]] + score[tc[2]];
+                if (triangleScore[t] > bestScore) {
+                    bestScore = triangleScore[t];
+                    bestTriangle = t;
+                }
+            }
+        }
+
+        cacheCount = std::min<size_t>(newCount, SCORE_CACHE_SIZE);
+        std::copy_n(newCache.begin(), cacheCount, cache.begin());
+    }
+
+    indices = std::move(output);
+}
+
+void MeshOptimizer::optimizeOverdraw(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t cacheSize) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return;
+    }
+
+    // Cluster boundaries: triangles that miss on all three vertices restart a cold cache anyway,
+    // so reordering whole clusters barely changes ACMR
+    std::vector<size_t> clusterStart{ 0 };
+    {
+        std::vector<uint64_t> insertedAt(vertices.size(), std::numeric_limits<uint64_t>::max());
+        uint64_t misses = 0;
+        for (size_t t = 0; t < triangleCount; t++) {
+            int triangleMisses = 0;
+            for (int c = 0; c < 3; c++) {
+                uint32_t v = indices[t * 3 + c];
+                if (insertedAt[v] == std::numeric_limits<uint64_t>::max() || misses - insertedAt[v] >= cacheSize) {
+                    insertedAt[v] = misses++;
+                    triangleMisses++;
+                }
+            }
+            if (triangleMisses == 3 && t != 0) {
+                clusterStart.push_back(t);
+            }
+        }
+    }
+    clusterStart.push_back(triangleCount);
+    const size_t clusterCount = clusterStart.size() - 1;
+    if (clusterCount < 2) {
+        return;
+    }
+
+    glm::vec3 meshCentroid(0.0f);
+    for (const Vertex& vertex : vertices) {
+        meshCentroid += vertex.pos;
+    }
+    meshCentroid /= static_cast<float>(std::max<size_t>(vertices.size(), 1));
+
+    // Clusters far out along their facing direction occlude the rest; draw them first
+    std::vector<float> sortKey(clusterCount);
+    for (size_t c = 0; c < clusterCount; c++) {
+        glm::vec3 centroid(0.0f);
+        glm::vec3 normal(0.0f);  // Area-weighted
+        for (size_t t = clusterStart[c]; t < clusterStart[c + 1]; t++) {
+            const glm::vec3& p0 = vertices[indices[t * 3]].pos;
+            const glm::vec3& p1 = vertices[indices[t * 3 + 1]].pos;
+            const glm::vec3& p2 = vertices[indices[t * 3 + 2]].pos;
+            centroid += (p0 + p1 + p2) / 3.0f;
+            normal += glm::cross(p1 - p0, p2 - p0);
+        }
+        centroid /= static_cast<float>(clusterStart[c + 1] - clusterStart[c]);
+        float length = glm::length(normal);
+        sortKey[c] = length > 0.0f ? glm::dot(centroid - meshCentroid, normal / length) : 0.0f;
+    }
+
+    std::vector<size_t> order(clusterCount);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) { return sortKey[a] > sortKey[b]; });
+
+    std::vector<uint32_t> output;
+    output.reserve(indices.size());
+    for (size_t c : order) {
+        output.insert(output.end(), indices.begin() + clusterStart[c] * 3, indices.begin() + clusterStart[c + 1] * 3);
+    }
+    indices = std::move(output);
+}
+
+void MeshOptimizer::optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices) {
+    constexpr uint32_t UNMAPPED = std::numeric_limits<uint32_t>::max();
+    std::vector<uint32_t> remap(vertices.size(), UNMAPPED);
+    std::vector<Vertex> reordered;
+    reordered.reserve(vertices.size());
+
+    for (uint32_t& index : indices) {
+        if (remap[index] == UNMAPPED) {
+            remap[index] = static_cast<uint32_t>(reordered.size());
+            reordered.push_back(vertices[index]);
+        }
+        index = remap[index];
+    }
+    vertices = std::move(reordered);
+}
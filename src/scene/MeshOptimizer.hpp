@@ -0,0 +1,80 @@
+#pragma once
+
+#include "src/utils/Vertex.hpp"
+
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Which optimization passes to run
+ */
+struct MeshOptimizationOptions {
+    bool vertexCache = true;  // Reorder triangles for post-transform cache hits
+    bool overdraw = false;    // Then reorder cache-cold clusters front-to-back (view independent)
+    bool vertexFetch = true;  // Reorder vertices into first-use order for fetch locality
+    uint32_t cacheSize = 16;  // FIFO size used for the ACMR report
+
+    // Packed into the mesh cache key so differently optimized caches never mix
+    uint32_t key() const {
+        return (vertexCache ? 1u : 0u) | (overdraw ? 2u : 0u) | (vertexFetch ? 4u : 0u) | (cacheSize << 8);
+    }
+};
+
+/**
+ * @brief Post-transform cache efficiency before and after optimization
+ *
+ * ACMR (average cache miss ratio) is vertex shader invocations per triangle for a
+ * simulated FIFO cache: 3.0 is no reuse, ~0.5-0.7 is excellent for closed meshes.
+ */
+struct MeshOptimizationStats {
+    double acmrBefore = 0.0;
+    double acmrAfter = 0.0;
+    double seconds = 0.0;
+};
+
+/**
+ * @brief Triangle and vertex reordering for GPU-friendly index buffers
+ *
+ * Runs between loading and upload; the mesh renders identically, only the order
+ * of triangles and vertices changes.
+ * - Vertex cache: Forsyth's linear-speed greedy triangle ordering
+ * - Overdraw: splits the cache-ordered list at cold-cache restarts and sorts those
+ *   clusters so outward-facing, outer geometry draws first
+ * - Vertex fetch: renumbers vertices in order of first use
+ */
+class MeshOptimizer {
+public:
+    /**
+     * @brief Optimize in place
+     * @param vertices Vertex data, reordered if options.vertexFetch is set
+     * @param indices Triangle list indices, reordered and remapped
+     * @param options Passes to run
+     * @return ACMR before and after, and the time taken
+     */
+    static MeshOptimizationStats optimize(std::vector<Vertex>& vertices,
+                                          std::vector<uint32_t>& indices,
+                                          const MeshOptimizationOptions& options);
+
+    /**
+     * @brief Average cache miss ratio of a triangle list under a FIFO cache
+     */
+    static double computeACMR(const std::vector<uint32_t>& indices, size_t vertexCount, uint32_t cacheSize);
+
+    /**
+     * @brief Reorder triangles for post-transform cache locality (Forsyth)
+     */
+    static void optimizeVertexCache(std::vector<uint32_t>& indices, size_t vertexCount);
+
+    /**
+     * @brief Sort cache-cold clusters of an already cache-ordered list to reduce overdraw
+     */
+    static void optimizeOverdraw(const std::vector<Vertex>& vertices, std::vector<uint32_t>& indices, uint32_t cacheSize);
+
+    /**
+     * @brief Renumber vertices in first-use order, dropping unreferenced ones
+     */
+    static void optimizeVertexFetch(std::vector<Vertex>& vertices, std::vector<uint32_t>& indices);
+
+private:
+    MeshOptimizer() = delete;  // Static utility class, no instances
+};
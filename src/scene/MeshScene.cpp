@@ -0,0 +1,162 @@
+#include "MeshScene.hpp"
+#include "src/scene/Mesh.hpp"
+
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+MeshScene::MeshScene(VulkanDevice& device, UploadManager& uploadManager,
+                     uint32_t vertexCapacity, uint32_t indexCapacity, uint32_t instanceCapacity)
+    : device(device), uploadManager(uploadManager),
+      vertexCapacity(vertexCapacity), indexCapacity(indexCapacity), instanceCapacity(instanceCapacity) {
+
+    // firstInstance selects the SceneInstance, so indirect draws need it with multiDrawIndirect
+    multiDrawIndirect = device.getCapabilities().multiDrawIndirect;
+    maxDrawIndirectCount = device.getPhysicalDevice().getProperties().limits.maxDrawIndirectCount;
+
+    vertexBuffer = std::make_unique<VulkanBuffer>(device,
+        static_cast<vk::DeviceSize>(vertexCapacity) * sizeof(PackedVertex),
+        vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer,
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
+    indexBuffer = std::make_unique<VulkanBuffer>(device,
+        static_cast<vk::DeviceSize>(indexCapacity) * sizeof(uint32_t),
+        vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndexBuffer,
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
+    instanceBuffer = std::make_unique<VulkanBuffer>(device,
+        static_cast<vk::DeviceSize>(instanceCapacity) * sizeof(SceneInstance),
+        vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eStorageBuffer,
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
+    // Storage usage lets GpuCulling read the commands
+    drawCommandBuffer = std::make_unique<VulkanBuffer>(device,
+        static_cast<vk::DeviceSize>(instanceCapacity) * sizeof(vk::DrawIndexedIndirectCommand),
+        vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eIndirectBuffer |
+        vk::BufferUsageFlagBits::eStorageBuffer,
+        vk::MemoryPropertyFlagBits::eDeviceLocal);
+}
+
+uint32_t MeshScene::loadOBJ(const std::string& filename, const std::optional<MeshOptimizationOptions>& optimization) {
+    uint32_t mesh = 0;
+    Mesh::loadOBJBlobs(filename, VertexFormat::Packed, optimization, [&](const MeshBlobView& blobs) {
+        mesh = addMesh(blobs);
+    });
+    return mesh;
+}
+
+uint32_t MeshScene::addMesh(const MeshBlobView& blobs) {
+    if (blobs.vertexFormat != VertexFormat::Packed) {
+        throw std::invalid_argument("MeshScene only holds packed vertices");
+    }
+    if (blobs.vertexCount > vertexCapacity - vertexCount || blobs.indexCount > indexCapacity - indexCount) {
+        throw std::runtime_error("MeshScene megabuffers are full");
+    }
+
+    SceneMesh mesh{
+        .firstIndex = indexCount,
+        .indexCount = blobs.indexCount,
+        .vertexOffset = static_cast<int32_t>(vertexCount),
+        .vertexCount = blobs.vertexCount,
+        .quantization = blobs.quantization
+    };
+
+    uploadManager.uploadBuffer(*vertexBuffer, blobs.vertexData.data(), blobs.vertexData.size(),
+                               static_cast<vk::DeviceSize>(vertexCount) * sizeof(PackedVertex));
+
+    // One index type for the whole megabuffer; indices stay mesh-relative, vertexOffset rebases them
+    const vk::DeviceSize indexOffset = static_cast<vk::DeviceSize>(indexCount) * sizeof(uint32_t);
+    if (blobs.indexSize == sizeof(uint32_t)) {
+        uploadManager.uploadBuffer(*indexBuffer, blobs.indexData.data(), blobs.indexData.size(), indexOffset);
+    } else {
+        std::vector<uint16_t> shortIndices(blobs.indexCount);
+        std::memcpy(shortIndices.data(), blobs.indexData.data(), blobs.indexData.size());
+        std::vector<uint32_t> wideIndices(shortIndices.begin(), shortIndices.end());
+        uploadManager.uploadBuffer(*indexBuffer, wideIndices.data(), wideIndices.size() * sizeof(uint32_t), indexOffset);
+    }
+
+    vertexCount += blobs.vertexCount;
+    indexCount += blobs.indexCount;
+    meshes.push_back(mesh);
+    return static_cast<uint32_t>(meshes.size() - 1);
+}
+
+uint32_t MeshScene::addInstance(uint32_t mesh, const glm::mat4& model) {
+    if (instances.size() >= instanceCapacity) {
+        throw std::runtime_error("MeshScene instance capacity reached");
+    }
+    const SceneMesh& source = meshes.at(mesh);
+    const uint32_t instance = static_cast<uint32_t>(instances.size());
+
+    instances.push_back({ .model = model, .quantization = source.quantization });
+    commands.push_back(vk::DrawIndexedIndirectCommand{
+        .indexCount = source.indexCount,
+        .instanceCount = 1,
+        .firstIndex = source.firstIndex,
+        .vertexOffset = source.vertexOffset,
+        .firstInstance = instance
+    });
+    return instance;
+}
+
+void MeshScene::commit() {
+    const uint32_t count = static_cast<uint32_t>(instances.size());
+    if (count > committedCount) {
+        const uint32_t added = count - committedCount;
+        uploadManager.uploadBuffer(*instanceBuffer, &instances[committedCount], added * sizeof(SceneInstance),
+                                   static_cast<vk::DeviceSize>(committedCount) * sizeof(SceneInstance));
+        uploadManager.uploadBuffer(*drawCommandBuffer, &commands[committedCount],
+                                   added * sizeof(vk::DrawIndexedIndirectCommand),
+                                   static_cast<vk::DeviceSize>(committedCount) * sizeof(vk::DrawIndexedIndirectCommand));
+    }
+    // Also submits mesh copies queued since the last commit
+    pendingCommits.push_back({ uploadManager.flush(), count });
+    committedCount = count;
+}
+
+void MeshScene::update() {
+    while (!pendingCommits.empty() && uploadManager.isComplete(pendingCommits.front().ticket)) {
+        drawCount = pendingCommits.front().instanceCount;
+        pendingCommits.pop_front();
+    }
+}
+
+void MeshScene::draw(const vk::raii::CommandBuffer& commandBuffer, vk::Buffer culledCommands,
+                     vk::Buffer drawCountBuffer) const {
+    if (drawCount == 0) {
+        return;
+    }
+
+    commandBuffer.bindVertexBuffers(0, vertexBuffer->getHandle(), {0});
+    commandBuffer.bindIndexBuffer(indexBuffer->getHandle(), 0, vk::IndexType::eUint32);
+
+    if (!multiDrawIndirect) {
+        // Consecutive instances of one mesh have consecutive firstInstance, so each run is one instanced call
+        for (uint32_t i = 0; i < drawCount;) {
+            const vk::DrawIndexedIndirectCommand& command = commands[i];
+            uint32_t run = 1;
+            while (i + run < drawCount && commands[i + run].firstIndex == command.firstIndex &&
+                   commands[i + run].vertexOffset == command.vertexOffset) {
+                run++;
+            }
+            commandBuffer.drawIndexed(command.indexCount, run, command.firstIndex, command.vertexOffset, command.firstInstance);
+            i += run;
+        }
+        return;
+    }
+
+    if (culledCommands && drawCountBuffer) {
+        commandBuffer.drawIndexedIndirectCount(culledCommands, 0, drawCountBuffer, 0, drawCount,
+                                               sizeof(vk::DrawIndexedIndirectCommand));
+        return;
+    }
+
+    const vk::Buffer commands = culledCommands ? culledCommands : drawCommandBuffer->getHandle();
+    for (uint32_t first = 0; first < drawCount; first += maxDrawIndirectCount) {
+        const uint32_t count = std::min(drawCount - first, maxDrawIndirectCount);
+        commandBuffer.drawIndexedIndirect(commands,
+                                          static_cast<vk::DeviceSize>(first) * sizeof(vk::DrawIndexedIndirectCommand),
+                                          count, sizeof(vk::DrawIndexedIndirectCommand));
+    }
+}
+
+vk::DeviceSize MeshScene::getGpuBytes() const {
+    return vertexBuffer->getSize() + indexBuffer->getSize() + instanceBuffer->getSize() + drawCommandBuffer->getSize();
+}
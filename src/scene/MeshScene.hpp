@@ -0,0 +1,169 @@
+#pragma once
+
+#include "src/utils/VulkanCommon.hpp"
+#include "src/utils/Vertex.hpp"
+#include "src/core/VulkanDevice.hpp"
+#include "src/resources/VulkanBuffer.hpp"
+#include "src/rendering/UploadManager.hpp"
+#include "src/loaders/MeshCache.hpp"
+#include "src/scene/MeshOptimizer.hpp"
+
+#include <deque>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Per-instance entry of the scene's instance buffer (std430, 112 bytes)
+ *
+ * Read by vertSceneMain through gl_InstanceIndex, which each indirect command
+ * sets to its instance with firstInstance.
+ */
+struct SceneInstance {
+    glm::mat4 model;                 // Instance placement within the scene
+    MeshPushConstants quantization;  // Dequantization ranges of the instance's mesh
+};
+static_assert(sizeof(SceneInstance) == 112, "SceneInstance must match the shader's std430 layout");
+
+/**
+ * @brief Where one mesh lives inside the scene's megabuffers
+ */
+struct SceneMesh {
+    uint32_t firstIndex = 0;
+    uint32_t indexCount = 0;
+    int32_t vertexOffset = 0;
+    uint32_t vertexCount = 0;
+    MeshPushConstants quantization{};  // Also the mesh's object-space bounds (center, extent)
+};
+
+/**
+ * @brief Many meshes in shared vertex/index megabuffers, drawn with indirect multi-draw
+ *
+ * Every mesh is appended to one packed vertex buffer and one 32-bit index buffer;
+ * each instance adds a SceneInstance and a VkDrawIndexedIndirectCommand on the GPU.
+ * Drawing binds the two megabuffers once and issues a single drawIndexedIndirect,
+ * so the CPU cost of a frame doesn't grow with the number of objects.
+ *
+ * Buffers are append-only: commit() uploads entries added since the last commit
+ * past the ones frames in flight are reading, and draws pick up the new entries
+ * once that upload completed.
+ */
+class MeshScene {
+public:
+    static constexpr uint32_t DEFAULT_VERTEX_CAPACITY = 4u << 20;   // 64 MB of packed vertices
+    static constexpr uint32_t DEFAULT_INDEX_CAPACITY = 16u << 20;   // 64 MB of 32-bit indices
+    static constexpr uint32_t DEFAULT_INSTANCE_CAPACITY = 65536;
+
+    /**
+     * @brief Create the megabuffers, instance buffer and indirect command buffer
+     * @param device Vulkan device reference
+     * @param uploadManager Upload manager for staging operations
+     * @param vertexCapacity Maximum packed vertices over all meshes
+     * @param indexCapacity Maximum indices over all meshes
+     * @param instanceCapacity Maximum instances (and indirect draws)
+     */
+    MeshScene(VulkanDevice& device, UploadManager& uploadManager,
+              uint32_t vertexCapacity = DEFAULT_VERTEX_CAPACITY,
+              uint32_t indexCapacity = DEFAULT_INDEX_CAPACITY,
+              uint32_t instanceCapacity = DEFAULT_INSTANCE_CAPACITY);
+
+    ~MeshScene() = default;
+
+    // Disable copy and move
+    MeshScene(const MeshScene&) = delete;
+    MeshScene& operator=(const MeshScene&) = delete;
+    MeshScene(MeshScene&&) = delete;
+    MeshScene& operator=(MeshScene&&) = delete;
+
+    /**
+     * @brief Load an OBJ (through the MeshCache) into the megabuffers
+     * @return Mesh id for addInstance
+     * @throws std::runtime_error if loading fails or the megabuffers are full
+     */
+    uint32_t loadOBJ(const std::string& filename, const std::optional<MeshOptimizationOptions>& optimization = {});
+
+    /**
+     * @brief Append packed mesh blobs to the megabuffers
+     *
+     * The copies join the upload batch that the next commit() submits.
+     * @return Mesh id for addInstance
+     * @throws std::invalid_argument if the blobs aren't VertexFormat::Packed
+     * @throws std::runtime_error if the megabuffers are full
+     */
+    uint32_t addMesh(const MeshBlobView& blobs);
+
+    /**
+     * @brief Add one drawn copy of a mesh; visible after the next commit()
+     * @return Instance index (the draw's firstInstance)
+     * @throws std::runtime_error if the instance capacity is reached
+     */
+    uint32_t addInstance(uint32_t mesh, const glm::mat4& model);
+
+    /**
+     * @brief Upload instances and draw commands added since the last commit in one batch
+     */
+    void commit();
+
+    /**
+     * @brief Make completed commits drawable (call once per frame)
+     */
+    void update();
+
+    /**
+     * @brief Bind the megabuffers and draw every drawable instance
+     *
+     * One drawIndexedIndirect (split only past maxDrawIndirectCount); without the
+     * multiDrawIndirect or drawIndirectFirstInstance features, falls back to one
+     * instanced drawIndexed per run of consecutive instances of a mesh, from the
+     * CPU copy of the commands.
+     * @param culledCommands Indirect buffer to draw from instead of the scene's own,
+     *                       laid out like it (e.g. GpuCulling's output); ignored by the fallback
+     * @param drawCountBuffer With culledCommands, a uint32 count of the commands at its front
+     *                        to draw, in one drawIndexedIndirectCount (needs drawIndirectCount
+     *                        and at most maxDrawIndirectCount commands)
+     */
+    void draw(const vk::raii::CommandBuffer& commandBuffer, vk::Buffer culledCommands = nullptr,
+              vk::Buffer drawCountBuffer = nullptr) const;
+
+    // Accessors
+    const SceneMesh& getMesh(uint32_t mesh) const { return meshes.at(mesh); }
+    uint32_t getMeshCount() const { return static_cast<uint32_t>(meshes.size()); }
+    uint32_t getInstanceCount() const { return static_cast<uint32_t>(instances.size()); }
+    uint32_t getInstanceCapacity() const { return instanceCapacity; }
+    bool drawsIndirect() const { return multiDrawIndirect; }  // False on the drawIndexed fallback
+    uint32_t getDrawCount() const { return drawCount; }
+    bool hasDraws() const { return drawCount > 0; }
+    vk::Buffer getInstanceBuffer() const { return instanceBuffer->getHandle(); }
+    vk::Buffer getDrawCommandBuffer() const { return drawCommandBuffer->getHandle(); }
+    vk::DeviceSize getGpuBytes() const;
+
+private:
+    struct Commit {
+        UploadTicket ticket;
+        uint32_t instanceCount;
+    };
+
+    VulkanDevice& device;
+    UploadManager& uploadManager;
+    bool multiDrawIndirect = false;
+    uint32_t maxDrawIndirectCount = 1;
+
+    std::unique_ptr<VulkanBuffer> vertexBuffer;
+    std::unique_ptr<VulkanBuffer> indexBuffer;
+    std::unique_ptr<VulkanBuffer> instanceBuffer;
+    std::unique_ptr<VulkanBuffer> drawCommandBuffer;
+    uint32_t vertexCapacity;
+    uint32_t indexCapacity;
+    uint32_t instanceCapacity;
+
+    std::vector<SceneMesh> meshes;
+    uint32_t vertexCount = 0;
+    uint32_t indexCount = 0;
+
+    std::vector<SceneInstance> instances;
+    std::vector<vk::DrawIndexedIndirectCommand> commands;  // CPU copy, mirrors drawCommandBuffer
+    uint32_t committedCount = 0;                           // Instances uploaded or uploading
+    uint32_t drawCount = 0;                                // Instances whose upload completed
+    std::deque<Commit> pendingCommits;
+};
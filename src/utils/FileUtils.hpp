@@ -4,8 +4,26 @@
 #include <vector>
 #include <string>
 #include <stdexcept>
+#include <span>
+#include <utility>
+
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace FileUtils {
+	// Owned copy of a whole file; MappedFile reads in place without the copy
 	inline std::vector<char> readFile(const std::string& filename) {
 		std::ifstream file(filename, std::ios::ate | std::ios::binary);
 		if (!file.is_open()) {
@@ -17,4 +35,117 @@ namespace FileUtils {
 		file.close();
 		return buffer;
 	}
+
+	// Read-only memory mapping of a whole file, unmapped on destruction. The mapping is
+	// page-aligned, so it can be read as SPIR-V words or other aligned data in place
+	class MappedFile {
+	public:
+		explicit MappedFile(const std::string& filename) {
+#ifdef _WIN32
+			fileHandle = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+									 OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+			if (fileHandle == INVALID_HANDLE_VALUE) {
+				throw std::runtime_error("failed to open file: " + filename);
+			}
+			LARGE_INTEGER fileSize;
+			GetFileSizeEx(fileHandle, &fileSize);
+			mappedSize = static_cast<size_t>(fileSize.QuadPart);
+			if (mappedSize > 0) {
+				mappingHandle = CreateFileMappingA(fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+				if (mappingHandle) {
+					mappedData = static_cast<const char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+				}
+				if (!mappedData) {
+					close();
+					throw std::runtime_error("failed to map file: " + filename);
+				}
+			}
+#else
+			fd = ::open(filename.c_str(), O_RDONLY);
+			if (fd < 0) {
+				throw std::runtime_error("failed to open file: " + filename);
+			}
+			struct stat st{};
+			if (fstat(fd, &st) != 0) {
+				close();
+				throw std::runtime_error("failed to stat file: " + filename);
+			}
+			mappedSize = static_cast<size_t>(st.st_size);
+			if (mappedSize > 0) {
+				void* ptr = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, fd, 0);
+				if (ptr == MAP_FAILED) {
+					close();
+					throw std::runtime_error("failed to map file: " + filename);
+				}
+				mappedData = static_cast<const char*>(ptr);
+				madvise(ptr, mappedSize, MADV_SEQUENTIAL);
+			}
+#endif
+		}
+
+		~MappedFile() { close(); }
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		MappedFile(MappedFile&& other) noexcept { swap(other); }
+		MappedFile& operator=(MappedFile&& other) noexcept {
+			if (this != &other) {
+				close();
+				swap(other);
+			}
+			return *this;
+		}
+
+		const char* data() const { return mappedData; }
+		size_t size() const { return mappedSize; }
+		std::span<const char> span() const { return { mappedData, mappedSize }; }
+
+	private:
+		const char* mappedData = nullptr;
+		size_t mappedSize = 0;
+#ifdef _WIN32
+		HANDLE fileHandle = INVALID_HANDLE_VALUE;
+		HANDLE mappingHandle = nullptr;
+#else
+		int fd = -1;
+#endif
+
+		void swap(MappedFile& other) noexcept {
+			std::swap(mappedData, other.mappedData);
+			std::swap(mappedSize, other.mappedSize);
+#ifdef _WIN32
+			std::swap(fileHandle, other.fileHandle);
+			std::swap(mappingHandle, other.mappingHandle);
+#else
+			std::swap(fd, other.fd);
+#endif
+		}
+
+		void close() {
+#ifdef _WIN32
+			if (mappedData) {
+				UnmapViewOfFile(mappedData);
+			}
+			if (mappingHandle) {
+				CloseHandle(mappingHandle);
+			}
+			if (fileHandle != INVALID_HANDLE_VALUE) {
+				CloseHandle(fileHandle);
+			}
+			fileHandle = INVALID_HANDLE_VALUE;
+			mappingHandle = nullptr;
+#else
+			if (mappedData) {
+				munmap(const_cast<char*>(mappedData), mappedSize);
+			}
+			if (fd >= 0) {
+				::close(fd);
+			}
+			fd = -1;
+#endif
+			mappedData = nullptr;
+			mappedSize = 0;
+		}
+	};
 }
@@ -2,8 +2,16 @@
 
 #include "VulkanCommon.hpp"
 #include <array>
+#include <cstdint>
 #include <glm/gtx/hash.hpp>
 
+// Vertex buffer layouts a pipeline or mesh can use
+enum class VertexFormat {
+	None,      // No vertex buffer; the vertex shader fetches its own data (heightmaps)
+	Standard,  // Vertex, 32 bytes
+	Packed     // PackedVertex, 16 bytes, dequantized with MeshPushConstants
+};
+
 struct Vertex {
 	glm::vec3 pos;
 	glm::vec3 color;
@@ -33,8 +41,89 @@ template<> struct std::hash<Vertex> {
 	}
 };
 
+// Quantized vertex: snorm16 position within the mesh bounds, RGBA8 color, unorm16 UV within the UV bounds
+struct PackedVertex {
+	std::array<int16_t, 4> pos;        // xyz, w unused (keeps the attribute 8-byte aligned)
+	std::array<uint8_t, 4> color;      // Linear RGBA
+	std::array<uint16_t, 2> texCoord;
+
+	static vk::VertexInputBindingDescription getBindingDescription() {
+		return { 0, sizeof(PackedVertex), vk::VertexInputRate::eVertex };
+	}
+
+	static std::array<vk::VertexInputAttributeDescription, 3> getAttributeDescriptions() {
+		return {
+			vk::VertexInputAttributeDescription( 0, 0, vk::Format::eR16G16B16A16Snorm, offsetof(PackedVertex, pos) ),
+			vk::VertexInputAttributeDescription( 1, 0, vk::Format::eR8G8B8A8Unorm, offsetof(PackedVertex, color) ),
+			vk::VertexInputAttributeDescription( 2, 0, vk::Format::eR16G16Unorm, offsetof(PackedVertex, texCoord) )
+		};
+	}
+};
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex must stay half the size of Vertex");
+
+// Per-instance input of instanced mesh draws (binding 1), after the vertex attributes
+struct InstanceData {
+	glm::mat4 model;               // Placement under the object's transform
+	std::array<uint8_t, 4> color;  // Linear RGBA tint
+
+	static vk::VertexInputBindingDescription getBindingDescription() {
+		return { 1, sizeof(InstanceData), vk::VertexInputRate::eInstance };
+	}
+
+	// A mat4 takes one location per column
+	static std::array<vk::VertexInputAttributeDescription, 5> getAttributeDescriptions() {
+		return {
+			vk::VertexInputAttributeDescription( 3, 1, vk::Format::eR32G32B32A32Sfloat, offsetof(InstanceData, model) ),
+			vk::VertexInputAttributeDescription( 4, 1, vk::Format::eR32G32B32A32Sfloat, offsetof(InstanceData, model) + sizeof(glm::vec4) ),
+			vk::VertexInputAttributeDescription( 5, 1, vk::Format::eR32G32B32A32Sfloat, offsetof(InstanceData, model) + 2 * sizeof(glm::vec4) ),
+			vk::VertexInputAttributeDescription( 6, 1, vk::Format::eR32G32B32A32Sfloat, offsetof(InstanceData, model) + 3 * sizeof(glm::vec4) ),
+			vk::VertexInputAttributeDescription( 7, 1, vk::Format::eR8G8B8A8Unorm, offsetof(InstanceData, color) )
+		};
+	}
+};
+static_assert(sizeof(InstanceData) == 68, "InstanceData is tightly packed");
+
+// Push constants of the packed path: ranges that map quantized attributes back to model space
+struct MeshPushConstants {
+	glm::vec4 positionCenter;  // xyz
+	glm::vec4 positionExtent;  // xyz half-size of the bounds
+	glm::vec4 texCoordRange;   // xy offset, zw scale
+};
+
 struct UniformBufferObject {
 	alignas(16) glm::mat4 model;
 	alignas(16) glm::mat4 view;
 	alignas(16) glm::mat4 proj;
 };
+
+// Push constants of the heightmap path, which rebuilds positions from SV_VertexID
+struct HeightmapPushConstants {
+	uint32_t width;
+	uint32_t height;
+	float scale;
+	uint32_t padding0;
+	// Tile being drawn: origin in points, extent in cells, own LOD step
+	uint32_t tileColumn;
+	uint32_t tileRow;
+	uint32_t tileColumns;
+	uint32_t tileRows;
+	uint32_t step;
+	// Steps of coarser left/right/top/bottom neighbors, 8 bits each, 0 when not coarser
+	uint32_t neighborSteps;
+	// Start of the drawn copy in the height and attribute buffers, in points (double-buffered maps)
+	uint32_t pointOffset;
+};
+
+// Every vertex path reads the index of its ObjectData from this push constant offset,
+// after its own constants; the renderer pushes it once per object
+constexpr uint32_t OBJECT_INDEX_OFFSET = 48;
+static_assert(sizeof(MeshPushConstants) <= OBJECT_INDEX_OFFSET && sizeof(HeightmapPushConstants) <= OBJECT_INDEX_OFFSET,
+			  "path push constants must end before the object index");
+
+// Per-object entry of the frame's object storage buffer (std430, 80 bytes)
+struct ObjectData {
+	glm::mat4 model;
+	uint32_t textureIndex;  // Slot in the bindless texture array
+	uint32_t padding[3];
+};
+static_assert(sizeof(ObjectData) == 80, "ObjectData must match the shader's std430 layout");
@@ -0,0 +1,188 @@
+// FDFLoader: the in-place row scanner, its errors, grid layout and the threaded split
+
+#include "src/loaders/FDFLoader.hpp"
+#include "tests/ScratchFile.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+    HeightmapData loadHeightmap(const std::string& contents) {
+        ScratchFile file(".fdf", contents);
+        HeightmapData heightmap;
+        FDFLoader::loadHeightmap(file.path(), heightmap);
+        return heightmap;
+    }
+
+    // The message names the 1-based line and what was wrong with it
+    void expectParseError(const std::string& contents, const std::string& line, const std::string& what) {
+        ScratchFile file(".fdf", contents);
+        HeightmapData heightmap;
+        try {
+            FDFLoader::loadHeightmap(file.path(), heightmap);
+            ADD_FAILURE() << "no error for:\n" << contents;
+        } catch (const std::runtime_error& e) {
+            const std::string message = e.what();
+            EXPECT_NE(message.find(line), std::string::npos) << message;
+            EXPECT_NE(message.find(what), std::string::npos) << message;
+        }
+    }
+
+    // Deterministic map large enough to be split across threads
+    int32_t patternHeight(size_t row, size_t column) {
+        return static_cast<int32_t>((row * 7 + column * 13) % 2001) - 1000;
+    }
+}
+
+TEST(FDFLoader, ParsesHeightsRowMajor) {
+    HeightmapData heightmap = loadHeightmap("0 1 2\n3 4 5\n");
+    EXPECT_EQ(heightmap.width, 3u);
+    EXPECT_EQ(heightmap.height, 2u);
+    EXPECT_EQ(heightmap.heights, (std::vector<float>{ 0, 1, 2, 3, 4, 5 }));
+    EXPECT_TRUE(heightmap.colors.empty());
+}
+
+TEST(FDFLoader, AcceptsSignsAndMixedWhitespace) {
+    HeightmapData heightmap = loadHeightmap("  -10\t+3   0 \r\n7 -0 2147483647\r\n");
+    EXPECT_EQ(heightmap.width, 3u);
+    EXPECT_EQ(heightmap.heights, (std::vector<float>{ -10, 3, 0, 7, 0, 2147483647.0f }));
+}
+
+TEST(FDFLoader, DropsTrailingBlankLines) {
+    HeightmapData heightmap = loadHeightmap("1 2\n3 4\n\n  \n\t\n");
+    EXPECT_EQ(heightmap.height, 2u);
+}
+
+TEST(FDFLoader, LastLineNeedsNoNewline) {
+    HeightmapData heightmap = loadHeightmap("1 2\n3 4");
+    EXPECT_EQ(heightmap.height, 2u);
+    EXPECT_EQ(heightmap.heights.back(), 4.0f);
+}
+
+TEST(FDFLoader, ParsesColorsAndDefaultsTheRestToWhite) {
+    HeightmapData heightmap = loadHeightmap("0,0xFF0000 1\n2,0x00ff00 3,0Xab\n");
+    EXPECT_EQ(heightmap.colors, (std::vector<uint32_t>{ 0xFF0000, 0xFFFFFF, 0x00FF00, 0x0000AB }));
+}
+
+TEST(FDFLoader, KeepsTheLowColorBytes) {
+    // Some maps write an alpha byte in front; only RGB is kept
+    HeightmapData heightmap = loadHeightmap("0,0x80123456\n");
+    EXPECT_EQ(heightmap.colors, (std::vector<uint32_t>{ 0x123456 }));
+}
+
+TEST(FDFLoader, ExplicitWhiteIsNoColor) {
+    HeightmapData heightmap = loadHeightmap("0,0xFFFFFF 1\n");
+    EXPECT_TRUE(heightmap.colors.empty());
+}
+
+TEST(FDFLoader, RejectsMalformedMaps) {
+    expectParseError("0 1 2\n3 4\n", "line 2", "shorter");
+    expectParseError("0 1\n3 4 5\n", "line 2", "longer");
+    expectParseError("0 1\n2 x\n", "line 2", "expected integer");
+    expectParseError("0 1\n2 -\n", "line 2", "expected integer");
+    expectParseError("0 1a\n", "line 1", "unexpected character");
+    expectParseError("0 2147483648\n", "line 1", "out of range");
+    expectParseError("0,FF\n", "line 1", "expected 0x");
+    expectParseError("0,0x\n", "line 1", "invalid color");
+    expectParseError("0,0x123456789\n", "line 1", "invalid color");
+    expectParseError(" \t\n1 2\n", "line 1", "empty row");
+}
+
+TEST(FDFLoader, RejectsEmptyMaps) {
+    expectParseError("", "", "empty map");
+    expectParseError("\n \n", "", "empty map");
+}
+
+TEST(FDFLoader, ThrowsForMissingFiles) {
+    HeightmapData heightmap;
+    EXPECT_THROW(FDFLoader::loadHeightmap("does/not/exist.fdf", heightmap), std::runtime_error);
+}
+
+TEST(FDFLoader, LoadCentersAndScalesTheGrid) {
+    ScratchFile file(".fdf", "0 1 2\n3 4 5,0xFF0000\n");
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    FDFLoadStats stats = FDFLoader::load(file.path(), vertices, indices);
+    EXPECT_EQ(stats.width, 3u);
+    EXPECT_EQ(stats.height, 2u);
+    ASSERT_EQ(vertices.size(), 6u);
+
+    // Longer side spans [-0.5, 0.5], heights share the scale
+    EXPECT_EQ(vertices[0].pos, glm::vec3(-0.5f, -0.25f, 0.0f));
+    EXPECT_EQ(vertices[5].pos, glm::vec3(0.5f, 0.25f, 2.5f));
+    EXPECT_EQ(vertices[0].texCoord, glm::vec2(0.0f, 0.0f));
+    EXPECT_EQ(vertices[5].texCoord, glm::vec2(1.0f, 1.0f));
+
+    // Colors are converted to linear; the sRGB endpoints map to themselves
+    EXPECT_EQ(vertices[0].color, glm::vec3(1.0f, 1.0f, 1.0f));
+    EXPECT_EQ(vertices[5].color, glm::vec3(1.0f, 0.0f, 0.0f));
+
+    EXPECT_EQ(indices.size(), 2u * 6u);
+}
+
+TEST(FDFLoader, GridIndicesAreTwoCounterClockwiseTrianglesPerCell) {
+    std::vector<uint32_t> indices;
+    FDFLoader::generateGridIndices(3, 2, indices);
+    EXPECT_EQ(indices, (std::vector<uint32_t>{ 0, 1, 3, 1, 4, 3, 1, 2, 4, 2, 5, 4 }));
+
+    FDFLoader::generateGridIndices(1, 5, indices);
+    EXPECT_TRUE(indices.empty());
+    FDFLoader::generateGridIndices(5, 1, indices);
+    EXPECT_TRUE(indices.empty());
+}
+
+TEST(FDFLoader, GridScaleMapsTheLongerSideToUnitLength) {
+    EXPECT_EQ(FDFLoader::gridScale(5, 3), 0.25f);
+    EXPECT_EQ(FDFLoader::gridScale(3, 5), 0.25f);
+    EXPECT_EQ(FDFLoader::gridScale(1, 1), 1.0f);
+}
+
+TEST(FDFLoader, LargeMapsParseTheSameOnEveryThread) {
+    constexpr size_t WIDTH = 500;
+    constexpr size_t HEIGHT = 1200;  // Several MB, so multi-core machines split it
+    std::string contents;
+    for (size_t row = 0; row < HEIGHT; row++) {
+        for (size_t column = 0; column < WIDTH; column++) {
+            contents += std::to_string(patternHeight(row, column));
+            if ((row + column) % 97 == 0) {
+                contents += ",0x00FF" + std::to_string(10 + row % 90);
+            }
+            contents += column + 1 < WIDTH ? " " : "\n";
+        }
+    }
+
+    ScratchFile file(".fdf", contents);
+    HeightmapData heightmap;
+    FDFLoadStats stats = FDFLoader::loadHeightmap(file.path(), heightmap);
+    EXPECT_EQ(stats.fileBytes, contents.size());
+    EXPECT_GE(stats.threadCount, 1u);
+    ASSERT_EQ(heightmap.getPointCount(), WIDTH * HEIGHT);
+    ASSERT_EQ(heightmap.colors.size(), WIDTH * HEIGHT);
+    for (size_t row = 0; row < HEIGHT; row++) {
+        for (size_t column = 0; column < WIDTH; column++) {
+            const size_t index = row * WIDTH + column;
+            ASSERT_EQ(heightmap.heights[index], static_cast<float>(patternHeight(row, column))) << row << ", " << column;
+            const uint32_t expected = (row + column) % 97 == 0
+                ? 0x00FF00u | std::stoul(std::to_string(10 + row % 90), nullptr, 16)
+                : 0xFFFFFFu;
+            ASSERT_EQ(heightmap.colors[index], expected) << row << ", " << column;
+        }
+    }
+}
+
+TEST(FDFLoader, ErrorsFromAnyThreadReachTheCaller) {
+    std::string row;
+    for (size_t column = 0; column < 500; column++) {
+        row += "123 ";
+    }
+    row += "\n";
+    std::string contents;
+    for (size_t i = 0; i < 1200; i++) {
+        contents += row;
+    }
+    contents += "1 2\n";
+    expectParseError(contents, "line 1201", "shorter");
+}
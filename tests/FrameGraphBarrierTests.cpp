@@ -0,0 +1,263 @@
+// FrameGraph's barrier batching: which hazards need a dependency and how they merge
+
+#include "src/rendering/FrameGraphBarriers.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+
+namespace {
+    using Stage = vk::PipelineStageFlagBits2;
+    using Access = vk::AccessFlagBits2;
+    using Layout = vk::ImageLayout;
+
+    const ResourceUse COMPUTE_WRITE{ .stages = Stage::eComputeShader, .access = Access::eShaderStorageWrite };
+    const ResourceUse COMPUTE_READ{ .stages = Stage::eComputeShader, .access = Access::eShaderStorageRead };
+    const ResourceUse INDIRECT_READ{ .stages = Stage::eDrawIndirect, .access = Access::eIndirectCommandRead };
+    const ResourceUse VERTEX_READ{ .stages = Stage::eVertexShader, .access = Access::eShaderStorageRead };
+    const ResourceUse COLOR_WRITE{
+        .stages = Stage::eColorAttachmentOutput,
+        .access = Access::eColorAttachmentWrite,
+        .layout = Layout::eColorAttachmentOptimal
+    };
+    const ResourceUse SAMPLED_READ{
+        .stages = Stage::eFragmentShader,
+        .access = Access::eShaderSampledRead,
+        .layout = Layout::eShaderReadOnlyOptimal
+    };
+    const ResourceUse COLOR_BLEND{
+        .stages = Stage::eColorAttachmentOutput,
+        .access = Access::eColorAttachmentRead,
+        .layout = Layout::eColorAttachmentOptimal
+    };
+
+    const vk::ImageSubresourceRange COLOR_RANGE{ vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1 };
+
+    // Handles are only compared, never used; VkImage is a pointer or a 64-bit integer
+    vk::Image fakeImage(uint64_t handle) {
+        return vk::Image(reinterpret_cast<VkImage>(handle));
+    }
+
+    BarrierAccess bufferAccess(const ResourceUse& use, bool write) {
+        return { .use = use, .write = write };
+    }
+
+    BarrierAccess imageAccess(const ResourceUse& use, bool write, vk::Image handle = fakeImage(0x10)) {
+        return { .use = use, .write = write, .image = true, .handle = handle, .range = COLOR_RANGE };
+    }
+}
+
+TEST(FrameGraphBarriers, FirstUseOfAFreshBufferNeedsNothing) {
+    BarrierBatch batch;
+    ResourceState state;
+    batch.add(state, bufferAccess(COMPUTE_WRITE, true));
+    EXPECT_TRUE(batch.empty());
+    EXPECT_EQ(state.writeStages, vk::PipelineStageFlags2(Stage::eComputeShader));
+    EXPECT_EQ(state.writeAccess, vk::AccessFlags2(Access::eShaderStorageWrite));
+}
+
+TEST(FrameGraphBarriers, ReadAfterWriteMakesTheWriteVisible) {
+    BarrierBatch batch;
+    ResourceState state;
+    batch.add(state, bufferAccess(COMPUTE_WRITE, true));
+    batch.add(state, bufferAccess(INDIRECT_READ, false));
+
+    const vk::MemoryBarrier2& barrier = batch.getMemoryBarrier();
+    EXPECT_EQ(barrier.srcStageMask, vk::PipelineStageFlags2(Stage::eComputeShader));
+    EXPECT_EQ(barrier.srcAccessMask, vk::AccessFlags2(Access::eShaderStorageWrite));
+    EXPECT_EQ(barrier.dstStageMask, vk::PipelineStageFlags2(Stage::eDrawIndirect));
+    EXPECT_EQ(barrier.dstAccessMask, vk::AccessFlags2(Access::eIndirectCommandRead));
+    EXPECT_TRUE(batch.getImageBarriers().empty());
+}
+
+TEST(FrameGraphBarriers, RepeatedReadsOfAVisibleWriteNeedNothing) {
+    BarrierBatch batch;
+    ResourceState state;
+    batch.add(state, bufferAccess(COMPUTE_WRITE, true));
+    batch.add(state, bufferAccess(INDIRECT_READ, false));
+    batch.clear();
+
+    batch.add(state, bufferAccess(INDIRECT_READ, false));
+    EXPECT_TRUE(batch.empty());
+
+    // A stage the write isn't visible to yet still waits for it
+    batch.add(state, bufferAccess(VERTEX_READ, false));
+    ASSERT_FALSE(batch.empty());
+    EXPECT_EQ(batch.getMemoryBarrier().srcStageMask, vk::PipelineStageFlags2(Stage::eComputeShader));
+    EXPECT_EQ(batch.getMemoryBarrier().dstStageMask, vk::PipelineStageFlags2(Stage::eVertexShader));
+}
+
+TEST(FrameGraphBarriers, WriteAfterReadIsAnExecutionDependencyOnly) {
+    BarrierBatch batch;
+    ResourceState state;
+    batch.add(state, bufferAccess(COMPUTE_READ, false));
+    EXPECT_TRUE(batch.empty());
+
+    batch.add(state, bufferAccess(COMPUTE_WRITE, true));
+    const vk::MemoryBarrier2& barrier = batch.getMemoryBarrier();
+    EXPECT_EQ(barrier.srcStageMask, vk::PipelineStageFlags2(Stage::eComputeShader));
+    EXPECT_FALSE(barrier.srcAccessMask);
+    EXPECT_EQ(barrier.dstStageMask, vk::PipelineStageFlags2(Stage::eComputeShader));
+    EXPECT_FALSE(barrier.dstAccessMask);
+}
+
+TEST(FrameGraphBarriers, WriteAfterWriteWaitsForTheWriteAndTheReadsSinceThen) {
+    BarrierBatch batch;
+    ResourceState state;
+    batch.add(state, bufferAccess(COMPUTE_WRITE, true));
+    batch.add(state, bufferAccess(INDIRECT_READ, false));
+    batch.clear();
+
+    batch.add(state, bufferAccess(COMPUTE_WRITE, true));
+    const vk::MemoryBarrier2& barrier = batch.getMemoryBarrier();
+    EXPECT_EQ(barrier.srcStageMask, Stage::eComputeShader | Stage::eDrawIndirect);
+    EXPECT_EQ(barrier.srcAccessMask, vk::AccessFlags2(Access::eShaderStorageWrite));
+    EXPECT_EQ(barrier.dstAccessMask, vk::AccessFlags2(Access::eShaderStorageWrite));
+
+    // The new write resets what later reads wait for
+    EXPECT_FALSE(state.readStages);
+    EXPECT_FALSE(state.visibleStages);
+}
+
+TEST(FrameGraphBarriers, HazardsOfSeveralBuffersShareOneMemoryBarrier) {
+    BarrierBatch batch;
+    ResourceState indirect, vertices;
+    batch.add(indirect, bufferAccess(COMPUTE_WRITE, true));
+    batch.add(vertices, bufferAccess({ .stages = Stage::eTransfer, .access = Access::eTransferWrite }, true));
+    batch.add(indirect, bufferAccess(INDIRECT_READ, false));
+    batch.add(vertices, bufferAccess(VERTEX_READ, false));
+
+    const vk::MemoryBarrier2& barrier = batch.getMemoryBarrier();
+    EXPECT_EQ(barrier.srcStageMask, Stage::eComputeShader | Stage::eTransfer);
+    EXPECT_EQ(barrier.srcAccessMask, Access::eShaderStorageWrite | Access::eTransferWrite);
+    EXPECT_EQ(barrier.dstStageMask, Stage::eDrawIndirect | Stage::eVertexShader);
+    EXPECT_EQ(barrier.dstAccessMask, Access::eIndirectCommandRead | Access::eShaderStorageRead);
+    EXPECT_TRUE(batch.getImageBarriers().empty());
+}
+
+TEST(FrameGraphBarriers, LayoutChangesBecomeImageBarriers) {
+    BarrierBatch batch;
+    ResourceState state;
+    const vk::Image image = fakeImage(0x42);
+    batch.add(state, imageAccess(COLOR_WRITE, true, image));
+    batch.clear();
+
+    batch.add(state, imageAccess(SAMPLED_READ, false, image));
+    EXPECT_FALSE(batch.getMemoryBarrier().srcStageMask);
+    ASSERT_EQ(batch.getImageBarriers().size(), 1u);
+    const vk::ImageMemoryBarrier2& barrier = batch.getImageBarriers()[0];
+    EXPECT_EQ(barrier.oldLayout, Layout::eColorAttachmentOptimal);
+    EXPECT_EQ(barrier.newLayout, Layout::eShaderReadOnlyOptimal);
+    EXPECT_EQ(barrier.srcStageMask, vk::PipelineStageFlags2(Stage::eColorAttachmentOutput));
+    EXPECT_EQ(barrier.srcAccessMask, vk::AccessFlags2(Access::eColorAttachmentWrite));
+    EXPECT_EQ(barrier.dstStageMask, vk::PipelineStageFlags2(Stage::eFragmentShader));
+    EXPECT_EQ(barrier.dstAccessMask, vk::AccessFlags2(Access::eShaderSampledRead));
+    EXPECT_EQ(barrier.image, image);
+    EXPECT_EQ(barrier.subresourceRange, COLOR_RANGE);
+    EXPECT_EQ(barrier.srcQueueFamilyIndex, VK_QUEUE_FAMILY_IGNORED);
+    EXPECT_EQ(state.layout, Layout::eShaderReadOnlyOptimal);
+}
+
+TEST(FrameGraphBarriers, ATransitionMakesTheImageVisibleToItsRead) {
+    BarrierBatch batch;
+    ResourceState state;
+    batch.add(state, imageAccess(COLOR_WRITE, true));
+    batch.add(state, imageAccess(SAMPLED_READ, false));
+    batch.clear();
+
+    batch.add(state, imageAccess(SAMPLED_READ, false));
+    EXPECT_TRUE(batch.empty());
+}
+
+TEST(FrameGraphBarriers, SameLayoutHazardsUseTheMemoryBarrier) {
+    BarrierBatch batch;
+    ResourceState state;
+    batch.add(state, imageAccess(COLOR_WRITE, true));
+    batch.clear();
+
+    batch.add(state, imageAccess(COLOR_BLEND, false));
+    EXPECT_TRUE(batch.getImageBarriers().empty());
+    EXPECT_EQ(batch.getMemoryBarrier().srcAccessMask, vk::AccessFlags2(Access::eColorAttachmentWrite));
+    EXPECT_EQ(batch.getMemoryBarrier().dstAccessMask, vk::AccessFlags2(Access::eColorAttachmentRead));
+}
+
+TEST(FrameGraphBarriers, RenderPassAttachmentsAreOrderedButNotTransitioned) {
+    BarrierBatch batch;
+    ResourceState state;
+    batch.add(state, imageAccess(SAMPLED_READ, false));
+    batch.clear();
+
+    BarrierAccess attachment = imageAccess(COLOR_WRITE, true);
+    attachment.renderPassLayout = Layout::eShaderReadOnlyOptimal;
+    batch.add(state, attachment);
+    EXPECT_TRUE(batch.getImageBarriers().empty());
+    EXPECT_EQ(batch.getMemoryBarrier().srcStageMask, vk::PipelineStageFlags2(Stage::eFragmentShader));
+    EXPECT_EQ(state.layout, Layout::eShaderReadOnlyOptimal);
+}
+
+TEST(FrameGraphBarriers, DiscardsTransitionFromUndefinedAfterAliasedAccesses) {
+    BarrierBatch batch;
+    ResourceState state;
+    batch.add(state, imageAccess(COLOR_WRITE, true));
+    batch.clear();
+
+    // Same layout as before, but the contents are dead and the memory was reused meanwhile
+    BarrierAccess discard = imageAccess(COLOR_WRITE, true);
+    discard.discard = true;
+    discard.aliasStages = Stage::eLateFragmentTests;
+    discard.aliasAccess = Access::eDepthStencilAttachmentWrite;
+    batch.add(state, discard);
+
+    ASSERT_EQ(batch.getImageBarriers().size(), 1u);
+    const vk::ImageMemoryBarrier2& barrier = batch.getImageBarriers()[0];
+    EXPECT_EQ(barrier.oldLayout, Layout::eUndefined);
+    EXPECT_EQ(barrier.newLayout, Layout::eColorAttachmentOptimal);
+    EXPECT_EQ(barrier.srcStageMask, Stage::eLateFragmentTests | Stage::eColorAttachmentOutput);
+    EXPECT_EQ(barrier.srcAccessMask, Access::eDepthStencilAttachmentWrite | Access::eColorAttachmentWrite);
+}
+
+TEST(FrameGraphBarriers, TransitionsOfSeveralImagesShareTheBatch) {
+    BarrierBatch batch;
+    ResourceState color, depth;
+    batch.add(color, imageAccess(COLOR_WRITE, true, fakeImage(1)));
+    batch.add(depth, imageAccess({
+        .stages = Stage::eEarlyFragmentTests,
+        .access = Access::eDepthStencilAttachmentWrite,
+        .layout = Layout::eDepthStencilAttachmentOptimal
+    }, true, fakeImage(2)));
+    EXPECT_EQ(batch.getImageBarriers().size(), 2u);
+    EXPECT_FALSE(batch.getMemoryBarrier().srcStageMask);
+}
+
+TEST(FrameGraphBarriers, HandOffMovesToTheFinalLayoutOnce) {
+    BarrierBatch batch;
+    ResourceState state;
+    const vk::Image image = fakeImage(7);
+    batch.add(state, imageAccess(COLOR_WRITE, true, image));
+    batch.clear();
+
+    batch.handOff(state, image, COLOR_RANGE, Layout::ePresentSrcKHR);
+    ASSERT_EQ(batch.getImageBarriers().size(), 1u);
+    const vk::ImageMemoryBarrier2& barrier = batch.getImageBarriers()[0];
+    EXPECT_EQ(barrier.oldLayout, Layout::eColorAttachmentOptimal);
+    EXPECT_EQ(barrier.newLayout, Layout::ePresentSrcKHR);
+    EXPECT_EQ(barrier.srcAccessMask, vk::AccessFlags2(Access::eColorAttachmentWrite));
+    EXPECT_EQ(barrier.dstStageMask, vk::PipelineStageFlags2(Stage::eBottomOfPipe));
+    EXPECT_EQ(state.layout, Layout::ePresentSrcKHR);
+    batch.clear();
+
+    batch.handOff(state, image, COLOR_RANGE, Layout::ePresentSrcKHR);
+    batch.handOff(state, image, COLOR_RANGE, Layout::eUndefined);
+    EXPECT_TRUE(batch.empty());
+}
+
+TEST(FrameGraphBarriers, ClearEmptiesTheBatch) {
+    BarrierBatch batch;
+    ResourceState buffer, image;
+    batch.add(buffer, bufferAccess(COMPUTE_READ, false));
+    batch.add(buffer, bufferAccess(COMPUTE_WRITE, true));
+    batch.add(image, imageAccess(COLOR_WRITE, true));
+    ASSERT_FALSE(batch.empty());
+    batch.clear();
+    EXPECT_TRUE(batch.empty());
+    EXPECT_TRUE(batch.getImageBarriers().empty());
+}
@@ -0,0 +1,174 @@
+// MemoryAllocator's per-block free list: first fit, alignment padding and coalescing
+
+#include "src/core/FreeList.hpp"
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <iterator>
+#include <map>
+
+namespace {
+    using Ranges = std::map<uint64_t, uint64_t>;
+}
+
+TEST(FreeList, DefaultConstructedHasNothingFree) {
+    FreeList list;
+    uint64_t offset = 0;
+    EXPECT_FALSE(list.allocate(1, 1, offset));
+    EXPECT_EQ(list.getRangeCount(), 0u);
+    EXPECT_EQ(list.getLargestRange(), 0u);
+}
+
+TEST(FreeList, AllocatesFirstFitFromTheFront) {
+    FreeList list(1024);
+    uint64_t a = 0, b = 0, c = 0;
+    ASSERT_TRUE(list.allocate(100, 1, a));
+    ASSERT_TRUE(list.allocate(200, 1, b));
+    ASSERT_TRUE(list.allocate(300, 1, c));
+    EXPECT_EQ(a, 0u);
+    EXPECT_EQ(b, 100u);
+    EXPECT_EQ(c, 300u);
+    EXPECT_EQ(list.getRanges(), (Ranges{ { 600, 424 } }));
+}
+
+TEST(FreeList, FailsWhenNoRangeFits) {
+    FreeList list(256);
+    uint64_t offset = 0;
+    EXPECT_FALSE(list.allocate(257, 1, offset));
+    ASSERT_TRUE(list.allocate(256, 1, offset));
+    EXPECT_EQ(list.getRangeCount(), 0u);
+    EXPECT_FALSE(list.allocate(1, 1, offset));
+}
+
+TEST(FreeList, ReusesTheFirstHoleThatFits) {
+    FreeList list(1024);
+    uint64_t a = 0, b = 0, c = 0;
+    ASSERT_TRUE(list.allocate(64, 1, a));
+    ASSERT_TRUE(list.allocate(256, 1, b));
+    ASSERT_TRUE(list.allocate(64, 1, c));
+    list.free(b, 256);
+
+    // Too big for the hole, so it goes after c; a small one then fills the hole
+    uint64_t big = 0, small = 0;
+    ASSERT_TRUE(list.allocate(512, 1, big));
+    EXPECT_EQ(big, 384u);
+    ASSERT_TRUE(list.allocate(128, 1, small));
+    EXPECT_EQ(small, 64u);
+}
+
+TEST(FreeList, NonPowerOfTwoAlignmentRoundsToAMultiple) {
+    FreeList list(1024);
+    uint64_t a = 0, b = 0;
+    ASSERT_TRUE(list.allocate(10, 1, a));
+    ASSERT_TRUE(list.allocate(10, 24, b));
+    EXPECT_EQ(b, 24u);
+}
+
+TEST(FreeList, AlignmentPaddingStaysFree) {
+    FreeList list(1024);
+    uint64_t a = 0, b = 0;
+    ASSERT_TRUE(list.allocate(10, 1, a));
+    ASSERT_TRUE(list.allocate(100, 256, b));
+    EXPECT_EQ(b, 256u);
+    EXPECT_EQ(list.getRanges(), (Ranges{ { 10, 246 }, { 356, 668 } }));
+
+    // The padding can be handed out again
+    uint64_t c = 0;
+    ASSERT_TRUE(list.allocate(200, 8, c));
+    EXPECT_EQ(c, 16u);
+}
+
+TEST(FreeList, FreeMergesWithTheNextRange) {
+    FreeList list(1024);
+    uint64_t a = 0, b = 0;
+    ASSERT_TRUE(list.allocate(100, 1, a));
+    ASSERT_TRUE(list.allocate(100, 1, b));
+    list.free(b, 100);
+    EXPECT_EQ(list.getRanges(), (Ranges{ { 100, 924 } }));
+}
+
+TEST(FreeList, FreeMergesWithThePreviousRange) {
+    FreeList list(300);
+    uint64_t a = 0, b = 0, c = 0;
+    ASSERT_TRUE(list.allocate(100, 1, a));
+    ASSERT_TRUE(list.allocate(100, 1, b));
+    ASSERT_TRUE(list.allocate(100, 1, c));
+    list.free(a, 100);
+    list.free(b, 100);
+    EXPECT_EQ(list.getRanges(), (Ranges{ { 0, 200 } }));
+}
+
+TEST(FreeList, FreeBridgesBothNeighbours) {
+    FreeList list(300);
+    uint64_t a = 0, b = 0, c = 0;
+    ASSERT_TRUE(list.allocate(100, 1, a));
+    ASSERT_TRUE(list.allocate(100, 1, b));
+    ASSERT_TRUE(list.allocate(100, 1, c));
+    list.free(a, 100);
+    list.free(c, 100);
+    EXPECT_EQ(list.getRangeCount(), 2u);
+
+    list.free(b, 100);
+    EXPECT_EQ(list.getRanges(), (Ranges{ { 0, 300 } }));
+    EXPECT_EQ(list.getLargestRange(), 300u);
+}
+
+TEST(FreeList, FreeKeepsNonAdjacentRangesApart) {
+    FreeList list(400);
+    uint64_t offsets[4];
+    for (uint64_t& offset : offsets) {
+        ASSERT_TRUE(list.allocate(100, 1, offset));
+    }
+    list.free(offsets[0], 100);
+    list.free(offsets[2], 100);
+    EXPECT_EQ(list.getRanges(), (Ranges{ { 0, 100 }, { 200, 100 } }));
+    EXPECT_EQ(list.getLargestRange(), 100u);
+}
+
+TEST(FreeList, PaddingIsReclaimedWhenItsNeighbourIsFreed) {
+    FreeList list(1024);
+    uint64_t a = 0, b = 0;
+    ASSERT_TRUE(list.allocate(10, 1, a));
+    ASSERT_TRUE(list.allocate(100, 256, b));
+    list.free(a, 10);
+    list.free(b, 100);
+    EXPECT_EQ(list.getRanges(), (Ranges{ { 0, 1024 } }));
+}
+
+TEST(FreeList, ChurnEndsAsOneRange) {
+    FreeList list(1 << 20);
+    std::map<uint64_t, uint64_t> live;
+    uint64_t seed = 12345;
+    auto next = [&seed] {
+        seed = seed * 6364136223846793005ull + 1442695040888963407ull;
+        return seed >> 33;
+    };
+    for (int i = 0; i < 2000; i++) {
+        if (live.empty() || next() % 3 != 0) {
+            uint64_t size = 1 + next() % 4096;
+            uint64_t alignment = uint64_t{ 1 } << (next() % 9);
+            uint64_t offset = 0;
+            if (list.allocate(size, alignment, offset)) {
+                EXPECT_EQ(offset % alignment, 0u);
+                // Never overlaps a live allocation
+                auto after = live.lower_bound(offset);
+                if (after != live.end()) {
+                    EXPECT_LE(offset + size, after->first);
+                }
+                if (after != live.begin()) {
+                    auto before = std::prev(after);
+                    EXPECT_LE(before->first + before->second, offset);
+                }
+                live.emplace(offset, size);
+            }
+        } else {
+            auto victim = std::next(live.begin(), static_cast<long>(next() % live.size()));
+            list.free(victim->first, victim->second);
+            live.erase(victim);
+        }
+    }
+    for (const auto& [offset, size] : live) {
+        list.free(offset, size);
+    }
+    EXPECT_EQ(list.getRanges(), (Ranges{ { 0, 1 << 20 } }));
+}
@@ -0,0 +1,216 @@
+// JobSystem: groups, work stealing, the owner's LIFO order, failures and main-thread publishing
+
+#include "src/core/JobSystem.hpp"
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+namespace {
+    constexpr auto TIMEOUT = std::chrono::seconds(10);
+
+    // Wait without helping, so only the workers take jobs
+    bool waitWithoutRunning(const JobGroup& group) {
+        auto deadline = std::chrono::steady_clock::now() + TIMEOUT;
+        while (!group.isDone()) {
+            if (std::chrono::steady_clock::now() > deadline) {
+                return false;
+            }
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    // One-shot gate a job can block on
+    class Gate {
+    public:
+        void open() {
+            {
+                std::lock_guard lock(mutex);
+                opened = true;
+            }
+            changed.notify_all();
+        }
+
+        bool waitOpen() {
+            std::unique_lock lock(mutex);
+            return changed.wait_for(lock, TIMEOUT, [this] { return opened; });
+        }
+
+    private:
+        std::mutex mutex;
+        std::condition_variable changed;
+        bool opened = false;
+    };
+}
+
+TEST(JobSystem, PicksAThreadCount) {
+    EXPECT_EQ(JobSystem(3).getThreadCount(), 3u);
+    EXPECT_GE(JobSystem().getThreadCount(), 1u);
+}
+
+TEST(JobSystem, WaitReturnsOnceEveryJobOfTheGroupRan) {
+    JobSystem jobs(4);
+    JobGroup group;
+    std::atomic<int> count = 0;
+    for (int i = 0; i < 1000; i++) {
+        jobs.submit([&] { count.fetch_add(1, std::memory_order_relaxed); }, &group);
+    }
+    jobs.wait(group);
+    EXPECT_TRUE(group.isDone());
+    EXPECT_EQ(count.load(), 1000);
+}
+
+TEST(JobSystem, WaitOnAnEmptyGroupReturnsAtOnce) {
+    JobSystem jobs(1);
+    JobGroup group;
+    EXPECT_TRUE(group.isDone());
+    jobs.wait(group);
+}
+
+TEST(JobSystem, WaitCoversJobsSubmittedByJobs) {
+    JobSystem jobs(2);
+    JobGroup group;
+    std::atomic<int> count = 0;
+    for (int i = 0; i < 10; i++) {
+        jobs.submit([&] {
+            for (int j = 0; j < 10; j++) {
+                jobs.submit([&] { count.fetch_add(1, std::memory_order_relaxed); }, &group);
+            }
+        }, &group);
+    }
+    jobs.wait(group);
+    EXPECT_EQ(count.load(), 100);
+}
+
+TEST(JobSystem, WaitRunsQueuedJobsOnTheWaitingThread) {
+    JobSystem jobs(1);
+    Gate gate;
+    JobGroup blocker;
+    jobs.submit([&] { gate.waitOpen(); }, &blocker);
+
+    // The only worker is stuck, so the waiter has to run these itself
+    JobGroup group;
+    std::atomic<int> onMain = 0;
+    const std::thread::id mainThread = std::this_thread::get_id();
+    for (int i = 0; i < 8; i++) {
+        jobs.submit([&] {
+            if (std::this_thread::get_id() == mainThread) {
+                onMain.fetch_add(1);
+            }
+        }, &group);
+    }
+    jobs.wait(group);
+    gate.open();
+    jobs.wait(blocker);
+    EXPECT_EQ(onMain.load(), 8);
+}
+
+TEST(JobSystem, WorkersRunTheirOwnFollowUpsNewestFirst) {
+    JobSystem jobs(1);
+    JobGroup group;
+    std::mutex mutex;
+    std::vector<int> order;
+    jobs.submit([&] {
+        for (int i = 0; i < 4; i++) {
+            jobs.submit([&, i] {
+                std::lock_guard lock(mutex);
+                order.push_back(i);
+            }, &group);
+        }
+    }, &group);
+    ASSERT_TRUE(waitWithoutRunning(group));
+    EXPECT_EQ(order, (std::vector<int>{ 3, 2, 1, 0 }));
+}
+
+TEST(JobSystem, IdleWorkersStealQueuedFollowUps) {
+    JobSystem jobs(2);
+    JobGroup group;
+    std::atomic<bool> stolen = false;
+    Gate stealSeen;
+    jobs.submit([&] {
+        const std::thread::id owner = std::this_thread::get_id();
+        for (int i = 0; i < 4; i++) {
+            // All four land on the owner's deque; only another worker can take one now
+            jobs.submit([&, owner] {
+                if (std::this_thread::get_id() != owner && !stolen.exchange(true)) {
+                    stealSeen.open();
+                }
+            }, &group);
+        }
+        stealSeen.waitOpen();
+    }, &group);
+    ASSERT_TRUE(waitWithoutRunning(group));
+    EXPECT_TRUE(stolen.load());
+}
+
+TEST(JobSystem, ThrowingJobsDontStopTheWorkers) {
+    JobSystem jobs(1);
+    JobGroup group;
+    std::atomic<int> count = 0;
+    jobs.submit([] { throw std::runtime_error("expected by the test"); }, &group);
+    jobs.submit([] { throw 42; }, &group);
+    jobs.submit([&] { count.fetch_add(1); }, &group);
+    ASSERT_TRUE(waitWithoutRunning(group));
+    EXPECT_EQ(count.load(), 1);
+
+    JobGroup later;
+    jobs.submit([&] { count.fetch_add(1); }, &later);
+    ASSERT_TRUE(waitWithoutRunning(later));
+    EXPECT_EQ(count.load(), 2);
+}
+
+TEST(JobSystem, DestructorRunsTheJobsStillQueued) {
+    std::atomic<int> count = 0;
+    {
+        JobSystem jobs(2);
+        for (int i = 0; i < 200; i++) {
+            jobs.submit([&] { count.fetch_add(1, std::memory_order_relaxed); });
+        }
+    }
+    EXPECT_EQ(count.load(), 200);
+}
+
+TEST(JobSystem, PublishedJobsRunOnlyInRunPublished) {
+    JobSystem jobs(2);
+    std::vector<int> order;
+    std::thread::id ranOn;
+    jobs.publish([&] { order.push_back(1); ranOn = std::this_thread::get_id(); });
+    jobs.publish([&] { order.push_back(2); });
+    EXPECT_TRUE(order.empty());
+
+    EXPECT_EQ(jobs.runPublished(), 2u);
+    EXPECT_EQ(order, (std::vector<int>{ 1, 2 }));
+    EXPECT_EQ(ranOn, std::this_thread::get_id());
+    EXPECT_EQ(jobs.runPublished(), 0u);
+}
+
+TEST(JobSystem, JobsPublishedWhileRunningWaitForTheNextCall) {
+    JobSystem jobs(1);
+    int count = 0;
+    jobs.publish([&] {
+        count++;
+        jobs.publish([&] { count += 10; });
+    });
+    EXPECT_EQ(jobs.runPublished(), 1u);
+    EXPECT_EQ(count, 1);
+    EXPECT_EQ(jobs.runPublished(), 1u);
+    EXPECT_EQ(count, 11);
+}
+
+TEST(JobSystem, WorkersHandResultsToTheMainThread) {
+    JobSystem jobs(4);
+    JobGroup group;
+    int sum = 0;  // Only touched by published jobs, so it needs no lock
+    for (int i = 1; i <= 100; i++) {
+        jobs.submit([&, i] { jobs.publish([&, i] { sum += i; }); }, &group);
+    }
+    jobs.wait(group);
+    EXPECT_EQ(jobs.runPublished(), 100u);
+    EXPECT_EQ(sum, 5050);
+}
@@ -0,0 +1,190 @@
+// MeshCache: round trips and every way a cache file stops matching its source
+
+#include "src/loaders/MeshCache.hpp"
+#include "tests/ScratchFile.hpp"
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <span>
+#include <string>
+#include <system_error>
+#include <vector>
+
+namespace {
+    class MeshCacheTest : public ::testing::Test {
+    protected:
+        ScratchFile source{ ".obj", "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n" };
+        std::vector<Vertex> vertices{
+            { { 0.0f, 0.0f, 0.0f }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f } },
+            { { 1.0f, 0.0f, 0.0f }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 1.0f } },
+            { { 0.0f, 1.0f, 0.0f }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 0.0f } }
+        };
+        std::vector<uint16_t> indices{ 0, 1, 2 };
+
+        void TearDown() override {
+            std::error_code error;
+            std::filesystem::remove(MeshCache::cachePath(source.path()), error);
+            std::filesystem::remove(MeshCache::cachePath(source.path()) + ".tmp", error);
+        }
+
+        MeshBlobView standardBlobs() const {
+            return {
+                .vertexFormat = VertexFormat::Standard,
+                .indexSize = 2,
+                .vertexCount = static_cast<uint32_t>(vertices.size()),
+                .indexCount = static_cast<uint32_t>(indices.size()),
+                .vertexData = std::as_bytes(std::span(vertices)),
+                .indexData = std::as_bytes(std::span(indices))
+            };
+        }
+
+        std::vector<char> readCache() const {
+            std::ifstream in(MeshCache::cachePath(source.path()), std::ios::binary);
+            return { std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>() };
+        }
+
+        void writeCache(const std::vector<char>& bytes) const {
+            std::ofstream out(MeshCache::cachePath(source.path()), std::ios::binary | std::ios::trunc);
+            out.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+        }
+    };
+
+    bool sameBytes(std::span<const std::byte> a, std::span<const std::byte> b) {
+        return std::ranges::equal(a, b);
+    }
+}
+
+TEST_F(MeshCacheTest, CachePathSitsNextToTheSource) {
+    EXPECT_EQ(MeshCache::cachePath("models/room.obj"), "models/room.obj.meshcache");
+}
+
+TEST_F(MeshCacheTest, MissesWithoutACacheFile) {
+    EXPECT_FALSE(MeshCache::load(source.path(), VertexFormat::Standard).has_value());
+}
+
+TEST_F(MeshCacheTest, RoundTripsStandardVertices) {
+    ASSERT_TRUE(MeshCache::store(source.path(), standardBlobs(), 7));
+    EXPECT_FALSE(std::filesystem::exists(MeshCache::cachePath(source.path()) + ".tmp"));
+
+    auto cache = MeshCache::load(source.path(), VertexFormat::Standard, 7);
+    ASSERT_TRUE(cache.has_value());
+    const MeshBlobView& blobs = cache->getBlobs();
+    EXPECT_EQ(blobs.vertexFormat, VertexFormat::Standard);
+    EXPECT_EQ(blobs.indexSize, 2u);
+    EXPECT_EQ(blobs.vertexCount, 3u);
+    EXPECT_EQ(blobs.indexCount, 3u);
+    EXPECT_TRUE(sameBytes(blobs.vertexData, standardBlobs().vertexData));
+    EXPECT_TRUE(sameBytes(blobs.indexData, standardBlobs().indexData));
+
+    // Blobs are aligned for in-place reads
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(blobs.vertexData.data()) % 16, 0u);
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(blobs.indexData.data()) % 16, 0u);
+}
+
+TEST_F(MeshCacheTest, RoundTripsPackedVerticesAndTheirQuantization) {
+    std::vector<PackedVertex> packed{
+        { { -32767, 0, 32767, 0 }, { 255, 128, 0, 255 }, { 0, 65535 } },
+        { { 1, 2, 3, 0 }, { 1, 2, 3, 4 }, { 100, 200 } }
+    };
+    std::vector<uint32_t> packedIndices{ 0, 1, 1 };
+    MeshBlobView blobs{
+        .vertexFormat = VertexFormat::Packed,
+        .indexSize = 4,
+        .quantization = {
+            .positionCenter = { 1.0f, 2.0f, 3.0f, 0.0f },
+            .positionExtent = { 4.0f, 5.0f, 6.0f, 0.0f },
+            .texCoordRange = { 0.25f, 0.5f, 2.0f, 4.0f }
+        },
+        .vertexCount = static_cast<uint32_t>(packed.size()),
+        .indexCount = static_cast<uint32_t>(packedIndices.size()),
+        .vertexData = std::as_bytes(std::span(packed)),
+        .indexData = std::as_bytes(std::span(packedIndices))
+    };
+    ASSERT_TRUE(MeshCache::store(source.path(), blobs));
+
+    auto cache = MeshCache::load(source.path(), VertexFormat::Packed);
+    ASSERT_TRUE(cache.has_value());
+    const MeshBlobView& loaded = cache->getBlobs();
+    EXPECT_EQ(loaded.indexSize, 4u);
+    EXPECT_TRUE(sameBytes(loaded.vertexData, blobs.vertexData));
+    EXPECT_TRUE(sameBytes(loaded.indexData, blobs.indexData));
+    EXPECT_EQ(loaded.quantization.positionCenter.y, 2.0f);
+    EXPECT_EQ(loaded.quantization.positionExtent.z, 6.0f);
+    EXPECT_EQ(loaded.quantization.texCoordRange.w, 4.0f);
+}
+
+TEST_F(MeshCacheTest, MissesForAnotherVertexFormat) {
+    ASSERT_TRUE(MeshCache::store(source.path(), standardBlobs()));
+    EXPECT_FALSE(MeshCache::load(source.path(), VertexFormat::Packed).has_value());
+}
+
+TEST_F(MeshCacheTest, MissesForAnotherProcessingKey) {
+    ASSERT_TRUE(MeshCache::store(source.path(), standardBlobs(), 1));
+    EXPECT_FALSE(MeshCache::load(source.path(), VertexFormat::Standard, 2).has_value());
+    EXPECT_TRUE(MeshCache::load(source.path(), VertexFormat::Standard, 1).has_value());
+}
+
+TEST_F(MeshCacheTest, MissesWhenTheSourceChangesSize) {
+    ASSERT_TRUE(MeshCache::store(source.path(), standardBlobs()));
+    source.write("v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nf 1 2 3\nf 2 4 3\n");
+    EXPECT_FALSE(MeshCache::load(source.path(), VertexFormat::Standard).has_value());
+}
+
+TEST_F(MeshCacheTest, MissesWhenTheSourceIsTouched) {
+    ASSERT_TRUE(MeshCache::store(source.path(), standardBlobs()));
+    auto modified = std::filesystem::last_write_time(source.path());
+    std::filesystem::last_write_time(source.path(), modified + std::chrono::hours(1));
+    EXPECT_FALSE(MeshCache::load(source.path(), VertexFormat::Standard).has_value());
+}
+
+TEST_F(MeshCacheTest, MissesWhenTheSourceIsGone) {
+    ASSERT_TRUE(MeshCache::store(source.path(), standardBlobs()));
+    std::filesystem::remove(source.path());
+    EXPECT_FALSE(MeshCache::load(source.path(), VertexFormat::Standard).has_value());
+}
+
+TEST_F(MeshCacheTest, StoreFailsWithoutASource) {
+    EXPECT_FALSE(MeshCache::store(source.path() + ".missing", standardBlobs()));
+}
+
+TEST_F(MeshCacheTest, MissesForACorruptHeader) {
+    ASSERT_TRUE(MeshCache::store(source.path(), standardBlobs()));
+    std::vector<char> bytes = readCache();
+    bytes[0] ^= 0x20;  // Magic
+    writeCache(bytes);
+    EXPECT_FALSE(MeshCache::load(source.path(), VertexFormat::Standard).has_value());
+}
+
+TEST_F(MeshCacheTest, MissesForAnotherVersion) {
+    ASSERT_TRUE(MeshCache::store(source.path(), standardBlobs()));
+    std::vector<char> bytes = readCache();
+    const uint32_t version = MeshCache::VERSION + 1;
+    std::copy_n(reinterpret_cast<const char*>(&version), sizeof(version), bytes.begin() + 8);
+    writeCache(bytes);
+    EXPECT_FALSE(MeshCache::load(source.path(), VertexFormat::Standard).has_value());
+}
+
+TEST_F(MeshCacheTest, MissesForATruncatedFile) {
+    ASSERT_TRUE(MeshCache::store(source.path(), standardBlobs()));
+    std::vector<char> bytes = readCache();
+    for (size_t size : { bytes.size() - 1, bytes.size() / 2, size_t{ 16 }, size_t{ 0 } }) {
+        writeCache(std::vector<char>(bytes.begin(), bytes.begin() + static_cast<std::ptrdiff_t>(size)));
+        EXPECT_FALSE(MeshCache::load(source.path(), VertexFormat::Standard).has_value()) << size << " bytes";
+    }
+}
+
+TEST_F(MeshCacheTest, StoreReplacesAnOlderCache) {
+    ASSERT_TRUE(MeshCache::store(source.path(), standardBlobs(), 1));
+    indices = { 2, 1, 0 };
+    ASSERT_TRUE(MeshCache::store(source.path(), standardBlobs(), 2));
+
+    auto cache = MeshCache::load(source.path(), VertexFormat::Standard, 2);
+    ASSERT_TRUE(cache.has_value());
+    EXPECT_TRUE(sameBytes(cache->getBlobs().indexData, standardBlobs().indexData));
+}
@@ -0,0 +1,150 @@
+// OBJLoader::buildVertices: corner dedupe on (vertex, texcoord, normal) index triples
+
+#include "src/loaders/OBJLoader.hpp"
+#include <tiny_obj_loader.h>
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+    tinyobj::index_t corner(int vertex, int texcoord = -1, int normal = -1) {
+        tinyobj::index_t index{};
+        index.vertex_index = vertex;
+        index.texcoord_index = texcoord;
+        index.normal_index = normal;
+        return index;
+    }
+
+    tinyobj::shape_t shape(std::vector<tinyobj::index_t> corners) {
+        tinyobj::shape_t result;
+        result.mesh.indices = std::move(corners);
+        return result;
+    }
+
+    // Unit square as two triangles: four positions and four texcoords
+    tinyobj::attrib_t squareAttrib() {
+        tinyobj::attrib_t attrib;
+        attrib.vertices = { 0, 0, 0,  1, 0, 0,  1, 1, 0,  0, 1, 0 };
+        attrib.texcoords = { 0, 0,  1, 0,  1, 1,  0, 1 };
+        attrib.normals = { 0, 0, 1,  0, 0, -1 };
+        return attrib;
+    }
+}
+
+TEST(OBJLoader, SharedCornersBecomeOneVertex) {
+    std::vector<tinyobj::shape_t> shapes{ shape({
+        corner(0, 0), corner(1, 1), corner(2, 2),
+        corner(0, 0), corner(2, 2), corner(3, 3)
+    }) };
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    OBJLoader::buildVertices(squareAttrib(), shapes, vertices, indices);
+
+    EXPECT_EQ(vertices.size(), 4u);
+    EXPECT_EQ(indices, (std::vector<uint32_t>{ 0, 1, 2, 0, 2, 3 }));
+    EXPECT_EQ(vertices[2].pos, glm::vec3(1.0f, 1.0f, 0.0f));
+}
+
+TEST(OBJLoader, AnyDifferingIndexSplitsTheVertex) {
+    // Same position with another texcoord or normal is a seam, not a shared vertex
+    std::vector<tinyobj::shape_t> shapes{ shape({
+        corner(0, 0, 0), corner(0, 1, 0), corner(0, 0, 1), corner(0, -1, 0), corner(0, 0, -1), corner(0, 0, 0)
+    }) };
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    OBJLoader::buildVertices(squareAttrib(), shapes, vertices, indices);
+
+    EXPECT_EQ(vertices.size(), 5u);
+    EXPECT_EQ(indices, (std::vector<uint32_t>{ 0, 1, 2, 3, 4, 0 }));
+}
+
+TEST(OBJLoader, FlipsTexcoordsAndZeroesMissingOnes) {
+    std::vector<tinyobj::shape_t> shapes{ shape({ corner(1, 1), corner(3, 3), corner(2) }) };
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    OBJLoader::buildVertices(squareAttrib(), shapes, vertices, indices);
+
+    ASSERT_EQ(vertices.size(), 3u);
+    EXPECT_EQ(vertices[0].texCoord, glm::vec2(1.0f, 1.0f));
+    EXPECT_EQ(vertices[1].texCoord, glm::vec2(0.0f, 0.0f));
+    EXPECT_EQ(vertices[2].texCoord, glm::vec2(0.0f, 0.0f));
+}
+
+TEST(OBJLoader, UsesVertexColorsWhenEveryVertexHasOne) {
+    tinyobj::attrib_t attrib = squareAttrib();
+    std::vector<tinyobj::shape_t> shapes{ shape({ corner(0), corner(1), corner(2) }) };
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+
+    OBJLoader::buildVertices(attrib, shapes, vertices, indices);
+    EXPECT_EQ(vertices[1].color, glm::vec3(1.0f, 1.0f, 1.0f));
+
+    attrib.colors = { 1, 0, 0,  0, 1, 0,  0, 0, 1,  1, 1, 0 };
+    OBJLoader::buildVertices(attrib, shapes, vertices, indices);
+    EXPECT_EQ(vertices[1].color, glm::vec3(0.0f, 1.0f, 0.0f));
+}
+
+TEST(OBJLoader, DedupesAcrossShapes) {
+    std::vector<tinyobj::shape_t> shapes{
+        shape({ corner(0, 0), corner(1, 1), corner(2, 2) }),
+        shape({ corner(0, 0), corner(2, 2), corner(3, 3) })
+    };
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    OBJLoader::buildVertices(squareAttrib(), shapes, vertices, indices);
+
+    EXPECT_EQ(vertices.size(), 4u);
+    EXPECT_EQ(indices, (std::vector<uint32_t>{ 0, 1, 2, 0, 2, 3 }));
+}
+
+TEST(OBJLoader, ClearsPreviousOutput) {
+    std::vector<tinyobj::shape_t> shapes{ shape({ corner(0), corner(1), corner(2) }) };
+    std::vector<Vertex> vertices(10);
+    std::vector<uint32_t> indices(10, 7);
+    OBJLoader::buildVertices(squareAttrib(), shapes, vertices, indices);
+    EXPECT_EQ(vertices.size(), 3u);
+    EXPECT_EQ(indices, (std::vector<uint32_t>{ 0, 1, 2 }));
+}
+
+TEST(OBJLoader, TableGrowsPastItsInitialEstimate) {
+    // Every corner unique, four times the keys the table is first sized for, then all over again
+    constexpr int POSITIONS = 5000;
+    constexpr int TEXCOORDS = 7;
+    tinyobj::attrib_t attrib;
+    for (int i = 0; i < POSITIONS; i++) {
+        attrib.vertices.insert(attrib.vertices.end(), { static_cast<float>(i), 0.0f, 0.0f });
+    }
+    for (int t = 0; t < TEXCOORDS; t++) {
+        attrib.texcoords.insert(attrib.texcoords.end(), { static_cast<float>(t), 0.0f });
+    }
+    std::vector<tinyobj::index_t> corners;
+    for (int pass = 0; pass < 2; pass++) {
+        for (int i = 0; i < POSITIONS; i++) {
+            for (int t = 0; t < TEXCOORDS; t++) {
+                corners.push_back(corner(i, t));
+            }
+        }
+    }
+    std::vector<tinyobj::shape_t> shapes{ shape(corners) };
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    OBJLoader::buildVertices(attrib, shapes, vertices, indices);
+
+    constexpr size_t UNIQUE = static_cast<size_t>(POSITIONS) * TEXCOORDS;
+    ASSERT_EQ(vertices.size(), UNIQUE);
+    ASSERT_EQ(indices.size(), 2 * UNIQUE);
+    for (size_t c = 0; c < UNIQUE; c++) {
+        ASSERT_EQ(indices[c], c);
+        ASSERT_EQ(indices[UNIQUE + c], c);
+        ASSERT_EQ(vertices[c].pos.x, static_cast<float>(c / TEXCOORDS));
+        ASSERT_EQ(vertices[c].texCoord.x, static_cast<float>(c % TEXCOORDS));
+    }
+}
+
+TEST(OBJLoader, LoadThrowsForMissingFiles) {
+    std::vector<Vertex> vertices;
+    std::vector<uint32_t> indices;
+    EXPECT_THROW(OBJLoader::load("does/not/exist.obj", vertices, indices), std::runtime_error);
+}
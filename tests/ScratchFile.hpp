@@ -0,0 +1,42 @@
+#pragma once
+
+#include <gtest/gtest.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+/**
+ * @brief File in the temp directory, named after the running test and removed with it
+ *
+ * ctest may run tests in parallel, so every test writes its own files.
+ */
+class ScratchFile {
+public:
+    explicit ScratchFile(std::string_view suffix, std::string_view contents = {}) {
+        const ::testing::TestInfo* test = ::testing::UnitTest::GetInstance()->current_test_info();
+        std::string name = std::string("engineTests_") + test->test_suite_name() + "_" + test->name() + std::string(suffix);
+        filePath = (std::filesystem::temp_directory_path() / name).string();
+        write(contents);
+    }
+
+    ~ScratchFile() {
+        std::error_code error;
+        std::filesystem::remove(filePath, error);
+    }
+
+    ScratchFile(const ScratchFile&) = delete;
+    ScratchFile& operator=(const ScratchFile&) = delete;
+
+    void write(std::string_view contents) const {
+        std::ofstream out(filePath, std::ios::binary | std::ios::trunc);
+        out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    }
+
+    const std::string& path() const { return filePath; }
+
+private:
+    std::string filePath;
+};